@@ -0,0 +1,257 @@
+package com.sri.yices;
+
+import java.io.BufferedReader;
+import java.io.IOException;
+import java.io.PrintWriter;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Paths;
+import java.util.ArrayList;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * Benchmarks for the JNI hot paths and some solver workloads (cf. ant bench).
+ *
+ * JMH is not in lib/ so this is a minimal harness in the same spirit: each
+ * case is run for a few warmup rounds, then for a few measured rounds of fixed
+ * duration, and we report the mean time per operation and its standard deviation
+ * across rounds. The results can be saved and later compared with a baseline.
+ *
+ * Usage: java com.sri.yices.Bench [options] [filter ...]
+ *   -warmup N        number of warmup rounds (default 3)
+ *   -rounds N        number of measured rounds (default 5)
+ *   -time MS         duration of one round in milliseconds (default 500)
+ *   -save FILE       save the results in FILE
+ *   -baseline FILE   compare with the results saved in FILE
+ *   -threshold P     tolerated slowdown in percent (default 20)
+ *   -list            print the case names and exit
+ * If filters are given, only the cases whose name contains one of them are run.
+ *
+ * The exit status is 1 if a case is slower than its baseline by more than the
+ * threshold, and 2 if the Yices library can't be loaded.
+ */
+public final class Bench {
+
+    /*
+     * A benchmark case
+     * - setUp is called once before the warmup rounds, tearDown once after the last round
+     * - op does one operation: its result is accumulated in a sink so that the
+     *   JIT can't drop the work
+     */
+    static abstract class Case {
+        final String name;
+
+        Case(String name) {
+            this.name = name;
+        }
+
+        void setUp() throws Exception { }
+
+        abstract int op() throws Exception;
+
+        void tearDown() throws Exception { }
+    }
+
+    /*
+     * Result of a case: mean and standard deviation of the time per operation
+     * over the measured rounds, in nanoseconds.
+     */
+    static final class Result {
+        final String name;
+        final double mean;
+        final double stddev;
+        final long ops;
+
+        Result(String name, double mean, double stddev, long ops) {
+            this.name = name;
+            this.mean = mean;
+            this.stddev = stddev;
+            this.ops = ops;
+        }
+    }
+
+    private static volatile int sink;
+
+    private int warmup = 3;
+    private int rounds = 5;
+    private long roundNanos = 500000000L;
+
+    private Bench() { }
+
+    /*
+     * All the cases
+     */
+    static List<Case> allCases() {
+        ArrayList<Case> list = new ArrayList<>();
+        TermBench.addCases(list);
+        ContextBench.addCases(list);
+        ModelBench.addCases(list);
+        ThreadBench.addCases(list);
+        return list;
+    }
+
+    /*
+     * Run op until roundNanos have elapsed (at least once)
+     * - returns { number of operations, elapsed time }
+     */
+    private long[] round(Case c) throws Exception {
+        int acc = 0;
+        long ops = 0;
+        long start = System.nanoTime();
+        long elapsed;
+        do {
+            acc += c.op();
+            ops ++;
+            elapsed = System.nanoTime() - start;
+        } while (elapsed < roundNanos);
+        sink += acc;
+        return new long[] { ops, elapsed };
+    }
+
+    private Result run(Case c) throws Exception {
+        c.setUp();
+        try {
+            for (int i = 0; i < warmup; i++) {
+                round(c);
+            }
+            double[] t = new double[rounds];
+            long ops = 0;
+            double sum = 0;
+            for (int i = 0; i < rounds; i++) {
+                long[] r = round(c);
+                t[i] = (double) r[1] / r[0];
+                ops += r[0];
+                sum += t[i];
+            }
+            double mean = sum / rounds;
+            double var = 0;
+            for (double x : t) {
+                var += (x - mean) * (x - mean);
+            }
+            double stddev = rounds > 1 ? Math.sqrt(var / (rounds - 1)) : 0;
+            return new Result(c.name, mean, stddev, ops);
+        } finally {
+            c.tearDown();
+        }
+    }
+
+    /*
+     * Baseline files:
+     * - one line per case: name, mean ns/op, stddev
+     * - empty lines and lines that start with '#' are ignored
+     */
+    static void save(String file, List<Result> results) throws IOException {
+        try (PrintWriter w = new PrintWriter(Files.newBufferedWriter(Paths.get(file), StandardCharsets.UTF_8))) {
+            w.println("# Yices " + Yices.version() + ", bindings " + Version.versionString + ", "
+                      + System.getProperty("java.vm.name") + " " + System.getProperty("java.version"));
+            for (Result r : results) {
+                w.printf("%s\t%.1f\t%.1f%n", r.name, r.mean, r.stddev);
+            }
+        }
+    }
+
+    static Map<String, Double> load(String file) throws IOException {
+        LinkedHashMap<String, Double> map = new LinkedHashMap<>();
+        try (BufferedReader r = Files.newBufferedReader(Paths.get(file), StandardCharsets.UTF_8)) {
+            String line;
+            while ((line = r.readLine()) != null) {
+                line = line.trim();
+                if (line.isEmpty() || line.startsWith("#")) continue;
+                String[] fields = line.split("\t");
+                if (fields.length < 2) throw new IOException("bad baseline line: " + line);
+                map.put(fields[0], Double.parseDouble(fields[1]));
+            }
+        }
+        return map;
+    }
+
+    private static boolean selected(String name, List<String> filters) {
+        if (filters.isEmpty()) return true;
+        for (String f : filters) {
+            if (name.contains(f)) return true;
+        }
+        return false;
+    }
+
+    public static void main(String[] args) throws Exception {
+        Bench bench = new Bench();
+        String saveFile = null;
+        String baselineFile = null;
+        double threshold = 20;
+        boolean list = false;
+        ArrayList<String> filters = new ArrayList<>();
+
+        for (int i = 0; i < args.length; i++) {
+            String a = args[i];
+            if (a.equals("-list")) {
+                list = true;
+            } else if (a.startsWith("-")) {
+                if (i + 1 == args.length) throw new IllegalArgumentException("missing value for " + a);
+                String v = args[++i];
+                switch (a) {
+                case "-warmup": bench.warmup = Integer.parseInt(v); break;
+                case "-rounds": bench.rounds = Math.max(1, Integer.parseInt(v)); break;
+                case "-time": bench.roundNanos = Long.parseLong(v) * 1000000L; break;
+                case "-save": saveFile = v; break;
+                case "-baseline": baselineFile = v; break;
+                case "-threshold": threshold = Double.parseDouble(v); break;
+                default: throw new IllegalArgumentException("unknown option " + a);
+                }
+            } else {
+                filters.add(a);
+            }
+        }
+
+        boolean ready;
+        try {
+            ready = Yices.isReady();
+        } catch (LinkageError e) {
+            System.err.println(e.getMessage());
+            ready = false;
+        }
+        if (!ready) {
+            System.err.println("Bench: the Yices library could not be loaded");
+            System.exit(2);
+        }
+
+        ArrayList<Case> cases = new ArrayList<>();
+        for (Case c : allCases()) {
+            if (selected(c.name, filters)) cases.add(c);
+        }
+        if (list) {
+            for (Case c : cases) System.out.println(c.name);
+            return;
+        }
+
+        Map<String, Double> baseline = baselineFile == null ? null : load(baselineFile);
+        ArrayList<Result> results = new ArrayList<>();
+        int regressions = 0;
+
+        System.out.printf("%-32s %14s %12s %12s%n", "case", "ns/op", "stddev", "baseline");
+        for (Case c : cases) {
+            Result r = bench.run(c);
+            results.add(r);
+            String cmp = "";
+            if (baseline != null && baseline.containsKey(r.name)) {
+                double b = baseline.get(r.name);
+                double change = 100 * (r.mean - b) / b;
+                cmp = String.format("%+.1f%%", change);
+                if (change > threshold) {
+                    cmp += "  REGRESSION";
+                    regressions ++;
+                }
+            }
+            System.out.printf("%-32s %14.1f %12.1f %12s%n", r.name, r.mean, r.stddev, cmp);
+        }
+
+        if (saveFile != null) {
+            save(saveFile, results);
+        }
+        if (regressions > 0) {
+            System.out.printf("%d case(s) slower than the baseline by more than %.0f%%%n", regressions, threshold);
+            System.exit(1);
+        }
+    }
+}
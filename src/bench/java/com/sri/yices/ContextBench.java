@@ -0,0 +1,81 @@
+package com.sri.yices;
+
+import java.time.Duration;
+import java.util.List;
+
+/**
+ * Context operations: assertion throughput and checks with or without a timeout.
+ */
+final class ContextBench {
+    private ContextBench() { }
+
+    /*
+     * n difference constraints x[i] < x[i+1] over fresh integer variables
+     */
+    static int[] chain(int n) {
+        int[] x = new int[n + 1];
+        for (int i = 0; i <= n; i++) {
+            x[i] = Terms.newUninterpretedTerm(Types.INT);
+        }
+        int[] a = new int[n];
+        for (int i = 0; i < n; i++) {
+            a[i] = Terms.arithLt(x[i], x[i + 1]);
+        }
+        return a;
+    }
+
+    static void addCases(List<Bench.Case> list) {
+        // assert n formulas in a fresh scope then pop it
+        for (int n : new int[] { 10, 1000, 100000 }) {
+            list.add(new Bench.Case("assertFormulas/" + n) {
+                Context ctx;
+                int[] a;
+                void setUp() {
+                    ctx = new Context("QF_IDL");
+                    a = chain(n);
+                }
+                int op() {
+                    ctx.push();
+                    ctx.assertFormulas(a);
+                    ctx.pop();
+                    return a.length;
+                }
+                void tearDown() { ctx.close(); }
+            });
+        }
+
+        // the context is SAT after the first check, so the next checks cost
+        // almost nothing: the difference is the overhead of the deadline
+        list.add(new Bench.Case("check.untimed") {
+            Context ctx;
+            void setUp() {
+                ctx = new Context("QF_IDL");
+                ctx.assertFormulas(chain(100));
+            }
+            int op() { return ctx.check().ordinal(); }
+            void tearDown() { ctx.close(); }
+        });
+        list.add(new Bench.Case("check.timed") {
+            Context ctx;
+            final Duration timeout = Duration.ofSeconds(10);
+            void setUp() {
+                ctx = new Context("QF_IDL");
+                ctx.assertFormulas(chain(100));
+            }
+            int op() { return ctx.check(timeout).ordinal(); }
+            void tearDown() { ctx.close(); }
+        });
+
+        // a real search that's stopped by the timer
+        // (interactive mode so that the context can be checked again after the interrupt)
+        list.add(new Bench.Case("check.timeout/10ms") {
+            Context ctx;
+            void setUp() {
+                ctx = new Context("QF_LIA", "interactive");
+                ctx.assertFormulas(ThreadBench.hardProblem(24));
+            }
+            int op() { return ctx.check(Duration.ofMillis(10)).ordinal(); }
+            void tearDown() { ctx.close(); }
+        });
+    }
+}
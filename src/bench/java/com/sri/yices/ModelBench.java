@@ -0,0 +1,86 @@
+package com.sri.yices;
+
+import java.math.BigInteger;
+import java.util.List;
+
+/**
+ * Model value extraction: bitvector values, rational values with small and big
+ * numerators, and expansion of a function value.
+ */
+final class ModelBench {
+    private ModelBench() { }
+
+    static void addCases(List<Bench.Case> list) {
+        for (int n : new int[] { 8, 64, 1024 }) {
+            list.add(new ModelCase("bvValue/" + n) {
+                int x;
+                void init(Context ctx) {
+                    x = Terms.newUninterpretedTerm(Types.bvType(n));
+                    ctx.assertFormula(Terms.bvEq(x, Terms.bvConst(n, 0x5a5a5a5a5a5a5a5aL)));
+                }
+                int op() { return model.bvValue(x).length; }
+            });
+        }
+
+        list.add(new ModelCase("bigRationalValue/small") {
+            int x;
+            void init(Context ctx) {
+                x = Terms.newUninterpretedTerm(Types.REAL);
+                ctx.assertFormula(Terms.eq(x, Terms.rationalConst(-22, 7)));
+            }
+            int op() { return model.bigRationalValue(x).getNumerator().signum(); }
+        });
+        list.add(new ModelCase("bigRationalValue/big") {
+            int x;
+            void init(Context ctx) {
+                x = Terms.newUninterpretedTerm(Types.REAL);
+                BigInteger num = BigInteger.ONE.shiftLeft(200).add(BigInteger.ONE);
+                BigInteger den = BigInteger.valueOf(3).pow(50);
+                ctx.assertFormula(Terms.eq(x, Terms.rationalConst(num, den)));
+            }
+            int op() { return model.bigRationalValue(x).getNumerator().signum(); }
+        });
+
+        // f is defined on 0 ... 99 so its value has 100 mappings
+        list.add(new ModelCase("valExpandFunction/100") {
+            int f;
+            void init(Context ctx) {
+                f = Terms.newUninterpretedTerm(Types.functionType(Types.INT, Types.INT));
+                for (int i = 0; i < 100; i++) {
+                    int fi = Terms.funApplication(f, Terms.intConst(i));
+                    ctx.assertFormula(Terms.eq(fi, Terms.intConst(i * i)));
+                }
+            }
+            int op() {
+                YVal v = model.getValue(f);
+                return model.expandFunction(v).vector.length;
+            }
+        });
+    }
+
+    /*
+     * Cases that query the model of some assertions
+     */
+    private static abstract class ModelCase extends Bench.Case {
+        Context ctx;
+        Model model;
+
+        ModelCase(String name) {
+            super(name);
+        }
+
+        abstract void init(Context ctx);
+
+        void setUp() {
+            ctx = new Context();
+            init(ctx);
+            if (ctx.check() != Status.SAT) throw new IllegalStateException(name + ": not sat");
+            model = ctx.getModel();
+        }
+
+        void tearDown() {
+            model.close();
+            ctx.close();
+        }
+    }
+}
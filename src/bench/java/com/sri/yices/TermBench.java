@@ -0,0 +1,87 @@
+package com.sri.yices;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+import java.util.List;
+
+/**
+ * Term construction: n-ary and/or with array and direct buffer arguments.
+ *
+ * The sizes straddle the bounds of the per-thread scratch arena in yicesJNI.cpp
+ * (ARENA_INIT_SIZE = 64 and ARENA_MAX_SIZE = 65536 elements). The terms are
+ * hash-consed so we measure the marshalling and the table lookup, not the
+ * allocation of new terms.
+ */
+final class TermBench {
+    private static final int[] SIZES = { 8, 64, 65, 1024, 65536, 65537 };
+
+    private TermBench() { }
+
+    /*
+     * n fresh Boolean variables
+     */
+    static int[] boolVars(int n) {
+        int[] a = new int[n];
+        for (int i = 0; i < n; i++) {
+            a[i] = Terms.newUninterpretedTerm(Types.BOOL);
+        }
+        return a;
+    }
+
+    static IntBuffer directBuffer(int[] a) {
+        IntBuffer b = ByteBuffer.allocateDirect(4 * a.length).order(ByteOrder.nativeOrder()).asIntBuffer();
+        b.put(a);
+        b.flip();
+        return b;
+    }
+
+    static void addCases(List<Bench.Case> list) {
+        for (int n : SIZES) {
+            list.add(new Bench.Case("and/" + n) {
+                int[] a;
+                void setUp() { a = boolVars(n); }
+                int op() { return Terms.and(a); }
+            });
+            list.add(new Bench.Case("or/" + n) {
+                int[] a;
+                void setUp() { a = boolVars(n); }
+                int op() { return Terms.or(a); }
+            });
+        }
+        for (int n : new int[] { 64, 65537 }) {
+            list.add(new Bench.Case("and.buffer/" + n) {
+                IntBuffer b;
+                void setUp() { b = directBuffer(boolVars(n)); }
+                int op() { return Terms.and(b); }
+            });
+        }
+
+        // a constructor that fails (type mismatch): exception vs. no-throw mode
+        list.add(new Bench.Case("mismatch.throw") {
+            int x, b;
+            void setUp() {
+                x = Terms.newUninterpretedTerm(Types.INT);
+                b = Terms.newUninterpretedTerm(Types.BOOL);
+            }
+            int op() {
+                try {
+                    return Terms.add(x, b);
+                } catch (YicesException e) {
+                    return -1;
+                }
+            }
+        });
+        list.add(new Bench.Case("mismatch.nothrow") {
+            int x, b;
+            NoThrow scope;
+            void setUp() {
+                x = Terms.newUninterpretedTerm(Types.INT);
+                b = Terms.newUninterpretedTerm(Types.BOOL);
+                scope = NoThrow.enter();
+            }
+            int op() { return Terms.add(x, b); }
+            void tearDown() { scope.close(); }
+        });
+    }
+}
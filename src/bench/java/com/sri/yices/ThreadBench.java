@@ -0,0 +1,95 @@
+package com.sri.yices;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+
+/**
+ * Scaling with the number of threads: each thread checks the same problem in its
+ * own context. One operation is one check in every context, so with perfect
+ * scaling the time per operation does not depend on the number of threads.
+ *
+ * These cases are only run if the Yices library is thread safe.
+ */
+final class ThreadBench {
+    private static final int[] THREADS = { 1, 2, 4, 8 };
+
+    private ThreadBench() { }
+
+    /*
+     * Pigeonhole formulas: n+1 pigeons in n holes (unsat, and hard for CDCL when n grows)
+     * - p[i][j] means pigeon i is in hole j
+     */
+    static int[] hardProblem(int n) {
+        int[][] p = new int[n + 1][n];
+        for (int i = 0; i <= n; i++) {
+            for (int j = 0; j < n; j++) {
+                p[i][j] = Terms.newUninterpretedTerm(Types.BOOL);
+            }
+        }
+        ArrayList<Integer> a = new ArrayList<>();
+        for (int i = 0; i <= n; i++) {
+            a.add(Terms.or(p[i]));
+        }
+        for (int j = 0; j < n; j++) {
+            for (int i = 0; i <= n; i++) {
+                for (int k = i + 1; k <= n; k++) {
+                    a.add(Terms.or(Terms.not(p[i][j]), Terms.not(p[k][j])));
+                }
+            }
+        }
+        return a.stream().mapToInt(Integer::intValue).toArray();
+    }
+
+    static void addCases(List<Bench.Case> list) {
+        if (!Yices.isThreadSafe()) return;
+
+        for (int k : THREADS) {
+            list.add(new Bench.Case("contexts/threads=" + k) {
+                ExecutorService pool;
+                Context[] ctx;
+                int[] problem;
+
+                void setUp() {
+                    problem = hardProblem(7);
+                    ctx = new Context[k];
+                    for (int i = 0; i < k; i++) {
+                        ctx[i] = new Context("QF_LIA");
+                    }
+                    pool = Executors.newFixedThreadPool(k, r -> {
+                        Thread t = new Thread(r, "yices-bench");
+                        t.setDaemon(true);
+                        return t;
+                    });
+                }
+
+                int op() throws Exception {
+                    ArrayList<Future<Status>> results = new ArrayList<>(k);
+                    for (Context c : ctx) {
+                        results.add(pool.submit(() -> {
+                            c.push();
+                            c.assertFormulas(problem);
+                            Status s = c.check();
+                            c.pop();
+                            return s;
+                        }));
+                    }
+                    int acc = 0;
+                    for (Future<Status> f : results) {
+                        acc += f.get().ordinal();
+                    }
+                    return acc;
+                }
+
+                void tearDown() {
+                    pool.shutdownNow();
+                    for (Context c : ctx) {
+                        c.close();
+                    }
+                }
+            });
+        }
+    }
+}
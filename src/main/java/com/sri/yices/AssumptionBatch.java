@@ -0,0 +1,83 @@
+package com.sri.yices;
+
+/**
+ * Result of Context.checkWithAssumptionsBatch.
+ *
+ * For each assumption set that was checked, this gives the status of the
+ * check and, depending on the status:
+ * - UNSAT: the unsat core
+ * - SAT: the values of the model terms (as constant terms)
+ * - otherwise: nothing
+ *
+ * processed() may be less than size() if the time budget was exhausted.
+ */
+public final class AssumptionBatch {
+    private final int size;
+    // r[0] = processed, then statuses, then offsets, then the cores and values (cf. Yices.checkWithAssumptionsBatch)
+    private final int[] r;
+
+    AssumptionBatch(int size, int[] r) {
+        this.size = size;
+        this.r = r;
+    }
+
+    /*
+     * Number of assumption sets in the batch
+     */
+    public int size() {
+        return size;
+    }
+
+    /*
+     * Number of sets that were checked
+     */
+    public int processed() {
+        return r[0];
+    }
+
+    private void check(int i) {
+        if (i < 0 || i >= size) throw new IndexOutOfBoundsException("invalid set index: " + i);
+    }
+
+    /*
+     * Status of set i, or null if it wasn't checked
+     */
+    public Status status(int i) {
+        check(i);
+        return i < r[0] ? Status.idToStatus(r[1 + i]) : null;
+    }
+
+    private int[] data(int i) {
+        int m = r[0];
+        int start = r[m + 1 + i];
+        int end = r[m + 2 + i];
+        int[] a = new int[end - start];
+        System.arraycopy(r, start, a, 0, a.length);
+        return a;
+    }
+
+    /*
+     * Unsat core for set i, or null if its status isn't UNSAT
+     */
+    public int[] core(int i) {
+        return status(i) == Status.UNSAT ? data(i) : null;
+    }
+
+    /*
+     * Values of the model terms for set i, or null if its status isn't SAT
+     */
+    public int[] values(int i) {
+        return status(i) == Status.SAT ? data(i) : null;
+    }
+
+    /*
+     * Number of sets with the given status
+     */
+    public int count(Status s) {
+        int n = 0;
+        for (int i = 0; i < r[0]; i++) {
+            if (Status.idToStatus(r[1 + i]) == s) n++;
+        }
+        return n;
+    }
+}
@@ -0,0 +1,185 @@
+package com.sri.yices;
+
+import java.util.concurrent.Callable;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.Executor;
+import java.util.concurrent.LinkedBlockingQueue;
+import java.util.concurrent.ThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Result of an asynchronous check (cf. Context.checkAsync).
+ *
+ * The check runs on an executor. Cancelling the future stops the search
+ * (with Yices.stopSearch); the check then returns INTERRUPTED but the future
+ * stays cancelled. A check that's cancelled before it starts is not run.
+ *
+ * A cancelled future is done as soon as cancel returns, while the check may
+ * still be running in yices_check_context. The end of the check is tracked
+ * separately: awaitFinished waits until run() has exited (or until it's
+ * certain that the check won't run). Context.close uses it so that the
+ * context is not deleted under a running check.
+ *
+ * Nothing is fetched when the check completes. For a check on a context,
+ * model() and unsatCore() fetch the model or unsat core from the context on
+ * first use (after the check has returned) and keep it for later calls.
+ * They see the context's current state: they must be called before the
+ * context is used for anything else.
+ */
+public final class CheckFuture extends CompletableFuture<Status> implements Runnable {
+    /*
+     * Default executor: as many threads as processors (or one thread if the
+     * Yices library is not thread safe). The threads are daemon threads that
+     * terminate when idle for a while.
+     */
+    private static ThreadPoolExecutor executor = null;
+
+    static synchronized Executor defaultExecutor() {
+        if (executor == null) {
+            int n = Yices.isThreadSafe() ? Runtime.getRuntime().availableProcessors() : 1;
+            executor = new ThreadPoolExecutor(n, n, 30, TimeUnit.SECONDS, new LinkedBlockingQueue<>(), r -> {
+                Thread t = new Thread(r, "yices-solver");
+                t.setDaemon(true);
+                return t;
+            });
+            executor.allowCoreThreadTimeOut(true);
+        }
+        return executor;
+    }
+
+    private final long ctx;             // context (0 if the check can't be stopped)
+    private final Context context;      // context for model() and unsatCore(), or null
+    private final Callable<Status> check;
+    // state: NEW -> RUNNING -> FINISHED, or NEW -> FINISHED if the check is not run
+    private static final int NEW = 0;
+    private static final int RUNNING = 1;
+    private static final int FINISHED = 2;
+
+    private int state = NEW;
+    private DeadlineScheduler.Deadline stopper = null;
+
+    // fetched on demand
+    private Model model = null;
+    private int[] core = null;
+
+    private CheckFuture(long ctx, Context context, Callable<Status> check) {
+        this.ctx = ctx;
+        this.context = context;
+        this.check = check;
+    }
+
+    /*
+     * Submit check to executor
+     * - ctx = pointer to the context that check uses, or 0
+     */
+    static CheckFuture submit(long ctx, Callable<Status> check, Executor executor) {
+        return submit(new CheckFuture(ctx, null, check), executor);
+    }
+
+    /*
+     * Submit a check on context
+     */
+    static CheckFuture submit(Context context, Callable<Status> check, Executor executor) {
+        return submit(new CheckFuture(context.getPtr(), context, check), executor);
+    }
+
+    private static CheckFuture submit(CheckFuture f, Executor executor) {
+        try {
+            executor.execute(f);
+        } catch (RuntimeException e) {
+            f.finish();
+            throw e;
+        }
+        return f;
+    }
+
+    public void run() {
+        synchronized (this) {
+            if (state != NEW || isDone()) return;
+            state = RUNNING;
+        }
+        try {
+            complete(check.call());
+        } catch (Throwable e) {
+            completeExceptionally(e);
+        } finally {
+            synchronized (this) {
+                if (stopper != null) stopper.close();
+            }
+            finish();
+        }
+    }
+
+    private synchronized void finish() {
+        state = FINISHED;
+        notifyAll();
+    }
+
+    /*
+     * Wait until the check is no longer running (i.e., run() has exited or
+     * the check will never start). This doesn't throw InterruptedException:
+     * the interrupt status is restored when the wait is over.
+     */
+    synchronized void awaitFinished() {
+        boolean interrupted = false;
+        while (state == RUNNING) {
+            try {
+                wait();
+            } catch (InterruptedException e) {
+                interrupted = true;
+            }
+        }
+        if (interrupted) Thread.currentThread().interrupt();
+    }
+
+    /*
+     * Status of the check if it completed normally with status s
+     */
+    private boolean hasStatus(Status s) {
+        return isDone() && !isCompletedExceptionally() && join() == s;
+    }
+
+    /**
+     * Model found by the check, fetched from the context on first call.
+     * Returns null if the check is not done or didn't return SAT. The same
+     * model is returned by later calls: the caller owns it and closes it.
+     */
+    public Model model() throws YicesException {
+        if (context == null || !hasStatus(Status.SAT)) return null;
+        awaitFinished();
+        synchronized (this) {
+            if (model == null) model = context.getModel();
+            return model;
+        }
+    }
+
+    /**
+     * Unsat core of a checkWithAssumptionsAsync, fetched from the context on
+     * first call. Returns null if the check is not done or didn't return UNSAT.
+     */
+    public int[] unsatCore() {
+        if (context == null || !hasStatus(Status.UNSAT)) return null;
+        awaitFinished();
+        synchronized (this) {
+            if (core == null) core = context.getUnsatCore();
+            return core.clone();
+        }
+    }
+
+    @Override
+    public boolean cancel(boolean mayInterruptIfRunning) {
+        boolean cancelled = super.cancel(mayInterruptIfRunning);
+        if (cancelled) {
+            synchronized (this) {
+                if (state == NEW) {
+                    // the check will not run
+                    finish();
+                } else if (state == RUNNING && ctx != 0 && stopper == null) {
+                    // a deadline that expires now: this retries until the search has started
+                    stopper = DeadlineScheduler.schedule(ctx, 0, TimeUnit.NANOSECONDS);
+                }
+            }
+        }
+        return cancelled;
+    }
+}
@@ -1,21 +1,32 @@
 package com.sri.yices;
 
+import java.lang.ref.Reference;
+
 /*
  * Context configuration
  */
 public class Config implements AutoCloseable {
     // pointer to the Yices config_t object
     private long ptr;
+    private final NativeRef ref;
 
     //<PROFILING>
-    static private long population = 0;
+    static private final NativeRef.Census census = new NativeRef.Census();
 
     /**
      * Returns the count of Config objects that have an unfreed
      * pointer to a Yices shared library object.
      */
     public static long getCensus(){
-        return population;
+        return census.live();
+    }
+
+    /**
+     * Returns the count of Config objects that were never closed
+     * (their pointer was freed when they were garbage collected).
+     */
+    public static long getLeakCount(){
+        return census.leaked();
     }
     //</PROFILING>
 
@@ -24,7 +35,7 @@ public class Config implements AutoCloseable {
      */
     public Config () {
         ptr = Yices.newConfig();
-        population++;
+        ref = new NativeRef(this, ptr, census, Yices::freeConfig);
     }
 
     /*
@@ -38,7 +49,7 @@ public class Config implements AutoCloseable {
             throw new YicesException();
         }
         ptr = p;
-        population++;
+        ref = new NativeRef(this, p, census, Yices::freeConfig);
     }
 
     /*
@@ -51,9 +62,8 @@ public class Config implements AutoCloseable {
      */
     public void close() {
         if (ptr != 0) {
-            Yices.freeConfig(ptr);
+            ref.close();
             ptr = 0;
-            population--;
         }
     }
 
@@ -64,7 +74,12 @@ public class Config implements AutoCloseable {
      * - value = parameter value
      */
     public void set(String name, String value) throws YicesException {
-        int code = Yices.setConfig(ptr, name, value);
+        int code;
+        try {
+            code = Yices.setConfig(ptr, name, value);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
     }
 
@@ -1,9 +1,13 @@
 package com.sri.yices;
 
+import java.lang.ref.Reference;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+import java.time.Duration;
 import java.util.Collection;
 import java.util.List;
-import java.util.Timer;
-import java.util.TimerTask;
+import java.util.concurrent.Callable;
+import java.util.concurrent.Executor;
 import java.util.concurrent.TimeUnit;
 
 /**
@@ -14,18 +18,41 @@ public class Context implements AutoCloseable {
      * pointer to the context
      */
     private long ptr;
+    private final NativeRef ref;
 
     /**
-     * A counter used to prevent memory leaks.
+     * Counters used to prevent memory leaks.
      */
-    static private long population = 0;
+    static private final NativeRef.Census census = new NativeRef.Census();
 
     /**
      * Returns the count of Context objects that have an unfreed
      * pointer to a Yices shared library object.
      */
     public static long getCensus(){
-        return population;
+        return census.live();
+    }
+
+    /**
+     * Returns the count of Context objects that were never closed
+     * (their pointer was freed when they were garbage collected).
+     */
+    public static long getLeakCount(){
+        return census.leaked();
+    }
+
+    /*
+     * Free a context pointer (called by close or by the Cleaner)
+     */
+    private static void free(long p) {
+        if (Profiler.enabled) {
+            long start = System.nanoTime();
+            Yices.freeContext(p);
+            long finish = System.nanoTime();
+            Profiler.delta("Yices.freeContext", start, finish);
+        } else {
+            Yices.freeContext(p);
+        }
     }
 
     static private final int ERROR_STATUS;
@@ -44,17 +71,22 @@ public class Context implements AutoCloseable {
      */
     public Context() {
         ptr = Yices.newContext(0);
-        population++;
+        ref = new NativeRef(this, ptr, census, Context::free);
     }
 
     /*
      * Constructor using a configuration
      */
     public Context(Config config) throws YicesException {
-        long p = Yices.newContext(config.getPtr());
+        long p;
+        try {
+            p = Yices.newContext(config.getPtr());
+        } finally {
+            Reference.reachabilityFence(config);
+        }
         if (p == 0) throw new YicesException();
         ptr = p;
-        population++;
+        ref = new NativeRef(this, p, census, Context::free);
     }
 
     /*
@@ -75,7 +107,7 @@ public class Context implements AutoCloseable {
         }
         Yices.freeConfig(config);
         ptr = p;
-        population++;
+        ref = new NativeRef(this, p, census, Context::free);
     }
 
     /*
@@ -100,26 +132,62 @@ public class Context implements AutoCloseable {
         }
         Yices.freeConfig(config);
         ptr = p;
-        population++;
+        ref = new NativeRef(this, p, census, Context::free);
     }
 
     protected long getPtr() { return ptr; }
 
+    /*
+     * For contexts obtained from a ContextPool:
+     * - the pool keeps the contexts that own the Yices context (with poolEntry =
+     *   where the context goes back when it's closed)
+     * - acquire returns a lease: a fresh Context object that shares the pointer
+     *   of its shell, and whose close returns the shell to the pool. Closing a
+     *   lease again, after the shell was handed out to someone else, does nothing.
+     */
+    ContextPool.Entry poolEntry = null;
+    private Context shell = null;
+
+    private Context(Context shell) {
+        this.shell = shell;
+        this.ptr = shell.ptr;
+        this.ref = null;
+    }
+
+    static Context lease(Context shell) {
+        return new Context(shell);
+    }
+
+    /*
+     * Last asynchronous check submitted (cf. checkAsync)
+     */
+    private CheckFuture async = null;
+
     /*
      * Close: free the Yices data structure
+     * - if the context came from a pool, it's reset and returned to the pool instead
      */
     public void close() {
-	    if (ptr != 0) {
-            if (Profiler.enabled) {
-                long start = System.nanoTime();
-                Yices.freeContext(ptr);
-                long finish = System.nanoTime();
-                Profiler.delta("Yices.freeContext", start, finish);
-            } else {
-                Yices.freeContext(ptr);
+        if (async != null) {
+            // don't delete or recycle the context under a running check
+            async.cancel(true);
+            async.awaitFinished();
+            async = null;
+        }
+        if (ref == null) {
+            // lease from a pool
+            Context s;
+            synchronized (this) {
+                s = shell;
+                shell = null;
+                ptr = 0;
             }
+            if (s != null) s.poolEntry.pool.recycle(s);
+            return;
+        }
+	    if (ptr != 0) {
+            ref.close();
 	        ptr = 0;
-            population--;
 	    }
     }
 
@@ -127,12 +195,22 @@ public class Context implements AutoCloseable {
      * Enable/disable options
      */
     public void enableOption(String option) throws YicesException {
-        int code = Yices.contextEnableOption(ptr, option);
+        int code;
+        try {
+            code = Yices.contextEnableOption(ptr, option);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
     }
 
     public void disableOption(String option) throws YicesException {
-        int code = Yices.contextDisableOption(ptr, option);
+        int code;
+        try {
+            code = Yices.contextDisableOption(ptr, option);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
     }
 
@@ -140,7 +218,11 @@ public class Context implements AutoCloseable {
      * Get the status
      */
     public Status getStatus() {
-        return Status.idToStatus(Yices.contextStatus(ptr));
+        try {
+            return Status.idToStatus(Yices.contextStatus(ptr));
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
     /*
@@ -148,16 +230,30 @@ public class Context implements AutoCloseable {
      * - push and pop may fail if the context does not support them
      */
     public void reset() {
-        Yices.resetContext(ptr);
+        try {
+            Yices.resetContext(ptr);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
     public void push() throws YicesException {
-        int code = Yices.push(ptr);
+        int code;
+        try {
+            code = Yices.push(ptr);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
     }
 
     public void pop() throws YicesException {
-        int code = Yices.pop(ptr);
+        int code;
+        try {
+            code = Yices.pop(ptr);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
     }
 
@@ -165,7 +261,11 @@ public class Context implements AutoCloseable {
      * Stop search
      */
     public void stopSearch() {
-        Yices.stopSearch(ptr);
+        try {
+            Yices.stopSearch(ptr);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
     /*
@@ -173,13 +273,17 @@ public class Context implements AutoCloseable {
      */
     public Model getModel() throws YicesException {
         long model = 0;
-        if (Profiler.enabled) {
-            long start = System.nanoTime();
-            model = Yices.getModel(ptr, 1);
-            long finish = System.nanoTime();
-            Profiler.delta("Yices.getModel", start, finish);
-        } else {
-            model = Yices.getModel(ptr, 1);
+        try {
+            if (Profiler.enabled) {
+                long start = System.nanoTime();
+                model = Yices.getModel(ptr, 1);
+                long finish = System.nanoTime();
+                Profiler.delta("Yices.getModel", start, finish);
+            } else {
+                model = Yices.getModel(ptr, 1);
+            }
+        } finally {
+            Reference.reachabilityFence(this);
         }
         if (model == 0) throw new YicesException();
         return new Model(model);
@@ -190,13 +294,17 @@ public class Context implements AutoCloseable {
      */
     public void assertFormula(int f) throws YicesException {
         int code;
-        if (Profiler.enabled) {
-            long start = System.nanoTime();
-            code = Yices.assertFormula(ptr, f);
-            long finish = System.nanoTime();
-            Profiler.delta("Yices.assertFormula", start, finish, true);
-        } else {
-            code = Yices.assertFormula(ptr, f);
+        try {
+            if (Profiler.enabled) {
+                long start = System.nanoTime();
+                code = Yices.assertFormula(ptr, f);
+                long finish = System.nanoTime();
+                Profiler.delta("Yices.assertFormula", start, finish, true);
+            } else {
+                code = Yices.assertFormula(ptr, f);
+            }
+        } finally {
+            Reference.reachabilityFence(this);
         }
         if (code < 0) {
             throw new YicesException();
@@ -208,13 +316,17 @@ public class Context implements AutoCloseable {
      */
     public void assertFormulas(int[] a) throws YicesException {
         int code;
-        if (Profiler.enabled) {
-            long start = System.nanoTime();
-            code = Yices.assertFormulas(ptr, a);
-            long finish = System.nanoTime();
-            Profiler.delta("Yices.assertFormulas", start, finish, true);
-        } else {
-            code = Yices.assertFormulas(ptr, a);
+        try {
+            if (Profiler.enabled) {
+                long start = System.nanoTime();
+                code = Yices.assertFormulas(ptr, a);
+                long finish = System.nanoTime();
+                Profiler.delta("Yices.assertFormulas", start, finish, true);
+            } else {
+                code = Yices.assertFormulas(ptr, a);
+            }
+        } finally {
+            Reference.reachabilityFence(this);
         }
         if (code < 0) {
             throw new YicesException();
@@ -238,14 +350,99 @@ public class Context implements AutoCloseable {
         assertFormulas(a);
     }
 
+    /*
+     * Assert the remaining formulas in buffer b (from its position to its limit).
+     * If b is a direct buffer in native byte order, the formulas are read without copying.
+     */
+    public void assertFormulas(IntBuffer b) throws YicesException {
+        if (!b.isDirect() || b.order() != ByteOrder.nativeOrder()) {
+            int[] a = new int[b.remaining()];
+            b.duplicate().get(a);
+            assertFormulas(a);
+            return;
+        }
+        int code;
+        try {
+            if (Profiler.enabled) {
+                long start = System.nanoTime();
+                code = Yices.assertFormulas(ptr, b, b.position(), b.remaining());
+                long finish = System.nanoTime();
+                Profiler.delta("Yices.assertFormulas", start, finish, true);
+            } else {
+                code = Yices.assertFormulas(ptr, b, b.position(), b.remaining());
+            }
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+        if (code < 0) {
+            throw new YicesException();
+        }
+    }
+
     /*
      * Assert a blocking clause
      */
     public void assertBlockingClause() throws YicesException {
-        int code = Yices.assertBlockingClause(ptr);
+        int code;
+        try {
+            code = Yices.assertBlockingClause(ptr);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
     }
 
+    /*
+     * All-SAT: enumerate up to maxModels models, in a single native call
+     * - after each model, a clause that blocks the values of the projection terms
+     *   is asserted (or the whole model is blocked, as in assertBlockingClause,
+     *   if projection is empty). The blocking clauses stay in the context: use
+     *   push/pop to get rid of them.
+     * - the projection terms can be Boolean, arithmetic, bitvector, or scalar terms
+     * - budget = time limit for the whole enumeration or null for no limit: a check
+     *   that's running when the budget is exhausted is interrupted
+     * - params may be null
+     * - if an error stops the enumeration after some models were found, the result
+     *   has these models and status ERROR (their blocking clauses are in the context).
+     *   YicesException is thrown only if the error happens before the first model.
+     */
+    public ModelEnumeration enumerateModels(Parameters params, int[] projection, int maxModels, Duration budget) throws YicesException {
+        if (maxModels < 0) throw new IllegalArgumentException("negative number of models");
+        long ns = 0;
+        if (budget != null) {
+            try {
+                ns = Math.max(budget.toNanos(), 1);
+            } catch (ArithmeticException e) {
+                ns = 0;
+            }
+        }
+        int[] proj = projection.clone();
+        Object[] out = new Object[4];
+        int[] info = new int[2];
+        long p = params == null ? 0 : params.getPtr();
+
+        int n;
+        DeadlineScheduler.Deadline deadline = ns > 0 ? DeadlineScheduler.schedule(ptr, ns, TimeUnit.NANOSECONDS) : null;
+        try {
+            if (Profiler.enabled) {
+                long start = System.nanoTime();
+                n = Yices.enumerateModels(ptr, p, proj, maxModels, ns, out, info);
+                Profiler.delta("Yices.enumerateModels", start, System.nanoTime());
+            } else {
+                n = Yices.enumerateModels(ptr, p, proj, maxModels, ns, out, info);
+            }
+        } finally {
+            if (deadline != null) deadline.close();
+            Reference.reachabilityFence(this);
+            Reference.reachabilityFence(params);
+        }
+        if (n < 0) throw new YicesException();
+        Status status = Status.idToStatus(info[0]);
+        // an error after some models: the caller gets them (status is ERROR)
+        if (n == 0 && status == Status.ERROR) throw new YicesException();
+        return new ModelEnumeration(proj, n, status, info[1], (long[]) out[0], (byte[]) out[1], (long[]) out[2], (int[]) out[3]);
+    }
+
     /*
      * Call the solver, use parameter pointer p
      */
@@ -262,8 +459,17 @@ public class Context implements AutoCloseable {
         return code;
     }
 
+    /*
+     * The reachability fences prevent the Cleaner from freeing this context
+     * (or the parameters) while the search is in progress.
+     */
     private int doCheck(long p) throws YicesException {
-        int code = doCheck(ptr, p);
+        int code;
+        try {
+            code = doCheck(ptr, p);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code == ERROR_STATUS) throw new YicesException();
         return code;
     }
@@ -279,7 +485,12 @@ public class Context implements AutoCloseable {
      * Call the solver, use the given parameter set.
      */
     public Status check(Parameters p) throws YicesException {
-        int code = doCheck(p == null ? 0 : p.getPtr());
+        int code;
+        try {
+            code = doCheck(p == null ? 0 : p.getPtr());
+        } finally {
+            Reference.reachabilityFence(p);
+        }
         return Status.idToStatus(code);
     }
 
@@ -287,37 +498,117 @@ public class Context implements AutoCloseable {
      * Check with a timeout in seconds
      */
     public Status check(int timeout) throws YicesException {
-        return doCheckWithTimer(0, timeout);
+        return check(null, timeout);
     }
 
     public Status check(Parameters p, int timeout) throws YicesException {
-        return doCheckWithTimer(p.getPtr(), timeout);
+        // timeouts shorter than one second are rounded up to one second
+        return check(p, (timeout < 1) ? 1L : timeout, TimeUnit.SECONDS);
+    }
+
+    /*
+     * Check with a timeout in any unit
+     */
+    public Status check(long timeout, TimeUnit unit) throws YicesException {
+        return check(null, timeout, unit);
+    }
+
+    public Status check(Parameters p, long timeout, TimeUnit unit) throws YicesException {
+        try {
+            return doCheckWithTimer(p == null ? 0 : p.getPtr(), timeout, unit);
+        } finally {
+            Reference.reachabilityFence(p);
+        }
+    }
+
+    public Status check(Duration timeout) throws YicesException {
+        return check(null, timeout);
+    }
+
+    public Status check(Parameters p, Duration timeout) throws YicesException {
+        long ns;
+        try {
+            ns = timeout.toNanos();
+        } catch (ArithmeticException e) {
+            // more than 292 years
+            ns = Long.MAX_VALUE;
+        }
+        return check(p, ns, TimeUnit.NANOSECONDS);
     }
 
     /*
      * Check with a timeout:
      * - p = pointer to the Yices internal parameter descriptor
-     * - timeout = timeout in seconds
-     * This calls Yices.stopSearch if the timer expires.
-     */
-    private Status doCheckWithTimer(long p, int timeout)  throws YicesException {
-        Timer timer = new Timer();
-        TimerTask task = new TimerTask() {
-            public void run() {
-                Yices.stopSearch(ptr);
-            }
-        };
-        long delay = (timeout < 1) ? 1000L : 1000L * timeout; //need miliseconds, have seconds.
-        timer.schedule(task, delay);
-        int code = doCheck(ptr, p);
-        timer.cancel();
+     * - timeout = timeout in the given unit
+     * This calls Yices.stopSearch if the timer expires (then the status is INTERRUPTED).
+     * The timer is shared by all contexts (cf. DeadlineScheduler).
+     */
+    private Status doCheckWithTimer(long p, long timeout, TimeUnit unit)  throws YicesException {
+        int code;
+        try (DeadlineScheduler.Deadline deadline = DeadlineScheduler.schedule(ptr, timeout, unit)) {
+            code = doCheck(ptr, p);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
         return Status.idToStatus(code);
     }
 
+    /*
+     * Asynchronous checks
+     * - the check runs on the given executor (or on a shared executor with
+     *   one thread per processor)
+     * - cancelling the returned future calls stopSearch
+     * - the context must not be used until the future is done (that includes
+     *   getting the model or unsat core, which is done after completion, e.g.
+     *   by the future's model() and unsatCore())
+     * - a cancelled future is done before the check has returned: close()
+     *   cancels the last asynchronous check and waits until it has returned,
+     *   but other methods (e.g., check) don't wait
+     *
+     * Futures derived from the returned one (e.g., by thenApply) don't propagate
+     * cancellation: cancel the returned future itself to stop the search.
+     */
+    public CheckFuture checkAsync() {
+        return checkAsync((Parameters) null);
+    }
+
+    public CheckFuture checkAsync(Parameters p) {
+        return checkAsync(p, CheckFuture.defaultExecutor());
+    }
+
+    public CheckFuture checkAsync(Parameters p, Executor executor) {
+        return submitAsync(() -> check(p), executor);
+    }
+
+    public CheckFuture checkAsync(Parameters p, Duration timeout) {
+        return submitAsync(() -> check(p, timeout), CheckFuture.defaultExecutor());
+    }
+
+    public CheckFuture checkWithAssumptionsAsync(Parameters params, int[] assumptions) {
+        int[] a = assumptions.clone();
+        return submitAsync(() -> checkWithAssumptions(params, a), CheckFuture.defaultExecutor());
+    }
+
+    public CheckFuture checkWithModelAsync(Parameters params, Model model, int[] assumptions) {
+        int[] a = assumptions.clone();
+        return submitAsync(() -> checkWithModel(params, model, a), CheckFuture.defaultExecutor());
+    }
+
+    private CheckFuture submitAsync(Callable<Status> check, Executor executor) {
+        CheckFuture f = CheckFuture.submit(this, check, executor);
+        async = f;
+        return f;
+    }
+
     // Since 2.6.4
     public int getModelInterpolant() {
-        int retval = Yices.getModelInterpolant(ptr);
+        int retval;
+        try {
+            retval = Yices.getModelInterpolant(ptr);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (retval < 0){
             YicesException error = YicesException.checkVersion(2, 6, 4);
             if (error == null) {
@@ -331,16 +622,80 @@ public class Context implements AutoCloseable {
 
     // Since 2.6.4
     public Status checkWithAssumptions(Parameters params, int[] assumptions) {
-        int code = Yices.checkContextWithAssumptions(ptr, params.getPtr(), assumptions);
+        int code;
+        try {
+            code = Yices.checkContextWithAssumptions(ptr, params == null ? 0 : params.getPtr(), assumptions);
+        } finally {
+            Reference.reachabilityFence(this);
+            Reference.reachabilityFence(params);
+        }
         if (code < 0) {
             throw new YicesException();
         }
         return Status.idToStatus(code);
     }
 
+    /*
+     * Batch of checks with assumptions, in a single native call
+     * - the assumption sets are in CSR form: set i is assumptions[offsets[i] ... offsets[i+1]-1]
+     * - the unsat core is collected for each UNSAT set, and the values of modelTerms for
+     *   each SAT set (modelTerms may be null)
+     * - budget = time limit for the whole batch or null for no limit: a check that's running
+     *   when the budget is exhausted is interrupted and the remaining sets are skipped
+     * - params may be null
+     */
+    public AssumptionBatch checkWithAssumptionsBatch(Parameters params, int[] offsets, int[] assumptions,
+                                                     int[] modelTerms, Duration budget) throws YicesException {
+        long ns = 0;
+        if (budget != null) {
+            try {
+                ns = Math.max(budget.toNanos(), 1);
+            } catch (ArithmeticException e) {
+                ns = 0;
+            }
+        }
+        long p = params == null ? 0 : params.getPtr();
+        int[] r;
+        DeadlineScheduler.Deadline deadline = ns > 0 ? DeadlineScheduler.schedule(ptr, ns, TimeUnit.NANOSECONDS) : null;
+        try {
+            if (Profiler.enabled) {
+                long start = System.nanoTime();
+                r = Yices.checkWithAssumptionsBatch(ptr, p, offsets, assumptions, modelTerms, ns);
+                Profiler.delta("Yices.checkWithAssumptionsBatch", start, System.nanoTime());
+            } else {
+                r = Yices.checkWithAssumptionsBatch(ptr, p, offsets, assumptions, modelTerms, ns);
+            }
+        } finally {
+            if (deadline != null) deadline.close();
+            Reference.reachabilityFence(this);
+            Reference.reachabilityFence(params);
+        }
+        if (r == null) throw new IllegalArgumentException("invalid assumption offsets");
+        return new AssumptionBatch(offsets.length - 1, r);
+    }
+
+    public AssumptionBatch checkWithAssumptionsBatch(Parameters params, int[][] sets, int[] modelTerms, Duration budget) throws YicesException {
+        int[] offsets = new int[sets.length + 1];
+        for (int i = 0; i < sets.length; i++) {
+            offsets[i+1] = offsets[i] + sets[i].length;
+        }
+        int[] assumptions = new int[offsets[sets.length]];
+        for (int i = 0; i < sets.length; i++) {
+            System.arraycopy(sets[i], 0, assumptions, offsets[i], sets[i].length);
+        }
+        return checkWithAssumptionsBatch(params, offsets, assumptions, modelTerms, budget);
+    }
+
     // Since 2.6.4
     public Status checkWithModel(Parameters params, Model model, int[] assumptions) {
-        int code = Yices.checkContextWithModel(ptr, params.getPtr(), model.getPtr(), assumptions);
+        int code;
+        try {
+            code = Yices.checkContextWithModel(ptr, params == null ? 0 : params.getPtr(), model.getPtr(), assumptions);
+        } finally {
+            Reference.reachabilityFence(this);
+            Reference.reachabilityFence(params);
+            Reference.reachabilityFence(model);
+        }
         if (code < 0) {
             YicesException error = YicesException.checkVersion(2, 6, 4);
             if (error == null) {
@@ -354,7 +709,12 @@ public class Context implements AutoCloseable {
 
     // Since 2.6.4
     public int[] getUnsatCore() {
-        int[] retval = Yices.getUnsatCore(ptr);
+        int[] retval;
+        try {
+            retval = Yices.getUnsatCore(ptr);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (retval == null) {
             YicesException error = YicesException.checkVersion(2, 6, 4);
             if (error == null) {
@@ -0,0 +1,274 @@
+package com.sri.yices;
+
+import java.util.ArrayDeque;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.WeakHashMap;
+
+/**
+ * Pool of contexts organized by logic (and mode).
+ *
+ * Creating a context requires building a configuration record and allocating
+ * all the solver tables. A pool avoids this: closing a context obtained from
+ * the pool resets it and puts it back, so that the next acquire for the same
+ * logic returns it immediately.
+ *
+ *   try (Context ctx = pool.acquire("QF_BV")) {
+ *       ...
+ *   } // ctx is reset and returned to the pool
+ *
+ * The pool also caches one Config and one Parameters record per logic. They
+ * belong to the pool and must not be closed by the caller.
+ *
+ * Each acquire returns a new Context object (a lease) even when the Yices
+ * context is recycled: closing a lease twice, or after it was recycled, does
+ * not affect the next holder.
+ *
+ * Yices.reset frees all the contexts and records: the pools forget them
+ * (without freeing them again) and create new ones on demand.
+ *
+ * All methods are thread-safe. A context must not be used after it's closed.
+ */
+public class ContextPool implements AutoCloseable {
+    // default bound on the number of idle contexts per logic
+    public static final int DEFAULT_MAX_IDLE = 8;
+
+    /*
+     * Idle contexts, configuration, and parameters for a logic/mode pair
+     */
+    static class Entry {
+        final ContextPool pool;
+        final ArrayDeque<Context> idle = new ArrayDeque<>();
+        final String key;
+        final long epoch = RefQueue.epoch();   // cf. Yices.reset
+        Config config;
+        Parameters params;
+
+        Entry(ContextPool pool, String key) {
+            this.pool = pool;
+            this.key = key;
+        }
+    }
+
+    private final int maxIdle;
+    private final HashMap<String, Entry> entries = new HashMap<>();
+    private boolean closed = false;
+
+    // all the pools, so that Yices.reset can empty them
+    private static final Map<ContextPool, Boolean> pools = Collections.synchronizedMap(new WeakHashMap<>());
+
+    public ContextPool() {
+        this(DEFAULT_MAX_IDLE);
+    }
+
+    /*
+     * maxIdle = maximal number of idle contexts kept per logic. Contexts
+     * closed when the pool is full are freed.
+     */
+    public ContextPool(int maxIdle) {
+        if (maxIdle < 0) throw new IllegalArgumentException("negative pool size");
+        this.maxIdle = maxIdle;
+        pools.put(this, Boolean.TRUE);
+    }
+
+    private static String key(String logic, String mode) {
+        return mode == null ? logic : logic + "/" + mode;
+    }
+
+    /*
+     * Get the entry for logic/mode: create it and its Config if needed
+     * - must be called with the lock held
+     */
+    private Entry entry(String logic, String mode) throws YicesException {
+        if (closed) throw new IllegalStateException("the context pool is closed");
+        String k = key(logic, mode);
+        Entry e = entries.get(k);
+        if (e == null) {
+            Config config = new Config(logic);
+            if (mode != null) {
+                try {
+                    config.set("mode", mode);
+                } catch (YicesException ex) {
+                    config.close();
+                    throw ex;
+                }
+            }
+            e = new Entry(this, k);
+            e.config = config;
+            entries.put(k, e);
+        }
+        return e;
+    }
+
+    /*
+     * Get a context for the given logic (and mode)
+     * - the allowed modes are "one-shot", "multi-check", "push-pop", "interactive"
+     *   (mode null means the default for logic)
+     * - the context is either an idle one or a fresh one
+     */
+    public Context acquire(String logic) throws YicesException {
+        return acquire(logic, null);
+    }
+
+    public Context acquire(String logic, String mode) throws YicesException {
+        Entry e;
+        synchronized (this) {
+            e = entry(logic, mode);
+            Context ctx = e.idle.pollLast();
+            if (ctx != null) {
+                return Context.lease(ctx);
+            }
+        }
+        return Context.lease(newContext(e));
+    }
+
+    /*
+     * Create a context for entry e (the shell of a lease)
+     * - this is slow so it's done without holding the pool lock
+     * - the entry lock protects e.config, which is freed when the pool is closed
+     */
+    private static Context newContext(Entry e) throws YicesException {
+        Context ctx;
+        synchronized (e) {
+            if (e.config == null) throw new IllegalStateException("the context pool is closed");
+            ctx = new Context(e.config);
+        }
+        ctx.poolEntry = e;
+        return ctx;
+    }
+
+    /*
+     * Create n idle contexts for logic/mode (e.g., before a burst of requests).
+     * This stops as soon as the pool is full.
+     */
+    public void prefill(String logic, int n) throws YicesException {
+        prefill(logic, null, n);
+    }
+
+    public void prefill(String logic, String mode, int n) throws YicesException {
+        for (int i = 0; i < n; i++) {
+            Entry e;
+            synchronized (this) {
+                e = entry(logic, mode);
+                if (e.idle.size() >= maxIdle) return;
+            }
+            e.pool.recycle(newContext(e));
+        }
+    }
+
+    /*
+     * Parameters record for the logic: initialized with the default parameters
+     * for a context of that logic (cf. Parameters.defaultsForContext).
+     */
+    public Parameters parameters(String logic) throws YicesException {
+        return parameters(logic, null);
+    }
+
+    public Parameters parameters(String logic, String mode) throws YicesException {
+        synchronized (this) {
+            Entry e = entry(logic, mode);
+            if (e.params != null) return e.params;
+        }
+        Parameters params = new Parameters();
+        try (Context ctx = acquire(logic, mode)) {
+            params.defaultsForContext(ctx);
+        }
+        synchronized (this) {
+            Entry e = entry(logic, mode);
+            if (e.params == null) {
+                e.params = params;
+                return params;
+            }
+        }
+        // another thread got there first
+        params.close();
+        return parameters(logic, mode);
+    }
+
+    /*
+     * Configuration record for the logic
+     */
+    public synchronized Config config(String logic) throws YicesException {
+        return entry(logic, null).config;
+    }
+
+    public synchronized Config config(String logic, String mode) throws YicesException {
+        return entry(logic, mode).config;
+    }
+
+    /*
+     * Number of idle contexts for logic/mode
+     */
+    public int idleCount(String logic) {
+        return idleCount(logic, null);
+    }
+
+    public synchronized int idleCount(String logic, String mode) {
+        Entry e = entries.get(key(logic, mode));
+        return e == null ? 0 : e.idle.size();
+    }
+
+    /*
+     * Called when the lease of shell ctx is closed
+     * - reset ctx and put it back if there's room, otherwise free it
+     * - after Yices.reset, ctx's pointer is dead: it's dropped without calling Yices
+     */
+    void recycle(Context ctx) {
+        Entry e = ctx.poolEntry;
+        if (e.epoch == RefQueue.epoch()) {
+            ctx.reset();
+            synchronized (this) {
+                if (!closed && entries.get(e.key) == e && e.idle.size() < maxIdle) {
+                    e.idle.addLast(ctx);
+                    return;
+                }
+            }
+        }
+        ctx.poolEntry = null;
+        ctx.close();
+    }
+
+    /*
+     * Called by Yices.reset (which frees all contexts, configs, and parameters):
+     * forget the idle contexts and the cached records of every pool
+     */
+    static void resetAll() {
+        ContextPool[] a;
+        synchronized (pools) {
+            a = pools.keySet().toArray(new ContextPool[0]);
+        }
+        for (ContextPool pool : a) {
+            synchronized (pool) {
+                pool.entries.clear();
+            }
+        }
+    }
+
+    /*
+     * Free all idle contexts and the cached records.
+     * Contexts that are still in use are freed when they are closed.
+     */
+    public void close() {
+        ArrayDeque<Context> toFree = new ArrayDeque<>();
+        synchronized (this) {
+            if (closed) return;
+            closed = true;
+            for (Entry e : entries.values()) {
+                toFree.addAll(e.idle);
+                e.idle.clear();
+                synchronized (e) {
+                    e.config.close();
+                    e.config = null;
+                }
+                if (e.params != null) e.params.close();
+            }
+            entries.clear();
+        }
+        for (Context ctx : toFree) {
+            ctx.poolEntry = null;
+            ctx.close();
+        }
+        pools.remove(this);
+    }
+}
@@ -0,0 +1,84 @@
+package com.sri.yices;
+
+import java.util.concurrent.ScheduledFuture;
+import java.util.concurrent.ScheduledThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Shared timer for checks with a timeout.
+ *
+ * All deadlines are handled by a single daemon thread. When a deadline
+ * expires, the timer calls Yices.stopSearch on the context.
+ *
+ * A Deadline must be closed as soon as the check returns. The Deadline
+ * lock guarantees that the timer can't stop anything after that, even if
+ * it fires at the same time: this matters if the context is checked again.
+ */
+final class DeadlineScheduler {
+    private static final ScheduledThreadPoolExecutor timer;
+
+    static {
+        timer = new ScheduledThreadPoolExecutor(1, r -> {
+            Thread t = new Thread(r, "yices-deadline");
+            t.setDaemon(true);
+            return t;
+        });
+        // cancelled deadlines are removed from the queue right away
+        timer.setRemoveOnCancelPolicy(true);
+    }
+
+    /*
+     * If the deadline expires before the search has started, stopSearch would have
+     * no effect so we try again after RETRY_NS.
+     */
+    private static final long RETRY_NS = 100000L;
+
+    private static final int SEARCHING = Status.SEARCHING.ordinal();
+
+    private DeadlineScheduler() { }
+
+    static final class Deadline implements AutoCloseable {
+        private final long ctx;
+        private boolean active = true;
+        private boolean expired = false;
+        private ScheduledFuture<?> future;
+
+        private Deadline(long ctx) {
+            this.ctx = ctx;
+        }
+
+        private synchronized void fire() {
+            if (active) {
+                if (Yices.contextStatus(ctx) == SEARCHING) {
+                    Yices.stopSearch(ctx);
+                    expired = true;
+                } else {
+                    future = timer.schedule(this::fire, RETRY_NS, TimeUnit.NANOSECONDS);
+                }
+            }
+        }
+
+        /*
+         * True if the timer stopped the search
+         */
+        public synchronized boolean hasExpired() {
+            return expired;
+        }
+
+        public synchronized void close() {
+            active = false;
+            if (future != null) future.cancel(false);
+        }
+    }
+
+    /*
+     * Schedule a call to Yices.stopSearch(ctx) after the given delay
+     */
+    static Deadline schedule(long ctx, long delay, TimeUnit unit) {
+        Deadline d = new Deadline(ctx);
+        synchronized (d) {
+            d.future = timer.schedule(d::fire, Math.max(delay, 0), unit);
+        }
+        return d;
+    }
+}
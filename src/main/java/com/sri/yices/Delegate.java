@@ -1,5 +1,7 @@
 package com.sri.yices;
 
+import java.util.concurrent.CompletableFuture;
+
 /**
  *  Providing access to yices's third party SAT solvers.
  *
@@ -42,6 +44,16 @@ public class  Delegate {
         return retval;
     }
 
+    /*
+     * Asynchronous variants: they run on the shared solver executor.
+     * The delegate can't be interrupted so cancelling the future does not stop it.
+     */
+    public static CompletableFuture<Status> checkFormulaAsync(int term, String logic, String delegate, Model[] marr){
+        return CheckFuture.submit(0, () -> checkFormula(term, logic, delegate, marr), CheckFuture.defaultExecutor());
+    }
 
-
+    public static CompletableFuture<Status> checkFormulasAsync(int[] terms, String logic, String delegate, Model[] marr){
+        int[] a = terms.clone();
+        return CheckFuture.submit(0, () -> checkFormulas(a, logic, delegate, marr), CheckFuture.defaultExecutor());
+    }
 }
@@ -1,7 +1,11 @@
 package com.sri.yices;
 
+import java.io.IOException;
+import java.io.OutputStream;
+import java.nio.ByteBuffer;
+
 /*
- * Bit-blast then export the CNF to a file
+ * Bit-blast then export the CNF to a file, to memory, or to a stream
  */
 
 public class Dimacs {
@@ -51,7 +55,54 @@ public class Dimacs {
         return code == 1;
     }
 
+    /*
+     * Bit-blast formulas then export the CNF to memory (no file is written)
+     * - terms = array of Boolean formulas (in the QF_BV theory)
+     * - status = an array to store the status of the formulas.
+     *  returns:
+     *   a DimacsBuffer that contains the CNF (to be closed by the caller)
+     *   null if the formulas are solved without CNF or after simplifying
+     *   throws an exception if there's an error
+     */
+    public static DimacsBuffer exportToBuffer(int[] terms, boolean simplify, Status[] status) throws YicesException {
+        if (status == null || status.length == 0){
+            throw new IllegalArgumentException("status array null or too small");
+        }
+        int[] result = { -1, -1 };
+        ByteBuffer b = Yices.exportToDimacsBuffer(terms, simplify, result);
+        if (result[0] < 0) {
+            if (result[0] == -3) throw new RuntimeException("failed to store the CNF in memory");
+            YicesException error = YicesException.checkVersion(2, 6, 2);
+            throw error != null ? error : new YicesException();
+        }
+        status[0] = Status.idToStatus(result[1]);
+        return result[0] == 1 ? new DimacsBuffer(b) : null;
+    }
 
+    public static DimacsBuffer exportToBuffer(int term, boolean simplify, Status[] status) throws YicesException {
+        return exportToBuffer(new int[] { term }, simplify, status);
+    }
 
+    /*
+     * Bit-blast formulas then write the CNF to out
+     * - binary: true for the compact binary format (cf. DimacsBuffer), false for DIMACS text
+     *  returns:
+     *   true if the CNF was written
+     *   false if the formulas are solved without CNF or after simplifying (nothing is written)
+     */
+    public static boolean export(int[] terms, OutputStream out, boolean binary, boolean simplify, Status[] status) throws YicesException, IOException {
+        try (DimacsBuffer cnf = exportToBuffer(terms, simplify, status)) {
+            if (cnf == null) return false;
+            if (binary) {
+                cnf.writeBinaryTo(out);
+            } else {
+                cnf.writeTo(out);
+            }
+            return true;
+        }
+    }
 
+    public static boolean export(int term, OutputStream out, boolean binary, boolean simplify, Status[] status) throws YicesException, IOException {
+        return export(new int[] { term }, out, binary, simplify, status);
+    }
 }
@@ -0,0 +1,245 @@
+package com.sri.yices;
+
+import java.io.IOException;
+import java.io.OutputStream;
+import java.lang.ref.Reference;
+import java.nio.ByteBuffer;
+
+/**
+ * CNF produced by Dimacs.exportToBuffer, stored in native memory.
+ *
+ * The DIMACS text can be copied into another buffer, or written to a stream,
+ * either as is or in a compact binary format:
+ *
+ * - the four bytes 'y' 'c' 'n' 'f'
+ * - the number of variables and the number of clauses
+ * - each clause, as a sequence of literals followed by 0. A literal v or -v
+ *   is written as 2v or 2v+1 (as in the binary DRAT format).
+ * All numbers are unsigned LEB128 integers: 7 bits per byte, least significant
+ * group first, with the high bit set in every byte except the last.
+ *
+ * The native memory is released by close, or by the Cleaner if the object is
+ * not closed (cf. NativeRef). No view of the native memory is handed out, so
+ * nothing can read it after it's released: buffer() returns a copy.
+ */
+public final class DimacsBuffer implements AutoCloseable {
+    private static final int CHUNK_SIZE = 65536;
+
+    //<PROFILING>
+    static private final NativeRef.Census census = new NativeRef.Census();
+
+    /**
+     * Returns the count of DimacsBuffer objects whose native memory
+     * is not released yet.
+     */
+    public static long getCensus(){
+        return census.live();
+    }
+
+    /**
+     * Returns the count of DimacsBuffer objects that were never closed
+     * (their native memory was released when they were garbage collected).
+     */
+    public static long getLeakCount(){
+        return census.leaked();
+    }
+    //</PROFILING>
+
+    private ByteBuffer mapped;     // native buffer or null if the CNF is empty or closed
+    private final NativeRef ref;   // null if the CNF is empty
+    private final int size;
+
+    DimacsBuffer(ByteBuffer mapped) {
+        this.mapped = mapped;
+        this.size = mapped == null ? 0 : mapped.capacity();
+        if (mapped == null) {
+            ref = null;
+        } else {
+            // NativeRef needs a non-zero handle: the mapping is released through the buffer
+            ref = new NativeRef(this, size, census, p -> Yices.freeDimacsBuffer(mapped), true);
+        }
+    }
+
+    /*
+     * Number of bytes of DIMACS text
+     */
+    public int size() {
+        return size;
+    }
+
+    // internal view: must not escape
+    private ByteBuffer view() {
+        if (mapped == null) {
+            if (size > 0) throw new IllegalStateException("the DIMACS buffer is closed");
+            return ByteBuffer.allocate(0);
+        }
+        return mapped.asReadOnlyBuffer();
+    }
+
+    /*
+     * Copy of the DIMACS text, in a heap buffer
+     * - throws IllegalStateException if the buffer is closed
+     */
+    public synchronized ByteBuffer buffer() {
+        ByteBuffer b = ByteBuffer.allocate(size);
+        copyTo(b);
+        b.flip();
+        return b;
+    }
+
+    /*
+     * Copy the DIMACS text into dst (at dst's position)
+     * - throws BufferOverflowException if dst.remaining() < size()
+     */
+    public synchronized void copyTo(ByteBuffer dst) {
+        try {
+            dst.put(view());
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+    }
+
+    /*
+     * Write the DIMACS text to out
+     */
+    public synchronized void writeTo(OutputStream out) throws IOException {
+        try {
+            ByteBuffer b = view();
+            byte[] chunk = new byte[Math.min(CHUNK_SIZE, Math.max(size, 1))];
+            while (b.hasRemaining()) {
+                int n = Math.min(chunk.length, b.remaining());
+                b.get(chunk, 0, n);
+                out.write(chunk, 0, n);
+            }
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+    }
+
+    /*
+     * Write the CNF to out in the binary format
+     */
+    public synchronized void writeBinaryTo(OutputStream out) throws IOException {
+        try {
+            new BinaryWriter(view(), out).run();
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+    }
+
+    public synchronized void close() {
+        if (mapped != null) {
+            ref.close();
+            mapped = null;
+        }
+    }
+
+
+    /*
+     * Conversion from DIMACS text to the binary format
+     */
+    private static final class BinaryWriter {
+        private final ByteBuffer in;
+        private final OutputStream out;
+        private final byte[] chunk = new byte[CHUNK_SIZE];
+        private int len = 0;
+
+        BinaryWriter(ByteBuffer in, OutputStream out) {
+            this.in = in;
+            this.out = out;
+        }
+
+        private void put(int b) throws IOException {
+            if (len == chunk.length) {
+                out.write(chunk, 0, len);
+                len = 0;
+            }
+            chunk[len++] = (byte) b;
+        }
+
+        private void putVarint(long x) throws IOException {
+            while (x >= 0x80) {
+                put((int) (x & 0x7F) | 0x80);
+                x >>>= 7;
+            }
+            put((int) x);
+        }
+
+        private void skipLine() {
+            while (in.hasRemaining() && in.get() != '\n') { }
+        }
+
+        private static boolean isSpace(int c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        // skip white space: return the next character, or -1 at the end
+        private int peek() {
+            while (in.hasRemaining()) {
+                int c = in.get(in.position());
+                if (!isSpace(c)) return c;
+                in.get();
+            }
+            return -1;
+        }
+
+        private String word() {
+            StringBuilder sb = new StringBuilder();
+            peek();
+            while (in.hasRemaining() && !isSpace(in.get(in.position()))) {
+                sb.append((char) in.get());
+            }
+            return sb.toString();
+        }
+
+        private long integer() throws IOException {
+            boolean negative = false;
+            if (peek() == '-') {
+                negative = true;
+                in.get();
+            }
+            long x = 0;
+            int digits = 0;
+            while (in.hasRemaining()) {
+                int c = in.get(in.position());
+                if (c < '0' || c > '9') break;
+                x = 10 * x + (c - '0');
+                in.get();
+                digits ++;
+            }
+            if (digits == 0) throw new IOException("invalid DIMACS input at offset " + in.position());
+            return negative ? -x : x;
+        }
+
+        void run() throws IOException {
+            put('y');
+            put('c');
+            put('n');
+            put('f');
+            boolean header = false;
+            int c;
+            while ((c = peek()) >= 0) {
+                if (c == 'c') {
+                    skipLine();
+                } else if (c == 'p') {
+                    in.get();
+                    if (header || !word().equals("cnf")) throw new IOException("invalid DIMACS header");
+                    putVarint(integer());
+                    putVarint(integer());
+                    header = true;
+                } else {
+                    if (!header) throw new IOException("missing DIMACS header");
+                    long lit = integer();
+                    putVarint(lit < 0 ? 2 * (-lit) + 1 : 2 * lit);
+                }
+            }
+            if (!header) {
+                // empty CNF
+                putVarint(0);
+                putVarint(0);
+            }
+            out.write(chunk, 0, len);
+            len = 0;
+        }
+    }
+}
@@ -1,5 +1,7 @@
 package com.sri.yices;
 
+import java.lang.ref.Reference;
+
 // Since 2.6.4
 
 public class InterpolationContext {
@@ -35,7 +37,14 @@ public class InterpolationContext {
         int[] tarr = { 0 };
         long[] marr = { 0 };
         if (!buildModel) { marr = null; }
-        int code = Yices.checkContextWithInterpolation(this.ctxA.getPtr(), this.ctxB.getPtr(), params.getPtr(), marr, tarr);
+        int code;
+        try {
+            code = Yices.checkContextWithInterpolation(this.ctxA.getPtr(), this.ctxB.getPtr(), params.getPtr(), marr, tarr);
+        } finally {
+            Reference.reachabilityFence(ctxA);
+            Reference.reachabilityFence(ctxB);
+            Reference.reachabilityFence(params);
+        }
         Status status = Status.idToStatus(code);
         if (status == Status.ERROR) {
             throw new YicesException();
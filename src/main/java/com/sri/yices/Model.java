@@ -1,6 +1,11 @@
 package com.sri.yices;
 
+import java.io.IOException;
+import java.io.OutputStream;
+import java.lang.ref.Reference;
 import java.math.BigInteger;
+import java.nio.ByteBuffer;
+import java.util.HashMap;
 
 /**
  * Class for Yices models
@@ -16,30 +21,39 @@ public class Model implements AutoCloseable {
             }
             throw error;
         }
-        population++;
+        ref = new NativeRef(this, ptr, census, Yices::freeModel);
     }
 
     /*
      * This is a pointer to the model
      */
     private long ptr;
+    private final NativeRef ref;
 
     protected Model(long p) {
         ptr = p;
-        population++;
+        ref = new NativeRef(this, p, census, Yices::freeModel);
     }
 
     protected long getPtr() { return ptr; }
 
     //<PROFILING>
-    static private long population = 0;
+    static private final NativeRef.Census census = new NativeRef.Census();
 
     /**
-     * Returns the count of Model objects that have an unfreed pointer
-     * to a Yices shared library object.
+     * Returns the count of Model objects that have an unfreed
+     * pointer to a Yices shared library object.
      */
     public static long getCensus(){
-        return population;
+        return census.live();
+    }
+
+    /**
+     * Returns the count of Model objects that were never closed
+     * (their pointer was freed when they were garbage collected).
+     */
+    public static long getLeakCount(){
+        return census.leaked();
     }
     //</PROFILING>
 
@@ -55,7 +69,7 @@ public class Model implements AutoCloseable {
         long p = Yices.modelFromMap(var, map);
         if (p == 0) throw new YicesException();
         ptr = p;
-        population++;
+        ref = new NativeRef(this, p, census, Yices::freeModel);
     }
 
     /*
@@ -63,9 +77,11 @@ public class Model implements AutoCloseable {
      */
     public void close() {
         if (ptr != 0) {
-            Yices.freeModel(ptr);
+            ref.close();
             ptr = 0;
-            population--;
+            synchronized (this) {
+                valueTrees = null;
+            }
         }
     }
 
@@ -77,18 +93,69 @@ public class Model implements AutoCloseable {
      * - the second version uses numColumns and numLines
      */
     public String toString() {
-        return Yices.modelToString(ptr);
+        try {
+            return Yices.modelToString(ptr);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
     public String toString(int numColumns, int numLines) {
-        return Yices.modelToString(ptr, numColumns, numLines);
+        try {
+            return Yices.modelToString(ptr, numColumns, numLines);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+    }
+
+    /*
+     * Pretty print the model without building a String (cf. Terms.toBuffer)
+     * - the versions without numColumns and numLines print in 80 columns with no line limit
+     * - toBuffer copies the text into dst if it fits and returns its size in bytes
+     */
+    public int toBuffer(int numColumns, int numLines, ByteBuffer dst) throws YicesException {
+        try {
+            return PrintedText.toBuffer((b, offset, capacity) -> Yices.modelToBuffer(ptr, numColumns, numLines, b, offset, capacity),
+                                        code -> Yices.modelToMappedBuffer(ptr, numColumns, numLines, code), dst);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+    }
+
+    public int toBuffer(ByteBuffer dst) throws YicesException {
+        return toBuffer(-1, -1, dst);
+    }
+
+    public void writeTo(int numColumns, int numLines, OutputStream out) throws IOException, YicesException {
+        try {
+            PrintedText.writeTo(code -> Yices.modelToMappedBuffer(ptr, numColumns, numLines, code), out);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+    }
+
+    public void writeTo(OutputStream out) throws IOException, YicesException {
+        writeTo(-1, -1, out);
+    }
+
+    public void appendTo(Appendable out) throws IOException, YicesException {
+        try {
+            PrintedText.appendTo(code -> Yices.modelToMappedBuffer(ptr, -1, -1, code), out);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
     /*
      * Value of a term t in the model
      */
     public boolean boolValue(int t) throws YicesException {
-        int x = Yices.getBoolValue(ptr, t);
+        int x;
+        try {
+            x = Yices.getBoolValue(ptr, t);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         // x is either -1 (error), 0 (false), or 1 (true).
         if (x < 0) throw new YicesException();
         return x != 0;
@@ -96,14 +163,24 @@ public class Model implements AutoCloseable {
 
     public long integerValue(int t) throws YicesException {
         long[] aux = new long[1];
-        int code = Yices.getIntegerValue(ptr, t, aux);
+        int code;
+        try {
+            code = Yices.getIntegerValue(ptr, t, aux);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
         return aux[0];
     }
 
     public double doubleValue(int t) throws YicesException {
         double[] aux = new double[1];
-        int code = Yices.getDoubleValue(ptr, t, aux);
+        int code;
+        try {
+            code = Yices.getDoubleValue(ptr, t, aux);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
         return aux[0];
     }
@@ -112,36 +189,99 @@ public class Model implements AutoCloseable {
     // the denominator is returned in a[1].
     public void rationalValue(int t, long[] a) throws YicesException {
         if (a.length < 2) throw new IllegalArgumentException("array too small");
-        int code = Yices.getRationalValue(ptr, t, a);
+        int code;
+        try {
+            code = Yices.getRationalValue(ptr, t, a);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
     }
 
     public BigInteger bigIntegerValue(int t) throws YicesException {
-        BigInteger v = Yices.getIntegerValue(ptr, t);
+        BigInteger v;
+        try {
+            v = Yices.getIntegerValue(ptr, t);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (v == null) throw new YicesException();
         return v;
     }
 
     public BigRational bigRationalValue(int t) throws YicesException {
-        BigRational v = Yices.getRationalValue(ptr, t);
+        BigRational v;
+        try {
+            v = Yices.getRationalValue(ptr, t);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (v == null) throw new YicesException();
         return v;
     }
 
     public boolean[] bvValue(int t) throws YicesException {
-        boolean[] b = Yices.getBvValue(ptr, t);
+        boolean[] b;
+        try {
+            b = Yices.getBvValue(ptr, t);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (b == null) throw new YicesException();
         return b;
     }
 
+    /*
+     * Packed bitvector values
+     * - bvValueWords returns the value as 64-bit words: bit i is bit (i % 64) of word i/64
+     * - bvValueBytes stores it in b as little-endian bytes, starting from b's position,
+     *   and returns the number of bytes written. This is done in place if b is direct.
+     */
+    public long[] bvValueWords(int t) throws YicesException {
+        long[] w;
+        try {
+            w = Yices.getBvValueWords(ptr, t);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+        if (w == null) throw new YicesException();
+        return w;
+    }
+
+    public int bvValueBytes(int t, ByteBuffer b) throws YicesException {
+        int n = (Yices.termBitSize(t) + 7)/8;
+        if (b.remaining() < n) throw new IllegalArgumentException("buffer too small");
+        if (b.isDirect()) {
+            try {
+                n = Yices.getBvValueBytes(ptr, t, b, b.position());
+            } finally {
+                Reference.reachabilityFence(this);
+            }
+            if (n < 0) throw new YicesException();
+        } else {
+            Terms.wordsToBytes(bvValueWords(t), b, n);
+        }
+        return n;
+    }
+
     public int scalarValue(int t) throws YicesException {
-        int v = Yices.getScalarValue(ptr, t);
+        int v;
+        try {
+            v = Yices.getScalarValue(ptr, t);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (v < 0) throw new YicesException();
         return v;
     }
 
     public int valueAsTerm(int t) throws YicesException {
-        int v = Yices.valueAsTerm(ptr, t);
+        int v;
+        try {
+            v = Yices.valueAsTerm(ptr, t);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (v < 0) throw new YicesException();
         return v;
     }
@@ -151,16 +291,58 @@ public class Model implements AutoCloseable {
             throw new IllegalArgumentException();
         }
         int[] output = new int[terms.length];
-        int v = Yices.valuesAsTerms(ptr, terms, output);
+        int v;
+        try {
+            v = Yices.valuesAsTerms(ptr, terms, output);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (v < 0) throw new YicesException();
         return output;
     }
 
+    /*
+     * Values of all terms in one call
+     * - this is much cheaper than calling boolValue, integerValue, bvValue, etc.
+     *   on each term when there are many terms
+     * - see ModelValues for how to read the result
+     */
+    public ModelValues values(int[] terms) throws YicesException {
+        if (terms == null) {
+            throw new IllegalArgumentException();
+        }
+        long[] values = new long[terms.length];
+        byte[] kinds = new byte[terms.length];
+        long[] bits = null;
+        int n;
+        try {
+            n = Yices.getValues(ptr, terms, values, kinds, bits);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+        if (n > 0) {
+            // the first call just computed how much space the bitvectors need
+            bits = new long[n];
+            try {
+                n = Yices.getValues(ptr, terms, values, kinds, bits);
+            } finally {
+                Reference.reachabilityFence(this);
+            }
+        }
+        if (n < 0) throw new YicesException();
+        return new ModelValues(terms, values, kinds, bits);
+    }
+
     /*
      * Set the value of a term t in the model
      */
     public void setBoolean(int t, boolean val)  throws YicesException {
-        int code = Yices.modelSetBool(ptr, t, val ? 1 : 0);
+        int code;
+        try {
+            code = Yices.modelSetBool(ptr, t, val ? 1 : 0);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) {
             YicesException error = YicesException.checkVersion(2, 6, 4);
             if (error == null) {
@@ -172,7 +354,12 @@ public class Model implements AutoCloseable {
     }
 
     public void setInteger(int t, long val)  throws YicesException {
-        int code = Yices.modelSetInteger(ptr, t, val);
+        int code;
+        try {
+            code = Yices.modelSetInteger(ptr, t, val);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) {
             YicesException error = YicesException.checkVersion(2, 6, 4);
             if (error == null) {
@@ -184,7 +371,12 @@ public class Model implements AutoCloseable {
     }
 
     public void setRational(int t, long num, long den)  throws YicesException {
-        int code = Yices.modelSetRational(ptr, t, num, den);
+        int code;
+        try {
+            code = Yices.modelSetRational(ptr, t, num, den);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) {
             YicesException error = YicesException.checkVersion(2, 6, 4);
             if (error == null) {
@@ -196,7 +388,12 @@ public class Model implements AutoCloseable {
     }
 
     public void setBVInteger(int t, long val)  throws YicesException {
-        int code = Yices.modelSetBVInteger(ptr, t, val);
+        int code;
+        try {
+            code = Yices.modelSetBVInteger(ptr, t, val);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) {
             YicesException error = YicesException.checkVersion(2, 6, 4);
             if (error == null) {
@@ -208,7 +405,62 @@ public class Model implements AutoCloseable {
     }
 
     public void setBVFromArray(int t, int[] arr)  throws YicesException {
-        int code = Yices.modelSetBVFromArray(ptr, t, arr);
+        int code;
+        try {
+            code = Yices.modelSetBVFromArray(ptr, t, arr);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+        if (code < 0) {
+            YicesException error = YicesException.checkVersion(2, 6, 4);
+            if (error == null) {
+                // not a library mismatch error; so do the default
+                error = new YicesException();
+            }
+            throw error;
+        }
+    }
+
+    /*
+     * Packed variants: the number of bits is the bitsize of t
+     * - bit i is bit (i % 64) of w[i/64]
+     * - or bit (i % 8) of byte i/8 in b, starting from its position
+     */
+    public void setBVFromWords(int t, long... w)  throws YicesException {
+        if (w.length < (Yices.termBitSize(t) + 63)/64) throw new IllegalArgumentException("array too small");
+        int code;
+        try {
+            code = Yices.modelSetBVFromWords(ptr, t, w);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+        if (code < 0) {
+            YicesException error = YicesException.checkVersion(2, 6, 4);
+            if (error == null) {
+                // not a library mismatch error; so do the default
+                error = new YicesException();
+            }
+            throw error;
+        }
+    }
+
+    public void setBVFromBytes(int t, ByteBuffer b)  throws YicesException {
+        int n = (Yices.termBitSize(t) + 7)/8;
+        if (b.remaining() < n) throw new IllegalArgumentException("buffer too small");
+        int code;
+        if (b.isDirect()) {
+            try {
+                code = Yices.modelSetBVFromBytes(ptr, t, b, b.position());
+            } finally {
+                Reference.reachabilityFence(this);
+            }
+        } else {
+            try {
+                code = Yices.modelSetBVFromWords(ptr, t, Terms.bytesToWords(b, n));
+            } finally {
+                Reference.reachabilityFence(this);
+            }
+        }
         if (code < 0) {
             YicesException error = YicesException.checkVersion(2, 6, 4);
             if (error == null) {
@@ -220,9 +472,83 @@ public class Model implements AutoCloseable {
     }
 
 
+    /*
+     * Bulk setters: vars[i] gets the i-th value
+     * - setRationals: the value of vars[i] is values[2i]/values[2i+1]
+     * - setBVWords: the words of each variable are stored one after the other
+     *   (same layout as setBVFromWords). It throws IllegalArgumentException if words
+     *   is too small (then nothing is assigned) or for a variable that's not a bitvector.
+     * If an assignment fails, the previous variables keep their value and the
+     * exception is thrown.
+     */
+    public void setBooleans(int[] vars, boolean[] values) throws YicesException {
+        if (values.length < vars.length) throw new IllegalArgumentException("values array too small");
+        try {
+            checkBulkSet(Yices.modelSetBools(ptr, vars, values), vars);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+    }
+
+    public void setIntegers(int[] vars, long[] values) throws YicesException {
+        if (values.length < vars.length) throw new IllegalArgumentException("values array too small");
+        try {
+            checkBulkSet(Yices.modelSetIntegers(ptr, vars, values), vars);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+    }
+
+    public void setRationals(int[] vars, long[] values) throws YicesException {
+        if (values.length < 2L * vars.length) throw new IllegalArgumentException("values array too small");
+        try {
+            checkBulkSet(Yices.modelSetRationals(ptr, vars, values), vars);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+    }
+
+    public void setBVIntegers(int[] vars, long[] values) throws YicesException {
+        if (values.length < vars.length) throw new IllegalArgumentException("values array too small");
+        try {
+            checkBulkSet(Yices.modelSetBVIntegers(ptr, vars, values), vars);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+    }
+
+    public void setBVWords(int[] vars, long[] words) throws YicesException {
+        int code;
+        try {
+            code = Yices.modelSetBVWords(ptr, vars, words);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+        if (code == -2) throw new IllegalArgumentException("words array too small");
+        if (code >= 0 && code < vars.length && Yices.typeOfTerm(vars[code]) >= 0 && !Yices.termIsBitvector(vars[code])) {
+            throw new IllegalArgumentException("not a bitvector: " + vars[code]);
+        }
+        checkBulkSet(code, vars);
+    }
+
+    private static void checkBulkSet(int code, int[] vars) throws YicesException {
+        if (code < vars.length) {
+            YicesException error = YicesException.checkVersion(2, 6, 4);
+            if (error == null) {
+                // not a library mismatch error; so do the default
+                error = new YicesException();
+            }
+            throw error;
+        }
+    }
 
     public int[] collectDefinedTerms() {
-        int[] retval = Yices.modelCollectDefinedTerms(ptr);
+        int[] retval;
+        try {
+            retval = Yices.modelCollectDefinedTerms(ptr);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (retval == null) {
             YicesException error = YicesException.checkVersion(2, 6, 4);
             if (error == null) {
@@ -250,7 +576,11 @@ public class Model implements AutoCloseable {
      * The implicant is returned in an int array, or null indicating an error.
      */
     public int[] implicant(int t){
-        return Yices.implicantForFormula(ptr, t);
+        try {
+            return Yices.implicantForFormula(ptr, t);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
     /*
@@ -264,7 +594,11 @@ public class Model implements AutoCloseable {
      * The implicant is returned in an int array, or null indicating an error.
      */
     public int[] implicant(int[] terms){
-        return Yices.implicantForFormulas(ptr, terms);
+        try {
+            return Yices.implicantForFormulas(ptr, terms);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
 
@@ -278,72 +612,187 @@ public class Model implements AutoCloseable {
      */
 
     public int[] support(int term) throws YicesException {
-        int[] retval = Yices.getSupport(ptr, term);
+        int[] retval;
+        try {
+            retval = Yices.getSupport(ptr, term);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (retval == null) throw new YicesException();
         return retval;
     }
 
     public int[] support(int[] terms) throws YicesException {
-        int[] retval = Yices.getSupport(ptr, terms);
+        int[] retval;
+        try {
+            retval = Yices.getSupport(ptr, terms);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (retval == null) throw new YicesException();
         return retval;
     }
 
+    /*
+     * Batches: the same operation on the same terms in many models (e.g., the
+     * counterexamples found in one frame of IC3/PDR)
+     * - a single native call processes all the models and the results are packed
+     *   in a ModelBatch
+     * - if parallel is true and Yices is thread safe, the models are split between
+     *   several native threads
+     * - the operation may fail on some models and succeed on others: if it fails on one,
+     *   the Yices error report is the one of the first model that failed
+     */
+    public static ModelBatch implicantBatch(Model[] models, int[] terms, boolean parallel) {
+        return batch(0, models, terms, null, GeneralizationMode.GEN_DEFAULT, parallel);
+    }
+
+    public static ModelBatch generalizeBatch(Model[] models, int[] terms, int[] elims, GeneralizationMode mode, boolean parallel) {
+        return batch(1, models, terms, elims, mode, parallel);
+    }
+
+    public static ModelBatch supportBatch(Model[] models, int[] terms, boolean parallel) throws YicesException {
+        return batch(2, models, terms, null, GeneralizationMode.GEN_DEFAULT, parallel);
+    }
+
+    private static ModelBatch batch(int op, Model[] models, int[] terms, int[] elims, GeneralizationMode mode, boolean parallel) {
+        long[] ptrs = new long[models.length];
+        for (int i = 0; i < models.length; i++) {
+            ptrs[i] = models[i].ptr;
+            if (ptrs[i] == 0) throw new IllegalStateException("model is closed");
+        }
+        int threads = parallel ? Runtime.getRuntime().availableProcessors() : 1;
+        int[] r;
+        try {
+            if (Profiler.enabled) {
+                long start = System.nanoTime();
+                r = Yices.modelBatch(op, ptrs, terms, elims, mode.ordinal(), threads);
+                Profiler.delta("Yices.modelBatch", start, System.nanoTime());
+            } else {
+                r = Yices.modelBatch(op, ptrs, terms, elims, mode.ordinal(), threads);
+            }
+        } finally {
+            for (Model m : models) {
+                Reference.reachabilityFence(m);
+            }
+        }
+        if (r == null) {
+            // only getSupport can be missing
+            YicesException error = YicesException.checkVersion(2, 6, 2);
+            if (error == null) {
+                error = new YicesException();
+            }
+            throw error;
+        }
+        return new ModelBatch(r);
+    }
+
     /*
      * Term exploration in a model
      */
     public YVal getValue(int t){
-        return Yices.getValue(ptr, t);
+        try {
+            return Yices.getValue(ptr, t);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
     public boolean isInt(YVal yval){
-        return Yices.valIsInt(ptr, yval.tag.ordinal(), yval.id);
+        try {
+            return Yices.valIsInt(ptr, yval.tag.ordinal(), yval.id);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
     public boolean isLong(YVal yval){
-        return Yices.valIsLong(ptr, yval.tag.ordinal(), yval.id);
+        try {
+            return Yices.valIsLong(ptr, yval.tag.ordinal(), yval.id);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
     public boolean isInteger(YVal yval){
-        return Yices.valIsLong(ptr, yval.tag.ordinal(), yval.id);
+        try {
+            return Yices.valIsLong(ptr, yval.tag.ordinal(), yval.id);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
     public int bitSize(YVal yval){
-        return Yices.valBitSize(ptr, yval.tag.ordinal(), yval.id);
+        try {
+            return Yices.valBitSize(ptr, yval.tag.ordinal(), yval.id);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
     public int tupleArity(YVal yval){
-        return Yices.valTupleArity(ptr, yval.tag.ordinal(), yval.id);
+        try {
+            return Yices.valTupleArity(ptr, yval.tag.ordinal(), yval.id);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
     public int mappingArity(YVal yval){
-        return Yices.valMappingArity(ptr, yval.tag.ordinal(), yval.id);
+        try {
+            return Yices.valMappingArity(ptr, yval.tag.ordinal(), yval.id);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
     public int functionArity(YVal yval){
-        return Yices.valFunctionArity(ptr, yval.tag.ordinal(), yval.id);
+        try {
+            return Yices.valFunctionArity(ptr, yval.tag.ordinal(), yval.id);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
     public int functionType(YVal yval){
-        return Yices.valFunctionType(ptr, yval.tag.ordinal(), yval.id);
+        try {
+            return Yices.valFunctionType(ptr, yval.tag.ordinal(), yval.id);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
     }
 
     public boolean boolValue(YVal yval) throws YicesException {
-        int code = Yices.valGetBool(ptr, yval.tag.ordinal(), yval.id);
+        int code;
+        try {
+            code = Yices.valGetBool(ptr, yval.tag.ordinal(), yval.id);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
         return code == 1;
     }
 
     public long integerValue(YVal yval) throws YicesException {
         long[] aux = new long[1];
-        int code = Yices.valGetInteger(ptr, yval.tag.ordinal(), yval.id, aux);
+        int code;
+        try {
+            code = Yices.valGetInteger(ptr, yval.tag.ordinal(), yval.id, aux);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
         return aux[0];
     }
 
     public double doubleValue(YVal yval) throws YicesException {
         double[] aux = new double[1];
-        int code = Yices.valGetDouble(ptr, yval.tag.ordinal(), yval.id, aux);
+        int code;
+        try {
+            code = Yices.valGetDouble(ptr, yval.tag.ordinal(), yval.id, aux);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
         return aux[0];
     }
@@ -352,24 +801,44 @@ public class Model implements AutoCloseable {
     // the denominator is returned in a[1].
     public void rationalValue(YVal yval, long[] a) throws YicesException {
         if (a.length < 2) throw new IllegalArgumentException("array too small");
-        int code = Yices.valGetRational(ptr, yval.tag.ordinal(), yval.id, a);
+        int code;
+        try {
+            code = Yices.valGetRational(ptr, yval.tag.ordinal(), yval.id, a);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
     }
 
     public BigInteger bigIntegerValue(YVal yval) throws YicesException {
-        BigInteger v = Yices.valGetInteger(ptr, yval.tag.ordinal(), yval.id);
+        BigInteger v;
+        try {
+            v = Yices.valGetInteger(ptr, yval.tag.ordinal(), yval.id);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (v == null) throw new YicesException();
         return v;
     }
 
     public BigRational bigRationalValue(YVal yval) throws YicesException {
-        BigRational v = Yices.valGetRational(ptr, yval.tag.ordinal(), yval.id);
+        BigRational v;
+        try {
+            v = Yices.valGetRational(ptr, yval.tag.ordinal(), yval.id);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (v == null) throw new YicesException();
         return v;
     }
 
     public boolean[] bvValue(YVal yval) throws YicesException {
-        boolean[] b = Yices.valGetBV(ptr, yval.tag.ordinal(), yval.id);
+        boolean[] b;
+        try {
+            b = Yices.valGetBV(ptr, yval.tag.ordinal(), yval.id);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (b == null) throw new YicesException();
         return b;
     }
@@ -378,7 +847,12 @@ public class Model implements AutoCloseable {
     // in a[0] (constant index), and its type in a[1]
     public int[] scalarValue(YVal yval) throws YicesException {
         int[] a = new int[2];
-        int v = Yices.valGetScalar(ptr, yval.tag.ordinal(), yval.id, a);
+        int v;
+        try {
+            v = Yices.valGetScalar(ptr, yval.tag.ordinal(), yval.id, a);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (v < 0) throw new YicesException();
         return a;
     }
@@ -388,7 +862,12 @@ public class Model implements AutoCloseable {
         int n = this.tupleArity(yval);
         if (n > 0) {
             retval = new YVal[n];
-            int code = Yices.valExpandTuple(ptr, yval.tag.ordinal(), yval.id, retval);
+            int code;
+            try {
+                code = Yices.valExpandTuple(ptr, yval.tag.ordinal(), yval.id, retval);
+            } finally {
+                Reference.reachabilityFence(this);
+            }
             if (code < 0) throw new YicesException();
         } else {
             throw new YicesException();
@@ -397,21 +876,68 @@ public class Model implements AutoCloseable {
     }
 
     public VectorValue expandFunction(YVal yval) throws YicesException {
-        int n = Yices.valFunctionCardinality(ptr, yval.tag.ordinal(), yval.id);
+        int n;
+        try {
+            n = Yices.valFunctionCardinality(ptr, yval.tag.ordinal(), yval.id);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (n <= 0) throw new YicesException();
         YVal[] vector =  new YVal[n];
         YVal[] value = new YVal[1];
-        int code = Yices.valExpandFunction(ptr, yval.tag.ordinal(), yval.id, value, vector);
+        int code;
+        try {
+            code = Yices.valExpandFunction(ptr, yval.tag.ordinal(), yval.id, value, vector);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
         return new VectorValue(vector, value[0]);
     }
 
+    /*
+     * Snapshot of the values of terms: the value DAG is built in one native call
+     * and then explored without calling Yices (cf. ValueSnapshot).
+     */
+    public ValueSnapshot snapshot(int... terms) throws YicesException {
+        long[] a;
+        try {
+            a = Yices.valSnapshot(ptr, terms);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+        if (a == null) throw new YicesException();
+        return new ValueSnapshot(this, a);
+    }
+
+    /*
+     * Value of t as a node in a snapshot: the snapshots are cached in the
+     * model, and dropped when the model is closed.
+     */
+    private HashMap<Integer, ValueSnapshot.Node> valueTrees = null;
+
+    public synchronized ValueSnapshot.Node valueTree(int t) throws YicesException {
+        if (ptr == 0) throw new IllegalStateException("the model is closed");
+        if (valueTrees == null) valueTrees = new HashMap<>();
+        ValueSnapshot.Node node = valueTrees.get(t);
+        if (node == null) {
+            node = snapshot(t).root(0);
+            valueTrees.put(t, node);
+        }
+        return node;
+    }
+
     public VectorValue expandMapping(YVal yval) throws YicesException {
         YVal[] value = new YVal[1];
         int n = this.mappingArity(yval);
         if (n <= 0) throw new YicesException();
         YVal[] vector =  new YVal[n];
-        int code = Yices.valExpandMapping(ptr, yval.tag.ordinal(), yval.id, vector, value);
+        int code;
+        try {
+            code = Yices.valExpandMapping(ptr, yval.tag.ordinal(), yval.id, vector, value);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
         return new VectorValue(vector, value[0]);
     }
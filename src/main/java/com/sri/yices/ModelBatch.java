@@ -0,0 +1,79 @@
+package com.sri.yices;
+
+/**
+ * Result of Model.implicantBatch, Model.generalizeBatch, or Model.supportBatch.
+ *
+ * For each model, this gives the implicant, generalization, or support computed
+ * in that model, or null if the operation failed on that model.
+ *
+ * The results are packed in one int array (cf. Yices.modelBatch):
+ * cube i is data()[start(i) ... end(i)-1]. This avoids copying when the terms are
+ * consumed in place (e.g., added to a frame as blocking clauses).
+ */
+public final class ModelBatch {
+    // r[0] = n, then n codes, then n+1 offsets, then the terms
+    private final int[] r;
+
+    ModelBatch(int[] r) {
+        this.r = r;
+    }
+
+    /*
+     * Number of models in the batch
+     */
+    public int size() {
+        return r[0];
+    }
+
+    private void check(int i) {
+        if (i < 0 || i >= r[0]) throw new IndexOutOfBoundsException("invalid model index: " + i);
+    }
+
+    /*
+     * True if the operation failed on model i
+     */
+    public boolean failed(int i) {
+        check(i);
+        return r[1 + i] < 0;
+    }
+
+    /*
+     * Number of models where the operation failed
+     */
+    public int failures() {
+        int n = 0;
+        for (int i = 0; i < r[0]; i++) {
+            if (r[1 + i] < 0) n++;
+        }
+        return n;
+    }
+
+    /*
+     * Packed representation: data(), with cube i between start(i) and end(i)
+     * - data() is not a copy: it must not be modified
+     */
+    public int[] data() {
+        return r;
+    }
+
+    public int start(int i) {
+        check(i);
+        return r[r[0] + 1 + i];
+    }
+
+    public int end(int i) {
+        check(i);
+        return r[r[0] + 2 + i];
+    }
+
+    /*
+     * Result for model i, or null if the operation failed
+     */
+    public int[] cube(int i) {
+        if (failed(i)) return null;
+        int start = start(i);
+        int[] a = new int[end(i) - start];
+        System.arraycopy(r, start, a, 0, a.length);
+        return a;
+    }
+}
@@ -0,0 +1,93 @@
+package com.sri.yices;
+
+/**
+ * Result of Context.enumerateModels: the values of the projection terms
+ * in each model found.
+ *
+ * status() is the status of the last check:
+ * - UNSAT if all the models were enumerated
+ * - SAT if the enumeration stopped after the maximal number of models
+ * - INTERRUPTED if the time budget was exhausted
+ * - UNKNOWN if the solver gave up
+ * - ERROR if an error stopped the enumeration after count() models
+ *   (cf. Yices.errorCode)
+ */
+public final class ModelEnumeration {
+    private final int[] projection;
+    private final int count;
+    private final Status status;
+    private final int nwords;
+    private final long[] values;
+    private final byte[] kinds;
+    private final long[] bits;
+    private final int[] valueTerms;
+
+    ModelEnumeration(int[] projection, int count, Status status, int nwords,
+                     long[] values, byte[] kinds, long[] bits, int[] valueTerms) {
+        this.projection = projection;
+        this.count = count;
+        this.status = status;
+        this.nwords = nwords;
+        this.values = values;
+        this.kinds = kinds;
+        this.bits = bits;
+        this.valueTerms = valueTerms;
+    }
+
+    /*
+     * Number of models found
+     */
+    public int count() {
+        return count;
+    }
+
+    public Status status() {
+        return status;
+    }
+
+    public int[] projection() {
+        return projection.clone();
+    }
+
+    /*
+     * Values of the projection terms in model i
+     */
+    public ModelValues values(int i) {
+        if (i < 0 || i >= count) throw new IndexOutOfBoundsException("invalid model index: " + i);
+        int k = projection.length;
+        long[] v = new long[k];
+        byte[] kd = new byte[k];
+        long[] b = new long[nwords];
+        System.arraycopy(values, i * k, v, 0, k);
+        System.arraycopy(kinds, i * k, kd, 0, k);
+        if (nwords > 0) System.arraycopy(bits, i * nwords, b, 0, nwords);
+        return new ModelValues(projection, v, kd, b);
+    }
+
+    /*
+     * Values of the projection terms in model i, as constant terms
+     * (this works for all kinds of values, including OVERFLOW and OTHER).
+     */
+    public int[] valueTerms(int i) {
+        if (i < 0 || i >= count) throw new IndexOutOfBoundsException("invalid model index: " + i);
+        int k = projection.length;
+        int[] t = new int[k];
+        System.arraycopy(valueTerms, i * k, t, 0, k);
+        return t;
+    }
+
+    /*
+     * Raw arrays: row i of values, kinds, valueTerms is at indices
+     * i * k ... i * k + k - 1 where k = number of projection terms.
+     * Bitvector offsets in row i are relative to i * wordsPerModel() in bits.
+     */
+    public long[] rawValues() { return values; }
+
+    public byte[] rawKinds() { return kinds; }
+
+    public long[] rawBits() { return bits; }
+
+    public int[] rawValueTerms() { return valueTerms; }
+
+    public int wordsPerModel() { return nwords; }
+}
@@ -0,0 +1,102 @@
+package com.sri.yices;
+
+/**
+ * Values of an array of terms in a model, obtained in a single call (cf. Model.values).
+ *
+ * For each term terms[i], kind(i) is one of the codes below:
+ * - BOOL: the value is boolValue(i)
+ * - INTEGER: the value is integerValue(i)
+ * - BITVECTOR: the value has bvWidth(i) bits, stored in 64-bit words
+ *   (little endian). Use bvWords(i), bvBit(i, k), or bvLong(i) to get it.
+ * - SCALAR: the value is scalarValue(i) (for scalar and uninterpreted types)
+ * - OVERFLOW: the term is arithmetic but its value is not an integer or does
+ *   not fit in 64 bits. Use Model.bigRationalValue to get it.
+ * - OTHER: tuples and functions. Use Model.getValue to explore the value.
+ *
+ * The raw arrays are also available:
+ * - for BOOL, INTEGER, SCALAR, values()[i] is the value
+ * - for BITVECTOR, values()[i] is (width << 32) | offset and the value
+ *   is stored in bits()[offset ... offset + (width + 63)/64 - 1]
+ * - for OVERFLOW and OTHER, values()[i] is 0.
+ */
+public final class ModelValues {
+    // These codes must match enum value_kind in yicesJNI.cpp
+    public static final byte BOOL = 0;
+    public static final byte INTEGER = 1;
+    public static final byte BITVECTOR = 2;
+    public static final byte SCALAR = 3;
+    public static final byte OVERFLOW = 4;
+    public static final byte OTHER = 5;
+
+    private final int[] terms;
+    private final long[] values;
+    private final byte[] kinds;
+    private final long[] bits;
+
+    ModelValues(int[] terms, long[] values, byte[] kinds, long[] bits) {
+        this.terms = terms;
+        this.values = values;
+        this.kinds = kinds;
+        this.bits = bits != null ? bits : new long[0];
+    }
+
+    public int size() { return terms.length; }
+
+    public int term(int i) { return terms[i]; }
+
+    public byte kind(int i) { return kinds[i]; }
+
+    public long[] values() { return values; }
+
+    public byte[] kinds() { return kinds; }
+
+    public long[] bits() { return bits; }
+
+    private void check(int i, byte kind) {
+        if (kinds[i] != kind) throw new IllegalArgumentException("wrong kind of value");
+    }
+
+    public boolean boolValue(int i) {
+        check(i, BOOL);
+        return values[i] != 0;
+    }
+
+    public long integerValue(int i) {
+        check(i, INTEGER);
+        return values[i];
+    }
+
+    public int scalarValue(int i) {
+        check(i, SCALAR);
+        return (int) values[i];
+    }
+
+    public int bvWidth(int i) {
+        check(i, BITVECTOR);
+        return (int) (values[i] >>> 32);
+    }
+
+    private int bvOffset(int i) {
+        return (int) values[i];
+    }
+
+    // bit k of the value of terms[i]
+    public boolean bvBit(int i, int k) {
+        int w = bvWidth(i);
+        if (k < 0 || k >= w) throw new IndexOutOfBoundsException();
+        return ((bits[bvOffset(i) + (k >>> 6)] >>> (k & 63)) & 1) != 0;
+    }
+
+    // low-order 64 bits of the value of terms[i]
+    public long bvLong(int i) {
+        return bvWidth(i) > 0 ? bits[bvOffset(i)] : 0;
+    }
+
+    // copy of the words that store the value of terms[i]
+    public long[] bvWords(int i) {
+        int w = bvWidth(i);
+        long[] a = new long[(w + 63) >>> 6];
+        System.arraycopy(bits, bvOffset(i), a, 0, a.length);
+        return a;
+    }
+}
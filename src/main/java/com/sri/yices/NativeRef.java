@@ -0,0 +1,145 @@
+package com.sri.yices;
+
+import java.lang.ref.Cleaner;
+import java.util.ArrayList;
+import java.util.concurrent.atomic.LongAdder;
+import java.util.function.LongConsumer;
+
+/**
+ * Owner of a pointer to a Yices object (context, model, config, or parameters).
+ *
+ * The pointer is freed either explicitly, when the Java object is closed, or by
+ * the Cleaner if the Java object becomes unreachable before it's closed. The
+ * census counts objects that are live, and objects that the Cleaner had to free
+ * (i.e., objects that were never closed).
+ *
+ * If the Yices library is not thread safe, the Cleaner thread does not call Yices:
+ * the pointers are kept in a list and freed by the next thread that creates an
+ * object or calls NativeRef.drain().
+ *
+ * Yices.reset frees all contexts, models, configs, and parameter records. A
+ * NativeRef created before the reset must not free its pointer again: each
+ * NativeRef records the reset epoch, and pointers from an older epoch are
+ * dropped without calling Yices. The epoch is kept by RefQueue and bumped by
+ * Yices.reset, with the RefQueue lock held. Memory that the reset doesn't free
+ * (substitutions, mapped buffers) is owned by NativeRefs created with
+ * survivesReset = true, and it's always freed.
+ */
+final class NativeRef implements Runnable {
+    private static final Cleaner cleaner = Cleaner.create();
+
+    /*
+     * Counters for one class: LongAdders so that concurrent updates are cheap.
+     */
+    static final class Census {
+        private final LongAdder created = new LongAdder();
+        private final LongAdder freed = new LongAdder();
+        private final LongAdder leaked = new LongAdder();
+
+        long live() {
+            return created.sum() - freed.sum();
+        }
+
+        long created() {
+            return created.sum();
+        }
+
+        long leaked() {
+            return leaked.sum();
+        }
+    }
+
+    // pointers that the Cleaner could not free
+    private static final ArrayList<NativeRef> deferred = new ArrayList<>();
+
+    private final Census census;
+    private final LongConsumer free;
+    private final Cleaner.Cleanable cleanable;
+    private final long epoch;
+    private long ptr;
+    private boolean closed = false;
+
+    /*
+     * - owner = the Java object
+     * - ptr = the pointer
+     * - free = function to call to delete the Yices object
+     * - survivesReset = true if Yices.reset does not free the object
+     * The free function and census must not refer to the owner.
+     */
+    NativeRef(Object owner, long ptr, Census census, LongConsumer free, boolean survivesReset) {
+        drain();
+        this.census = census;
+        this.free = free;
+        this.ptr = ptr;
+        this.epoch = survivesReset ? -1 : RefQueue.epoch();
+        census.created.increment();
+        this.cleanable = cleaner.register(owner, this);
+    }
+
+    NativeRef(Object owner, long ptr, Census census, LongConsumer free) {
+        this(owner, ptr, census, free, false);
+    }
+
+    /*
+     * Explicit close: free the pointer now.
+     * Does nothing if it's already freed.
+     */
+    void close() {
+        synchronized (this) {
+            closed = true;
+        }
+        cleanable.clean();
+    }
+
+    /*
+     * Called once: either from close, or by the Cleaner
+     */
+    public void run() {
+        long p;
+        synchronized (this) {
+            p = ptr;
+            ptr = 0;
+            if (!closed) {
+                census.leaked.increment();
+                if (!Yices.isThreadSafe()) {
+                    synchronized (deferred) {
+                        ptr = p;
+                        deferred.add(this);
+                    }
+                    return;
+                }
+            }
+        }
+        release(p);
+    }
+
+    private void release(long p) {
+        if (p != 0) {
+            synchronized (RefQueue.class) {
+                // the pointer was freed by Yices.reset if the epoch has changed
+                if (epoch < 0 || epoch == RefQueue.epoch()) free.accept(p);
+            }
+            census.freed.increment();
+        }
+    }
+
+    /*
+     * Free the pointers that the Cleaner put aside
+     */
+    static void drain() {
+        NativeRef[] a;
+        synchronized (deferred) {
+            if (deferred.isEmpty()) return;
+            a = deferred.toArray(new NativeRef[0]);
+            deferred.clear();
+        }
+        for (NativeRef r : a) {
+            long p;
+            synchronized (r) {
+                p = r.ptr;
+                r.ptr = 0;
+            }
+            r.release(p);
+        }
+    }
+}
@@ -0,0 +1,95 @@
+package com.sri.yices;
+
+/**
+ * No-throw mode for speculative term and type construction.
+ *
+ * A YicesException is expensive: it fetches the error message and report
+ * across JNI and fills in a stack trace. In no-throw mode, the term and type
+ * constructors of Terms and Types return NULL_TERM or NULL_TYPE instead of
+ * throwing. The error is kept in a slot of the current thread (in the native
+ * library) and nothing is allocated until it's read:
+ *
+ *   try (NoThrow scope = NoThrow.enter()) {
+ *       int t = Terms.add(x, y);
+ *       if (t == Terms.NULL_TERM) {
+ *           // NoThrow.errorCode(), NoThrow.errorReport(), NoThrow.error()
+ *       }
+ *   }
+ *
+ * The mode is per thread and scopes can be nested. Only the constructors that
+ * return a term or a type are affected: other functions throw as usual.
+ */
+public final class NoThrow implements AutoCloseable {
+
+    // nesting depth for the current thread
+    private static final ThreadLocal<int[]> depth = ThreadLocal.withInitial(() -> new int[1]);
+
+    private final int[] counter;
+    private boolean closed = false;
+
+    private NoThrow(int[] counter) {
+        this.counter = counter;
+    }
+
+    /*
+     * Enter no-throw mode for the current thread, until the scope is closed
+     */
+    public static NoThrow enter() {
+        int[] d = depth.get();
+        d[0] ++;
+        return new NoThrow(d);
+    }
+
+    public void close() {
+        if (!closed) {
+            if (depth.get() != counter) throw new IllegalStateException("scope closed by another thread");
+            closed = true;
+            counter[0] --;
+        }
+    }
+
+    /*
+     * True if the current thread is in no-throw mode
+     */
+    public static boolean isEnabled() {
+        return depth.get()[0] > 0;
+    }
+
+    /*
+     * Called by the wrappers when a constructor fails: in no-throw mode,
+     * stash the error and return -1 (the null term or type), otherwise throw.
+     */
+    static int fail() throws YicesException {
+        if (depth.get()[0] > 0) {
+            Yices.stashError();
+            return -1;
+        }
+        throw new YicesException();
+    }
+
+    /*
+     * Last error stashed in this thread (0 = no error)
+     */
+    public static int errorCode() {
+        return Yices.lastErrorCode();
+    }
+
+    public static ErrorReport errorReport() {
+        return Yices.lastErrorReport();
+    }
+
+    public static String errorString() {
+        return Yices.lastErrorString();
+    }
+
+    /*
+     * Exception for the last error, for callers that decide to throw after all
+     */
+    public static YicesException error() {
+        return new YicesException(Yices.lastErrorString(), Yices.lastErrorReport());
+    }
+
+    public static void clearError() {
+        Yices.clearLastError();
+    }
+}
@@ -1,21 +1,32 @@
 package com.sri.yices;
 
+import java.lang.ref.Reference;
+
 /*
  * Wrapper around a Yices param_t structure
  */
 public class Parameters implements AutoCloseable {
     // pointer to the parameter record
     private long ptr;
+    private final NativeRef ref;
 
     //<PROFILING>
-    static private long population = 0;
+    static private final NativeRef.Census census = new NativeRef.Census();
 
     /**
      * Returns the count of Parameters objects that have an unfreed
      * pointer to a Yices shared library object.
      */
     public static long getCensus(){
-        return population;
+        return census.live();
+    }
+
+    /**
+     * Returns the count of Parameters objects that were never closed
+     * (their pointer was freed when they were garbage collected).
+     */
+    public static long getLeakCount(){
+        return census.leaked();
     }
     //</PROFILING>
 
@@ -24,7 +35,7 @@ public class Parameters implements AutoCloseable {
      */
     public Parameters() {
         ptr = Yices.newParamRecord();
-        population++;
+        ref = new NativeRef(this, ptr, census, Yices::freeParamRecord);
     }
 
     /*
@@ -32,9 +43,8 @@ public class Parameters implements AutoCloseable {
      */
     public void close() {
         if (ptr != 0) {
-            Yices.freeParamRecord(ptr);
+            ref.close();
             ptr = 0;
-            population--;
         }
     }
 
@@ -45,7 +55,12 @@ public class Parameters implements AutoCloseable {
      * Set a search parameter: name and value are both given as strings
      */
     public void setParam(String name, String value) throws YicesException {
-        int code = Yices.setParam(ptr, name, value);
+        int code;
+        try {
+            code = Yices.setParam(ptr, name, value);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
         if (code < 0) throw new YicesException();
     }
 
@@ -53,6 +68,11 @@ public class Parameters implements AutoCloseable {
      * Set parameters for a context
      */
     public void defaultsForContext(Context ctx) {
-        Yices.defaultParamsForContext(ctx.getPtr(), ptr);
+        try {
+            Yices.defaultParamsForContext(ctx.getPtr(), ptr);
+        } finally {
+            Reference.reachabilityFence(this);
+            Reference.reachabilityFence(ctx);
+        }
     }
 }
@@ -0,0 +1,155 @@
+package com.sri.yices;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Path;
+import java.nio.file.StandardOpenOption;
+
+/**
+ * Result of parsing many terms or types in one call (cf. Terms.parseAll and Types.parseAll).
+ *
+ * The input is UTF-8 text that contains a sequence of items: atoms or parenthesized
+ * expressions, separated by white space. Comments (from ';' to the end of the line)
+ * are ignored. Each item is parsed on its own: a parse error in one item does not
+ * prevent the others from being parsed.
+ *
+ * For item i, get(i) is the term or type (or -1 if there was an error), and
+ * errorCode(i), errorLine(i), errorColumn(i) describe the error. The line and
+ * column are relative to the item, as in the ErrorReport of a YicesException.
+ */
+public final class ParseBatch {
+    private static final int ITEM_SIZE = 6;
+
+    // r[0] = number of items, then six entries per item (cf. Yices.parseBatch)
+    private final int[] r;
+
+    private ParseBatch(int[] r) {
+        this.r = r;
+    }
+
+    static ParseBatch parse(String s, boolean types) {
+        byte[] b = s.getBytes(StandardCharsets.UTF_8);
+        return make(Yices.parseBatch(b, 0, b.length, types));
+    }
+
+    /*
+     * Parse the bytes between b's position and limit (the position is not changed)
+     */
+    static ParseBatch parse(ByteBuffer b, boolean types) {
+        int[] r;
+        if (!b.hasRemaining()) {
+            // no items: an empty mapped file may have no address
+            r = new int[] { 0 };
+        } else if (b.isDirect()) {
+            r = Yices.parseBatchBuffer(b, b.position(), b.remaining(), types);
+        } else if (b.hasArray()) {
+            r = Yices.parseBatch(b.array(), b.arrayOffset() + b.position(), b.remaining(), types);
+        } else {
+            // read-only heap buffer
+            byte[] a = new byte[b.remaining()];
+            b.duplicate().get(a);
+            r = Yices.parseBatch(a, 0, a.length, types);
+        }
+        return make(r);
+    }
+
+    /*
+     * Parse a file: the file is mapped in memory
+     */
+    static ParseBatch parseFile(Path file, boolean types) throws IOException {
+        try (FileChannel channel = FileChannel.open(file, StandardOpenOption.READ)) {
+            long size = channel.size();
+            if (size > Integer.MAX_VALUE) throw new IOException("file too large: " + file);
+            MappedByteBuffer b = channel.map(FileChannel.MapMode.READ_ONLY, 0, size);
+            return parse(b, types);
+        }
+    }
+
+    private static ParseBatch make(int[] r) {
+        if (r == null) throw new IllegalArgumentException("invalid buffer");
+        return new ParseBatch(r);
+    }
+
+    /*
+     * Number of items
+     */
+    public int size() {
+        return r[0];
+    }
+
+    private int field(int i, int k) {
+        if (i < 0 || i >= r[0]) throw new IndexOutOfBoundsException("invalid item index: " + i);
+        return r[1 + ITEM_SIZE * i + k];
+    }
+
+    /*
+     * Term or type of item i (-1 if there was an error)
+     */
+    public int get(int i) {
+        return field(i, 0);
+    }
+
+    /*
+     * All the terms or types, in order (-1 for the items that could not be parsed)
+     */
+    public int[] results() {
+        int n = r[0];
+        int[] a = new int[n];
+        for (int i = 0; i < n; i++) {
+            a[i] = r[1 + ITEM_SIZE * i];
+        }
+        return a;
+    }
+
+    public boolean isError(int i) {
+        return get(i) < 0;
+    }
+
+    // 0 if there's no error
+    public int errorCode(int i) {
+        return field(i, 1);
+    }
+
+    // start and end of item i in the input, as byte offsets
+    public int start(int i) {
+        return field(i, 2);
+    }
+
+    public int end(int i) {
+        return field(i, 3);
+    }
+
+    public int errorLine(int i) {
+        return field(i, 4);
+    }
+
+    public int errorColumn(int i) {
+        return field(i, 5);
+    }
+
+    /*
+     * Number of items that could not be parsed
+     */
+    public int errorCount() {
+        int n = 0;
+        for (int i = 0; i < r[0]; i++) {
+            if (r[1 + ITEM_SIZE * i] < 0) n++;
+        }
+        return n;
+    }
+
+    /*
+     * Indices of the items that could not be parsed
+     */
+    public int[] errors() {
+        int[] a = new int[errorCount()];
+        int j = 0;
+        for (int i = 0; i < r[0]; i++) {
+            if (r[1 + ITEM_SIZE * i] < 0) a[j++] = i;
+        }
+        return a;
+    }
+}
@@ -0,0 +1,249 @@
+package com.sri.yices;
+
+import java.util.ArrayList;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+
+/**
+ * Portfolio solving: the same formulas are asserted in several contexts with
+ * different configurations or search parameters (e.g., dpllt vs. mcsat, or
+ * different random seeds).  A check runs all the contexts in parallel and
+ * returns the first definitive answer (SAT or UNSAT). The other searches are
+ * interrupted with stopSearch.
+ *
+ * If the Yices library is not thread safe, the contexts are checked one after
+ * the other, until one of them returns SAT or UNSAT.
+ *
+ * A portfolio is not thread safe: check and assertFormula(s) must not be called
+ * concurrently.
+ */
+public class Portfolio implements AutoCloseable {
+    /*
+     * Portfolio member: context + parameters (null means default parameters)
+     * - running is true while the member's check is in progress
+     */
+    private static class Member {
+        final Context context;
+        final Parameters params;
+        volatile boolean running;
+        volatile Status status;
+        volatile YicesException error;
+
+        Member(Context context, Parameters params) {
+            this.context = context;
+            this.params = params;
+        }
+    }
+
+    private final ArrayList<Member> members = new ArrayList<>();
+    private int winner = -1;
+
+    /*
+     * Threads for the parallel checks: daemon threads that are created on
+     * demand and reused across checks.
+     */
+    private static ExecutorService executor = null;
+
+    private static synchronized ExecutorService getExecutor() {
+        if (executor == null) {
+            executor = Executors.newCachedThreadPool(r -> {
+                Thread t = new Thread(r, "yices-portfolio");
+                t.setDaemon(true);
+                return t;
+            });
+        }
+        return executor;
+    }
+
+    // delay between two rounds of stopSearch calls to the losers
+    private static final long STOP_INTERVAL_MS = 10;
+
+    public Portfolio() {
+    }
+
+    /*
+     * Add a context built from config, with the given search parameters
+     * - params may be null
+     * - the portfolio owns the context (it's freed by close) but not the parameters
+     * - returns the index of the new member
+     */
+    public int add(Config config, Parameters params) throws YicesException {
+        members.add(new Member(new Context(config), params));
+        return members.size() - 1;
+    }
+
+    /*
+     * Add a context for logic, with the given search parameters
+     */
+    public int add(String logic, Parameters params) throws YicesException {
+        members.add(new Member(new Context(logic), params));
+        return members.size() - 1;
+    }
+
+    public int size() {
+        return members.size();
+    }
+
+    public Context context(int i) {
+        return members.get(i).context;
+    }
+
+    /*
+     * Assert formulas in all the contexts
+     */
+    public void assertFormula(int f) throws YicesException {
+        for (Member m: members) {
+            m.context.assertFormula(f);
+        }
+    }
+
+    public void assertFormulas(int[] a) throws YicesException {
+        for (Member m: members) {
+            m.context.assertFormulas(a);
+        }
+    }
+
+    public void push() throws YicesException {
+        for (Member m: members) {
+            m.context.push();
+        }
+    }
+
+    public void pop() throws YicesException {
+        for (Member m: members) {
+            m.context.pop();
+        }
+    }
+
+    /*
+     * Index of the member that returned the result of the last check,
+     * or -1 if no member returned SAT or UNSAT.
+     */
+    public int winner() {
+        return winner;
+    }
+
+    /*
+     * Model from the winner of the last check (if that was SAT)
+     */
+    public Model getModel() throws YicesException {
+        if (winner < 0) throw new IllegalStateException("no winner");
+        return members.get(winner).context.getModel();
+    }
+
+    private static boolean isDefinitive(Status s) {
+        return s == Status.SAT || s == Status.UNSAT;
+    }
+
+    /*
+     * Check all the contexts
+     * - returns SAT or UNSAT as soon as one context finds it
+     * - otherwise, returns the status of the last context (UNKNOWN or INTERRUPTED)
+     * - if no context gives a definitive answer and one of them fails,
+     *   the corresponding YicesException is thrown.
+     */
+    public Status check() throws YicesException {
+        if (members.isEmpty()) throw new IllegalStateException("empty portfolio");
+        winner = -1;
+        if (members.size() == 1 || !Yices.isThreadSafe()) {
+            return checkSerial();
+        }
+        return checkParallel();
+    }
+
+    private Status checkSerial() throws YicesException {
+        Status result = null;
+        for (int i = 0; i < members.size(); i++) {
+            Member m = members.get(i);
+            result = m.context.check(m.params);
+            if (isDefinitive(result)) {
+                winner = i;
+                break;
+            }
+        }
+        return result;
+    }
+
+    private Status checkParallel() throws YicesException {
+        int n = members.size();
+        AtomicInteger first = new AtomicInteger(-1);
+        CountDownLatch done = new CountDownLatch(n);
+        ExecutorService exec = getExecutor();
+
+        for (int i = 0; i < n; i++) {
+            Member m = members.get(i);
+            int index = i;
+            m.running = true;
+            m.status = null;
+            m.error = null;
+            exec.execute(() -> {
+                try {
+                    // the search is pointless if we already have a winner
+                    if (first.get() < 0) {
+                        m.status = m.context.check(m.params);
+                    } else {
+                        m.status = Status.INTERRUPTED;
+                    }
+                    if (isDefinitive(m.status) && first.compareAndSet(-1, index)) {
+                        stopOthers(index);
+                    }
+                } catch (YicesException e) {
+                    m.error = e;
+                } finally {
+                    m.running = false;
+                    done.countDown();
+                }
+            });
+        }
+
+        // Wait for everybody, so that all the contexts are idle when we return.
+        // A loser may not have started its search when stopSearch was first called
+        // (then the call has no effect), so we keep stopping the losers until they're done.
+        boolean interrupted = false;
+        while (true) {
+            try {
+                if (done.await(STOP_INTERVAL_MS, TimeUnit.MILLISECONDS)) break;
+            } catch (InterruptedException e) {
+                // the caller wants us to give up: stop everything
+                interrupted = true;
+                first.compareAndSet(-1, n);
+            }
+            int w = first.get();
+            if (w >= 0) stopOthers(w);
+        }
+        if (interrupted) Thread.currentThread().interrupt();
+
+        int w = first.get();
+        if (w >= 0 && w < n) {
+            winner = w;
+            return members.get(w).status;
+        }
+        for (Member m: members) {
+            if (m.error != null) throw m.error;
+        }
+        return members.get(n - 1).status;
+    }
+
+    private void stopOthers(int w) {
+        for (int i = 0; i < members.size(); i++) {
+            Member m = members.get(i);
+            if (i != w && m.running) {
+                m.context.stopSearch();
+            }
+        }
+    }
+
+    /*
+     * Free all the contexts
+     */
+    public void close() {
+        for (Member m: members) {
+            m.context.close();
+        }
+        members.clear();
+        winner = -1;
+    }
+}
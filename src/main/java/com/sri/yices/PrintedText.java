@@ -0,0 +1,111 @@
+package com.sri.yices;
+
+import java.io.IOException;
+import java.io.OutputStream;
+import java.nio.ByteBuffer;
+import java.nio.CharBuffer;
+import java.nio.charset.CharsetDecoder;
+import java.nio.charset.CoderResult;
+import java.nio.charset.CodingErrorAction;
+import java.nio.charset.StandardCharsets;
+
+/**
+ * Output of the pretty printer, written without building a String
+ * (cf. Terms.toBuffer, Terms.writeTo, Model.toBuffer, Model.writeTo).
+ *
+ * The printer writes the text in native memory. It is then either copied into a
+ * direct buffer supplied by the caller, or mapped and streamed in chunks, so a
+ * large model never needs a large Java array.
+ */
+final class PrintedText {
+    private static final int CHUNK_SIZE = 65536;
+
+    private PrintedText() { }
+
+    static void check(long code) throws YicesException {
+        if (code == -2) throw new IllegalArgumentException("invalid buffer");
+        if (code == -3) throw new RuntimeException("failed to store the text in memory");
+        if (code < 0) throw new YicesException();
+    }
+
+    /*
+     * Source of the text: one of the mapped buffer natives
+     */
+    interface Printer {
+        ByteBuffer print(int[] code);
+    }
+
+    private static ByteBuffer map(Printer p) throws YicesException {
+        int[] code = new int[1];
+        ByteBuffer b = p.print(code);
+        check(code[0]);
+        return b;
+    }
+
+    /*
+     * Copy the text into dst, at dst's position
+     * - direct is the native copy, used if dst is direct
+     * - if the text is too large for dst, nothing is copied
+     * - returns the size of the text
+     */
+    interface Copier {
+        long copy(ByteBuffer dst, int offset, int capacity);
+    }
+
+    static int toBuffer(Copier direct, Printer p, ByteBuffer dst) throws YicesException {
+        long n;
+        if (dst.isDirect()) {
+            n = direct.copy(dst, dst.position(), dst.remaining());
+            check(n);
+            if (n <= dst.remaining()) dst.position(dst.position() + (int) n);
+        } else {
+            ByteBuffer b = map(p);
+            try {
+                n = b == null ? 0 : b.capacity();
+                if (n <= dst.remaining() && b != null) dst.put(b);
+            } finally {
+                if (b != null) Yices.freeMappedBuffer(b);
+            }
+        }
+        return (int) n;
+    }
+
+    static void writeTo(Printer p, OutputStream out) throws IOException, YicesException {
+        ByteBuffer b = map(p);
+        if (b == null) return;
+        try {
+            byte[] chunk = new byte[Math.min(CHUNK_SIZE, b.capacity())];
+            while (b.hasRemaining()) {
+                int n = Math.min(chunk.length, b.remaining());
+                b.get(chunk, 0, n);
+                out.write(chunk, 0, n);
+            }
+        } finally {
+            Yices.freeMappedBuffer(b);
+        }
+    }
+
+    static void appendTo(Printer p, Appendable out) throws IOException, YicesException {
+        ByteBuffer b = map(p);
+        if (b == null) return;
+        try {
+            CharsetDecoder decoder = StandardCharsets.UTF_8.newDecoder()
+                .onMalformedInput(CodingErrorAction.REPLACE)
+                .onUnmappableCharacter(CodingErrorAction.REPLACE);
+            CharBuffer chunk = CharBuffer.allocate(Math.min(CHUNK_SIZE, b.capacity() + 1));
+            boolean done = false;
+            while (!done) {
+                CoderResult r = decoder.decode(b, chunk, true);
+                if (r.isUnderflow()) {
+                    decoder.flush(chunk);
+                    done = true;
+                }
+                chunk.flip();
+                out.append(chunk);
+                chunk.clear();
+            }
+        } finally {
+            Yices.freeMappedBuffer(b);
+        }
+    }
+}
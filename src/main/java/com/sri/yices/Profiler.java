@@ -1,15 +1,30 @@
 package com.sri.yices;
 
+import java.lang.management.ManagementFactory;
 import java.util.Comparator;
-import java.util.HashMap;
-import java.util.HashSet;
 import java.util.LinkedHashMap;
 import java.util.Map;
 import java.util.Set;
-
-
-//FIXME: decide on the units. millisecs or nanoseconds.
-
+import java.util.TreeMap;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.atomic.AtomicLongArray;
+import java.util.concurrent.atomic.LongAccumulator;
+import java.util.concurrent.atomic.LongAdder;
+
+import javax.management.JMException;
+import javax.management.MBeanServer;
+import javax.management.ObjectName;
+
+/**
+ * Profiling of calls to the Yices library.
+ *
+ * For each instrumented API routine, we keep the number of calls, the total
+ * and maximal time spent in the routine, and a histogram of call times.
+ * All times are in nanoseconds.
+ *
+ * The counters are LongAdders and the histograms use atomic increments, so the
+ * profiler can be used by many threads at once and is cheap enough to stay enabled.
+ */
 public final class Profiler {
 
     /**
@@ -17,45 +32,70 @@ public final class Profiler {
      */
     public static boolean enabled = false;
 
-    static private final boolean distributions = false;
+    /*
+     * Histogram buckets: a call time t (in ns) is mapped to bucket(t).
+     * - for t < 4, bucket(t) = t
+     * - otherwise, t is between 2^k and 2^(k+1) and the bucket is determined
+     *   by k and the next two bits of t. So each power of two is split in four
+     *   buckets and the relative error is at most 25%.
+     */
+    static final int NUM_BUCKETS = 4 * 62;
 
-    static private long cost = 0;
+    static int bucket(long t) {
+        if (t < 4) return (int) Math.max(t, 0);
+        int k = 63 - Long.numberOfLeadingZeros(t);
+        return 4 * (k - 1) + (int) ((t >>> (k - 2)) & 3);
+    }
 
-    static private Set<Long> threads = new HashSet<Long>();
+    // smallest call time in bucket i
+    static long bucketLowerBound(int i) {
+        if (i < 4) return i;
+        int k = i/4 + 1;
+        return (4L + (i & 3)) << (k - 2);
+    }
 
-    static private Map<String,Long> lineItems = new HashMap<String,Long>();
-    // for pretty printing
-    static private int lineItemMax = 0;
+    /*
+     * Statistics for one API routine
+     */
+    private static final class Stat {
+        final LongAdder calls = new LongAdder();
+        final LongAdder total = new LongAdder();
+        final LongAccumulator max = new LongAccumulator(Math::max, 0);
+        final AtomicLongArray histogram = new AtomicLongArray(NUM_BUCKETS);
+
+        void add(long dcost) {
+            calls.increment();
+            total.add(dcost);
+            max.accumulate(dcost);
+            histogram.incrementAndGet(bucket(dcost));
+        }
+    }
 
-    // for each instrumented API routine: the value maps a call time in TENTHS of a second to the number of calls that have that time.
-    static private Map<String, Map<Integer,Integer>> distribution = new HashMap<String, Map<Integer,Integer>>();
+    static private final LongAdder cost = new LongAdder();
 
-    private static void addThread(){
-        long tid = Thread.currentThread().getId();
-        threads.add(tid);
-    }
+    static private final Set<Long> threads = ConcurrentHashMap.newKeySet();
 
-    private static void addLineItem(String caller, long cost){
-        Long current = lineItems.get(caller);
-        if (current == null){
-            int len = caller.length();
-            lineItems.put(caller, cost);
-            lineItemMax = (lineItemMax < len ? len : lineItemMax);
-        } else {
-            lineItems.put(caller, current + cost);
+    // true once the current thread is in threads
+    static private final ThreadLocal<Boolean> registered = ThreadLocal.withInitial(() -> Boolean.FALSE);
+
+    static private final ConcurrentHashMap<String, Stat> lineItems = new ConcurrentHashMap<>();
+
+    // event counters (e.g., cache hits), by name
+    static private final ConcurrentHashMap<String, LongAdder> counters = new ConcurrentHashMap<>();
+
+    private static void addThread(){
+        if (!registered.get()) {
+            threads.add(Thread.currentThread().getId());
+            registered.set(Boolean.TRUE);
         }
     }
 
-    private static void addDistribution(String caller, int callTime){
-        // callTime is in millseconds; lets try tenths for a readable histogram
-        callTime /= 100;
-        Map<Integer,Integer> map = distribution.get(caller);
-        if (map == null){
-            map = new HashMap<Integer,Integer>();
-            distribution.put(caller, map);
+    private static void addLineItem(String caller, long dcost){
+        Stat s = lineItems.get(caller);
+        if (s == null) {
+            s = lineItems.computeIfAbsent(caller, k -> new Stat());
         }
-        int count = map.getOrDefault(callTime, 0);
-        map.put(callTime, count + 1);
+        s.add(dcost);
     }
 
     public static int getThreadCount(){
@@ -71,40 +111,240 @@ public final class Profiler {
      * Increments the cost by (stop - start)
      */
     public static void delta(String caller, long start, long stop){
-        delta(caller, start, stop, false);
+        long dcost = stop >= start ? stop - start : start - stop;
+        addThread();
+        addLineItem(caller, dcost);
+        cost.add(dcost);
     }
 
     /**
-     * Increments the cost by (stop - start)
-     * If distribution is true, adds the delta to the distribution.
+     * Same as delta(caller, start, stop).
+     * The distribution flag is kept for compatibility: all call times now
+     * go in a histogram.
      */
     public static void delta(String caller, long start, long stop, boolean distribution){
-        long dcost = stop >= start ? stop - start : start - stop;
-        addThread();
-        addLineItem(caller, dcost);
-        cost += dcost;
-        if (distributions && distribution) {
-            addDistribution(caller, (int)(cost/1000000));
+        delta(caller, start, stop);
+    }
+
+    /**
+     * Adds n to the event counter name (e.g., "QueryCache.hits").
+     * Unlike delta, this is meant for events that don't take time.
+     */
+    public static void count(String name, long n){
+        LongAdder c = counters.get(name);
+        if (c == null) {
+            c = counters.computeIfAbsent(name, k -> new LongAdder());
         }
+        c.add(n);
+    }
+
+    public static void count(String name){
+        count(name, 1);
+    }
+
+    /**
+     * Current value of all the event counters
+     */
+    public static Map<String, Long> counters(){
+        TreeMap<String, Long> map = new TreeMap<>();
+        counters.forEach((name, c) -> map.put(name, c.sum()));
+        return map;
     }
 
     /**
      * Resets the cost accumulation counter to zero.
      */
     public static void reset(){
-        cost = 0;
+        cost.reset();
     }
 
+    /**
+     * Clear all the statistics
+     */
+    public static void clear(){
+        cost.reset();
+        lineItems.clear();
+        counters.clear();
+    }
 
     /**
-     * Returns the accumulated time spent in the Yices solver in nanoseconds.
+     * Returns the accumulated time spent in the Yices solver in nanoseconds
+     * (since the last call to get or reset).
      */
     public static long get(){
-        long retval = cost;
-        cost = 0;
-        return retval;
+        return cost.sumThenReset();
     }
 
+
+    /**
+     * Statistics for one API routine, read at some point in time.
+     * The fields are read one after the other, so they may be slightly
+     * inconsistent if other threads are making calls.
+     */
+    public static final class Snapshot {
+        public final String caller;
+        public final long calls;
+        public final long totalNanos;
+        public final long maxNanos;
+        // histogram[i] = number of calls in bucket i (see bucketLowerBound)
+        private final long[] histogram;
+
+        private Snapshot(String caller, Stat s) {
+            this.caller = caller;
+            this.calls = s.calls.sum();
+            this.totalNanos = s.total.sum();
+            this.maxNanos = s.max.get();
+            this.histogram = new long[NUM_BUCKETS];
+            for (int i = 0; i < NUM_BUCKETS; i++) {
+                histogram[i] = s.histogram.get(i);
+            }
+        }
+
+        public long meanNanos() {
+            return calls == 0 ? 0 : totalNanos / calls;
+        }
+
+        /**
+         * Approximate percentile: p is between 0 and 100.
+         * This returns the lower bound of the bucket that contains the p-th percentile.
+         */
+        public long percentileNanos(double p) {
+            long n = 0;
+            for (long c : histogram) n += c;
+            if (n == 0) return 0;
+            long rank = (long) Math.ceil(p / 100 * n);
+            long seen = 0;
+            for (int i = 0; i < NUM_BUCKETS; i++) {
+                seen += histogram[i];
+                if (seen >= rank && histogram[i] > 0) return Math.min(bucketLowerBound(i), maxNanos);
+            }
+            return maxNanos;
+        }
+
+        public long[] histogram() {
+            return histogram.clone();
+        }
+
+        public String toString() {
+            return String.format("%s: %d calls, total %d ms, mean %d ns, p50 %d ns, p99 %d ns, max %d ns",
+                                 caller, calls, totalNanos / 1000000, meanNanos(),
+                                 percentileNanos(50), percentileNanos(99), maxNanos);
+        }
+    }
+
+    /**
+     * Statistics for all the API routines that have been called
+     */
+    public static Map<String, Snapshot> snapshot() {
+        TreeMap<String, Snapshot> map = new TreeMap<>();
+        lineItems.forEach((caller, s) -> map.put(caller, new Snapshot(caller, s)));
+        return map;
+    }
+
+
+    /*
+     * JMX export
+     */
+    private static final class ProfilerBean implements ProfilerMXBean {
+        public boolean isEnabled() { return enabled; }
+        public void setEnabled(boolean b) { configure(b); }
+        public int getThreadCount() { return Profiler.getThreadCount(); }
+
+        public Map<String, Long> getCallCounts() {
+            TreeMap<String, Long> map = new TreeMap<>();
+            lineItems.forEach((caller, s) -> map.put(caller, s.calls.sum()));
+            return map;
+        }
+
+        public Map<String, Long> getTotalNanos() {
+            TreeMap<String, Long> map = new TreeMap<>();
+            lineItems.forEach((caller, s) -> map.put(caller, s.total.sum()));
+            return map;
+        }
+
+        public Map<String, Long> getMaxNanos() {
+            TreeMap<String, Long> map = new TreeMap<>();
+            lineItems.forEach((caller, s) -> map.put(caller, s.max.get()));
+            return map;
+        }
+
+        public Map<String, Long> getCounters() { return counters(); }
+
+        public String getReport() { return report(); }
+
+        public Map<String, Long> getCensus() {
+            TreeMap<String, Long> map = new TreeMap<>();
+            map.put("Config", Config.getCensus());
+            map.put("Context", Context.getCensus());
+            map.put("Model", Model.getCensus());
+            map.put("Parameters", Parameters.getCensus());
+            map.put("Substitution", Substitution.getCensus());
+            return map;
+        }
+
+        public Map<String, Long> getLeakCounts() {
+            TreeMap<String, Long> map = new TreeMap<>();
+            map.put("Config", Config.getLeakCount());
+            map.put("Context", Context.getLeakCount());
+            map.put("Model", Model.getLeakCount());
+            map.put("Parameters", Parameters.getLeakCount());
+            map.put("Substitution", Substitution.getLeakCount());
+            return map;
+        }
+
+        public long getNativeHeapBytes() { return Yices.nativeHeapUsage(); }
+        public void clear() { Profiler.clear(); }
+    }
+
+    public static final String MBEAN_NAME = "com.sri.yices:type=Profiler";
+
+    /**
+     * Register the profiler with the platform MBean server (under MBEAN_NAME).
+     * Does nothing if it's already registered.
+     */
+    public static synchronized void registerMBean() throws JMException {
+        MBeanServer server = ManagementFactory.getPlatformMBeanServer();
+        ObjectName name = new ObjectName(MBEAN_NAME);
+        if (!server.isRegistered(name)) {
+            server.registerMBean(new ProfilerBean(), name);
+        }
+    }
+
+
+    /**
+     * Native statistics collected by libyices2java (when built with tracing, see
+     * Yices.setNativeTracing). The result maps the Java name of each native
+     * (e.g., "and___3I") to { calls, total ns, marshalling ns }, by decreasing total time.
+     */
+    public static Map<String, long[]> nativeSnapshot() {
+        long[] stats = Yices.nativeStats();
+        String[] names = Yices.nativeTraceNames();
+        int n = (int) Math.min(stats[0], names.length);
+        LinkedHashMap<String, long[]> map = new LinkedHashMap<>();
+        java.util.stream.IntStream.range(0, n).boxed()
+            .sorted(Comparator.comparingLong((Integer i) -> stats[2 + 3 * i]).reversed())
+            .forEachOrdered(i -> map.put(names[i].replace("Java_com_sri_yices_Yices_", ""),
+                                         new long[] { stats[1 + 3 * i], stats[2 + 3 * i], stats[3 + 3 * i] }));
+        return map;
+    }
+
+    public static String nativeReport() {
+        StringBuilder sb = new StringBuilder();
+        Map<String, long[]> map = nativeSnapshot();
+        int padLength = 5;
+        for (String name : map.keySet()) {
+            padLength = Math.max(padLength, name.length() + 5);
+        }
+        for (Map.Entry<String, long[]> e : map.entrySet()) {
+            long[] v = e.getValue();
+            sb.append(pad(e.getKey(), padLength)).append(v[0]).append(" calls, ")
+                .append(v[1]/1000).append(" us total, ")
+                .append(v[2]/1000).append(" us marshalling\n");
+        }
+        return sb.toString();
+    }
+
+
     public static String report(){
         StringBuilder sb = new StringBuilder();
         toString(sb);
@@ -132,61 +372,36 @@ public final class Profiler {
 
 
     private static void lineItems2StringBuilder(StringBuilder sb){
-        LinkedHashMap<String, Long> sortedLineItems = new LinkedHashMap<String, Long>();
-        lineItems.entrySet()
+        LinkedHashMap<String, Snapshot> sortedLineItems = new LinkedHashMap<String, Snapshot>();
+        snapshot().values()
             .stream()
-            .sorted(Map.Entry.comparingByValue(Comparator.reverseOrder()))
-            .forEachOrdered(x -> sortedLineItems.put(x.getKey(), x.getValue()));
-
-        int padLength = lineItemMax + 5;
+            .sorted(Comparator.comparingLong((Snapshot x) -> x.totalNanos).reversed())
+            .forEachOrdered(x -> sortedLineItems.put(x.caller, x));
 
+        int padLength = 5;
         for (String caller : sortedLineItems.keySet()){
-            sb.append(pad(caller, padLength)).append(lineItems.get(caller)/1000000).append(" milliseconds\n");
-        }
-    }
-
-    /* Data is formatted for this:
-<python graph plot code>
-import matplotlib.pyplot as plt
-# frequencies
-counts = <data goes here>
-rng = list(range(0, 100))
-plt.bar(rng, counts)
-plt.xlabel('call time (tenths of a second)')
-plt.ylabel('No. of calls')
-plt.title('<caller> on ...')
-plt.show()
-</python graph plot code>
-     */
-    private static void distribution2StringBuilder(String caller, StringBuilder sb){
-        Map<Integer,Integer> map = distribution.get(caller);
-        sb.append("[");
-        for (int i = 0; i < 100; i++) {
-            sb.append(map.getOrDefault(i, 0));
-            if (i < 99) {
-                sb.append(", ");
-            }
+            padLength = Math.max(padLength, caller.length() + 5);
         }
-        sb.append("]\n");
-    }
 
-    private static void distribution2StringBuilder(StringBuilder sb){
-        for (String caller : distribution.keySet()){
-            sb.append("\n").append(caller).append(" Distribution").append("\n\n");
-            distribution2StringBuilder(caller, sb);
+        for (Snapshot s : sortedLineItems.values()){
+            sb.append(pad(s.caller, padLength)).append(s.totalNanos/1000000).append(" milliseconds, ")
+                .append(s.calls).append(" calls, p50 = ").append(s.percentileNanos(50))
+                .append(" ns, p99 = ").append(s.percentileNanos(99))
+                .append(" ns, max = ").append(s.maxNanos).append(" ns\n");
         }
     }
 
-
-
     public static void toString(StringBuilder sb){
         if (enabled) {
             sb.append("\n--- PROFILING SUMMARY ---\n\n");
             sb.append("Calling thread count: ").append(getThreadCount()).append("\n\n");
             lineItems2StringBuilder(sb);
-            if (distributions) {
-                distribution2StringBuilder(sb);
-                sb.append("\n |distribution| = ").append(distribution.size()).append("\n");
+            Map<String, Long> c = counters();
+            if (!c.isEmpty()) {
+                sb.append("\n");
+                for (Map.Entry<String, Long> e : c.entrySet()) {
+                    sb.append(e.getKey()).append(" = ").append(e.getValue()).append("\n");
+                }
             }
         }
     }
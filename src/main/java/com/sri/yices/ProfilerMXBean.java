@@ -0,0 +1,25 @@
+package com.sri.yices;
+
+import java.util.Map;
+
+/**
+ * JMX view of the Profiler (cf. Profiler.registerMBean)
+ * - the maps are indexed by API routine names (e.g., "Yices.checkContext")
+ * - times are in nanoseconds
+ * - the census maps are indexed by class names (e.g., "Context")
+ * - the counters are event counts (e.g., "QueryCache.hits")
+ */
+public interface ProfilerMXBean {
+    boolean isEnabled();
+    void setEnabled(boolean enabled);
+    int getThreadCount();
+    Map<String, Long> getCallCounts();
+    Map<String, Long> getTotalNanos();
+    Map<String, Long> getMaxNanos();
+    Map<String, Long> getCounters();
+    String getReport();
+    Map<String, Long> getCensus();
+    Map<String, Long> getLeakCounts();
+    long getNativeHeapBytes();
+    void clear();
+}
@@ -0,0 +1,366 @@
+package com.sri.yices;
+
+import java.time.Duration;
+import java.util.Arrays;
+import java.util.Iterator;
+import java.util.LinkedHashMap;
+import java.util.Map;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Cache of satisfiability checks.
+ *
+ * A query is a logic and a set of formulas (their conjunction). Terms are hash-consed,
+ * so the same formula always has the same term id and the key of a query is the logic
+ * plus the sorted array of distinct ids. Only SAT and UNSAT answers are cached.
+ *
+ * On request, a cache entry also keeps
+ * - for SAT: the values of the uninterpreted terms that occur in the formulas, so that
+ *   a model can be rebuilt on a hit (cf. Model(int[], int[])). This works only if none of
+ *   these terms is a function or a tuple. For other queries, a request for a model is
+ *   treated as a miss and the query is checked again.
+ * - for UNSAT: an unsat core (the formulas are then checked as assumptions).
+ *
+ * The entries are evicted in LRU order when their estimated size exceeds the byte limit.
+ * The cache is emptied when the Yices garbage collector runs since term ids may be reused
+ * afterwards.
+ *
+ * The hits, misses, and evictions are counted by the cache, and also by the Profiler when
+ * it's enabled (as "QueryCache.hits", "QueryCache.misses", and "QueryCache.evictions").
+ *
+ * A cache can be used by several threads. The checks run without holding the cache's lock.
+ */
+public final class QueryCache {
+
+    /*
+     * Result of a query
+     * - the model is owned by the caller: it must be closed when it's no longer needed
+     */
+    public static final class Result {
+        private final Status status;
+        private final Model model;
+        private final int[] core;
+        private final boolean cached;
+
+        private Result(Status status, Model model, int[] core, boolean cached) {
+            this.status = status;
+            this.model = model;
+            this.core = core;
+            this.cached = cached;
+        }
+
+        public Status status() {
+            return status;
+        }
+
+        /*
+         * Model if status is SAT and a model was requested, null otherwise
+         */
+        public Model model() {
+            return model;
+        }
+
+        /*
+         * Unsat core if status is UNSAT and a core was requested, null otherwise
+         */
+        public int[] core() {
+            return core == null ? null : core.clone();
+        }
+
+        /*
+         * True if the result came from the cache
+         */
+        public boolean isCached() {
+            return cached;
+        }
+    }
+
+    private static final class Key {
+        final String logic;
+        final int[] formulas;
+        final int hash;
+
+        Key(String logic, int[] formulas) {
+            this.logic = logic;
+            this.formulas = formulas;
+            this.hash = 31 * (logic == null ? 0 : logic.hashCode()) + Arrays.hashCode(formulas);
+        }
+
+        @Override
+        public int hashCode() {
+            return hash;
+        }
+
+        @Override
+        public boolean equals(Object obj) {
+            if (!(obj instanceof Key)) return false;
+            Key k = (Key) obj;
+            return hash == k.hash && (logic == null ? k.logic == null : logic.equals(k.logic))
+                && Arrays.equals(formulas, k.formulas);
+        }
+    }
+
+    /*
+     * Entry: status + optional core or model map (vars[i] := values[i])
+     * - noModel is true if we know that the model can't be cached
+     */
+    private static final class Entry {
+        final Status status;
+        int[] core;
+        int[] vars;
+        int[] values;
+        boolean noModel;
+        long bytes;
+
+        Entry(Status status) {
+            this.status = status;
+        }
+    }
+
+    // rough size of an entry: key and entry objects, map node
+    private static final long ENTRY_OVERHEAD = 128;
+
+    private static long arrayBytes(int[] a) {
+        return a == null ? 0 : 16 + 4L * a.length;
+    }
+
+    private static long estimate(Key k, Entry e) {
+        long n = ENTRY_OVERHEAD + arrayBytes(k.formulas) + arrayBytes(e.core) + arrayBytes(e.vars) + arrayBytes(e.values);
+        if (k.logic != null) n += 40 + 2L * k.logic.length();
+        return n;
+    }
+
+    /*
+     * Number of garbage collections (and resets) so far: a cache is emptied when this changes
+     */
+    private static volatile long gcCount = 0;
+
+    static void garbageCollected() {
+        gcCount ++;
+    }
+
+    private final LinkedHashMap<Key, Entry> map = new LinkedHashMap<>(16, 0.75f, true);
+    private final long maxBytes;
+    private long bytes = 0;
+    private long epoch = gcCount;
+    private long hits = 0;
+    private long misses = 0;
+    private long evictions = 0;
+
+    /*
+     * Cache whose entries take at most maxBytes (estimated)
+     */
+    public QueryCache(long maxBytes) {
+        if (maxBytes <= 0) throw new IllegalArgumentException("maxBytes must be positive");
+        this.maxBytes = maxBytes;
+    }
+
+    /*
+     * Check the conjunction of formulas in a fresh context for logic
+     * (or a default context if logic is null)
+     */
+    public Result check(String logic, int[] formulas) throws YicesException {
+        return check(logic, formulas, false, false, null);
+    }
+
+    /*
+     * Same thing with optional model, core, and timeout
+     * - wantModel: if the formulas are SAT, the result includes a model
+     * - wantCore: if the formulas are UNSAT, the result includes an unsat core
+     * - timeout may be null; the answer is not cached if the search is interrupted
+     */
+    public Result check(String logic, int[] formulas, boolean wantModel, boolean wantCore, Duration timeout) throws YicesException {
+        Key key = new Key(logic, canonical(formulas));
+
+        Entry e = lookup(key);
+        if (e != null) {
+            if (e.status == Status.UNSAT && (!wantCore || e.core != null)) {
+                hit();
+                return new Result(Status.UNSAT, null, wantCore ? e.core : null, true);
+            }
+            if (e.status == Status.SAT && (!wantModel || e.vars != null)) {
+                hit();
+                Model m = wantModel ? new Model(e.vars, e.values) : null;
+                return new Result(Status.SAT, m, null, true);
+            }
+            if (e.status == Status.SAT && e.noModel) {
+                // checking again won't make the model cacheable
+                miss();
+                return solve(key, true, false, timeout, false);
+            }
+        }
+        miss();
+        return solve(key, wantModel, wantCore, timeout, true);
+    }
+
+    /*
+     * Sorted array of distinct formulas
+     */
+    private static int[] canonical(int[] formulas) {
+        int[] a = formulas.clone();
+        Arrays.sort(a);
+        int n = 0;
+        for (int i = 0; i < a.length; i++) {
+            if (n == 0 || a[n - 1] != a[i]) a[n++] = a[i];
+        }
+        return n == a.length ? a : Arrays.copyOf(a, n);
+    }
+
+    private Result solve(Key key, boolean wantModel, boolean wantCore, Duration timeout, boolean store) throws YicesException {
+        // the solve runs without the lock: a GC or reset may happen in the meantime
+        long g = gcCount;
+        Context ctx = key.logic == null ? new Context() : new Context(key.logic);
+        try {
+            Status s;
+            DeadlineScheduler.Deadline deadline = null;
+            if (timeout != null) {
+                long ns;
+                try {
+                    ns = timeout.toNanos();
+                } catch (ArithmeticException x) {
+                    ns = Long.MAX_VALUE;
+                }
+                deadline = DeadlineScheduler.schedule(ctx.getPtr(), ns, TimeUnit.NANOSECONDS);
+            }
+            try {
+                if (wantCore) {
+                    s = ctx.checkWithAssumptions(null, key.formulas);
+                } else {
+                    ctx.assertFormulas(key.formulas);
+                    s = ctx.check();
+                }
+            } finally {
+                if (deadline != null) deadline.close();
+            }
+
+            Model model = null;
+            int[] core = null;
+            Entry e = new Entry(s);
+            if (s == Status.SAT && wantModel) {
+                model = ctx.getModel();
+                try {
+                    storeModel(key, e, model);
+                } catch (RuntimeException x) {
+                    model.close();
+                    throw x;
+                }
+            } else if (s == Status.UNSAT && wantCore) {
+                core = ctx.getUnsatCore();
+                e.core = core;
+            }
+            if (store && (s == Status.SAT || s == Status.UNSAT)) {
+                insert(key, e, g);
+            }
+            return new Result(s, model, core == null ? null : core.clone(), false);
+        } finally {
+            ctx.close();
+        }
+    }
+
+    /*
+     * Keep the values of the uninterpreted terms of key in e (if possible)
+     */
+    private static void storeModel(Key key, Entry e, Model model) throws YicesException {
+        int[] vars = Terms.uninterpretedTerms(key.formulas);
+        for (int x : vars) {
+            if (Terms.isFunction(x) || Terms.isTuple(x)) {
+                e.noModel = true;
+                return;
+            }
+        }
+        int[] values = new int[vars.length];
+        for (int i = 0; i < vars.length; i++) {
+            values[i] = model.valueAsTerm(vars[i]);
+        }
+        e.vars = vars;
+        e.values = values;
+    }
+
+    private void hit() {
+        synchronized (this) {
+            hits ++;
+        }
+        if (Profiler.enabled) Profiler.count("QueryCache.hits");
+    }
+
+    private void miss() {
+        synchronized (this) {
+            misses ++;
+        }
+        if (Profiler.enabled) Profiler.count("QueryCache.misses");
+    }
+
+    private void checkEpoch() {
+        long g = gcCount;
+        if (epoch != g) {
+            map.clear();
+            bytes = 0;
+            epoch = g;
+        }
+    }
+
+    private synchronized Entry lookup(Key key) {
+        checkEpoch();
+        return map.get(key);
+    }
+
+    /*
+     * Store e, computed when the GC count was g
+     * - e is dropped if the count has changed: its terms may be gone
+     */
+    private void insert(Key key, Entry e, long g) {
+        int evicted = 0;
+        synchronized (this) {
+            checkEpoch();
+            if (g != epoch) return;
+            e.bytes = estimate(key, e);
+            Entry old = map.put(key, e);
+            if (old != null) bytes -= old.bytes;
+            bytes += e.bytes;
+            Iterator<Map.Entry<Key, Entry>> it = map.entrySet().iterator();
+            while (bytes > maxBytes && it.hasNext()) {
+                Entry x = it.next().getValue();
+                it.remove();
+                bytes -= x.bytes;
+                evicted ++;
+            }
+            evictions += evicted;
+        }
+        if (evicted > 0 && Profiler.enabled) Profiler.count("QueryCache.evictions", evicted);
+    }
+
+    /*
+     * Remove all the entries (the counters are kept)
+     */
+    public synchronized void clear() {
+        map.clear();
+        bytes = 0;
+    }
+
+    public synchronized int size() {
+        checkEpoch();
+        return map.size();
+    }
+
+    // estimated size of the entries in bytes
+    public synchronized long bytes() {
+        checkEpoch();
+        return bytes;
+    }
+
+    public long maxBytes() {
+        return maxBytes;
+    }
+
+    public synchronized long hits() {
+        return hits;
+    }
+
+    public synchronized long misses() {
+        return misses;
+    }
+
+    public synchronized long evictions() {
+        return evictions;
+    }
+}
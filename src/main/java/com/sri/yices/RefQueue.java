@@ -0,0 +1,116 @@
+package com.sri.yices;
+
+/**
+ * Pending reference-counter updates for TermHandle and TypeHandle.
+ *
+ * Increments and decrements are stored here and sent to Yices in batches
+ * (by Yices.updateRefs). Each update is encoded in a single int:
+ * (x << 2) | k where x is a term or type and k is
+ *  0: incref term, 1: decref term, 2: incref type, 3: decref type.
+ *
+ * The queue is flushed when it's full and before every garbage collection.
+ * Decrements come from the Cleaner thread: if the Yices library is not
+ * thread safe, they are just stored and the queue grows until the next
+ * flush from the thread that creates handles or collects garbage.
+ *
+ * Yices.reset empties the queue and starts a new epoch: the handles created
+ * before the reset refer to terms and types that don't exist anymore, so
+ * their decrements are dropped (cf. epoch and decrefTerm). NativeRef uses
+ * the same epoch.
+ */
+final class RefQueue {
+    static final int CAPACITY = 1024;
+
+    private static final int INCREF_TERM = 0;
+    private static final int DECREF_TERM = 1;
+    private static final int INCREF_TYPE = 2;
+    private static final int DECREF_TYPE = 3;
+
+    // larger indices can't be encoded
+    private static final int MAX_INDEX = Integer.MAX_VALUE >> 2;
+
+    private static int[] ops = new int[CAPACITY];
+    private static int size = 0;
+    private static long failures = 0;
+
+    // number of calls to Yices.reset
+    private static long epoch = 0;
+
+    private RefQueue() { }
+
+    /*
+     * The increments return the current epoch: the matching decrement
+     * is ignored if it's from an older epoch.
+     */
+    static synchronized long increfTerm(int t) { add(t, INCREF_TERM, true); return epoch; }
+    static synchronized void decrefTerm(int t, long e) { if (e == epoch) add(t, DECREF_TERM, false); }
+    static synchronized long increfType(int tau) { add(tau, INCREF_TYPE, true); return epoch; }
+    static synchronized void decrefType(int tau, long e) { if (e == epoch) add(tau, DECREF_TYPE, false); }
+
+    static synchronized long epoch() {
+        return epoch;
+    }
+
+    /*
+     * Called by Yices.reset (with the lock held): drop the pending updates
+     */
+    static synchronized void reset() {
+        size = 0;
+        if (ops.length > CAPACITY) ops = new int[CAPACITY];
+        epoch ++;
+    }
+
+    /*
+     * Add an update
+     * - owner is true if we're called from the thread that created the handle,
+     *   false if we're called from the Cleaner
+     */
+    private static synchronized void add(int x, int k, boolean owner) {
+        if (x > MAX_INDEX) {
+            // can't happen with the current term and type tables
+            flush();
+            int code;
+            switch (k) {
+            case INCREF_TERM: code = Yices.yicesIncrefTerm(x); break;
+            case DECREF_TERM: code = Yices.yicesDecrefTerm(x); break;
+            case INCREF_TYPE: code = Yices.yicesIncrefType(x); break;
+            default: code = Yices.yicesDecrefType(x); break;
+            }
+            if (code < 0) failures ++;
+            return;
+        }
+        if (size == ops.length) {
+            int[] tmp = new int[2 * size];
+            System.arraycopy(ops, 0, tmp, 0, size);
+            ops = tmp;
+        }
+        ops[size++] = (x << 2) | k;
+        if (size >= CAPACITY && (owner || Yices.isThreadSafe())) {
+            flush();
+        }
+    }
+
+    /*
+     * Send all pending updates to Yices
+     */
+    static synchronized void flush() {
+        if (size > 0) {
+            int f = Yices.updateRefs(ops, size);
+            if (f > 0) failures += f;
+            size = 0;
+            if (ops.length > CAPACITY) ops = new int[CAPACITY];
+        }
+    }
+
+    static synchronized int pending() {
+        return size;
+    }
+
+    /*
+     * Number of updates that Yices rejected so far (e.g., because a term
+     * was deleted by a garbage collection while a handle still referred to it).
+     */
+    static synchronized long failures() {
+        return failures;
+    }
+}
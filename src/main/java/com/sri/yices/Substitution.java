@@ -0,0 +1,167 @@
+package com.sri.yices;
+
+import java.lang.ref.Reference;
+
+/**
+ * Substitution that can be applied many times (e.g., the frame shift of an unrolling).
+ *
+ * The substitution vars[i] := values[i] is checked and copied to the native library
+ * once, when the object is created. The native object also keeps a memo table that
+ * maps terms to their images, so a term that has been substituted before is not
+ * sent to Yices again. The table is emptied when the Yices garbage collector runs.
+ *
+ * The terms of vars and values are protected from the garbage collector until the
+ * substitution is closed.
+ *
+ * A substitution created before Yices.reset can't be used after the reset:
+ * apply and applyArray throw IllegalStateException.
+ *
+ * The methods are synchronized: a substitution can be shared by several threads
+ * but they'll take turns.
+ */
+public class Substitution implements AutoCloseable {
+    private long ptr;
+    private final NativeRef ref;
+
+    //<PROFILING>
+    static private final NativeRef.Census census = new NativeRef.Census();
+
+    /**
+     * Returns the count of Substitution objects that have an unfreed
+     * pointer to a Yices shared library object.
+     */
+    public static long getCensus(){
+        return census.live();
+    }
+
+    /**
+     * Returns the count of Substitution objects that were never closed
+     * (their pointer was freed when they were garbage collected).
+     */
+    public static long getLeakCount(){
+        return census.leaked();
+    }
+    //</PROFILING>
+
+    /*
+     * Substitution vars[i] := values[i]
+     * - vars and values must have the same length
+     * - vars[i] must be a variable and values[i] a term of compatible type
+     *   (cf. Terms.subst)
+     */
+    public Substitution(int[] vars, int[] values) throws YicesException {
+        if (vars.length != values.length) throw new IllegalArgumentException("bad substitution");
+        long p = Yices.newSubstitution(vars, values);
+        if (p == 0) throw new YicesException();
+        ptr = p;
+        ref = new NativeRef(this, p, census, Yices::freeSubstitution, true);
+    }
+
+    /*
+     * Close: free the native object
+     */
+    public synchronized void close() {
+        if (ptr != 0) {
+            ref.close();
+            ptr = 0;
+        }
+    }
+
+    private long getPtr() {
+        if (ptr == 0) throw new IllegalStateException("substitution is closed");
+        return ptr;
+    }
+
+    /*
+     * Image of t
+     */
+    public synchronized int apply(int t) throws YicesException {
+        long p = getPtr();
+        int w;
+        try {
+            if (Profiler.enabled) {
+                long start = System.nanoTime();
+                w = Yices.substitutionApply(p, t);
+                Profiler.delta("Yices.substitutionApply", start, System.nanoTime());
+            } else {
+                w = Yices.substitutionApply(p, t);
+            }
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+        if (w < 0) throw error(w);
+        return w;
+    }
+
+    /*
+     * Replace a[off ... off+n-1] by their images
+     * - all the terms are substituted with a single native call
+     * - if there's an error, a is unchanged
+     */
+    public synchronized void applyArray(int[] a, int off, int n) throws YicesException {
+        if (off < 0 || n < 0 || n > a.length - off) throw new IndexOutOfBoundsException();
+        long p = getPtr();
+        int code;
+        try {
+            if (Profiler.enabled) {
+                long start = System.nanoTime();
+                code = Yices.substitutionApplyArray(p, a, off, n);
+                Profiler.delta("Yices.substitutionApplyArray", start, System.nanoTime());
+            } else {
+                code = Yices.substitutionApplyArray(p, a, off, n);
+            }
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+        if (code < 0) throw error(code);
+    }
+
+    // exception for a negative code returned by substitutionApply or substitutionApplyArray
+    private static RuntimeException error(int code) {
+        if (code == -2) return new IllegalStateException("substitution created before Yices.reset");
+        return new YicesException();
+    }
+
+    public void applyArray(int[] a) throws YicesException {
+        applyArray(a, 0, a.length);
+    }
+
+    /*
+     * Memo statistics (since the substitution was created or the last clearMemo)
+     * - hits = number of terms found in the memo table
+     * - misses = number of terms that Yices had to substitute
+     * - memoSize = number of terms in the table
+     */
+    private synchronized long stat(int i) {
+        long[] stats = new long[3];
+        try {
+            Yices.substitutionStats(getPtr(), stats);
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+        return stats[i];
+    }
+
+    public long hits() {
+        return stat(0);
+    }
+
+    public long misses() {
+        return stat(1);
+    }
+
+    public long memoSize() {
+        return stat(2);
+    }
+
+    /*
+     * Empty the memo table and reset the statistics
+     */
+    public synchronized void clearMemo() {
+        try {
+            Yices.substitutionClear(getPtr());
+        } finally {
+            Reference.reachabilityFence(this);
+        }
+    }
+}
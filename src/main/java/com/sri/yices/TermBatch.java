@@ -0,0 +1,678 @@
+package com.sri.yices;
+
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * Builder for constructing many terms with a single call to the native library.
+ *
+ * Each constructor method records an instruction and returns a reference to
+ * its (future) result. A reference is a negative integer: it can be passed as
+ * argument to the later constructors of the same batch, mixed with ordinary terms.
+ * Method build() runs all the instructions natively and returns the resulting terms.
+ *
+ * Example:
+ * <pre>
+ *   TermBatch b = new TermBatch();
+ *   int r1 = b.bvAdd(x, y);
+ *   int r2 = b.bvLt(r1, z);
+ *   int r3 = b.or(r2, p);
+ *   int[] terms = b.build();
+ *   int t = TermBatch.term(terms, r3);
+ * </pre>
+ */
+public class TermBatch {
+    /*
+     * Op codes: they must match enum batch_op in yicesJNI.cpp
+     */
+    public static final int NOT = 0;
+    public static final int AND = 1;
+    public static final int OR = 2;
+    public static final int XOR = 3;
+    public static final int IFF = 4;
+    public static final int IMPLIES = 5;
+    public static final int ITE = 6;
+    public static final int EQ = 7;
+    public static final int NEQ = 8;
+    public static final int DISTINCT = 9;
+    public static final int TUPLE = 10;
+    public static final int SELECT = 11;
+    public static final int TUPLE_UPDATE = 12;
+    public static final int APPLY = 13;
+    public static final int UPDATE = 14;
+    public static final int FORALL = 15;
+    public static final int EXISTS = 16;
+    public static final int LAMBDA = 17;
+    public static final int UNINTERPRETED = 18;
+    public static final int VARIABLE = 19;
+    public static final int INT = 20;
+    public static final int ADD = 21;
+    public static final int SUB = 22;
+    public static final int NEG = 23;
+    public static final int MUL = 24;
+    public static final int SQUARE = 25;
+    public static final int POWER = 26;
+    public static final int DIV = 27;
+    public static final int IDIV = 28;
+    public static final int IMOD = 29;
+    public static final int ABS = 30;
+    public static final int FLOOR = 31;
+    public static final int CEIL = 32;
+    public static final int DIVIDES = 33;
+    public static final int IS_INT = 34;
+    public static final int ARITH_EQ = 35;
+    public static final int ARITH_NEQ = 36;
+    public static final int ARITH_GEQ = 37;
+    public static final int ARITH_LEQ = 38;
+    public static final int ARITH_GT = 39;
+    public static final int ARITH_LT = 40;
+    public static final int BV_CONST = 41;
+    public static final int BV_ADD = 42;
+    public static final int BV_SUB = 43;
+    public static final int BV_NEG = 44;
+    public static final int BV_MUL = 45;
+    public static final int BV_SQUARE = 46;
+    public static final int BV_POWER = 47;
+    public static final int BV_DIV = 48;
+    public static final int BV_REM = 49;
+    public static final int BV_SDIV = 50;
+    public static final int BV_SREM = 51;
+    public static final int BV_SMOD = 52;
+    public static final int BV_NOT = 53;
+    public static final int BV_AND = 54;
+    public static final int BV_OR = 55;
+    public static final int BV_XOR = 56;
+    public static final int BV_NAND = 57;
+    public static final int BV_NOR = 58;
+    public static final int BV_XNOR = 59;
+    public static final int BV_SHL = 60;
+    public static final int BV_LSHR = 61;
+    public static final int BV_ASHR = 62;
+    public static final int BV_SHIFT_LEFT0 = 63;
+    public static final int BV_SHIFT_LEFT1 = 64;
+    public static final int BV_SHIFT_RIGHT0 = 65;
+    public static final int BV_SHIFT_RIGHT1 = 66;
+    public static final int BV_ASHIFT_RIGHT = 67;
+    public static final int BV_ROTATE_LEFT = 68;
+    public static final int BV_ROTATE_RIGHT = 69;
+    public static final int BV_EXTRACT = 70;
+    public static final int BV_EXTRACT_BIT = 71;
+    public static final int BV_FROM_BOOL_ARRAY = 72;
+    public static final int BV_CONCAT = 73;
+    public static final int BV_REPEAT = 74;
+    public static final int BV_SIGN_EXTEND = 75;
+    public static final int BV_ZERO_EXTEND = 76;
+    public static final int BV_RED_AND = 77;
+    public static final int BV_RED_OR = 78;
+    public static final int BV_RED_COMP = 79;
+    public static final int BV_EQ = 80;
+    public static final int BV_NEQ = 81;
+    public static final int BV_GE = 82;
+    public static final int BV_GT = 83;
+    public static final int BV_LE = 84;
+    public static final int BV_LT = 85;
+    public static final int BV_SGE = 86;
+    public static final int BV_SGT = 87;
+    public static final int BV_SLE = 88;
+    public static final int BV_SLT = 89;
+
+    private int[] program;
+    private int size;   // number of elements used in program
+    private int count;  // number of instructions
+
+    public TermBatch() {
+        this(64);
+    }
+
+    // capacity = initial size of the program buffer
+    public TermBatch(int capacity) {
+        program = new int[Math.max(capacity, 8)];
+        size = 0;
+        count = 0;
+    }
+
+    // number of instructions recorded so far
+    public int count() {
+        return count;
+    }
+
+    // forget all instructions
+    public void clear() {
+        size = 0;
+        count = 0;
+    }
+
+    // check whether x is a reference to the result of an instruction
+    static public boolean isRef(int x) {
+        return x < 0;
+    }
+
+    // reference to the result of instruction k
+    static public int ref(int k) {
+        return ~k;
+    }
+
+    // convert x to a term: x is either a term or a reference into the array returned by build()
+    static public int term(int[] terms, int x) {
+        return x >= 0 ? x : terms[~x];
+    }
+
+    /**
+     * Run all the instructions and return the resulting terms.
+     * terms[k] is the result of instruction k (i.e., of reference ~k).
+     * The batch is not cleared so more instructions can be added and build() called again.
+     * Throws YicesException if a term can't be built, or IllegalArgumentException
+     * if the program is malformed.
+     */
+    public int[] build() throws YicesException {
+        int[] terms;
+        if (Profiler.enabled) {
+            long start = System.nanoTime();
+            terms = Yices.termBatch(program, count);
+            long finish = System.nanoTime();
+            Profiler.delta("Yices.termBatch", start, finish);
+        } else {
+            terms = Yices.termBatch(program, count);
+        }
+        if (terms == null) {
+            if (Yices.errorCode() == 0) throw new IllegalArgumentException("malformed term batch");
+            throw new YicesException();
+        }
+        return terms;
+    }
+
+    private void ensureCapacity(int n) {
+        if (size + n > program.length) {
+            int len = Math.max(program.length + (program.length >> 1), size + n);
+            program = Arrays.copyOf(program, len);
+        }
+    }
+
+    private int emit(int op, int... x) {
+        ensureCapacity(x.length + 2);
+        program[size++] = op;
+        program[size++] = x.length;
+        System.arraycopy(x, 0, program, size, x.length);
+        size += x.length;
+        return ~(count++);
+    }
+
+    // op x[0] ... x[n-1] y
+    private int emit(int op, int[] x, int y) {
+        ensureCapacity(x.length + 3);
+        program[size++] = op;
+        program[size++] = x.length + 1;
+        System.arraycopy(x, 0, program, size, x.length);
+        size += x.length;
+        program[size++] = y;
+        return ~(count++);
+    }
+
+    // op f x[0] ... x[n-1] y
+    private int emit(int op, int f, int[] x, int y) {
+        ensureCapacity(x.length + 4);
+        program[size++] = op;
+        program[size++] = x.length + 2;
+        program[size++] = f;
+        System.arraycopy(x, 0, program, size, x.length);
+        size += x.length;
+        program[size++] = y;
+        return ~(count++);
+    }
+
+    private static int[] toArray(List<Integer> a) {
+        return a.stream().mapToInt(Integer::intValue).toArray();
+    }
+
+    private static void checkNonEmpty(int[] a) {
+        if (a.length == 0) throw new IllegalArgumentException("empty input");
+    }
+
+    private static void checkNonNegative(int n) {
+        if (n < 0) throw new IllegalArgumentException("negative argument");
+    }
+
+    /*
+     * General constructors
+     */
+    public int ifThenElse(int cond, int iftrue, int iffalse) {
+        return emit(ITE, cond, iftrue, iffalse);
+    }
+
+    public int eq(int left, int right) {
+        return emit(EQ, left, right);
+    }
+
+    public int neq(int left, int right) {
+        return emit(NEQ, left, right);
+    }
+
+    public int distinct(int... arg) {
+        return emit(DISTINCT, arg);
+    }
+
+    public int distinct(List<Integer> arg) {
+        return distinct(toArray(arg));
+    }
+
+    public int forall(int[] vars, int body) {
+        return emit(FORALL, vars, body);
+    }
+
+    public int exists(int[] vars, int body) {
+        return emit(EXISTS, vars, body);
+    }
+
+    public int lambda(int[] vars, int body) {
+        return emit(LAMBDA, vars, body);
+    }
+
+    public int newUninterpretedTerm(int tau) {
+        return emit(UNINTERPRETED, tau);
+    }
+
+    public int newVariable(int tau) {
+        return emit(VARIABLE, tau);
+    }
+
+    /*
+     * Tuples and functions
+     */
+    public int tuple(int... arg) {
+        return emit(TUPLE, arg);
+    }
+
+    public int tuple(List<Integer> arg) {
+        return tuple(toArray(arg));
+    }
+
+    public int select(int idx, int tuple) {
+        checkNonNegative(idx);
+        return emit(SELECT, idx, tuple);
+    }
+
+    public int tupleUpdate(int tuple, int idx, int newval) {
+        checkNonNegative(idx);
+        return emit(TUPLE_UPDATE, tuple, idx, newval);
+    }
+
+    public int funApplication(int fun, int... arg) {
+        checkNonEmpty(arg);
+        int[] x = new int[arg.length + 1];
+        x[0] = fun;
+        System.arraycopy(arg, 0, x, 1, arg.length);
+        return emit(APPLY, x);
+    }
+
+    public int funApplication(int fun, List<Integer> arg) {
+        return funApplication(fun, toArray(arg));
+    }
+
+    public int functionUpdate(int fun, int[] arg, int newval) {
+        checkNonEmpty(arg);
+        return emit(UPDATE, fun, arg, newval);
+    }
+
+    public int functionUpdate1(int fun, int arg, int newval) {
+        return emit(UPDATE, fun, arg, newval);
+    }
+
+    /*
+     * Boolean terms
+     */
+    public int not(int arg) {
+        return emit(NOT, arg);
+    }
+
+    public int and(int... arg) {
+        return emit(AND, arg);
+    }
+
+    public int and(List<Integer> arg) {
+        return and(toArray(arg));
+    }
+
+    public int or(int... arg) {
+        return emit(OR, arg);
+    }
+
+    public int or(List<Integer> arg) {
+        return or(toArray(arg));
+    }
+
+    public int xor(int... arg) {
+        return emit(XOR, arg);
+    }
+
+    public int xor(List<Integer> arg) {
+        return xor(toArray(arg));
+    }
+
+    public int iff(int left, int right) {
+        return emit(IFF, left, right);
+    }
+
+    public int implies(int left, int right) {
+        return emit(IMPLIES, left, right);
+    }
+
+    /*
+     * Arithmetic terms
+     */
+    public int intConst(long x) {
+        return emit(INT, (int) x, (int) (x >>> 32));
+    }
+
+    public int add(int... arg) {
+        return emit(ADD, arg);
+    }
+
+    public int add(List<Integer> arg) {
+        return add(toArray(arg));
+    }
+
+    public int sub(int left, int right) {
+        return emit(SUB, left, right);
+    }
+
+    public int neg(int arg) {
+        return emit(NEG, arg);
+    }
+
+    public int mul(int... arg) {
+        return emit(MUL, arg);
+    }
+
+    public int mul(List<Integer> arg) {
+        return mul(toArray(arg));
+    }
+
+    public int square(int arg) {
+        return emit(SQUARE, arg);
+    }
+
+    public int power(int arg, int exponent) {
+        if (exponent < 0) throw new IllegalArgumentException("exponent can't be negative");
+        return emit(POWER, arg, exponent);
+    }
+
+    public int div(int left, int right) {
+        return emit(DIV, left, right);
+    }
+
+    public int idiv(int left, int right) {
+        return emit(IDIV, left, right);
+    }
+
+    public int imod(int left, int right) {
+        return emit(IMOD, left, right);
+    }
+
+    public int abs(int arg) {
+        return emit(ABS, arg);
+    }
+
+    public int floor(int arg) {
+        return emit(FLOOR, arg);
+    }
+
+    public int ceil(int arg) {
+        return emit(CEIL, arg);
+    }
+
+    public int divides(int left, int right) {
+        return emit(DIVIDES, left, right);
+    }
+
+    public int isInt(int arg) {
+        return emit(IS_INT, arg);
+    }
+
+    public int arithEq(int left, int right) {
+        return emit(ARITH_EQ, left, right);
+    }
+
+    public int arithNeq(int left, int right) {
+        return emit(ARITH_NEQ, left, right);
+    }
+
+    public int arithGeq(int left, int right) {
+        return emit(ARITH_GEQ, left, right);
+    }
+
+    public int arithLeq(int left, int right) {
+        return emit(ARITH_LEQ, left, right);
+    }
+
+    public int arithGt(int left, int right) {
+        return emit(ARITH_GT, left, right);
+    }
+
+    public int arithLt(int left, int right) {
+        return emit(ARITH_LT, left, right);
+    }
+
+    /*
+     * Bitvector terms
+     */
+    public int bvConst(int n, long x) {
+        if (n <= 0) throw new IllegalArgumentException("bitsize must be positive");
+        return emit(BV_CONST, n, (int) x, (int) (x >>> 32));
+    }
+
+    public int bvAdd(int... arg) {
+        checkNonEmpty(arg);
+        return emit(BV_ADD, arg);
+    }
+
+    public int bvSub(int left, int right) {
+        return emit(BV_SUB, left, right);
+    }
+
+    public int bvNeg(int arg) {
+        return emit(BV_NEG, arg);
+    }
+
+    public int bvMul(int... arg) {
+        checkNonEmpty(arg);
+        return emit(BV_MUL, arg);
+    }
+
+    public int bvSquare(int arg) {
+        return emit(BV_SQUARE, arg);
+    }
+
+    public int bvPower(int arg, int exponent) {
+        if (exponent < 0) throw new IllegalArgumentException("exponent can't be negative");
+        return emit(BV_POWER, arg, exponent);
+    }
+
+    public int bvDiv(int left, int right) {
+        return emit(BV_DIV, left, right);
+    }
+
+    public int bvRem(int left, int right) {
+        return emit(BV_REM, left, right);
+    }
+
+    public int bvSDiv(int left, int right) {
+        return emit(BV_SDIV, left, right);
+    }
+
+    public int bvSRem(int left, int right) {
+        return emit(BV_SREM, left, right);
+    }
+
+    public int bvSMod(int left, int right) {
+        return emit(BV_SMOD, left, right);
+    }
+
+    public int bvNot(int arg) {
+        return emit(BV_NOT, arg);
+    }
+
+    public int bvAnd(int... arg) {
+        checkNonEmpty(arg);
+        return emit(BV_AND, arg);
+    }
+
+    public int bvOr(int... arg) {
+        checkNonEmpty(arg);
+        return emit(BV_OR, arg);
+    }
+
+    public int bvXor(int... arg) {
+        checkNonEmpty(arg);
+        return emit(BV_XOR, arg);
+    }
+
+    public int bvNand(int left, int right) {
+        return emit(BV_NAND, left, right);
+    }
+
+    public int bvNor(int left, int right) {
+        return emit(BV_NOR, left, right);
+    }
+
+    public int bvXNor(int left, int right) {
+        return emit(BV_XNOR, left, right);
+    }
+
+    public int bvShl(int left, int right) {
+        return emit(BV_SHL, left, right);
+    }
+
+    public int bvLshr(int left, int right) {
+        return emit(BV_LSHR, left, right);
+    }
+
+    public int bvAshr(int left, int right) {
+        return emit(BV_ASHR, left, right);
+    }
+
+    // shift/rotate by constants: n is not a term here
+    public int bvShiftLeft0(int arg, int n) {
+        checkNonNegative(n);
+        return emit(BV_SHIFT_LEFT0, arg, n);
+    }
+
+    public int bvShiftLeft1(int arg, int n) {
+        checkNonNegative(n);
+        return emit(BV_SHIFT_LEFT1, arg, n);
+    }
+
+    public int bvShiftRight0(int arg, int n) {
+        checkNonNegative(n);
+        return emit(BV_SHIFT_RIGHT0, arg, n);
+    }
+
+    public int bvShiftRight1(int arg, int n) {
+        checkNonNegative(n);
+        return emit(BV_SHIFT_RIGHT1, arg, n);
+    }
+
+    public int bvAShiftRight(int arg, int n) {
+        checkNonNegative(n);
+        return emit(BV_ASHIFT_RIGHT, arg, n);
+    }
+
+    public int bvRotateLeft(int arg, int n) {
+        checkNonNegative(n);
+        return emit(BV_ROTATE_LEFT, arg, n);
+    }
+
+    public int bvRotateRight(int arg, int n) {
+        checkNonNegative(n);
+        return emit(BV_ROTATE_RIGHT, arg, n);
+    }
+
+    // extract arg[i:j]
+    public int bvExtract(int arg, int i, int j) {
+        checkNonNegative(i);
+        checkNonNegative(j);
+        return emit(BV_EXTRACT, arg, i, j);
+    }
+
+    public int bvExtractBit(int arg, int i) {
+        checkNonNegative(i);
+        return emit(BV_EXTRACT_BIT, arg, i);
+    }
+
+    public int bvFromBoolArray(int... arg) {
+        checkNonEmpty(arg);
+        return emit(BV_FROM_BOOL_ARRAY, arg);
+    }
+
+    // concat: high-order bits are from the left
+    public int bvConcat(int... arg) {
+        checkNonEmpty(arg);
+        return emit(BV_CONCAT, arg);
+    }
+
+    public int bvRepeat(int arg, int n) {
+        checkNonNegative(n);
+        return emit(BV_REPEAT, arg, n);
+    }
+
+    public int bvSignExtend(int arg, int n) {
+        checkNonNegative(n);
+        return emit(BV_SIGN_EXTEND, arg, n);
+    }
+
+    public int bvZeroExtend(int arg, int n) {
+        checkNonNegative(n);
+        return emit(BV_ZERO_EXTEND, arg, n);
+    }
+
+    public int bvRedAnd(int arg) {
+        return emit(BV_RED_AND, arg);
+    }
+
+    public int bvRedOr(int arg) {
+        return emit(BV_RED_OR, arg);
+    }
+
+    public int bvRedComp(int left, int right) {
+        return emit(BV_RED_COMP, left, right);
+    }
+
+    public int bvEq(int left, int right) {
+        return emit(BV_EQ, left, right);
+    }
+
+    public int bvNeq(int left, int right) {
+        return emit(BV_NEQ, left, right);
+    }
+
+    public int bvGe(int left, int right) {
+        return emit(BV_GE, left, right);
+    }
+
+    public int bvGt(int left, int right) {
+        return emit(BV_GT, left, right);
+    }
+
+    public int bvLe(int left, int right) {
+        return emit(BV_LE, left, right);
+    }
+
+    public int bvLt(int left, int right) {
+        return emit(BV_LT, left, right);
+    }
+
+    public int bvSGe(int left, int right) {
+        return emit(BV_SGE, left, right);
+    }
+
+    public int bvSGt(int left, int right) {
+        return emit(BV_SGT, left, right);
+    }
+
+    public int bvSLe(int left, int right) {
+        return emit(BV_SLE, left, right);
+    }
+
+    public int bvSLt(int left, int right) {
+        return emit(BV_SLT, left, right);
+    }
+}
@@ -0,0 +1,174 @@
+package com.sri.yices;
+
+import java.util.concurrent.ScheduledFuture;
+import java.util.concurrent.ScheduledThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.locks.ReentrantReadWriteLock;
+import java.util.function.Supplier;
+
+/**
+ * Garbage collection policy for long-running processes.
+ *
+ * Terms and types are deleted by Yices.yicesGarbageCollect unless they have
+ * a positive reference counter (e.g., they're held by a TermHandle
+ * or TypeHandle), or they are named and keepNamed is true.
+ *
+ * The collector polls the number of terms (Yices.yicesNumTerms) and collects
+ * garbage when that number has grown by a given factor since the last
+ * collection. Polling is done either by a background thread (see start)
+ * or by the application (see maybeCollect).
+ *
+ * A term that was just created is not protected until it's wrapped in a
+ * handle. Code that creates terms should run between enter() and exit()
+ * (or use guard) when collections can happen in the background:
+ * collecting garbage waits until no thread is in such a section.
+ */
+public final class TermCollector {
+    private static final ReentrantReadWriteLock lock = new ReentrantReadWriteLock();
+
+    // policy
+    private static double growthFactor = 2.0;
+    private static int minTerms = 100000;
+    private static boolean keepNamed = true;
+
+    // number of terms after the last collection (0 means no collection yet)
+    private static volatile int baseline = 0;
+    private static volatile long collections = 0;
+    private static volatile long totalNanos = 0;
+
+    private static ScheduledThreadPoolExecutor timer = null;
+    private static ScheduledFuture<?> task = null;
+
+    private TermCollector() { }
+
+    /*
+     * Set the policy:
+     * - garbage is collected when the number of terms is at least minTerms
+     *   and at least growthFactor * (number of terms after the previous collection)
+     * - keepNamed: whether named terms and types are preserved
+     */
+    public static synchronized void configure(double growthFactor, int minTerms, boolean keepNamed) {
+        if (growthFactor < 1.0) throw new IllegalArgumentException("growthFactor must be at least 1");
+        TermCollector.growthFactor = growthFactor;
+        TermCollector.minTerms = Math.max(minTerms, 0);
+        TermCollector.keepNamed = keepNamed;
+    }
+
+    static boolean shouldCollect(int numTerms, int baseline, double growthFactor, int minTerms) {
+        return numTerms >= minTerms && numTerms >= growthFactor * baseline;
+    }
+
+    /*
+     * Check the policy every period (in a daemon thread).
+     * The Yices library must be thread safe for this.
+     */
+    public static synchronized void start(long period, TimeUnit unit) {
+        if (!Yices.isThreadSafe()) {
+            throw new IllegalStateException("background collection requires a thread-safe Yices library");
+        }
+        if (timer == null) {
+            timer = new ScheduledThreadPoolExecutor(1, r -> {
+                Thread t = new Thread(r, "yices-gc");
+                t.setDaemon(true);
+                return t;
+            });
+        }
+        if (task != null) task.cancel(false);
+        task = timer.scheduleWithFixedDelay(TermCollector::maybeCollect, period, period, unit);
+    }
+
+    public static synchronized void stop() {
+        if (task != null) {
+            task.cancel(false);
+            task = null;
+        }
+    }
+
+    public static synchronized boolean isRunning() {
+        return task != null;
+    }
+
+    /*
+     * Collect garbage if the policy says so.
+     * Returns true if garbage was collected.
+     */
+    public static boolean maybeCollect() {
+        double factor;
+        int min;
+        boolean named;
+        synchronized (TermCollector.class) {
+            factor = growthFactor;
+            min = minTerms;
+            named = keepNamed;
+        }
+        if (shouldCollect(Yices.yicesNumTerms(), baseline, factor, min)) {
+            collect(named);
+            return true;
+        }
+        return false;
+    }
+
+    /*
+     * Collect garbage now
+     * - this must not be called between enter() and exit()
+     */
+    public static void collect(boolean keepNamed) {
+        lock.writeLock().lock();
+        try {
+            long start = System.nanoTime();
+            Yices.yicesGarbageCollect(null, null, keepNamed);
+            long finish = System.nanoTime();
+            baseline = Yices.yicesNumTerms();
+            collections ++;
+            totalNanos += finish - start;
+            if (Profiler.enabled) {
+                Profiler.delta("TermCollector.collect", start, finish);
+            }
+        } finally {
+            lock.writeLock().unlock();
+        }
+    }
+
+    /*
+     * Sections where garbage can't be collected: enter/exit can be nested.
+     */
+    public static void enter() {
+        lock.readLock().lock();
+    }
+
+    public static void exit() {
+        lock.readLock().unlock();
+    }
+
+    public static <T> T guard(Supplier<T> body) {
+        enter();
+        try {
+            return body.get();
+        } finally {
+            exit();
+        }
+    }
+
+    /*
+     * Statistics
+     * - number of collections
+     * - total time spent in the garbage collector (in nanoseconds)
+     * - number of terms after the last collection
+     * - number of reference-counter updates waiting to be sent to Yices
+     */
+    public static long collections() {
+        return collections;
+    }
+
+    public static long totalNanos() {
+        return totalNanos;
+    }
+
+    public static int baseline() {
+        return baseline;
+    }
+
+    public static int pendingUpdates() {
+        return RefQueue.pending();
+    }
+}
@@ -0,0 +1,83 @@
+package com.sri.yices;
+
+import java.util.HashMap;
+
+/**
+ * The subterms of a set of roots in topological order: the children of
+ * a term always come before the term itself, and each subterm occurs once.
+ * The DAG is built by a single native call (cf. Terms.dag).
+ *
+ * Terms are identified by their index in the order (between 0 and size()-1):
+ * child(i, j) is the index of the j-th child of term i.
+ *
+ * The children of a composite term or a projection are as in TermInfo.
+ * For sums and products, the children are the non-constant components
+ * (the coefficients and exponents are not included).
+ */
+public final class TermDag {
+    // r[0] = n, then n terms, n constructors, n+1 offsets, then the children (cf. Yices.termDag)
+    private final int[] r;
+    private final int n;
+    private HashMap<Integer, Integer> index = null;
+
+    TermDag(int[] r) {
+        this.r = r;
+        this.n = r[0];
+    }
+
+    public int size() {
+        return n;
+    }
+
+    private void check(int i) {
+        if (i < 0 || i >= n) throw new IndexOutOfBoundsException("invalid term index: " + i);
+    }
+
+    public int term(int i) {
+        check(i);
+        return r[1 + i];
+    }
+
+    public Constructor constructor(int i) {
+        check(i);
+        return Constructor.idToConstructor(r[1 + n + i]);
+    }
+
+    public int numChildren(int i) {
+        check(i);
+        return r[2 + 2 * n + i] - r[1 + 2 * n + i];
+    }
+
+    public int child(int i, int j) {
+        if (j < 0 || j >= numChildren(i)) throw new IndexOutOfBoundsException("invalid child index: " + j);
+        return r[r[1 + 2 * n + i] + j];
+    }
+
+    // indices of the children of term i
+    public int[] children(int i) {
+        int[] a = new int[numChildren(i)];
+        System.arraycopy(r, r[1 + 2 * n + i], a, 0, a.length);
+        return a;
+    }
+
+    // all the terms, in topological order
+    public int[] terms() {
+        int[] a = new int[n];
+        System.arraycopy(r, 1, a, 0, n);
+        return a;
+    }
+
+    /*
+     * Index of term t or -1 if t is not in the DAG
+     */
+    public synchronized int indexOf(int t) {
+        if (index == null) {
+            index = new HashMap<>(2 * n);
+            for (int i = 0; i < n; i++) {
+                index.put(r[1 + i], i);
+            }
+        }
+        Integer i = index.get(t);
+        return i == null ? -1 : i;
+    }
+}
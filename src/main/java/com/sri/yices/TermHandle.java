@@ -0,0 +1,73 @@
+package com.sri.yices;
+
+import java.lang.ref.Cleaner;
+
+/**
+ * Managed reference to a term.
+ *
+ * The term's reference counter is incremented when the handle is created and
+ * decremented when the handle becomes unreachable (or is released), so the term
+ * survives garbage collection as long as the handle is in use. The updates are
+ * queued and sent to Yices in batches (see RefQueue).
+ *
+ * This is meant to be used with TermCollector: terms that are not held by a
+ * handle (or by the roots passed to the garbage collector) may be deleted
+ * when garbage is collected.
+ */
+public final class TermHandle {
+    // shared by TermHandle and TypeHandle
+    static final Cleaner cleaner = Cleaner.create();
+
+    public final int term;
+    private final Cleaner.Cleanable cleanable;
+
+    // e = reset epoch of the incref (cf. RefQueue)
+    private TermHandle(int term, long e) {
+        this.term = term;
+        // the action must not refer to this handle
+        this.cleanable = cleaner.register(this, () -> RefQueue.decrefTerm(term, e));
+    }
+
+    /*
+     * Handle for term t
+     * - several handles can refer to the same term
+     */
+    public static TermHandle of(int t) {
+        if (t < 0) throw new IllegalArgumentException("invalid term: " + t);
+        long e = RefQueue.increfTerm(t);
+        return new TermHandle(t, e);
+    }
+
+    public static TermHandle[] of(int... a) {
+        TermHandle[] h = new TermHandle[a.length];
+        for (int i = 0; i < a.length; i++) {
+            h[i] = of(a[i]);
+        }
+        return h;
+    }
+
+    /*
+     * Decrement the reference counter now rather than when the handle is
+     * garbage collected. This does nothing if called more than once, or if
+     * Yices.reset was called since the handle was created.
+     */
+    public void release() {
+        cleanable.clean();
+    }
+
+    public boolean equals(Object o) {
+        return o instanceof TermHandle && ((TermHandle) o).term == term;
+    }
+
+    public int hashCode() {
+        return term;
+    }
+
+    public String toString() {
+        try {
+            return Terms.toString(term);
+        } catch (YicesException e) {
+            return "term " + term;
+        }
+    }
+}
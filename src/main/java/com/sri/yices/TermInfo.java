@@ -0,0 +1,94 @@
+package com.sri.yices;
+
+/**
+ * Constructor, type, flags, and children of a term, fetched in a single
+ * native call (cf. Terms.info).
+ *
+ * For a composite term, the children are the same as in Terms.children.
+ * For a projection, the only child is the argument (and projIndex gives
+ * the index). Sums and products have no children here: use the sum and
+ * product components.
+ */
+public final class TermInfo {
+    // flags: one bit per Terms.isXXX test (must match termInfo in yicesJNI.cpp)
+    private static final int BOOL = 0x1;
+    private static final int INTEGER = 0x2;
+    private static final int REAL = 0x4;
+    private static final int ARITHMETIC = 0x8;
+    private static final int BITVECTOR = 0x10;
+    private static final int TUPLE = 0x20;
+    private static final int FUNCTION = 0x40;
+    private static final int SCALAR = 0x80;
+    private static final int GROUND = 0x100;
+    private static final int ATOMIC = 0x200;
+    private static final int COMPOSITE = 0x400;
+    private static final int PROJECTION = 0x800;
+    private static final int SUM = 0x1000;
+    private static final int BVSUM = 0x2000;
+    private static final int PRODUCT = 0x4000;
+
+    private static final int HEADER = 6;
+
+    private final int term;
+    private final Constructor constructor;
+    private final int type;
+    private final int bitSize;
+    private final int flags;
+    private final int numChildren;
+    private final int projIndex;
+    private final int[] children;
+
+    TermInfo(int term, int[] a) {
+        this.term = term;
+        this.constructor = Constructor.idToConstructor(a[0]);
+        this.type = a[1];
+        this.bitSize = a[2];
+        this.flags = a[3];
+        this.numChildren = a[4];
+        this.projIndex = a[5];
+        this.children = new int[a.length - HEADER];
+        System.arraycopy(a, HEADER, children, 0, children.length);
+    }
+
+    public int term() { return term; }
+    public Constructor constructor() { return constructor; }
+    public int type() { return type; }
+    public int bitSize() { return bitSize; }
+
+    public boolean isBool() { return (flags & BOOL) != 0; }
+    public boolean isInteger() { return (flags & INTEGER) != 0; }
+    public boolean isReal() { return (flags & REAL) != 0; }
+    public boolean isArithmetic() { return (flags & ARITHMETIC) != 0; }
+    public boolean isBitvector() { return (flags & BITVECTOR) != 0; }
+    public boolean isTuple() { return (flags & TUPLE) != 0; }
+    public boolean isFunction() { return (flags & FUNCTION) != 0; }
+    public boolean isScalar() { return (flags & SCALAR) != 0; }
+    public boolean isGround() { return (flags & GROUND) != 0; }
+    public boolean isAtomic() { return (flags & ATOMIC) != 0; }
+    public boolean isComposite() { return (flags & COMPOSITE) != 0; }
+    public boolean isProjection() { return (flags & PROJECTION) != 0; }
+    public boolean isSum() { return (flags & SUM) != 0; }
+    public boolean isBvSum() { return (flags & BVSUM) != 0; }
+    public boolean isProduct() { return (flags & PRODUCT) != 0; }
+
+    /*
+     * Number of children as in Terms.numChildren: for sums and products,
+     * that's the number of components.
+     */
+    public int numChildren() { return numChildren; }
+
+    // -1 if the term is not a projection
+    public int projIndex() { return projIndex; }
+
+    public int child(int i) {
+        return children[i];
+    }
+
+    public int[] children() {
+        return children.clone();
+    }
+
+    public String toString() {
+        return "TermInfo(" + term + ", " + constructor + ", type = " + type + ", children = " + children.length + ")";
+    }
+}
@@ -0,0 +1,101 @@
+package com.sri.yices;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.nio.file.StandardOpenOption;
+
+/**
+ * Binary snapshots of term DAGs.
+ *
+ * A snapshot contains all the terms reachable from a set of roots, their types,
+ * and (optionally) the names of these terms and types. Loading a snapshot rebuilds
+ * the terms by calling the term constructors in topological order, in a single
+ * native call, so a process can restore a large base theory without going through
+ * the Java term constructors.
+ *
+ * When a snapshot is loaded:
+ * - a named uninterpreted term or variable is reused if a term of the same name,
+ *   kind, and type already exists; otherwise a new one is created.
+ * - named scalar and uninterpreted types are reused in the same way.
+ * - the other terms and types get the names they had when the snapshot was saved.
+ * Unnamed uninterpreted terms, variables, and types are always fresh.
+ *
+ * The snapshot is in native byte order: it can't be moved between machines with
+ * different endianness. Terms that contain algebraic root atoms can't be saved.
+ */
+public final class TermSnapshot {
+    private TermSnapshot() { }
+
+    /*
+     * Snapshot of roots, with the names of the terms and types
+     */
+    public static byte[] save(int... roots) throws YicesException {
+        return save(roots, true);
+    }
+
+    public static byte[] save(int[] roots, boolean names) throws YicesException {
+        byte[] b;
+        if (Profiler.enabled) {
+            long start = System.nanoTime();
+            b = Yices.snapshotSave(roots, names);
+            Profiler.delta("Yices.snapshotSave", start, System.nanoTime());
+        } else {
+            b = Yices.snapshotSave(roots, names);
+        }
+        if (b == null) {
+            if (Yices.errorCode() != 0) throw new YicesException();
+            throw new IllegalArgumentException("can't save the terms");
+        }
+        return b;
+    }
+
+    public static void save(Path file, int... roots) throws IOException, YicesException {
+        Files.write(file, save(roots, true));
+    }
+
+    /*
+     * Load a snapshot and return its roots
+     * - b can be a direct buffer (e.g., a mapped file) or a heap buffer
+     *   (then it's copied); the bytes between b's position and limit are used
+     */
+    public static int[] load(ByteBuffer b) throws YicesException {
+        if (!b.isDirect()) {
+            ByteBuffer d = ByteBuffer.allocateDirect(b.remaining());
+            d.put(b.duplicate()).flip();
+            b = d;
+        }
+        int[] roots;
+        if (Profiler.enabled) {
+            long start = System.nanoTime();
+            roots = Yices.snapshotLoad(b, b.position(), b.remaining());
+            Profiler.delta("Yices.snapshotLoad", start, System.nanoTime());
+        } else {
+            roots = Yices.snapshotLoad(b, b.position(), b.remaining());
+        }
+        if (roots == null) {
+            if (Yices.errorCode() != 0) throw new YicesException();
+            throw new IllegalArgumentException("invalid snapshot");
+        }
+        return roots;
+    }
+
+    public static int[] load(byte[] b) throws YicesException {
+        return load(ByteBuffer.wrap(b));
+    }
+
+    /*
+     * Load a snapshot file (the file is mapped in memory)
+     */
+    public static int[] load(Path file) throws IOException, YicesException {
+        try (FileChannel channel = FileChannel.open(file, StandardOpenOption.READ)) {
+            long size = channel.size();
+            if (size > Integer.MAX_VALUE) throw new IOException("file too large: " + file);
+            MappedByteBuffer b = channel.map(FileChannel.MapMode.READ_ONLY, 0, size);
+            return load(b);
+        }
+    }
+}
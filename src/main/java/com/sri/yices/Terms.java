@@ -1,13 +1,20 @@
 package com.sri.yices;
 
+import java.io.IOException;
+import java.io.OutputStream;
 import java.math.BigDecimal;
 import java.math.BigInteger;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+import java.nio.file.Path;
 
 import java.util.List;
 
 /**
  * Wrappers to access the Yices term constructors.
- * These call the native API and throw a YicesException if there's an error.
+ * These call the native API and throw a YicesException if there's an error
+ * (or return NULL_TERM in no-throw mode, cf. NoThrow).
  */
 public class Terms {
     /**
@@ -47,7 +54,7 @@ public class Terms {
      */
     static public int mkConst(int tau, int index) throws YicesException {
         int t = Yices.mkConstant(tau, index);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -61,28 +68,28 @@ public class Terms {
      */
     static public int bvConst(int n, long x) throws YicesException {
         int t = Yices.bvConst(n, x);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvZero(int n) throws YicesException {
         if (n < 0) throw new IllegalArgumentException("negative bitvector size");
         int t = Yices.bvZero(n);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvOne(int n) throws YicesException {
         if (n < 0) throw new IllegalArgumentException("negative bitvector size");
         int t = Yices.bvOne(n);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvMinusOne(int n) throws YicesException {
         if (n < 0) throw new IllegalArgumentException("negative bitvector size");
         int t = Yices.bvMinusOne(n);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -94,7 +101,7 @@ public class Terms {
      */
     static public int bvConst(int... a) throws YicesException {
         int t = Yices.bvConstFromIntArray(a);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -102,6 +109,51 @@ public class Terms {
         return bvConst(a.stream().mapToInt(Integer::intValue).toArray());
     }
 
+    /*
+     * Bitvector constant of n bits from packed words
+     * - bit i is bit (i % 64) of w[i/64] so w[0] contains the 64 low-order bits
+     * - w must contain at least (n + 63)/64 words
+     */
+    static public int bvConstFromWords(int n, long... w) throws YicesException {
+        if (n <= 0) throw new IllegalArgumentException("bitvector size must be positive");
+        if (w.length < (n + 63)/64) throw new IllegalArgumentException("array too small");
+        int t = Yices.bvConstFromWords(n, w);
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    /*
+     * Same thing with little-endian bytes: bit i is bit (i % 8) of byte i/8,
+     * starting from the position of b.
+     * - b must have at least (n + 7)/8 remaining bytes
+     * - if b is a direct buffer, it's read in place
+     */
+    static public int bvConstFromBytes(int n, ByteBuffer b) throws YicesException {
+        if (n <= 0) throw new IllegalArgumentException("bitvector size must be positive");
+        if (b.remaining() < (n + 7)/8) throw new IllegalArgumentException("buffer too small");
+        int t = b.isDirect() ? Yices.bvConstFromBytes(n, b, b.position()) : Yices.bvConstFromWords(n, bytesToWords(b, (n + 7)/8));
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    // pack nbytes of b (from its position) into little-endian words
+    static long[] bytesToWords(ByteBuffer b, int nbytes) {
+        long[] w = new long[(nbytes + 7)/8];
+        int p = b.position();
+        for (int i=0; i<nbytes; i++) {
+            w[i >>> 3] |= (b.get(p + i) & 0xFFL) << (8 * (i & 7));
+        }
+        return w;
+    }
+
+    // store the low-order nbytes of words w into b (from its position)
+    static void wordsToBytes(long[] w, ByteBuffer b, int nbytes) {
+        int p = b.position();
+        for (int i=0; i<nbytes; i++) {
+            b.put(p + i, (byte) (w[i >>> 3] >>> (8 * (i & 7))));
+        }
+    }
+
     /*
      * Convert boolean array a to a bit-vector constant
      * - a[0] = low-order bit
@@ -122,7 +174,7 @@ public class Terms {
      */
     static public int parseBvBin(String s) throws YicesException {
         int t = Yices.parseBvBin(s);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -132,7 +184,7 @@ public class Terms {
      */
     static public int parseBvHex(String s) throws YicesException {
         int t = Yices.parseBvHex(s);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -161,7 +213,7 @@ public class Terms {
             num = - num;
         }
         int t = Yices.mkRationalConstant(num, den);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -184,7 +236,7 @@ public class Terms {
      */
     static public int parseRational(String s) throws YicesException {
         int t = Yices.parseRational(s);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -194,7 +246,7 @@ public class Terms {
      */
     static public int parseFloat(String s) throws YicesException {
         int t = Yices.parseFloat(s);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -214,7 +266,7 @@ public class Terms {
      */
     static public int newUninterpretedTerm(int tau) throws YicesException {
         int t = Yices.newUninterpretedTerm(tau);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -294,7 +346,7 @@ public class Terms {
      */
     static public int newVariable(int tau) throws YicesException {
         int t = Yices.newVariable(tau);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -318,25 +370,25 @@ public class Terms {
      */
     static public int ifThenElse(int cond, int iftrue, int iffalse) throws YicesException {
         int t = Yices.ifThenElse(cond, iftrue, iffalse);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int eq(int left, int right) throws YicesException {
         int t = Yices.eq(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int neq(int left, int right) throws YicesException {
         int t = Yices.neq(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int distinct(int... arg) throws YicesException {
         int t = Yices.distinct(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -347,40 +399,40 @@ public class Terms {
 
     static public int forall(int[] vars, int body) throws YicesException {
         int t = Yices.forall(vars, body);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int forall(List<Integer> varlist, int body) throws YicesException {
         int[] vars =  varlist.stream().mapToInt(Integer::intValue).toArray();
         int t = Yices.forall(vars, body);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int exists(int[] vars, int body) throws YicesException {
         int t = Yices.exists(vars, body);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int exists(List<Integer> varlist, int body) throws YicesException {
         int[] vars =  varlist.stream().mapToInt(Integer::intValue).toArray();
         int t = Yices.exists(vars, body);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int lambda(int[] vars, int body) throws YicesException {
         int t = Yices.lambda(vars, body);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int lambda(List<Integer> varlist, int body) throws YicesException {
         int[] vars =  varlist.stream().mapToInt(Integer::intValue).toArray();
         int t = Yices.lambda(vars, body);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -389,7 +441,7 @@ public class Terms {
      */
     static public int tuple(int... arg) throws YicesException {
         int t = Yices.tuple(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -399,13 +451,13 @@ public class Terms {
 
     static public int select(int idx, int tuple) throws YicesException {
         int t = Yices.select(idx, tuple);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int tupleUpdate(int tuple, int idx, int newval) throws YicesException {
         int t = Yices.tupleUpdate(tuple, idx, newval);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -422,7 +474,7 @@ public class Terms {
         } else {
             t = Yices.funApplication(fun, arg);
         }
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -432,20 +484,20 @@ public class Terms {
 
     static public int functionUpdate(int fun, int[] arg, int newval) throws YicesException {
         int t = Yices.functionUpdate(fun, arg, newval);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int functionUpdate(int fun, List<Integer> arg, int newval) throws YicesException {
         int t = Yices.functionUpdate(fun, arg.stream().mapToInt(Integer::intValue).toArray(), newval);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // Update1 is the common case where arg[] is a single argument
     static public int functionUpdate1(int fun, int arg, int newval) throws YicesException {
         int t = Yices.functionUpdate1(fun, arg, newval);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -454,13 +506,13 @@ public class Terms {
      */
     static public int not(int arg) throws YicesException {
         int t = Yices.not(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int and(int... arg) throws YicesException {
         int t = Yices.and(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -470,7 +522,7 @@ public class Terms {
 
     static public int or(int... arg) throws YicesException {
         int t = Yices.or(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -481,7 +533,7 @@ public class Terms {
 
     static public int xor(int... arg) throws YicesException {
         int t = Yices.xor(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -492,13 +544,13 @@ public class Terms {
 
     static public int iff(int left, int right) throws YicesException {
         int t = Yices.iff(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int implies(int left, int right) throws YicesException {
         int t = Yices.implies(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -508,46 +560,46 @@ public class Terms {
      */
     static public int add(int left, int right) throws YicesException {
         int t = Yices.add(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int sub(int left, int right) throws YicesException {
         int t = Yices.sub(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // unary minus
     static public int neg(int arg) throws YicesException {
         int t = Yices.neg(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int mul(int left, int right) throws YicesException {
         int t = Yices.mul(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int square(int arg) throws YicesException {
         int t = Yices.square(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int power(int arg, int exponent) throws YicesException {
         if (exponent < 0) throw new IllegalArgumentException("exponent can't be negative");
         int t = Yices.power(arg, exponent);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // sum of all elements of arg
     static public int add(int... arg) throws YicesException {
         int t = Yices.add(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -558,7 +610,7 @@ public class Terms {
     // product of all elements of arg
     static public int mul(int... arg) throws YicesException {
         int t = Yices.mul(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -570,41 +622,41 @@ public class Terms {
     // real division: x/y
     static public int div(int x, int y) throws YicesException {
         int t = Yices.div(x, y);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // integer division:
     static public int idiv(int x, int y) throws YicesException {
         int t = Yices.idiv(x, y);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // remainder in integer division
     static public int imod(int x, int y) throws YicesException {
         int t = Yices.imod(x, y);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // absolute value
     static public int abs(int x) throws YicesException {
         int t = Yices.abs(x);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // floor and ceiling
     static public int floor(int x) throws YicesException {
         int t = Yices.floor(x);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int ceil(int x) throws YicesException {
         int t = Yices.ceil(x);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -613,7 +665,7 @@ public class Terms {
         if (coeff.length != t.length)
             throw new IllegalArgumentException("coeff and term arrays must have the same length");
         int term = Yices.intPoly(coeff, t);
-        if (term < 0) throw new YicesException();
+        if (term < 0) return NoThrow.fail();
         return term;
     }
 
@@ -629,7 +681,7 @@ public class Terms {
         if (num.length != den.length || num.length != t.length)
             throw new IllegalArgumentException("coeff and term arrays must have the same length");
         int term = Yices.rationalPoly(num, den, t);
-        if (term < 0) throw new YicesException();
+        if (term < 0) return NoThrow.fail();
         return term;
     }
 
@@ -643,97 +695,97 @@ public class Terms {
     // arithmetic atoms
     static public int divides(int x, int y) throws YicesException {
         int t = Yices.divides(x, y);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int isInt(int x) throws YicesException {
         int t = Yices.isInt(x);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (x == y)
     static public int arithEq(int x, int y) throws YicesException {
         int t = Yices.arithEq(x, y);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (x != y)
     static public int arithNeq(int x, int y) throws YicesException {
         int t = Yices.arithNeq(x, y);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (x >= y)
     static public int arithGeq(int x, int y) throws YicesException {
         int t = Yices.arithGeq(x, y);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (x <= y)
     static public int arithLeq(int x, int y) throws YicesException {
         int t = Yices.arithLeq(x, y);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (x > y)
     static public int arithGt(int x, int y) throws YicesException {
         int t = Yices.arithGt(x, y);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (x < y)
     static public int arithLt(int x, int y) throws YicesException {
         int t = Yices.arithLt(x, y);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (x == 0)
     static public int arithEq0(int x) throws YicesException {
         int t = Yices.arithEq0(x);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (x != 0)
     static public int arithNeq0(int x) throws YicesException {
         int t = Yices.arithNeq0(x);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (x >= 0)
     static public int arithGeq0(int x) throws YicesException {
         int t = Yices.arithGeq0(x);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (x <= 0)
     static public int arithLeq0(int x) throws YicesException {
         int t = Yices.arithLeq0(x);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (x > 0)
     static public int arithGt0(int x) throws YicesException {
         int t = Yices.arithGt0(x);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (x < 0)
     static public int arithLt0(int x) throws YicesException {
         int t = Yices.arithLt0(x);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -742,114 +794,114 @@ public class Terms {
      */
     static public int bvAdd(int left, int right) throws YicesException {
         int t = Yices.bvAdd(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvSub(int left, int right) throws YicesException {
         int t = Yices.bvSub(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // 2s complement negation
     static public int bvNeg(int arg) throws YicesException {
         int t = Yices.bvNeg(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvMul(int left, int right) throws YicesException {
         int t = Yices.bvMul(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvSquare(int arg) throws YicesException {
         int t = Yices.bvSquare(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvPower(int arg, int exponent) throws YicesException {
         if (exponent < 0) throw new IllegalArgumentException("exponent can't be negative");
         int t = Yices.bvPower(arg, exponent);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // unsigned division
     static public int bvDiv(int left, int right) throws YicesException {
         int t = Yices.bvDiv(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvRem(int left, int right) throws YicesException {
         int t = Yices.bvRem(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // signed division
     static public int bvSDiv(int left, int right) throws YicesException {
         int t = Yices.bvSDiv(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvSRem(int left, int right) throws YicesException {
         int t = Yices.bvSRem(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvSMod(int left, int right) throws YicesException {
         int t = Yices.bvSMod(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // bitwise operations
     static public int bvNot(int arg) throws YicesException {
         int t = Yices.bvNot(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvAnd(int left, int right) throws YicesException {
         int t = Yices.bvAnd(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvOr(int left, int right) throws YicesException {
         int t = Yices.bvOr(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvXor(int left, int right) throws YicesException {
         int t = Yices.bvXor(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvNand(int left, int right) throws YicesException {
         int t = Yices.bvNand(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvNor(int left, int right) throws YicesException {
         int t = Yices.bvNor(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvXNor(int left, int right) throws YicesException {
         int t = Yices.bvXNor(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -857,19 +909,19 @@ public class Terms {
     // gives the shift amount.
     static public int bvShl(int left, int right) throws YicesException {
         int t = Yices.bvShl(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvLshr(int left, int right) throws YicesException {
         int t = Yices.bvLshr(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvAshr(int left, int right) throws YicesException {
         int t = Yices.bvAshr(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -877,7 +929,7 @@ public class Terms {
     static public int bvAdd(int... arg) throws YicesException {
         if (arg.length == 0) throw new IllegalArgumentException("empty input");
         int t = Yices.bvAdd(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -888,7 +940,7 @@ public class Terms {
     static public int bvAnd(int... arg) throws YicesException {
         if (arg.length == 0) throw new IllegalArgumentException("empty input");
         int t = Yices.bvAnd(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -899,7 +951,7 @@ public class Terms {
     static public int bvOr(int... arg) throws YicesException {
         if (arg.length == 0) throw new IllegalArgumentException("empty input");
         int t = Yices.bvOr(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -910,7 +962,7 @@ public class Terms {
     static public int bvXor(int... arg) throws YicesException {
         if (arg.length == 0) throw new IllegalArgumentException("empty input");
         int t = Yices.bvXor(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -922,49 +974,49 @@ public class Terms {
     static public int bvShiftLeft0(int arg, int n) throws YicesException {
         if (n < 0) throw new IllegalArgumentException("shift amount can't be negative");
         int t = Yices.bvShiftLeft0(arg, n);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvShiftLeft1(int arg, int n) throws YicesException {
         if (n < 0) throw new IllegalArgumentException("shift amount can't be negative");
         int t = Yices.bvShiftLeft1(arg, n);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvShiftRight0(int arg, int n) throws YicesException {
         if (n < 0) throw new IllegalArgumentException("shift amount can't be negative");
         int t = Yices.bvShiftRight0(arg, n);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvShiftRight1(int arg, int n) throws YicesException {
         if (n < 0) throw new IllegalArgumentException("shift amount can't be negative");
         int t = Yices.bvShiftRight1(arg, n);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvAShiftRight(int arg, int n) throws YicesException {
         if (n < 0) throw new IllegalArgumentException("shift amount can't be negative");
         int t = Yices.bvAShiftRight(arg, n);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvRotateLeft(int arg, int n) throws YicesException {
         if (n < 0) throw new IllegalArgumentException("shift amount can't be negative");
         int t = Yices.bvRotateLeft(arg, n);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvRotateRight(int arg, int n) throws YicesException {
         if (n < 0) throw new IllegalArgumentException("shift amount can't be negative");
         int t = Yices.bvRotateRight(arg, n);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -972,7 +1024,7 @@ public class Terms {
     static public int bvExtract(int a, int i, int j) throws YicesException {
         if (i < 0 || j < 0) throw new IllegalArgumentException("negative bit-vector index");
         int t = Yices.bvExtract(a, i, j);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -980,7 +1032,7 @@ public class Terms {
     static public int bvExtractBit(int a, int i) throws YicesException {
         if (i < 0) throw new IllegalArgumentException("negative bit-vector index");
         int t = Yices.bvExtractBit(a, i);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -989,7 +1041,7 @@ public class Terms {
     static public int bvFromBoolArray(int... a) throws YicesException {
         if (a.length == 0) throw new IllegalArgumentException("empty boolean array");
         int t = Yices.bvFromBoolArray(a);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -1000,13 +1052,13 @@ public class Terms {
     // concat: high-order bits are from the left
     static public int bvConcat(int left, int right) throws YicesException {
         int t = Yices.bvConcat(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
     static public int bvConcat(int... a) throws YicesException {
         if (a.length == 0) throw new IllegalArgumentException("empty input");
         int t = Yices.bvConcat(a);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -1018,7 +1070,7 @@ public class Terms {
     static public int bvRepeat(int a, int n) throws YicesException {
         if (n <= 0) throw new IllegalArgumentException("n must be positive");
         int t = Yices.bvRepeat(a, n);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -1026,74 +1078,74 @@ public class Terms {
     static public int bvSignExtend(int arg, int n) throws YicesException {
         if (n <= 0) throw new IllegalArgumentException("n must be positive");
         int t = Yices.bvSignExtend(arg, n);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvZeroExtend(int arg, int n) throws YicesException {
         if (n <= 0) throw new IllegalArgumentException("n must be positive");
         int t = Yices.bvZeroExtend(arg, n);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // obscure operations
     static public int bvRedAnd(int arg) throws YicesException {
         int t = Yices.bvRedAnd(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvRedOr(int arg) throws YicesException {
         int t = Yices.bvRedOr(arg);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvRedComp(int left, int right) throws YicesException {
         int t = Yices.bvRedComp(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // Atoms
     static public int bvEq(int left, int right) throws YicesException {
         int t = Yices.bvEq(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     static public int bvNeq(int left, int right) throws YicesException {
         int t = Yices.bvNeq(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // unsigned comparison: (left >= right)
     static public int bvGe(int left, int right) throws YicesException {
         int t = Yices.bvGe(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (left > right)
     static public int bvGt(int left, int right) throws YicesException {
         int t = Yices.bvGt(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (left <= right)
     static public int bvLe(int left, int right) throws YicesException {
         int t = Yices.bvLe(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (left < right)
     static public int bvLt(int left, int right) throws YicesException {
         int t = Yices.bvLt(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -1101,28 +1153,142 @@ public class Terms {
     // signed comparison: (left >= right)
     static public int bvSGe(int left, int right) throws YicesException {
         int t = Yices.bvSGe(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (left > right)
     static public int bvSGt(int left, int right) throws YicesException {
         int t = Yices.bvSGt(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (left <= right)
     static public int bvSLe(int left, int right) throws YicesException {
         int t = Yices.bvSLe(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
     // (left < right)
     static public int bvSLt(int left, int right) throws YicesException {
         int t = Yices.bvSLt(left, right);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    /**
+     * Direct buffer variants of the n-ary constructors
+     *
+     * The arguments are the remaining elements of arg (from its position to its limit).
+     * If arg is a direct buffer in native byte order, the native code reads it in place.
+     * Otherwise, the elements are copied into an array first.
+     */
+    static private boolean isDirect(IntBuffer b) {
+        return b.isDirect() && b.order() == ByteOrder.nativeOrder();
+    }
+
+    static private int[] toArray(IntBuffer b) {
+        int[] a = new int[b.remaining()];
+        b.duplicate().get(a);
+        return a;
+    }
+
+    static public int funApplication(int fun, IntBuffer arg) throws YicesException {
+        int t = isDirect(arg) ? Yices.funApplication(fun, arg, arg.position(), arg.remaining()) : Yices.funApplication(fun, toArray(arg));
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    static public int and(IntBuffer arg) throws YicesException {
+        int t = isDirect(arg) ? Yices.and(arg, arg.position(), arg.remaining()) : Yices.and(toArray(arg));
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    static public int or(IntBuffer arg) throws YicesException {
+        int t = isDirect(arg) ? Yices.or(arg, arg.position(), arg.remaining()) : Yices.or(toArray(arg));
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    static public int xor(IntBuffer arg) throws YicesException {
+        int t = isDirect(arg) ? Yices.xor(arg, arg.position(), arg.remaining()) : Yices.xor(toArray(arg));
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    static public int distinct(IntBuffer arg) throws YicesException {
+        int t = isDirect(arg) ? Yices.distinct(arg, arg.position(), arg.remaining()) : Yices.distinct(toArray(arg));
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    static public int tuple(IntBuffer arg) throws YicesException {
+        int t = isDirect(arg) ? Yices.tuple(arg, arg.position(), arg.remaining()) : Yices.tuple(toArray(arg));
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    static public int add(IntBuffer arg) throws YicesException {
+        int t = isDirect(arg) ? Yices.add(arg, arg.position(), arg.remaining()) : Yices.add(toArray(arg));
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    static public int mul(IntBuffer arg) throws YicesException {
+        int t = isDirect(arg) ? Yices.mul(arg, arg.position(), arg.remaining()) : Yices.mul(toArray(arg));
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    static public int bvAdd(IntBuffer arg) throws YicesException {
+        if (!arg.hasRemaining()) throw new IllegalArgumentException("empty input");
+        int t = isDirect(arg) ? Yices.bvAdd(arg, arg.position(), arg.remaining()) : Yices.bvAdd(toArray(arg));
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    static public int bvMul(IntBuffer arg) throws YicesException {
+        if (!arg.hasRemaining()) throw new IllegalArgumentException("empty input");
+        int t = isDirect(arg) ? Yices.bvMul(arg, arg.position(), arg.remaining()) : Yices.bvMul(toArray(arg));
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    static public int bvAnd(IntBuffer arg) throws YicesException {
+        if (!arg.hasRemaining()) throw new IllegalArgumentException("empty input");
+        int t = isDirect(arg) ? Yices.bvAnd(arg, arg.position(), arg.remaining()) : Yices.bvAnd(toArray(arg));
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    static public int bvOr(IntBuffer arg) throws YicesException {
+        if (!arg.hasRemaining()) throw new IllegalArgumentException("empty input");
+        int t = isDirect(arg) ? Yices.bvOr(arg, arg.position(), arg.remaining()) : Yices.bvOr(toArray(arg));
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    static public int bvXor(IntBuffer arg) throws YicesException {
+        if (!arg.hasRemaining()) throw new IllegalArgumentException("empty input");
+        int t = isDirect(arg) ? Yices.bvXor(arg, arg.position(), arg.remaining()) : Yices.bvXor(toArray(arg));
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    static public int bvFromBoolArray(IntBuffer arg) throws YicesException {
+        if (!arg.hasRemaining()) throw new IllegalArgumentException("empty input");
+        int t = isDirect(arg) ? Yices.bvFromBoolArray(arg, arg.position(), arg.remaining()) : Yices.bvFromBoolArray(toArray(arg));
+        if (t < 0) return NoThrow.fail();
+        return t;
+    }
+
+    static public int bvConcat(IntBuffer arg) throws YicesException {
+        if (!arg.hasRemaining()) throw new IllegalArgumentException("empty input");
+        int t = isDirect(arg) ? Yices.bvConcat(arg, arg.position(), arg.remaining()) : Yices.bvConcat(toArray(arg));
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
@@ -1258,6 +1424,125 @@ public class Terms {
         return t;
     }
 
+    /*
+     * Cache of term information, indexed by term id
+     * - the entries are immutable so they can be shared between threads without locking;
+     *   two threads may fetch the same entry and one of them is then lost
+     * - the cache is cleared by Yices.yicesGarbageCollect and Yices.reset since
+     *   the ids of deleted terms can be reused.
+     * - infoGeneration is incremented on each clear: an entry fetched before a clear
+     *   is not stored after it (the term may have been deleted in between)
+     */
+    private static final int INFO_CACHE_INIT_SIZE = 1024;
+    private static volatile TermInfo[] infoCache = new TermInfo[INFO_CACHE_INIT_SIZE];
+    private static volatile long infoGeneration = 0;
+
+    /*
+     * All the information about term x (constructor, type, flags, children),
+     * fetched in a single native call the first time and cached.
+     */
+    static public TermInfo info(int x) throws YicesException {
+        long g = infoGeneration;
+        TermInfo[] cache = infoCache;
+        if (x >= 0 && x < cache.length) {
+            TermInfo info = cache[x];
+            if (info != null) return info;
+        }
+        int[] a;
+        if (Profiler.enabled) {
+            long start = System.nanoTime();
+            a = Yices.termInfo(x);
+            Profiler.delta("Yices.termInfo", start, System.nanoTime());
+        } else {
+            a = Yices.termInfo(x);
+        }
+        if (a == null) throw new YicesException();
+        TermInfo info = new TermInfo(x, a);
+        storeInfo(x, info, g);
+        return info;
+    }
+
+    private static synchronized void storeInfo(int x, TermInfo info, long g) {
+        if (g != infoGeneration) return;
+        TermInfo[] cache = infoCache;
+        if (x >= cache.length) {
+            int n = cache.length;
+            while (n <= x) n <<= 1;
+            TermInfo[] b = new TermInfo[n];
+            System.arraycopy(cache, 0, b, 0, cache.length);
+            cache = b;
+        }
+        cache[x] = info;
+        infoCache = cache;
+    }
+
+    /*
+     * Forget all cached TermInfos
+     */
+    static public synchronized void clearInfoCache() {
+        infoCache = new TermInfo[INFO_CACHE_INIT_SIZE];
+        infoGeneration ++;
+    }
+
+    /*
+     * All the subterms of roots in topological order (cf. TermDag)
+     */
+    static public TermDag dag(int... roots) throws YicesException {
+        int[] r = Yices.termDag(roots);
+        if (r == null) throw new YicesException();
+        return new TermDag(r);
+    }
+
+    /*
+     * Uninterpreted terms that occur in roots
+     */
+    static public int[] uninterpretedTerms(int... roots) throws YicesException {
+        int[] r = Yices.termSymbols(roots);
+        if (r == null) throw new YicesException();
+        int[] a = new int[r[0]];
+        System.arraycopy(r, 1, a, 0, a.length);
+        return a;
+    }
+
+    /*
+     * Variables that have a free occurrence in roots
+     */
+    static public int[] freeVariables(int... roots) throws YicesException {
+        int[] r = Yices.termSymbols(roots);
+        if (r == null) throw new YicesException();
+        int[] a = new int[r.length - 1 - r[0]];
+        System.arraycopy(r, 1 + r[0], a, 0, a.length);
+        return a;
+    }
+
+    /*
+     * Number of distinct subterms in roots
+     */
+    static public long dagSize(int... roots) throws YicesException {
+        long[] size = new long[2];
+        if (Yices.termSize(roots, size) < 0) throw new YicesException();
+        return size[0];
+    }
+
+    /*
+     * Size of roots without sharing: each subterm is counted once per occurrence
+     * (Long.MAX_VALUE if that overflows)
+     */
+    static public long treeSize(int... roots) throws YicesException {
+        long[] size = new long[2];
+        if (Yices.termSize(roots, size) < 0) throw new YicesException();
+        return size[1];
+    }
+
+    // number of cached entries
+    static public int infoCacheSize() {
+        int n = 0;
+        for (TermInfo i : infoCache) {
+            if (i != null) n++;
+        }
+        return n;
+    }
+
 
     /*
      * Check whether term x is a constant
@@ -1363,13 +1648,49 @@ public class Terms {
         return s;
     }
 
+    /*
+     * Pretty print t without building a String (cf. PrintedText)
+     * - negative numColumns or numLines mean 80 columns and no line limit
+     * - toBuffer copies the text into dst (at its position) if it fits, and
+     *   returns the size of the text in bytes; if it doesn't fit, dst is unchanged
+     */
+    static public int toBuffer(int t, int numColumns, int numLines, ByteBuffer dst) throws YicesException {
+        return PrintedText.toBuffer((b, offset, capacity) -> Yices.termToBuffer(t, numColumns, numLines, b, offset, capacity),
+                                    code -> Yices.termToMappedBuffer(t, numColumns, numLines, code), dst);
+    }
+
+    static public void writeTo(int t, int numColumns, int numLines, OutputStream out) throws IOException, YicesException {
+        PrintedText.writeTo(code -> Yices.termToMappedBuffer(t, numColumns, numLines, code), out);
+    }
+
+    static public void appendTo(int t, int numColumns, int numLines, Appendable out) throws IOException, YicesException {
+        PrintedText.appendTo(code -> Yices.termToMappedBuffer(t, numColumns, numLines, code), out);
+    }
+
     // Parsing of a term (Yices syntax)
     static public int parse(String s) throws YicesException {
         int t = Yices.parseTerm(s);
-        if (t < 0) throw new YicesException();
+        if (t < 0) return NoThrow.fail();
         return t;
     }
 
+    /*
+     * Parse all the terms in s, b, or a file (in one native call).
+     * The terms are separated by white space or parentheses, and parse errors
+     * are reported per term (cf. ParseBatch).
+     */
+    static public ParseBatch parseAll(String s) {
+        return ParseBatch.parse(s, false);
+    }
+
+    static public ParseBatch parseAll(ByteBuffer b) {
+        return ParseBatch.parse(b, false);
+    }
+
+    static public ParseBatch parseFile(Path file) throws IOException {
+        return ParseBatch.parseFile(file, false);
+    }
+
     /*
      * Substitutions
      *
@@ -1379,11 +1700,13 @@ public class Terms {
      * substTerm(t, v, map): apply the substitution to t.
      * substTermArray(a, v, map): apply the substitution to all elements of array a.
      * If there's an error, a is unchanged.
+     *
+     * To apply the same substitution many times, class Substitution is cheaper.
      */
      static public int subst(int t, int[] v, int[] map) throws YicesException {
          if (v.length != map.length) throw new IllegalArgumentException("bad substitution");
          int w = Yices.substTerm(t, v, map);
-         if (w < 0) throw new YicesException();
+         if (w < 0) return NoThrow.fail();
          return w;
      }
 
@@ -0,0 +1,42 @@
+package com.sri.yices;
+
+import java.lang.ref.Cleaner;
+
+/**
+ * Managed reference to a type: same as TermHandle
+ */
+public final class TypeHandle {
+    public final int type;
+    private final Cleaner.Cleanable cleanable;
+
+    private TypeHandle(int type, long e) {
+        this.type = type;
+        this.cleanable = TermHandle.cleaner.register(this, () -> RefQueue.decrefType(type, e));
+    }
+
+    public static TypeHandle of(int tau) {
+        if (tau < 0) throw new IllegalArgumentException("invalid type: " + tau);
+        long e = RefQueue.increfType(tau);
+        return new TypeHandle(tau, e);
+    }
+
+    public void release() {
+        cleanable.clean();
+    }
+
+    public boolean equals(Object o) {
+        return o instanceof TypeHandle && ((TypeHandle) o).type == type;
+    }
+
+    public int hashCode() {
+        return type;
+    }
+
+    public String toString() {
+        try {
+            return Types.toString(type);
+        } catch (YicesException e) {
+            return "type " + type;
+        }
+    }
+}
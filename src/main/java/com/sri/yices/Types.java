@@ -1,11 +1,13 @@
 package com.sri.yices;
 
+import java.nio.ByteBuffer;
 import java.util.Arrays;
 import java.util.List;
 
 /**
  * Wrappers to access the Yices type constructors.
- * These call the native API and throw an exception if there's an error.
+ * These call the native API and throw an exception if there's an error
+ * (or return NULL_TYPE in no-throw mode, cf. NoThrow).
  */
 public class Types {
     /**
@@ -55,7 +57,7 @@ public class Types {
         }
         int tau = Yices.bvType(nbits);
         if (tau < 0) {
-            throw new YicesException();
+            return NoThrow.fail();
         }
         return tau;
     }
@@ -70,7 +72,7 @@ public class Types {
         }
         int tau = Yices.newScalarType(card);
         if (tau < 0) {
-            throw new YicesException();
+            return NoThrow.fail();
         }
         return tau;
     }
@@ -113,7 +115,7 @@ public class Types {
     static public int tupleType(int... a) throws YicesException {
         int tau = Yices.tupleType(a);
         if (tau < 0) {
-            throw new YicesException();
+            return NoThrow.fail();
         }
         return tau;
     }
@@ -131,7 +133,7 @@ public class Types {
         }
         int tau = Yices.functionType(sigma, a);
         if (tau < 0) {
-            throw new YicesException();
+            return NoThrow.fail();
         }
         return tau;
     }
@@ -150,7 +152,7 @@ public class Types {
         int[] domain = Arrays.copyOf(a, a.length - 1);
         int tau = Yices.functionType(range, domain);
         if (tau < 0) {
-            throw new YicesException();
+            return NoThrow.fail();
         }
         return tau;
     }
@@ -303,9 +305,20 @@ public class Types {
     static public int parse(String s) throws YicesException {
         int tau = Yices.parseType(s);
         if (tau < 0) {
-            throw new YicesException();
+            return NoThrow.fail();
         }
         return tau;
     }
+
+    /*
+     * Parse all the types in s or b (cf. Terms.parseAll)
+     */
+    static public ParseBatch parseAll(String s) {
+        return ParseBatch.parse(s, true);
+    }
+
+    static public ParseBatch parseAll(ByteBuffer b) {
+        return ParseBatch.parse(b, true);
+    }
 }
 
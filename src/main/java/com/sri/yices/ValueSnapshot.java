@@ -0,0 +1,249 @@
+package com.sri.yices;
+
+import java.math.BigInteger;
+
+/**
+ * Snapshot of the values of some terms in a model (cf. Model.snapshot and Model.valueTree).
+ *
+ * The DAG of values reachable from the terms is built by a single native call,
+ * and stored in primitive arrays. Each node of the DAG is a YVal: the snapshot
+ * gives its tag, its children (for tuples, functions, and mappings), and its
+ * value (for atomic nodes), without calling Yices.
+ *
+ * The only exception is a rational whose numerator or denominator doesn't fit
+ * in 64 bits: bigRationalValue gets it from the model, so the model must
+ * still be open then.
+ */
+public final class ValueSnapshot {
+    private final Model model;
+    private final int[] roots;
+    private final byte[] tags;
+    private final int[] ids;
+    private final int[] childOffset;    // children of node i: children[childOffset[i] ... childOffset[i+1]-1]
+    private final int[] children;
+    private final int[] valueOffset;    // values of node i: values[valueOffset[i] ... valueOffset[i+1]-1]
+    private final long[] values;
+
+    /*
+     * a = result of Yices.valSnapshot (see yicesJNI.cpp for the layout)
+     */
+    ValueSnapshot(Model model, long[] a) {
+        this.model = model;
+        int n = (int) a[0];
+        int r = (int) a[1];
+        int k = 2;
+        roots = new int[r];
+        for (int i = 0; i < r; i++) roots[i] = (int) a[k++];
+        tags = new byte[n];
+        for (int i = 0; i < n; i++) tags[i] = (byte) a[k++];
+        ids = new int[n];
+        for (int i = 0; i < n; i++) ids[i] = (int) a[k++];
+        childOffset = new int[n + 1];
+        for (int i = 0; i <= n; i++) childOffset[i] = (int) a[k++];
+        valueOffset = new int[n + 1];
+        for (int i = 0; i <= n; i++) valueOffset[i] = (int) a[k++];
+        children = new int[childOffset[n]];
+        for (int i = 0; i < children.length; i++) children[i] = (int) a[k++];
+        values = new long[valueOffset[n]];
+        System.arraycopy(a, k, values, 0, values.length);
+    }
+
+    /*
+     * Number of nodes and number of roots (i.e., terms)
+     */
+    public int size() {
+        return tags.length;
+    }
+
+    public int numRoots() {
+        return roots.length;
+    }
+
+    /*
+     * Node for the value of the i-th term
+     */
+    public Node root(int i) {
+        return new Node(roots[i]);
+    }
+
+    public Node node(int i) {
+        if (i < 0 || i >= tags.length) throw new IndexOutOfBoundsException("invalid node index: " + i);
+        return new Node(i);
+    }
+
+    /**
+     * View of a node: this is just a snapshot and an index so it's cheap to create.
+     */
+    public final class Node {
+        public final int index;
+
+        private Node(int index) {
+            this.index = index;
+        }
+
+        public YValTag tag() {
+            return YValTag.idToTag(tags[index]);
+        }
+
+        public int id() {
+            return ids[index];
+        }
+
+        public YVal toYVal() {
+            return new YVal(tags[index], ids[index]);
+        }
+
+        private void check(YValTag t) {
+            if (tag() != t) throw new IllegalStateException("not a " + t + " value: " + tag());
+        }
+
+        private long value(int k) {
+            return values[valueOffset[index] + k];
+        }
+
+        /*
+         * Children: components of a tuple, default value then mappings of a function,
+         * arguments then value of a mapping
+         */
+        public int numChildren() {
+            return childOffset[index + 1] - childOffset[index];
+        }
+
+        public Node child(int k) {
+            if (k < 0 || k >= numChildren()) throw new IndexOutOfBoundsException("invalid child index: " + k);
+            return new Node(children[childOffset[index] + k]);
+        }
+
+        public boolean boolValue() {
+            check(YValTag.BOOL);
+            return value(0) != 0;
+        }
+
+        /*
+         * Rationals: fitsLong is true if the numerator and denominator fit in 64 bits
+         */
+        public boolean fitsLong() {
+            check(YValTag.RATIONAL);
+            return value(0) != 0;
+        }
+
+        public long numerator() {
+            if (!fitsLong()) throw new ArithmeticException("numerator too large");
+            return value(1);
+        }
+
+        public long denominator() {
+            if (!fitsLong()) throw new ArithmeticException("denominator too large");
+            return value(2);
+        }
+
+        public boolean isInteger() {
+            return fitsLong() && value(2) == 1;
+        }
+
+        public BigRational bigRationalValue() throws YicesException {
+            if (fitsLong()) {
+                return new BigRational(BigInteger.valueOf(value(1)), BigInteger.valueOf(value(2)));
+            }
+            return model.bigRationalValue(toYVal());
+        }
+
+        /*
+         * Approximation of a rational or algebraic number
+         */
+        public double doubleValue() throws YicesException {
+            if (tag() == YValTag.ALGEBRAIC) return Double.longBitsToDouble(value(0));
+            if (fitsLong()) return (double) value(1) / value(2);
+            return model.doubleValue(toYVal());
+        }
+
+        /*
+         * Bitvectors: bit i is bit (i % 64) of bvWords()[i/64]
+         */
+        public int bvWidth() {
+            check(YValTag.BV);
+            return (int) value(0);
+        }
+
+        public long[] bvWords() {
+            int w = (bvWidth() + 63)/64;
+            long[] a = new long[w];
+            System.arraycopy(values, valueOffset[index] + 1, a, 0, w);
+            return a;
+        }
+
+        public boolean bvBit(int i) {
+            if (i < 0 || i >= bvWidth()) throw new IndexOutOfBoundsException("invalid bit index: " + i);
+            return ((value(1 + (i >>> 6)) >>> (i & 63)) & 1) != 0;
+        }
+
+        /*
+         * Scalars: the constant index and the type
+         */
+        public int scalarIndex() {
+            check(YValTag.SCALAR);
+            return (int) value(0);
+        }
+
+        public int scalarType() {
+            check(YValTag.SCALAR);
+            return (int) value(1);
+        }
+
+        /*
+         * Functions: type, default value, and the mappings
+         */
+        public int functionType() {
+            check(YValTag.FUNCTION);
+            return (int) value(0);
+        }
+
+        public Node defaultValue() {
+            check(YValTag.FUNCTION);
+            return child(0);
+        }
+
+        public int numMappings() {
+            check(YValTag.FUNCTION);
+            return numChildren() - 1;
+        }
+
+        public Node mapping(int k) {
+            check(YValTag.FUNCTION);
+            return child(k + 1);
+        }
+
+        /*
+         * Mappings: arguments and value
+         */
+        public int mappingArity() {
+            check(YValTag.MAPPING);
+            return numChildren() - 1;
+        }
+
+        public Node mappingArg(int k) {
+            if (k < 0 || k >= mappingArity()) throw new IndexOutOfBoundsException("invalid argument index: " + k);
+            return child(k);
+        }
+
+        public Node mappingValue() {
+            return child(mappingArity());
+        }
+
+        public boolean equals(Object o) {
+            return o instanceof Node && ((Node) o).snapshot() == ValueSnapshot.this && ((Node) o).index == index;
+        }
+
+        public int hashCode() {
+            return index;
+        }
+
+        private ValueSnapshot snapshot() {
+            return ValueSnapshot.this;
+        }
+
+        public String toString() {
+            return String.format("<%s: %d>", tag(), id());
+        }
+    }
+}
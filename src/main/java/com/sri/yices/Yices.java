@@ -1,6 +1,8 @@
 package com.sri.yices;
 
 import java.math.BigInteger;
+import java.nio.ByteBuffer;
+import java.nio.IntBuffer;
 
 public final class Yices {
     private static boolean is_ready;
@@ -77,15 +79,59 @@ public final class Yices {
     // check whether the library was compiled in THREAD_SAFE mode.
     public static native boolean isThreadSafe();
 
+    /*
+     * Native call tracing: this is available only if libyices2java was
+     * compiled with YICES_JNI_TRACE (make TRACE=1).
+     * - setNativeTracing turns tracing on or off. It returns false if tracing is not available.
+     * - nativeTraceNames returns the C names of the natives called while tracing was on
+     * - nativeStats returns an array a such that a[0] = n = number of natives and,
+     *   for native i in 0 .. n-1 (in the same order as nativeTraceNames):
+     *     a[1 + 3i] = number of calls
+     *     a[2 + 3i] = total time spent in the native (nanoseconds)
+     *     a[3 + 3i] = part of that time spent converting between Java and C data
+     *   The counters are summed over all threads.
+     * - resetNativeStats resets all counters to 0
+     * Profiler.nativeReport() combines nativeTraceNames and nativeStats.
+     */
+    public static native boolean setNativeTracing(boolean enable);
+    public static native String[] nativeTraceNames();
+    public static native long[] nativeStats();
+    public static native void resetNativeStats();
+
+    /*
+     * Number of bytes of native heap in use (all of libyices2java, Yices, and
+     * anything else that uses malloc in the process). Returns -1 if the C
+     * library can't report it (only glibc does for now).
+     */
+    public static native long nativeHeapUsage();
+
     /*
      * Global operations:
      * - init is required and must be performed first
      * - exit frees the internal data structures used by Yices
      * - reset is the same as exit(); init();
+     *
+     * After a reset, all term and type ids are invalid and the ids can be
+     * reused: the term information cache and the query caches are cleared as
+     * in yicesGarbageCollect. Contexts, models, configs, and parameter records
+     * created before the reset are freed by Yices: they must not be used
+     * afterwards, and closing them does nothing.
      */
     private static native void init();
     private static native void exit();
-    public static native void reset();
+    private static native void yicesReset();
+
+    public static void reset() {
+        synchronized (RefQueue.class) {
+            yicesReset();
+            RefQueue.reset();
+            Terms.clearInfoCache();
+            QueryCache.garbageCollected();
+        }
+        // the pools lock their records when they free them: this must be done
+        // without holding the RefQueue lock
+        ContextPool.resetAll();
+    }
 
     /*
      * Error reports
@@ -96,6 +142,18 @@ public final class Yices {
 
     public static native ErrorReport errorReport();
 
+    /*
+     * Per-thread error slot (cf. NoThrow)
+     * - stashError copies the current error report into the slot of the calling
+     *   thread, clears the Yices error, and returns the error code
+     * - the other functions read or clear the slot
+     */
+    public static native int stashError();
+    public static native int lastErrorCode();
+    public static native String lastErrorString();
+    public static native ErrorReport lastErrorReport();
+    public static native void clearLastError();
+
     // For testing only
     public static native void testException();
 
@@ -267,6 +325,11 @@ public final class Yices {
     // this converts x to a bitvector: x[0] = low-order bit, x[n-1] = high-order bit,
     // where n = array length (n must be positive).
     public static native int bvConstFromIntArray(int... x);
+    // packed variants: bit i is bit (i % 64) of w[i/64], or bit (i % 8) of the byte
+    // at offset + i/8 in b. Buffer b must be direct. They return -1 if there's an error
+    // or not enough words or bytes for n bits.
+    public static native int bvConstFromWords(int n, long[] w);
+    public static native int bvConstFromBytes(int n, ByteBuffer b, int offset);
     public static native int parseBvBin(String s);
     public static native int parseBvHex(String x);
 
@@ -350,6 +413,39 @@ public final class Yices {
     public static native int bvSLe(int left, int right);
     public static native int bvSLt(int left, int right);
 
+    /*
+     * Batch construction: build n terms in a single call
+     * - program is a sequence of n instructions: op, m, x[0], ..., x[m-1]
+     * - a negative operand x refers to the result of instruction ~x of the same program
+     * - the op codes are defined in TermBatch.java
+     * Returns the array of n terms, or null if an instruction fails or if program is malformed.
+     * If program is malformed (bad op code, arity, or immediate operand), the Yices error code is 0.
+     */
+    public static native int[] termBatch(int[] program, int n);
+
+    /*
+     * Variants of the n-ary constructors that read their arguments from a direct IntBuffer
+     * - the arguments are the n elements of buffer arg starting at index offset
+     *   (the buffer's position and limit are ignored)
+     * - arg must be a direct buffer in native byte order
+     * They throw IllegalArgumentException if arg is not direct or if the range is out of bounds.
+     */
+    public static native int funApplication(int fun, IntBuffer arg, int offset, int n);
+    public static native int and(IntBuffer arg, int offset, int n);
+    public static native int or(IntBuffer arg, int offset, int n);
+    public static native int xor(IntBuffer arg, int offset, int n);
+    public static native int distinct(IntBuffer arg, int offset, int n);
+    public static native int tuple(IntBuffer arg, int offset, int n);
+    public static native int add(IntBuffer arg, int offset, int n);
+    public static native int mul(IntBuffer arg, int offset, int n);
+    public static native int bvAdd(IntBuffer arg, int offset, int n);
+    public static native int bvMul(IntBuffer arg, int offset, int n);
+    public static native int bvAnd(IntBuffer arg, int offset, int n);
+    public static native int bvOr(IntBuffer arg, int offset, int n);
+    public static native int bvXor(IntBuffer arg, int offset, int n);
+    public static native int bvFromBoolArray(IntBuffer arg, int offset, int n);
+    public static native int bvConcat(IntBuffer arg, int offset, int n);
+
     /*
      * Accessors and checks on term x
      */
@@ -384,6 +480,32 @@ public final class Yices {
     public static native int termProjIndex(int x);
     public static native int termProjArg(int x);
 
+    // everything about x in one call (cf. TermInfo), or null if x is not a valid term
+    public static native int[] termInfo(int x);
+
+    /*
+     * Traversal of the DAG reachable from roots (cf. TermDag)
+     * - termDag returns the terms in topological order with their constructors and children
+     * - termSymbols returns the uninterpreted terms and the free variables
+     *   (r[0] = number of uninterpreted terms, followed by the uninterpreted terms then the variables)
+     * - termSize stores the DAG size in size[0] and the tree size in size[1]
+     * The children of sums and products are their non-constant components.
+     * All return null or -1 if one of the roots is not a valid term.
+     */
+    public static native int[] termDag(int[] roots);
+    public static native int[] termSymbols(int[] roots);
+    public static native int termSize(int[] roots, long[] size);
+
+    /*
+     * Binary snapshots of term DAGs (cf. TermSnapshot)
+     * - snapshotSave returns null if a root is invalid or if it can't be saved
+     * - snapshotLoad takes a direct buffer: it returns the roots, or null if the
+     *   snapshot is malformed or a term can't be built (it throws IllegalArgumentException
+     *   if the buffer is not direct or the range is out of bounds)
+     */
+    public static native byte[] snapshotSave(int[] roots, boolean names);
+    public static native int[] snapshotLoad(ByteBuffer buffer, int offset, int n);
+
     /*
      * Values of constant terms
      * To access the value of rational constants, we provide two functions:
@@ -396,14 +518,45 @@ public final class Yices {
     private static native byte[] rationalConstNumAsBytes(int x); // null for error
     private static native byte[] rationalConstDenAsBytes(int x); // null for error
 
+    // numerator and denominator in one call (cf. limbsToRational), null for error
+    private static native long[] rationalConstLimbs(int x);
+
     public static BigRational rationalConstValue(int x) {
-        byte[] num = rationalConstNumAsBytes(x);
-        byte[] den = rationalConstDenAsBytes(x);
-        if (num != null && den != null) {
-            return new BigRational(num, den);
-        } else {
-            return null;
+        long[] r = rationalConstLimbs(x);
+        return r != null ? limbsToRational(r) : null;
+    }
+
+    /*
+     * Conversion of the limb arrays returned by the rational natives:
+     * - if the numerator and denominator fit in 64 bits, the array is { num, den }
+     * - otherwise it's { sign, k, num[0 ... k-1], den[0 ...] } where num and den are
+     *   the magnitudes as 64-bit limbs, least significant first
+     */
+    static BigRational limbsToRational(long[] r) {
+        if (r.length == 2) {
+            return new BigRational(BigInteger.valueOf(r[0]), BigInteger.valueOf(r[1]));
         }
+        int k = (int) r[1];
+        BigInteger num = limbsToBigInteger((int) r[0], r, 2, k);
+        BigInteger den = limbsToBigInteger(1, r, 2 + k, r.length - 2 - k);
+        return new BigRational(num, den);
+    }
+
+    private static BigInteger limbsToBigInteger(int sign, long[] a, int offset, int n) {
+        if (n == 0) return BigInteger.ZERO;
+        if (n == 1 && a[offset] >= 0) {
+            BigInteger x = BigInteger.valueOf(a[offset]);
+            return sign < 0 ? x.negate() : x;
+        }
+        byte[] b = new byte[8 * n];
+        for (int i = 0; i < n; i++) {
+            long limb = a[offset + i];
+            int base = 8 * (n - 1 - i);
+            for (int j = 0; j < 8; j++) {
+                b[base + j] = (byte) (limb >>> (56 - 8 * j));
+            }
+        }
+        return new BigInteger(sign, b);
     }
 
     /*
@@ -427,6 +580,16 @@ public final class Yices {
     // Parsing of a term (Yices syntax)
     public static native int parseTerm(String s);
 
+    /*
+     * Batch parsing of the terms (or types if types is true) in a UTF-8 buffer (cf. ParseBatch)
+     * - the items are the top-level atoms or parenthesized expressions
+     * - each item takes six entries in the result: term, error code, start, end, line, column
+     * - result[0] = number of items
+     * These return null if offset or n are out of bounds (or if buffer isn't direct).
+     */
+    public static native int[] parseBatch(byte[] a, int offset, int n, boolean types);
+    public static native int[] parseBatchBuffer(ByteBuffer buffer, int offset, int n, boolean types);
+
     /*
      * Substitutions
      *
@@ -440,6 +603,24 @@ public final class Yices {
     public static native int substTerm(int t, int[] v, int[] map);
     public static native int substTermArray(int[] a, int[] v, int[] map);
 
+    /*
+     * Reusable substitutions (cf. Substitution)
+     * - newSubstitution(v, map) checks the substitution and returns a pointer to it,
+     *   or 0 if there's an error
+     * - substitutionApply(s, t) returns the image of t or -1
+     *   (or -2 if s was created before reset: then s can only be freed)
+     * - substitutionApplyArray(s, a, off, n) replaces a[off ... off+n-1] by their images.
+     *   It returns 0 if this works, -1 otherwise (and a is unchanged).
+     * - substitutionStats(s, stats) stores the number of memo hits, misses, and
+     *   the size of the memo table in stats[0 ... 2]
+     */
+    public static native long newSubstitution(int[] v, int[] map);
+    public static native void freeSubstitution(long s);
+    public static native int substitutionApply(long s, int t);
+    public static native int substitutionApplyArray(long s, int[] a, int off, int n);
+    public static native void substitutionStats(long s, long[] stats);
+    public static native void substitutionClear(long s);
+
 
     /*
      * GARBAGE COLLECTION
@@ -454,7 +635,27 @@ public final class Yices {
     public static native int yicesNumPosrefTerms();
     public static native int yicesNumPosrefTypes();
 
-    public static native void yicesGarbageCollect(int[] rootTerms, int[] rootTypes, boolean keepNamed);
+    /*
+     * Batched incref/decref: see RefQueue for the encoding of ops.
+     * Returns the number of updates that failed or -1 if n is out of bounds.
+     */
+    public static native int updateRefs(int[] ops, int n);
+
+    private static native void garbageCollect(int[] rootTerms, int[] rootTypes, boolean keepNamed);
+
+    /*
+     * The pending reference-counter updates of TermHandles and TypeHandles
+     * are applied before the garbage collector runs. Holding the queue's
+     * lock ensures that no new handle is waiting for its incref.
+     */
+    public static void yicesGarbageCollect(int[] rootTerms, int[] rootTypes, boolean keepNamed) {
+        synchronized (RefQueue.class) {
+            RefQueue.flush();
+            garbageCollect(rootTerms, rootTypes, keepNamed);
+            Terms.clearInfoCache();
+            QueryCache.garbageCollected();
+        }
+    }
 
     public static void yicesGarbageCollect(boolean keepNamed) {
 	yicesGarbageCollect(null, null, keepNamed);
@@ -482,6 +683,7 @@ public final class Yices {
     public static native int contextDisableOption(long ctx, String option);
     public static native int assertFormula(long ctx, int t);
     public static native int assertFormulas(long ctx, int[] t);
+    public static native int assertFormulas(long ctx, IntBuffer t, int offset, int n); // t must be a direct buffer
     public static native int checkContext(long ctx, long params);
     // since 2.?.?  (new in the 2.6.4 bindings)
     public static native int checkContextWithAssumptions(long ctx, long params, int[] t);
@@ -504,6 +706,19 @@ public final class Yices {
     // since 2.6.4
     public static native int getModelInterpolant(long ctx);
 
+    /*
+     * Batch of checks with assumptions: assumption set i is assumptions[offsets[i] ... offsets[i+1]-1]
+     * - for each UNSAT set, the result contains the unsat core
+     * - for each SAT set, the result contains the values of modelTerms (as constant terms)
+     *   modelTerms may be null
+     * - budget = time limit in nanoseconds, checked before each set (0 means no limit)
+     * - a set whose check fails gets status ERROR and the batch continues
+     * Returns r where r[0] = m = number of sets processed, r[1 ... m] = statuses,
+     * and r[m+1 ... 2m+1] = offsets in r of the cores or values for each set.
+     * Returns null if the offsets are not valid.
+     */
+    public static native int[] checkWithAssumptionsBatch(long ctx, long params, int[] offsets, int[] assumptions, int[] modelTerms, long budget);
+
     /*
      * MODELS
      */
@@ -528,6 +743,26 @@ public final class Yices {
     // since  2.6.4
     public static native int modelSetBVFromArray(long model, int var, int[] arr);
 
+    // since 2.6.4: packed variants (same layout as in bvConstFromWords/bvConstFromBytes)
+    // the number of bits is the bitsize of var
+    public static native int modelSetBVFromWords(long model, int var, long[] w);
+    public static native int modelSetBVFromBytes(long model, int var, ByteBuffer b, int offset);
+
+    /*
+     * since 2.6.4: bulk setters
+     * - vars[i] gets the value stored in values at index i (modelSetBools, modelSetIntegers,
+     *   modelSetBVIntegers), at index 2i and 2i+1 (numerator and denominator in modelSetRationals),
+     *   or in the next (bitsize(vars[i]) + 63)/64 words (modelSetBVWords)
+     * - the result is the number of variables assigned: if it's less than vars.length,
+     *   then the assignment of vars[result] failed and the error report says why
+     * - the result is -1 if values is too small (-2 if words is too small for modelSetBVWords)
+     */
+    public static native int modelSetBools(long model, int[] vars, boolean[] values);
+    public static native int modelSetIntegers(long model, int[] vars, long[] values);
+    public static native int modelSetRationals(long model, int[] vars, long[] values);
+    public static native int modelSetBVIntegers(long model, int[] vars, long[] values);
+    public static native int modelSetBVWords(long model, int[] vars, long[] words);
+
     // since 2.?.?  (new in the 2.6.4 bindings)
     public static native int[] modelCollectDefinedTerms(long model);
 
@@ -562,20 +797,25 @@ public final class Yices {
 	    return val != null ? new BigInteger(val) : null;
     }
 
+    // numerator and denominator in one call (cf. limbsToRational), null for error
+    private static native long[] getRationalValueLimbs(long model, int t);
+
     public static BigRational getRationalValue(long model, int t) {
-        byte[] num = getRationalValueNumAsBytes(model, t);
-        byte[] den = getRationalValueDenAsBytes(model, t);
-        if (num != null && den != null) {
-            return new BigRational(num, den);
-        } else {
-            return null;
-        }
+        long[] r = getRationalValueLimbs(model, t);
+        return r != null ? limbsToRational(r) : null;
     }
 
     // Value of a bitvector term: the result is little endian
     // return null if there's an error
     public static native boolean[] getBvValue(long model, int t);
 
+    // Packed variants: the first one returns null if there's an error.
+    // The second one stores the value in the direct buffer b, from the given offset,
+    // and returns the number of bytes written, or -1 for error (it throws
+    // IllegalArgumentException if b is not direct or too small).
+    public static native long[] getBvValueWords(long model, int t);
+    public static native int getBvValueBytes(long model, int t, ByteBuffer b, int offset);
+
     // Value (i.e., index) of a scalar or uninterpreted term
     // return -1 if there's an error.
     public static native int getScalarValue(long model, int t);
@@ -603,6 +843,39 @@ public final class Yices {
      */
     public static native int valuesAsTerms(long model, int[] in, int[] out);
 
+    /*
+     * Bulk evaluation: values of terms t[0 ... n-1] in model
+     * - values and kinds must have length >= n
+     * - bits is used for bitvector values (it can be null if there are none)
+     *
+     * kinds[i] is one of the codes defined in ModelValues and
+     * values[i] is either the value of t[i] or an offset in bits:
+     * see ModelValues.java for details.
+     *
+     * Returns the number of elements of bits that are needed, or -1 for error.
+     * If this number is larger than bits.length, nothing is stored and the
+     * call must be repeated with a larger array.
+     */
+    public static native int getValues(long model, int[] t, long[] values, byte[] kinds, long[] bits);
+
+    /*
+     * Enumerate up to maxModels models of context ctx, blocking the values of the
+     * projection terms after each model (or the whole model if projection is empty).
+     * - budget = time limit in nanoseconds (0 or negative means no limit). It's checked
+     *   between models: use stopSearch to interrupt a long check.
+     * - the results are stored in out[0 ... 3] = values, kinds, bits, valueTerms
+     *   (bits is null if there are no bitvector terms): the values of the projection
+     *   terms in model i are in row i (indices i * k ... i * k + k - 1 where
+     *   k = projection.length), as in getValues except that the bitvector offsets in
+     *   row i are relative to i * nwords in bits. The arrays have one row per model found.
+     * - info[0] = status of the last check (ERROR if an error stopped the enumeration),
+     *   info[1] = nwords
+     * Returns the number of models found (even if there was an error afterwards),
+     * or -1 if the arguments are invalid.
+     */
+    public static native int enumerateModels(long ctx, long params, int[] projection, int maxModels, long budget,
+                                             Object[] out, int[] info);
+
     /*
      * Export the model as a String (pretty printing).
      *
@@ -614,6 +887,24 @@ public final class Yices {
     public static native String modelToString(long model, int numColumns, int numLines);
     public static native String modelToString(long model);
 
+    /*
+     * Pretty printing without building a String (cf. PrintedText)
+     * - negative numColumns or numLines mean 80 columns and no limit on the number of lines
+     * - modelToBuffer and termToBuffer copy the text in dst[offset ... offset + capacity - 1]
+     *   (dst must be a direct buffer). They return the size of the text and copy
+     *   nothing if it's more than capacity. They return -1 if the printer fails,
+     *   -3 if the text can't be stored in memory, and throw IllegalArgumentException
+     *   if dst is not direct or too small.
+     * - modelToMappedBuffer and termToMappedBuffer return the text as a direct buffer to
+     *   be released by freeMappedBuffer. code[0] is 0 if this works or -1/-3 as above.
+     *   The result is null if there's an error or the text is empty.
+     */
+    public static native long modelToBuffer(long model, int numColumns, int numLines, ByteBuffer dst, int offset, int capacity);
+    public static native long termToBuffer(int t, int numColumns, int numLines, ByteBuffer dst, int offset, int capacity);
+    public static native ByteBuffer modelToMappedBuffer(long model, int numColumns, int numLines, int[] code);
+    public static native ByteBuffer termToMappedBuffer(int t, int numColumns, int numLines, int[] code);
+    public static native void freeMappedBuffer(ByteBuffer buffer);
+
 
     /*
      * Check whether the given delegate is supported
@@ -728,6 +1019,20 @@ public final class Yices {
      */
     public static native int exportToDimacs(int[] terms, String filename, boolean simplify_cnf, int[] status);
 
+    /*
+     * Bit-blast n formulas then export the CNF to memory
+     * - result must have length at least 2
+     *   result[0] = 1 if the CNF was constructed, 0 if the formulas were solved,
+     *               a negative number if there's an error (-3 means the CNF could not be
+     *               stored in memory)
+     *   result[1] = the ordinal of the formulas' status
+     * - returns a direct buffer that contains the DIMACS text, or null if there's
+     *   no CNF (or it's empty). The buffer is mapped read-only: it must not be
+     *   written to, and it must be freed by freeDimacsBuffer (cf. DimacsBuffer).
+     */
+    public static native ByteBuffer exportToDimacsBuffer(int[] terms, boolean simplify_cnf, int[] result);
+    public static native void freeDimacsBuffer(ByteBuffer buffer);
+
     /*
      * Given a term t and a model 'model', the support of t in model is a set of uninterpreted
      * terms whose values are sufficient to fix the value of t in model. For example, if
@@ -737,6 +1042,19 @@ public final class Yices {
     public static native int[] getSupport(long model, int term);
     public static native int[] getSupport(long model, int[] terms);
 
+    /*
+     * Batched implicants, generalizations, or supports: the same terms in many models
+     * - op = 0 for implicantForFormulas, 1 for generalizeModel, 2 for getSupport
+     * - elims and mode are used only by generalizeModel (elims may be null)
+     * - threads = number of threads to use (the call is sequential if threads <= 1
+     *   or if Yices is not thread safe)
+     * Returns r where r[0] = n = number of models, r[1 ... n] = 0 or -1 if the operation
+     * failed on that model, and r[n+1 ... 2n+1] = offsets in r of the result for each model.
+     * If an operation failed, the error report is the one of the first model that failed.
+     * Returns null if op is not valid or a model pointer is 0.
+     */
+    public static native int[] modelBatch(int op, long[] models, int[] terms, int[] elims, int mode, int threads);
+
     public static native YVal getValue(long model, int term);
 
     public static native boolean valIsInt(long model, int tag, int id);
@@ -787,14 +1105,11 @@ public final class Yices {
 	    return val != null ? new BigInteger(val) : null;
     }
 
+    private static native long[] valGetRationalLimbs(long model, int tag, int id);
+
     public static BigRational valGetRational(long model, int tag, int id) {
-        byte[] num = valGetRationalNumAsBytes(model, tag, id);
-        byte[] den = valGetRationalDenAsBytes(model, tag, id);
-        if (num != null && den != null) {
-            return new BigRational(num, den);
-        } else {
-            return null;
-        }
+        long[] r = valGetRationalLimbs(model, tag, id);
+        return r != null ? limbsToRational(r) : null;
     }
 
 
@@ -826,6 +1141,10 @@ public final class Yices {
     // public static native int yices_val_expand_mapping(model_t *model, const yval_t *m, yval_t tup[], yval_t *val);
     public static native int valExpandMapping(long model, int tag, int id, YVal[] args, YVal[] value);
 
+    // Flattened DAG of the values of terms in model (see ValueSnapshot for the layout).
+    // Returns null if there's an error.
+    public static native long[] valSnapshot(long model, int[] terms);
+
 
     /* <TooHardBasket> */
     // public static native int yices_val_get_algebraic_number(model_t *model, const yval_t *v, lp_algebraic_number_t *a);
@@ -25,6 +25,12 @@ public class YicesException extends RuntimeException {
         this.errorReport = new ErrorReport();
     }
 
+    // exception for an error stashed in no-throw mode (cf. NoThrow.error)
+    YicesException(String message, ErrorReport report) {
+        super(message);
+        this.errorReport = report;
+    }
+
     /**
      * We use this to create an exception to throw if an operation requires a more recent 
      * version of yices.
@@ -1,3 +1,12 @@
+/*
+ * This file is compiled on Linux, macOS, and Windows (with MinGW).
+ * For Windows, MINGW selects the casts between jint and int32_t
+ * (jint is long there) and _WIN32 replaces the POSIX memory files.
+ */
+#if defined(__MINGW32__) && !defined(MINGW)
+#define MINGW
+#endif
+
 #include <jni.h>
 #include <assert.h>
 #include <gmp.h>
@@ -6,6 +15,38 @@
 
 #include <new>
 #include <limits>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <system_error>
+#include <unordered_map>
+#include <string>
+#include <string.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+// for the DIMACS export and printing to memory
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
 
 #include "com_sri_yices_Yices.h"
 
@@ -31,11 +72,180 @@
 #define YICES_ERROR_REQUIRES_AT_LEAST_2_6_2  -262
 #define YICES_ERROR_REQUIRES_AT_LEAST_2_6_4  -264
 
+/*
+ * Native call tracing
+ *
+ * If the library is built with -DYICES_JNI_TRACE (make TRACE=1), every native
+ * starts with TRACE_NATIVE(). When tracing is enabled at runtime (see
+ * setNativeTracing), this records for each native:
+ * - the number of calls
+ * - the total time spent in the native (in nanoseconds)
+ * - the part of that time spent converting arguments and results between Java
+ *   and C (i.e., in the helpers that contain a TRACE_MARSHAL() scope).
+ * The rest is mostly time spent in Yices.
+ *
+ * The counters are per thread so updating them does not require synchronization.
+ * The counters of a thread are added to trace_retired when the thread exits.
+ *
+ * Without YICES_JNI_TRACE, TRACE_NATIVE() and TRACE_MARSHAL() expand to nothing.
+ */
+#ifdef YICES_JNI_TRACE
+
+#include <mutex>
+
+#define TRACE_MAX_NATIVES 1024
+
+static inline uint64_t trace_clock() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * Counters for one thread
+ * - only the owner thread writes them, other threads read them when
+ *   collecting statistics (hence the relaxed atomics)
+ */
+class trace_counters {
+ public:
+  std::atomic<uint64_t> calls[TRACE_MAX_NATIVES];
+  std::atomic<uint64_t> total[TRACE_MAX_NATIVES];
+  std::atomic<uint64_t> marshal[TRACE_MAX_NATIVES];
+
+  trace_counters() { clear(); }
+
+  void clear() {
+    for (int32_t i=0; i<TRACE_MAX_NATIVES; i++) {
+      calls[i].store(0, std::memory_order_relaxed);
+      total[i].store(0, std::memory_order_relaxed);
+      marshal[i].store(0, std::memory_order_relaxed);
+    }
+  }
+};
+
+static inline void trace_add(std::atomic<uint64_t> &c, uint64_t x) {
+  c.store(c.load(std::memory_order_relaxed) + x, std::memory_order_relaxed);
+}
+
+static std::atomic<bool> trace_enabled(false);
+static std::mutex trace_lock;               // protects everything below
+static const char *trace_names[TRACE_MAX_NATIVES];
+static std::atomic<int32_t> trace_count(0);
+static trace_counters trace_retired;
+
+/*
+ * Per-thread state: counters + the native being traced
+ * - all live thread states are in a doubly-linked list
+ */
+class trace_thread {
+ public:
+  trace_counters *counters;
+  int32_t current;
+  int32_t marshal_depth;
+  trace_thread *prev, *next;
+
+  trace_thread(): counters(NULL), current(-1), marshal_depth(0), prev(NULL), next(NULL) {}
+  ~trace_thread();
+
+  trace_counters *get_counters();
+};
+
+static trace_thread *trace_threads = NULL;
+
+trace_counters *trace_thread::get_counters() {
+  if (counters == NULL) {
+    counters = new trace_counters();
+    std::lock_guard<std::mutex> guard(trace_lock);
+    next = trace_threads;
+    if (next != NULL) next->prev = this;
+    trace_threads = this;
+  }
+  return counters;
+}
+
+trace_thread::~trace_thread() {
+  if (counters != NULL) {
+    std::lock_guard<std::mutex> guard(trace_lock);
+    for (int32_t i=0; i<TRACE_MAX_NATIVES; i++) {
+      trace_add(trace_retired.calls[i], counters->calls[i].load(std::memory_order_relaxed));
+      trace_add(trace_retired.total[i], counters->total[i].load(std::memory_order_relaxed));
+      trace_add(trace_retired.marshal[i], counters->marshal[i].load(std::memory_order_relaxed));
+    }
+    if (prev != NULL) prev->next = next; else trace_threads = next;
+    if (next != NULL) next->prev = prev;
+    delete counters;
+  }
+}
+
+static thread_local trace_thread trace_state;
+
+/*
+ * Give an id to a native: this is called once per native (function-local static)
+ * - return -1 if there are too many natives
+ */
+static int32_t trace_register(const char *name) {
+  std::lock_guard<std::mutex> guard(trace_lock);
+  int32_t id = trace_count.load();
+  if (id >= TRACE_MAX_NATIVES) return -1;
+  trace_names[id] = name;
+  trace_count.store(id + 1);
+  return id;
+}
+
+class native_probe {
+  int32_t id;
+  int32_t saved;
+  uint64_t start;
+ public:
+  explicit native_probe(int32_t i): id(-1), saved(-1), start(0) {
+    if (i >= 0 && trace_enabled.load(std::memory_order_relaxed)) {
+      id = i;
+      saved = trace_state.current;
+      trace_state.current = i;
+      start = trace_clock();
+    }
+  }
+  ~native_probe() {
+    if (id >= 0) {
+      trace_counters *c = trace_state.get_counters();
+      trace_add(c->calls[id], 1);
+      trace_add(c->total[id], trace_clock() - start);
+      trace_state.current = saved;
+    }
+  }
+};
+
+class marshal_probe {
+  bool active;
+  uint64_t start;
+ public:
+  marshal_probe(): active(false), start(0) {
+    if (trace_state.current >= 0 && trace_state.marshal_depth++ == 0) {
+      active = true;
+      start = trace_clock();
+    }
+  }
+  ~marshal_probe() {
+    if (trace_state.current >= 0 && --trace_state.marshal_depth == 0 && active) {
+      trace_add(trace_state.get_counters()->marshal[trace_state.current], trace_clock() - start);
+    }
+  }
+};
+
+#define TRACE_NATIVE() static const int32_t trace_id_ = trace_register(__func__); native_probe trace_probe_(trace_id_)
+#define TRACE_MARSHAL() marshal_probe trace_marshal_
+
+#else
+
+#define TRACE_NATIVE()
+#define TRACE_MARSHAL()
+
+#endif
+
 /**
  *  Assumes that for each __YICES_VERSION __YICES_VERSION_MAJOR and __YICES_VERSION_PATCHLEVEL
  * are between 0 and less than 100.
  */
 JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_versionOrdinal(JNIEnv *env, jclass){
+  TRACE_NATIVE();
   return (10000 * __YICES_VERSION) + (100 * __YICES_VERSION_MAJOR) + __YICES_VERSION_PATCHLEVEL;
 }
 
@@ -60,6 +270,7 @@ JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_versionOrdinal(JNIEnv *env, jcl
  */
 
 static inline int32_t *array2int32(JNIEnv *env, jintArray a, jboolean *copy){
+  TRACE_MARSHAL();
 #ifdef MINGW
   return reinterpret_cast<int32_t *>(env->GetIntArrayElements(a, copy));
 #else
@@ -76,6 +287,7 @@ static inline type_t *array2types(JNIEnv *env, jintArray a, jboolean *copy){
 }
 
 static inline void release_int32_elems(JNIEnv *env, jintArray a, int32_t *ptr, jint mode){
+  TRACE_MARSHAL();
 #ifdef MINGW
   env->ReleaseIntArrayElements(a, reinterpret_cast<jint*>(ptr), mode);
 #else
@@ -100,22 +312,221 @@ static inline void release_type_elems(JNIEnv *env, jintArray a, type_t *ptr){
 }
 
 static inline void array2int_region(JNIEnv *env, jintArray a, jsize start, jsize end, int32_t *ptr){
+  TRACE_MARSHAL();
 #ifdef MINGW
-  env->GetIntArrayRegions(a, start, end, reinterpret_cast<jint*>(ptr));
+  env->GetIntArrayRegion(a, start, end, reinterpret_cast<jint*>(ptr));
 #else
   env->GetIntArrayRegion(a, start, end, ptr);
 #endif
 }
 
 static inline void set_int_region(JNIEnv *env, jintArray a, jsize start, jsize end, const int32_t *ptr){
+  TRACE_MARSHAL();
 #ifdef MINGW
-  env->SetIntArrayRegions(a, start, end, reinterpret_cast<jint*>(ptr));
+  env->SetIntArrayRegion(a, start, end, reinterpret_cast<const jint*>(ptr));
 #else
   env->SetIntArrayRegion(a, start, end, ptr);
 #endif
 }
 
 
+/*
+ * RAII guards for JNI resources
+ * - utf_chars holds the modified UTF-8 characters of a Java string
+ * - pinned_array<A> holds the elements of a Java array of type A (jintArray,
+ *   jlongArray, jbyteArray, or jbooleanArray)
+ *
+ * The destructor releases the resource, so an early return or an exception
+ * can't leak it. get() is NULL if the Java object is null or if the JVM could
+ * not provide the data (then an OutOfMemoryError is pending).
+ *
+ * Array elements are released with JNI_ABORT (the Java array is unchanged)
+ * unless commit() is called. For int arrays, ints() gives the elements as
+ * int32_t* (or term_t*, type_t*): this hides the jint/int32_t mismatch on Windows.
+ */
+class utf_chars {
+ public:
+  utf_chars(JNIEnv *env, jstring s): env(env), s(s), chars(NULL) {
+    TRACE_MARSHAL();
+    if (s != NULL) chars = env->GetStringUTFChars(s, NULL);
+  }
+
+  ~utf_chars() {
+    if (chars != NULL) env->ReleaseStringUTFChars(s, chars);
+  }
+
+  const char *get() const { return chars; }
+
+  utf_chars(const utf_chars &) = delete;
+  utf_chars &operator=(const utf_chars &) = delete;
+
+ private:
+  JNIEnv *env;
+  jstring s;
+  const char *chars;
+};
+
+template <typename A> struct array_ops;
+
+template <> struct array_ops<jintArray> {
+  typedef jint elem;
+  static elem *get(JNIEnv *env, jintArray a) { return env->GetIntArrayElements(a, NULL); }
+  static void release(JNIEnv *env, jintArray a, elem *p, jint mode) { env->ReleaseIntArrayElements(a, p, mode); }
+};
+
+template <> struct array_ops<jlongArray> {
+  typedef jlong elem;
+  static elem *get(JNIEnv *env, jlongArray a) { return env->GetLongArrayElements(a, NULL); }
+  static void release(JNIEnv *env, jlongArray a, elem *p, jint mode) { env->ReleaseLongArrayElements(a, p, mode); }
+};
+
+template <> struct array_ops<jbyteArray> {
+  typedef jbyte elem;
+  static elem *get(JNIEnv *env, jbyteArray a) { return env->GetByteArrayElements(a, NULL); }
+  static void release(JNIEnv *env, jbyteArray a, elem *p, jint mode) { env->ReleaseByteArrayElements(a, p, mode); }
+};
+
+template <> struct array_ops<jbooleanArray> {
+  typedef jboolean elem;
+  static elem *get(JNIEnv *env, jbooleanArray a) { return env->GetBooleanArrayElements(a, NULL); }
+  static void release(JNIEnv *env, jbooleanArray a, elem *p, jint mode) { env->ReleaseBooleanArrayElements(a, p, mode); }
+};
+
+template <typename A>
+class pinned_array {
+ public:
+  typedef typename array_ops<A>::elem elem;
+
+  pinned_array(JNIEnv *env, A a): env(env), array(a), data(NULL), size(0), mode(JNI_ABORT) {
+    TRACE_MARSHAL();
+    if (a != NULL) {
+      size = env->GetArrayLength(a);
+      data = array_ops<A>::get(env, a);
+    }
+  }
+
+  ~pinned_array() {
+    if (data != NULL) array_ops<A>::release(env, array, data, mode);
+  }
+
+  elem *get() const { return data; }
+  int32_t *ints() const { return reinterpret_cast<int32_t *>(data); }
+  jsize length() const { return size; }
+
+  // copy the elements back into the Java array when they're released
+  void commit() { mode = 0; }
+
+  pinned_array(const pinned_array &) = delete;
+  pinned_array &operator=(const pinned_array &) = delete;
+
+ private:
+  JNIEnv *env;
+  A array;
+  elem *data;
+  jsize size;
+  jint mode;
+};
+
+
+/*
+ * Classes and method ids used by the natives
+ *
+ * They are resolved once in JNI_OnLoad and kept as global references
+ * (rather than calling FindClass/GetMethodID every time we create an object
+ * or throw an exception). The references are released in JNI_OnUnload.
+ */
+static jclass out_of_mem_class = NULL;          // com.sri.yices.OutOfMemory (or java.lang.OutOfMemoryError)
+static jclass illegal_arg_class = NULL;         // java.lang.IllegalArgumentException
+static jclass string_class = NULL;              // java.lang.String
+static jclass yval_class = NULL;                // com.sri.yices.YVal
+static jmethodID yval_init = NULL;              // YVal(int tag, int id)
+static jclass error_report_class = NULL;        // com.sri.yices.ErrorReport
+static jmethodID error_report_init = NULL;      // ErrorReport(int, int, int, int, int, int, int, long)
+static jclass big_integer_class = NULL;         // java.math.BigInteger
+static jmethodID big_integer_signum = NULL;
+static jmethodID big_integer_to_byte_array = NULL;
+
+/*
+ * Global reference to class name
+ * - return NULL if the class can't be found (and clear the pending exception)
+ */
+static jclass global_class_ref(JNIEnv *env, const char *name) {
+  jclass c = env->FindClass(name);
+  if (c == NULL) {
+    env->ExceptionClear();
+    return NULL;
+  }
+  jclass g = static_cast<jclass>(env->NewGlobalRef(c));
+  env->DeleteLocalRef(c);
+  return g;
+}
+
+static void delete_global_refs(JNIEnv *env) {
+  if (out_of_mem_class != NULL) env->DeleteGlobalRef(out_of_mem_class);
+  if (illegal_arg_class != NULL) env->DeleteGlobalRef(illegal_arg_class);
+  if (string_class != NULL) env->DeleteGlobalRef(string_class);
+  if (yval_class != NULL) env->DeleteGlobalRef(yval_class);
+  if (error_report_class != NULL) env->DeleteGlobalRef(error_report_class);
+  if (big_integer_class != NULL) env->DeleteGlobalRef(big_integer_class);
+  out_of_mem_class = NULL;
+  illegal_arg_class = NULL;
+  string_class = NULL;
+  yval_class = NULL;
+  error_report_class = NULL;
+  big_integer_class = NULL;
+  yval_init = NULL;
+  error_report_init = NULL;
+  big_integer_signum = NULL;
+  big_integer_to_byte_array = NULL;
+}
+
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm, void *) {
+  JNIEnv *env;
+
+  if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) != JNI_OK) {
+    return JNI_ERR;
+  }
+
+  out_of_mem_class = global_class_ref(env, "com/sri/yices/OutOfMemory");
+  if (out_of_mem_class == NULL) out_of_mem_class = global_class_ref(env, "java/lang/OutOfMemoryError");
+  illegal_arg_class = global_class_ref(env, "java/lang/IllegalArgumentException");
+  string_class = global_class_ref(env, "java/lang/String");
+  yval_class = global_class_ref(env, "com/sri/yices/YVal");
+  error_report_class = global_class_ref(env, "com/sri/yices/ErrorReport");
+  big_integer_class = global_class_ref(env, "java/math/BigInteger");
+
+  if (yval_class != NULL) {
+    yval_init = env->GetMethodID(yval_class, "<init>", "(II)V");
+  }
+  if (error_report_class != NULL) {
+    error_report_init = env->GetMethodID(error_report_class, "<init>", "(IIIIIIIJ)V");
+  }
+  if (big_integer_class != NULL) {
+    big_integer_signum = env->GetMethodID(big_integer_class, "signum", "()I");
+    big_integer_to_byte_array = env->GetMethodID(big_integer_class, "toByteArray", "()[B");
+  }
+
+  if (out_of_mem_class == NULL || illegal_arg_class == NULL || string_class == NULL ||
+      yval_init == NULL || error_report_init == NULL ||
+      big_integer_signum == NULL || big_integer_to_byte_array == NULL) {
+    // System.loadLibrary will fail with an UnsatisfiedLinkError
+    env->ExceptionClear();
+    delete_global_refs(env);
+    return JNI_ERR;
+  }
+
+  return JNI_VERSION_1_6;
+}
+
+JNIEXPORT void JNICALL JNI_OnUnload(JavaVM *vm, void *) {
+  JNIEnv *env;
+
+  if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) == JNI_OK) {
+    delete_global_refs(env);
+  }
+}
+
+
 /*
  * Out-of-memory handler: throws a C++ exception
  * that we can catch and convert to a Java exception.
@@ -132,17 +543,12 @@ static void throw_out_of_mem_exception() {
  * Code that throws the Java exception
  */
 static void out_of_mem_exception(JNIEnv *env) {
-  jclass e;
-  jint code;
-
-  code = 0;
-  e = env->FindClass("com/sri/yices/OutOfMemory");
-  if (e == NULL) e = env->FindClass("java/lang/OutOfMemoryError");
+  jint code = -1;
 
-  if (e != NULL) {
-    code = env->ThrowNew(e, NULL);
+  if (out_of_mem_class != NULL) {
+    code = env->ThrowNew(out_of_mem_class, NULL);
   }
-  if (e == NULL || code < 0) {
+  if (code < 0) {
     // Something went  badly wrong.
     // We check whether an exception is pending. If not we report a fatal error
     if (! env->ExceptionCheck()) {
@@ -151,12 +557,20 @@ static void out_of_mem_exception(JNIEnv *env) {
   }
 }
 
+/*
+ * For invalid arguments that Yices doesn't see (so no Yices error is set)
+ */
+static void illegal_argument_exception(JNIEnv *env, const char *msg) {
+  env->ThrowNew(illegal_arg_class, msg);
+}
+
 
 /*
  * Convert array a of size n into a Java Int array
  * - return NULL if we can't allocate the new array and throw an exception
  */
 static jintArray convertToIntArray(JNIEnv *env, int32_t n, const int32_t *a) {
+  TRACE_MARSHAL();
   jintArray b;
 
   b = env->NewIntArray(n);
@@ -168,11 +582,26 @@ static jintArray convertToIntArray(JNIEnv *env, int32_t n, const int32_t *a) {
   return b;
 }
 
+static jlongArray convertToLongArray(JNIEnv *env, int32_t n, const jlong *a) {
+  TRACE_MARSHAL();
+  jlongArray b;
+
+  b = env->NewLongArray(n);
+  if (b == NULL) {
+    out_of_mem_exception(env);
+  } else {
+    env->SetLongArrayRegion(b, 0, n, a);
+  }
+  return b;
+}
+
+
 
 /*
  * Convert a string (s may be NULL);
  */
 static jstring convertToString(JNIEnv *env, const char *s) {
+  TRACE_MARSHAL();
   jstring b = NULL;
 
   if (s != NULL) {
@@ -191,20 +620,21 @@ static jstring convertToString(JNIEnv *env, const char *s) {
  * - a[i] is converted to false if a[i] = 0 or to true if a[i] != 0
  */
 static jbooleanArray convertToBoolArray(JNIEnv *env, int32_t n, const int32_t *a) {
+  TRACE_MARSHAL();
   jbooleanArray b;
 
   b = env->NewBooleanArray(n);
   if (b == NULL) {
     out_of_mem_exception(env);
   } else {
-    jboolean *aux = env->GetBooleanArrayElements(b, NULL);
-    if (aux == NULL) {
+    pinned_array<jbooleanArray> aux(env, b);
+    if (aux.get() == NULL) {
       out_of_mem_exception(env);
     } else {
       for (int32_t i = 0; i<n; i++) {
-        aux[i] = (a[i] != 0);
+        aux.get()[i] = (a[i] != 0);
       }
-      env->ReleaseBooleanArrayElements(b, aux, 0); // copy back
+      aux.commit(); // copy back
     }
   }
 
@@ -212,44 +642,207 @@ static jbooleanArray convertToBoolArray(JNIEnv *env, int32_t n, const int32_t *a
 }
 
 /*
- * Clone array a: make a copy
- * - return NULL and throw an exception if we can't clone
- * - the JVM may make a copy already. In this case, we just store "true" in *copy
- * - otherwise, we allocate an auxiliary array, copy a into it, and store "false" in *copy
+ * Conversion between arrays of bits (one int per bit) and packed words
+ * - W is an unsigned integer type (uint64_t or uint8_t)
+ * - bit i is stored as bit (i % k) of w[i/k] where k = number of bits in W
+ *   (so the words are little endian)
+ * - w must have room for (n + k - 1)/k words
  */
-static int32_t *cloneIntArray(JNIEnv *env, jintArray a, jboolean *copy) {
-  int32_t *aux = NULL;
+template <typename W>
+static void pack_bits(uint32_t n, const int32_t *a, W *w) {
+  const uint32_t k = 8 * sizeof(W);
+  uint32_t i, j, l;
+  W x;
+
+  for (l=0, i=0; i<n; l++) {
+    x = 0;
+    for (j=0; j<k && i<n; j++, i++) {
+      x |= static_cast<W>(static_cast<W>(a[i] != 0) << j);
+    }
+    w[l] = x;
+  }
+}
+
+template <typename W>
+static void unpack_bits(uint32_t n, const W *w, int32_t *a) {
+  const uint32_t k = 8 * sizeof(W);
+  uint32_t i, j, l;
+  W x;
+
+  for (l=0, i=0; i<n; l++) {
+    x = w[l];
+    for (j=0; j<k && i<n; j++, i++) {
+      a[i] = x & 1;
+      x >>= 1;
+    }
+  }
+}
+
+/*
+ * Scratch buffers
+ *
+ * Most natives that take an int array need a private copy of it, either because
+ * Yices may modify the array (e.g., yices_and and yices_distinct sort their
+ * arguments) or because GetIntArrayElements makes a copy anyway (HotSpot always
+ * copies). To avoid a malloc/free pair on every call, the array is copied with
+ * GetIntArrayRegion into a per-thread arena that is allocated once and reused.
+ * Requests larger than ARENA_MAX_SIZE, or made while the arena is in use, get a
+ * temporary heap buffer instead.
+ *
+ * We don't use GetPrimitiveArrayCritical: a Yices call can run for an arbitrarily
+ * long time and the JVM may not be able to collect garbage while a critical
+ * region is held.
+ */
+#define ARENA_INIT_SIZE 64
+#define ARENA_MAX_SIZE 65536
+
+class int_arena {
+ public:
+  int32_t *data;
+  jsize size;
+  bool busy;
 
-  aux = array2int32(env, a, copy);
-  if (aux == NULL) {
+  int_arena(): data(NULL), size(0), busy(false) {}
+  ~int_arena() { delete [] data; }
+};
+
+static thread_local int_arena arena;
+
+/*
+ * Return a buffer of at least n int32s
+ * - throw std::bad_alloc if we can't allocate it
+ * - the buffer must be freed by calling scratch_free
+ */
+static int32_t *scratch_alloc(jsize n) {
+  if (n <= ARENA_MAX_SIZE && !arena.busy) {
+    if (arena.size < n || arena.data == NULL) {
+      jsize size = ARENA_INIT_SIZE;
+      while (size < n) size <<= 1;
+      int32_t *b = new int32_t[size];
+      delete [] arena.data;
+      arena.data = b;
+      arena.size = size;
+    }
+    arena.busy = true;
+    return arena.data;
+  }
+  return new int32_t[n > 0 ? n : 1];
+}
+
+static void scratch_free(int32_t *b) {
+  if (b == arena.data) {
+    arena.busy = false;
+  } else {
+    delete [] b;
+  }
+}
+
+/*
+ * Copy a[0 ... n-1] into a scratch buffer
+ * - return NULL and throw an exception if we can't allocate the buffer
+ */
+static int32_t *scratch_copy(JNIEnv *env, jintArray a, jsize n) {
+  int32_t *b;
+
+  try {
+    b = scratch_alloc(n);
+  } catch (std::bad_alloc &ba) {
     out_of_mem_exception(env);
-  } else if (!copy) {
-    jsize n = env->GetArrayLength(a);
-    int32_t *b = aux;
+    return NULL;
+  }
+  array2int_region(env, a, 0, n, b);
+  return b;
+}
+
+/*
+ * Content of a direct IntBuffer: elements offset ... offset+n-1
+ * - return NULL and throw IllegalArgumentException if buffer is not a direct buffer
+ *   or if the range is out of bounds
+ * - the buffer must use the native byte order (this is checked on the Java side)
+ */
+static int32_t *direct_int_buffer(JNIEnv *env, jobject buffer, jint offset, jint n) {
+  int32_t *b = NULL;
+  if (buffer != NULL && offset >= 0 && n >= 0) {
+    b = static_cast<int32_t *>(env->GetDirectBufferAddress(buffer));
+  }
+  if (b == NULL || env->GetDirectBufferCapacity(buffer) < static_cast<jlong>(offset) + n) {
+    illegal_argument_exception(env, "invalid direct buffer");
+    return NULL;
+  }
+  return b + offset;
+}
+
+/*
+ * Same thing for a direct ByteBuffer: bytes offset ... offset+n-1
+ */
+static uint8_t *direct_byte_buffer(JNIEnv *env, jobject buffer, jint offset, jint n) {
+  uint8_t *b = NULL;
+  if (buffer != NULL && offset >= 0 && n >= 0) {
+    b = static_cast<uint8_t *>(env->GetDirectBufferAddress(buffer));
+  }
+  if (b == NULL || env->GetDirectBufferCapacity(buffer) < static_cast<jlong>(offset) + n) {
+    illegal_argument_exception(env, "invalid direct buffer");
+    return NULL;
+  }
+  return b + offset;
+}
+
+
+/*
+ * N-ary term constructors: f(n, a) where a is the content of arg.
+ *
+ * If f's argument is a const array, Yices does not modify it and the direct
+ * buffer variant can pass the buffer as is. Otherwise, f gets a copy.
+ */
+template <typename T>
+static jint nary_term(JNIEnv *env, term_t (*f)(uint32_t, T[]), jintArray arg) {
+  jint result = -1;
+  jsize n = env->GetArrayLength(arg);
+  term_t *a = scratch_copy(env, arg, n);
+
+  if (a != NULL) {
     try {
-      aux = new int32_t[n];
-      for (int32_t i=0; i<n; i++) {
-        aux[i] = b[i];
-      }
+      result = f(n, a);
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
-      aux = NULL;
     }
-    release_int32_elems(env, a, b);
+    scratch_free(a);
   }
+  return result;
+}
+
+static jint direct_nary_term(JNIEnv *env, term_t (*f)(uint32_t, const term_t[]), jobject buffer, jint offset, jint n) {
+  jint result = -1;
+  const term_t *a = direct_int_buffer(env, buffer, offset, n);
 
-  return aux;
+  if (a != NULL) {
+    try {
+      result = f(n, a);
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+  }
+  return result;
 }
 
-/*
- * Free memory used by the previous function if any
- */
-static void freeClonedIntArray(JNIEnv *env, jintArray a, int32_t *aux, jboolean *copy) {
-  if (copy) {
-    release_int32_elems(env, a, aux);
-  } else {
-    delete [] aux;
+static jint direct_nary_term(JNIEnv *env, term_t (*f)(uint32_t, term_t[]), jobject buffer, jint offset, jint n) {
+  jint result = -1;
+  const term_t *b = direct_int_buffer(env, buffer, offset, n);
+
+  if (b != NULL) {
+    term_t *a = NULL;
+    try {
+      a = scratch_alloc(n);
+      for (jint i=0; i<n; i++) {
+        a[i] = b[i];
+      }
+      result = f(n, a);
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+    if (a != NULL) scratch_free(a);
   }
+  return result;
 }
 
 
@@ -303,6 +896,7 @@ static void negate_bytes(jbyte *b, size_t n) {
  * Returns NULL and raise an exception if allocation fails.
  */
 static jbyteArray mpz_to_byte_array(JNIEnv *env, mpz_t z) {
+  TRACE_MARSHAL();
   jbyte buffer[32];
   jbyte *aux;
   jbyteArray result = NULL;
@@ -379,12 +973,91 @@ static jbyteArray mpz_to_byte_array(JNIEnv *env, mpz_t z) {
 }
 
 
+/*
+ * Rationals as arrays of 64-bit limbs (cf. Yices.limbsToRational)
+ * - if num and den both fit in a signed 64-bit integer, the array is { num, den }
+ * - otherwise, the array is { sign, k, num[0 ... k-1], den[0 ... ] } where num
+ *   and den are the magnitudes of the numerator and denominator, least significant
+ *   limb first.
+ */
+static jlongArray rational64_to_limbs(JNIEnv *env, int64_t num, uint64_t den) {
+  TRACE_MARSHAL();
+  jlongArray result = NULL;
+
+  if (den <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+    jlong aux[2] = { num, (jlong) den };
+    result = env->NewLongArray(2);
+    if (result == NULL) {
+      out_of_mem_exception(env);
+    } else {
+      env->SetLongArrayRegion(result, 0, 2, aux);
+    }
+  } else {
+    jlong aux[4] = { num < 0 ? -1 : (num > 0), 1, 0, (jlong) den };
+    // magnitude of num without overflow for INT64_MIN
+    aux[2] = num < 0 ? (jlong) (- (uint64_t) num) : num;
+    result = env->NewLongArray(4);
+    if (result == NULL) {
+      out_of_mem_exception(env);
+    } else {
+      env->SetLongArrayRegion(result, 0, 4, aux);
+    }
+  }
+  return result;
+}
+
+static jlongArray mpq_to_limbs(JNIEnv *env, mpq_t q) {
+  TRACE_MARSHAL();
+  mpz_ptr num = mpq_numref(q);
+  mpz_ptr den = mpq_denref(q);
+
+  if (mpz_fits_slong_p(num) && mpz_fits_slong_p(den) && sizeof(long) == 8) {
+    return rational64_to_limbs(env, mpz_get_si(num), mpz_get_si(den));
+  }
+
+  jlongArray result = NULL;
+  size_t k = (mpz_sizeinbase(num, 2) + 63) >> 6;
+  size_t l = (mpz_sizeinbase(den, 2) + 63) >> 6;
+  size_t n = k + l + 2;
+
+  if (n > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+    throw std::bad_alloc();
+  }
+  std::vector<jlong> aux(n, 0);
+  aux[0] = mpz_sgn(num);
+  mpz_export(aux.data() + 2, &k, -1, sizeof(jlong), 0, 0, num);
+  aux[1] = k;
+  mpz_export(aux.data() + 2 + k, &l, -1, sizeof(jlong), 0, 0, den);
+  n = k + l + 2;
+  result = env->NewLongArray(n);
+  if (result == NULL) {
+    out_of_mem_exception(env);
+  } else {
+    env->SetLongArrayRegion(result, 0, n, aux.data());
+  }
+  return result;
+}
+
+/*
+ * Per-thread mpq for the conversions: this avoids allocating GMP
+ * numbers on every call.
+ */
+struct mpq_scratch {
+  mpq_t q;
+  mpq_scratch() { mpq_init(q); }
+  ~mpq_scratch() { mpq_clear(q); }
+};
+
+static thread_local mpq_scratch scratch_q;
+
+
 /*
  * Inverse operation: convert a byte array to mpz
  * - n = array size, b = array of bytes
  * - return true if this works, false if we can't allocate memory
  */
 static void byte_array_to_mpz(mpz_t z, jbyte *b, jsize n) {
+  TRACE_MARSHAL();
   if (b[0] < 0) {
     negate_bytes(b, n);
     mpz_import(z, n, 1, 1, 0, 0, b);
@@ -399,15 +1072,16 @@ static void byte_array_to_mpz(mpz_t z, jbyte *b, jsize n) {
  * For testing
  */
 JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_testMpzToBytes(JNIEnv *env, jclass, jstring s) {
+  TRACE_NATIVE();
   jbyteArray result = NULL;
   mpz_t z;
-  const char *aux = env->GetStringUTFChars(s, NULL);
+  utf_chars aux(env, s);
 
-  if (s == NULL) {
+  if (aux.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     mpz_init(z);
-    mpz_set_str(z, aux, 0);
+    mpz_set_str(z, aux.get(), 0);
     result = mpz_to_byte_array(env, z);
     mpz_clear(z);
   }
@@ -417,24 +1091,20 @@ JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_testMpzToBytes(JNIEnv *env
 
 
 JNIEXPORT void JNICALL Java_com_sri_yices_Yices_testBytesToMpz(JNIEnv *env, jclass, jbyteArray a) {
-  jsize n;
-  jbyte *b;
+  TRACE_NATIVE();
+  pinned_array<jbyteArray> b(env, a);
 
-  n = env->GetArrayLength(a);
-  b = env->GetByteArrayElements(a, NULL);
-  if (b == NULL) {
+  if (b.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     mpz_t z;
 
     mpz_init(z);
-    byte_array_to_mpz(z, b, n);
+    byte_array_to_mpz(z, b.get(), b.length());
     fprintf(stdout, "Got mpz number: ");
     mpz_out_str(stdout, 10, z);
     fprintf(stdout, "\n");
     mpz_clear(z);
-
-    env->ReleaseByteArrayElements(a, b, JNI_ABORT); // don't change a
   }
 }
 
@@ -443,28 +1113,24 @@ JNIEXPORT void JNICALL Java_com_sri_yices_Yices_testBytesToMpz(JNIEnv *env, jcla
  * Convert the given array of bytes to an integer constant
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bytesToIntConstant(JNIEnv *env, jclass, jbyteArray a) {
+  TRACE_NATIVE();
   jint result = -1;
-  jsize n;
-  jbyte *b;
+  pinned_array<jbyteArray> b(env, a);
 
-  n = env->GetArrayLength(a);
-  b = env->GetByteArrayElements(a, NULL);
-  if (b == NULL) {
+  if (b.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     try {
       mpz_t z;
 
       mpz_init(z);
-      byte_array_to_mpz(z, b, n);
+      byte_array_to_mpz(z, b.get(), b.length());
       result = yices_mpz(z);
       mpz_clear(z);
 
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-
-    env->ReleaseByteArrayElements(a, b, JNI_ABORT); // don't change a
   }
 
   return result;
@@ -475,23 +1141,20 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bytesToIntConstant(JNIEnv *env,
  * - return -1 if the denominator is zero
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bytesToRationalConstant(JNIEnv *env, jclass, jbyteArray num, jbyteArray den) {
+  TRACE_NATIVE();
   jint result = -1;
-  jsize num_size, den_size;
-  jbyte *num_bytes, *den_bytes;
+  pinned_array<jbyteArray> num_bytes(env, num);
+  pinned_array<jbyteArray> den_bytes(env, den);
 
-  num_size = env->GetArrayLength(num);
-  num_bytes = env->GetByteArrayElements(num, NULL);
-  den_size = env->GetArrayLength(den);
-  den_bytes = env->GetByteArrayElements(den, NULL);
-  if (num_bytes == NULL || den_bytes == NULL) {
+  if (num_bytes.get() == NULL || den_bytes.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     try {
       mpq_t q;
 
       mpq_init(q);
-      byte_array_to_mpz(mpq_numref(q), num_bytes, num_size);
-      byte_array_to_mpz(mpq_denref(q), den_bytes, den_size);
+      byte_array_to_mpz(mpq_numref(q), num_bytes.get(), num_bytes.length());
+      byte_array_to_mpz(mpq_denref(q), den_bytes.get(), den_bytes.length());
       if (mpz_sgn(mpq_denref(q)) != 0) {
         // the denominator is non-zero
         mpq_canonicalize(q);
@@ -504,9 +1167,6 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bytesToRationalConstant(JNIEnv *
     }
   }
 
-  if (num_bytes != NULL) env->ReleaseByteArrayElements(num, num_bytes, JNI_ABORT);
-  if (den_bytes != NULL) env->ReleaseByteArrayElements(den, den_bytes, JNI_ABORT);
-
   return result;
 }
 
@@ -518,15 +1178,8 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bytesToRationalConstant(JNIEnv *
  * Convert a Java BigInteger object x to mpz_t
  */
 static void convertBigIntToMpz(JNIEnv *env, jobject x, mpz_t z) {
-  jclass bigIntClass = env->FindClass("java/math/BigInteger");
-  assert(bigIntClass != NULL);
-
-  jmethodID signum =  env->GetMethodID(bigIntClass, "signum", "()I");
-  jmethodID toByteArray = env->GetMethodID(bigIntClass, "toByteArray", "()[B");
-  assert(signum != NULL && toByteArray != NULL);
-
-  jint sign = env->CallIntMethod(x, signum);
-  jbyteArray bytes = reinterpret_cast<jbyteArray>(env->CallObjectMethod(x, toByteArray));
+  jint sign = env->CallIntMethod(x, big_integer_signum);
+  jbyteArray bytes = reinterpret_cast<jbyteArray>(env->CallObjectMethod(x, big_integer_to_byte_array));
   jsize n = env->GetArrayLength(bytes);
   jbyte *b = env->GetByteArrayElements(bytes, NULL);
 
@@ -588,18 +1241,22 @@ static inline uint64_t *to_uint64ptr(jlong *x) {
  * VERSION DATA
  */
 JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_version(JNIEnv *env, jclass cls) {
+  TRACE_NATIVE();
   return convertToString(env, yices_version);
 }
 
 JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_buildArch(JNIEnv *env, jclass cls) {
+  TRACE_NATIVE();
   return convertToString(env, yices_build_arch);
 }
 
 JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_buildMode(JNIEnv *env, jclass cls) {
+  TRACE_NATIVE();
   return convertToString(env, yices_build_mode);
 }
 
 JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_buildDate(JNIEnv *env, jclass cls) {
+  TRACE_NATIVE();
   return convertToString(env, yices_build_date);
 }
 
@@ -608,45 +1265,192 @@ JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_buildDate(JNIEnv *env, jclass
  * yices_has_mcsat returns 0 for false and 1 for true so we're good.
  */
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_hasMcsat(JNIEnv *env, jclass cls) {
+  TRACE_NATIVE();
   int32_t x = yices_has_mcsat();
   assert(0 == x || 1 == x);
   return (jboolean) x;
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_isThreadSafe(JNIEnv *env, jclass cls) {
+  TRACE_NATIVE();
   int32_t x = yices_is_thread_safe();
   assert(0 == x || 1 == x);
   return (jboolean) x;
 }
 
 
-
 /*
- * GLOBAL INITIALIZATION/EXIT/RESET
+ * NATIVE CALL TRACING
  */
-JNIEXPORT void JNICALL Java_com_sri_yices_Yices_init(JNIEnv *, jclass) {
-  yices_init();
-  yices_set_out_of_mem_callback(throw_out_of_mem_exception);
-}
-
-JNIEXPORT void JNICALL Java_com_sri_yices_Yices_exit(JNIEnv *, jclass) {
-  yices_exit();
-}
 
-JNIEXPORT void JNICALL Java_com_sri_yices_Yices_reset(JNIEnv *, jclass) {
-  yices_reset();
+/*
+ * Enable or disable tracing
+ * - returns false if the library was built without YICES_JNI_TRACE
+ */
+JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_setNativeTracing(JNIEnv *env, jclass, jboolean enable) {
+#ifdef YICES_JNI_TRACE
+  trace_enabled.store(enable != 0);
+  return true;
+#else
+  return false;
+#endif
 }
 
-
-
 /*
- * Error reports
+ * Names of the natives that have been traced so far: name[i] is for native i
+ */
+JNIEXPORT jobjectArray JNICALL Java_com_sri_yices_Yices_nativeTraceNames(JNIEnv *env, jclass) {
+#ifdef YICES_JNI_TRACE
+  std::lock_guard<std::mutex> guard(trace_lock);
+  int32_t n = trace_count.load();
+  jobjectArray result = env->NewObjectArray(n, string_class, NULL);
+  if (result == NULL) {
+    out_of_mem_exception(env);
+    return NULL;
+  }
+  for (int32_t i=0; i<n; i++) {
+    jstring s = env->NewStringUTF(trace_names[i]);
+    if (s == NULL) {
+      out_of_mem_exception(env);
+      return NULL;
+    }
+    env->SetObjectArrayElement(result, i, s);
+    env->DeleteLocalRef(s);
+  }
+  return result;
+#else
+  return env->NewObjectArray(0, string_class, NULL);
+#endif
+}
+
+/*
+ * Statistics, summed over all threads:
+ * - a[0] = n = number of natives
+ * - for native i, a[1 + 3i] = number of calls
+ *                 a[2 + 3i] = total time in nanoseconds
+ *                 a[3 + 3i] = marshalling time in nanoseconds
+ * The natives are in the same order as in nativeTraceNames.
+ */
+JNIEXPORT jlongArray JNICALL Java_com_sri_yices_Yices_nativeStats(JNIEnv *env, jclass) {
+#ifdef YICES_JNI_TRACE
+  std::lock_guard<std::mutex> guard(trace_lock);
+  int32_t n = trace_count.load();
+  jlong *a = NULL;
+  jlongArray result = NULL;
+
+  try {
+    a = new jlong[1 + 3 * n];
+    a[0] = n;
+    for (int32_t i=0; i<n; i++) {
+      a[1 + 3 * i] = trace_retired.calls[i].load(std::memory_order_relaxed);
+      a[2 + 3 * i] = trace_retired.total[i].load(std::memory_order_relaxed);
+      a[3 + 3 * i] = trace_retired.marshal[i].load(std::memory_order_relaxed);
+      for (trace_thread *t = trace_threads; t != NULL; t = t->next) {
+        a[1 + 3 * i] += t->counters->calls[i].load(std::memory_order_relaxed);
+        a[2 + 3 * i] += t->counters->total[i].load(std::memory_order_relaxed);
+        a[3 + 3 * i] += t->counters->marshal[i].load(std::memory_order_relaxed);
+      }
+    }
+    result = env->NewLongArray(1 + 3 * n);
+    if (result == NULL) {
+      out_of_mem_exception(env);
+    } else {
+      env->SetLongArrayRegion(result, 0, 1 + 3 * n, a);
+    }
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  delete [] a;
+  return result;
+#else
+  jlongArray result = env->NewLongArray(1);
+  if (result == NULL) {
+    out_of_mem_exception(env);
+  }
+  return result;
+#endif
+}
+
+/*
+ * Reset all counters to zero
+ * - this is not atomic: calls made concurrently may or may not be counted
+ */
+JNIEXPORT void JNICALL Java_com_sri_yices_Yices_resetNativeStats(JNIEnv *env, jclass) {
+#ifdef YICES_JNI_TRACE
+  std::lock_guard<std::mutex> guard(trace_lock);
+  trace_retired.clear();
+  for (trace_thread *t = trace_threads; t != NULL; t = t->next) {
+    t->counters->clear();
+  }
+#endif
+}
+
+
+/*
+ * NATIVE MEMORY
+ *
+ * Yices does not report how much memory a context or model uses, so the best
+ * we can do is the size of the malloc heap: number of bytes in use, as reported
+ * by mallinfo (glibc only). Return -1 if this is not available.
+ */
+JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_nativeHeapUsage(JNIEnv *env, jclass) {
+  TRACE_NATIVE();
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 info = mallinfo2();
+  return static_cast<jlong>(info.uordblks + info.hblkhd);
+#elif defined(__GLIBC__)
+  // the fields are int: this wraps around above 2GB
+  struct mallinfo info = mallinfo();
+  return static_cast<jlong>(static_cast<unsigned>(info.uordblks) + static_cast<unsigned>(info.hblkhd));
+#else
+  return -1;
+#endif
+}
+
+
+
+/*
+ * GLOBAL INITIALIZATION/EXIT/RESET
+ */
+JNIEXPORT void JNICALL Java_com_sri_yices_Yices_init(JNIEnv *, jclass) {
+  TRACE_NATIVE();
+  yices_init();
+  yices_set_out_of_mem_callback(throw_out_of_mem_exception);
+}
+
+JNIEXPORT void JNICALL Java_com_sri_yices_Yices_exit(JNIEnv *, jclass) {
+  TRACE_NATIVE();
+  yices_exit();
+}
+
+/*
+ * Epochs for native objects that hold term ids (cf. substitution):
+ * - gc_epoch is incremented by every garbage collection and every reset:
+ *   the ids that are not protected may then be reused
+ * - reset_epoch is incremented by every reset: all the ids are then invalid
+ */
+static std::atomic<uint32_t> gc_epoch(0);
+static std::atomic<uint32_t> reset_epoch(0);
+
+JNIEXPORT void JNICALL Java_com_sri_yices_Yices_yicesReset(JNIEnv *, jclass) {
+  TRACE_NATIVE();
+  yices_reset();
+  gc_epoch.fetch_add(1, std::memory_order_relaxed);
+  reset_epoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+
+/*
+ * Error reports
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_errorCode(JNIEnv *, jclass) {
+  TRACE_NATIVE();
   return yices_error_code();
 }
 
 JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_errorString(JNIEnv *env, jclass) {
+  TRACE_NATIVE();
   jstring result;
   char *e;
 
@@ -657,29 +1461,87 @@ JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_errorString(JNIEnv *env, jcla
 }
 
 JNIEXPORT void JNICALL Java_com_sri_yices_Yices_resetError(JNIEnv *, jclass) {
+  TRACE_NATIVE();
   yices_clear_error();
 }
 
 JNIEXPORT jobject JNICALL Java_com_sri_yices_Yices_errorReport(JNIEnv *env, jclass) {
+  TRACE_NATIVE();
   try {
     error_report_t* report = yices_error_report();
-	// now construct new ErrorReport(report->code, report->line, report->column, report->term1, report->type1, report->term2, report->type2, report->badval);
-	jclass cls = env->FindClass("com/sri/yices/ErrorReport");
-	if (cls != NULL) {
-	  jmethodID constructor = env->GetMethodID(cls, "<init>", "(IIIIIIIJ)V");
-	  if (constructor != NULL) {
-		jobject object = env->NewObject(cls, constructor, report->code, report->line, report->column, report->term1, report->type1, report->term2, report->type2, report->badval);
-		return object;
-	  }
-	}
+    // now construct new ErrorReport(report->code, report->line, report->column, report->term1, report->type1, report->term2, report->type2, report->badval);
+    return env->NewObject(error_report_class, error_report_init, report->code, report->line, report->column,
+                          report->term1, report->type1, report->term2, report->type2, report->badval);
   } catch (std::bad_alloc &ba) {
 	out_of_mem_exception(env);
   }
   return 0;
 }
 
+/*
+ * Per-thread error slot for the no-throw mode (cf. NoThrow.java)
+ *
+ * When a call fails in no-throw mode, the Java wrapper calls stashError: this
+ * copies the Yices error report into the slot of the current thread and clears
+ * the Yices error. Nothing is allocated. The code, report, or message are read
+ * from the slot later, and only if the caller wants them.
+ */
+struct error_slot {
+  error_report_t report;
+  error_slot() { memset(&report, 0, sizeof(report)); }
+};
+
+static thread_local error_slot last_error;
+
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_stashError(JNIEnv *, jclass) {
+  TRACE_NATIVE();
+  last_error.report = *yices_error_report();
+  yices_clear_error();
+  return last_error.report.code;
+}
+
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_lastErrorCode(JNIEnv *, jclass) {
+  TRACE_NATIVE();
+  return last_error.report.code;
+}
+
+JNIEXPORT void JNICALL Java_com_sri_yices_Yices_clearLastError(JNIEnv *, jclass) {
+  TRACE_NATIVE();
+  memset(&last_error.report, 0, sizeof(last_error.report));
+}
+
+JNIEXPORT jobject JNICALL Java_com_sri_yices_Yices_lastErrorReport(JNIEnv *env, jclass) {
+  TRACE_NATIVE();
+  const error_report_t *report = &last_error.report;
+  return env->NewObject(error_report_class, error_report_init, report->code, report->line, report->column,
+                        report->term1, report->type1, report->term2, report->type2, report->badval);
+}
+
+/*
+ * Message for the stashed report: yices_error_string formats the current
+ * report so we put the stashed one back while we build the string.
+ */
+JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_lastErrorString(JNIEnv *env, jclass) {
+  TRACE_NATIVE();
+  jstring result = NULL;
+  error_report_t *current = yices_error_report();
+  error_report_t saved = *current;
+  try {
+    *current = last_error.report;
+    char *e = yices_error_string();
+    *current = saved;
+    result = convertToString(env, e);
+    yices_free_string(e);
+  } catch (std::bad_alloc &ba) {
+    *current = saved;
+    out_of_mem_exception(env);
+  }
+  return result;
+}
+
 // to test the throw exception code
 JNIEXPORT void JNICALL Java_com_sri_yices_Yices_testException(JNIEnv *env, jclass) {
+  TRACE_NATIVE();
   out_of_mem_exception(env);
 }
 
@@ -690,14 +1552,17 @@ JNIEXPORT void JNICALL Java_com_sri_yices_Yices_testException(JNIEnv *env, jclas
  * exceptions.
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_boolType(JNIEnv *, jclass) {
+  TRACE_NATIVE();
   return yices_bool_type();
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_realType(JNIEnv *, jclass) {
+  TRACE_NATIVE();
   return yices_real_type();
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_intType(JNIEnv *, jclass) {
+  TRACE_NATIVE();
   return yices_int_type();
 }
 
@@ -706,6 +1571,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_intType(JNIEnv *, jclass) {
  * If n<0, we replace it by zero. Yices will report an error if n is 0.
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvType(JNIEnv *env, jclass, jint n) {
+  TRACE_NATIVE();
   uint32_t nb = n<0 ? 0 : n;
   try {
     return yices_bv_type(nb);
@@ -719,6 +1585,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvType(JNIEnv *env, jclass, jint
  * Scalar type: c = cardinality: it must be positive. As above, we convert c<0 to 0.
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_newScalarType(JNIEnv *env, jclass, jint c) {
+  TRACE_NATIVE();
   uint32_t card = c<0 ? 0 : c;
   try {
     return yices_new_scalar_type(card);
@@ -729,6 +1596,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_newScalarType(JNIEnv *env, jclas
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_newUninterpretedType(JNIEnv *env, jclass) {
+  TRACE_NATIVE();
   try {
     return yices_new_uninterpreted_type();
   } catch (std::bad_alloc &ba) {
@@ -739,6 +1607,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_newUninterpretedType(JNIEnv *env
 
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_tupleType(JNIEnv *env, jclass, jintArray a) {
+  TRACE_NATIVE();
   jsize n = env->GetArrayLength(a);
   if (n == 0) {
     // force an error in Yices
@@ -762,6 +1631,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_tupleType(JNIEnv *env, jclass, j
 
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_functionType(JNIEnv *env, jclass, jint range, jintArray domain) {
+  TRACE_NATIVE();
   jsize n = env->GetArrayLength(domain);
   if (n == 0) {
     // force an error
@@ -788,38 +1658,47 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_functionType(JNIEnv *env, jclass
  * CHECK/EXPLORE TYPES
  */
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_typeIsBool(JNIEnv *, jclass, jint tau) {
+  TRACE_NATIVE();
   return yices_type_is_bool(tau);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_typeIsInt(JNIEnv *, jclass, jint tau) {
+  TRACE_NATIVE();
   return yices_type_is_int(tau);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_typeIsReal(JNIEnv *, jclass, jint tau) {
+  TRACE_NATIVE();
   return yices_type_is_real(tau);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_typeIsArithmetic(JNIEnv *, jclass, jint tau) {
+  TRACE_NATIVE();
   return yices_type_is_arithmetic(tau);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_typeIsBitvector(JNIEnv *, jclass, jint tau) {
+  TRACE_NATIVE();
   return yices_type_is_bitvector(tau);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_typeIsScalar(JNIEnv *, jclass, jint tau) {
+  TRACE_NATIVE();
   return yices_type_is_scalar(tau);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_typeIsUninterpreted(JNIEnv *, jclass, jint tau) {
+  TRACE_NATIVE();
   return yices_type_is_uninterpreted(tau);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_typeIsTuple(JNIEnv *, jclass, jint tau) {
+  TRACE_NATIVE();
   return yices_type_is_tuple(tau);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_typeIsFunction(JNIEnv *, jclass, jint tau) {
+  TRACE_NATIVE();
   return yices_type_is_function(tau);
 }
 
@@ -828,6 +1707,7 @@ JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_typeIsFunction(JNIEnv *, jcl
  * - this may allocate memory so we check for out-of-memory error here
  */
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_isSubtype(JNIEnv *env, jclass, jint tau, jint sigma) {
+  TRACE_NATIVE();
   try {
     return yices_test_subtype(tau, sigma);
   } catch (std::bad_alloc &ba) {
@@ -841,6 +1721,7 @@ JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_isSubtype(JNIEnv *env, jclas
  * - this may allocate memory so we check for out-of-memory error here
  */
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_areCompatible(JNIEnv *env, jclass, jint tau, jint sigma) {
+  TRACE_NATIVE();
   try {
     return yices_compatible_types(tau, sigma);
   } catch (std::bad_alloc &ba) {
@@ -853,6 +1734,7 @@ JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_areCompatible(JNIEnv *env, j
  * Number of bits in a bitvector type
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvTypeSize(JNIEnv *, jclass, jint tau) {
+  TRACE_NATIVE();
   return yices_bvtype_size(tau);
 }
 
@@ -860,6 +1742,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvTypeSize(JNIEnv *, jclass, jin
  * Cardinality of a scalar type
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_scalarTypeCard(JNIEnv *, jclass, jint tau) {
+  TRACE_NATIVE();
   return yices_scalar_type_card(tau);
 }
 
@@ -867,6 +1750,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_scalarTypeCard(JNIEnv *, jclass,
  * Number of children of type tau
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_typeNumChildren(JNIEnv *, jclass, jint tau) {
+  TRACE_NATIVE();
   return yices_type_num_children(tau);
 }
 
@@ -874,6 +1758,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_typeNumChildren(JNIEnv *, jclass
  * Get i-th child of type tau
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_typeChild(JNIEnv *, jclass, jint tau, jint i) {
+  TRACE_NATIVE();
   return yices_type_child(tau, i);
 }
 
@@ -886,6 +1771,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_typeChild(JNIEnv *, jclass, jint
  * return NULL is tau is not a valid type
  */
 JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_typeChildren(JNIEnv *env, jclass, jint tau) {
+  TRACE_NATIVE();
   type_vector_t aux;
   jintArray result = NULL;
   int32_t code;
@@ -911,18 +1797,18 @@ JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_typeChildren(JNIEnv *env, j
  * Give a a name to type tau
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_setTypeName(JNIEnv *env, jclass, jint tau, jstring name) {
+  TRACE_NATIVE();
   jint code = -1;
-  const char *s = env->GetStringUTFChars(name, NULL);
+  utf_chars s(env, name);
 
-  if (s == NULL) {
+  if (s.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     try {
-      code = yices_set_type_name(tau, s);
+      code = yices_set_type_name(tau, s.get());
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    env->ReleaseStringUTFChars(name, s);
   }
 
   return code;
@@ -930,39 +1816,41 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_setTypeName(JNIEnv *env, jclass,
 
 
 JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_getTypeName(JNIEnv *env, jclass, jint tau) {
+  TRACE_NATIVE();
   return convertToString(env, yices_get_type_name(tau));
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getTypeByName(JNIEnv *env, jclass, jstring name) {
+  TRACE_NATIVE();
   jint tau = -1;
-  const char *s = env->GetStringUTFChars(name, NULL);
+  utf_chars s(env, name);
 
-  if (s == NULL) {
+  if (s.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     try {
-      tau = yices_get_type_by_name(s);
+      tau = yices_get_type_by_name(s.get());
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    env->ReleaseStringUTFChars(name, s);
   }
 
   return tau;
 }
 
 JNIEXPORT void JNICALL Java_com_sri_yices_Yices_removeTypeName(JNIEnv *env, jclass, jstring name) {
-  const char *s = env->GetStringUTFChars(name, NULL);
+  TRACE_NATIVE();
+  utf_chars s(env, name);
 
-  if (s == NULL) {
+  if (s.get() == NULL) {
     out_of_mem_exception(env);
   } else {
-    yices_remove_type_name(s);
-    env->ReleaseStringUTFChars(name, s);
+    yices_remove_type_name(s.get());
   }
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_clearTypeName(JNIEnv *env, jclass, jint tau) {
+  TRACE_NATIVE();
   return yices_clear_type_name(tau);
 }
 
@@ -972,6 +1860,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_clearTypeName(JNIEnv *env, jclas
  * We print into an array of 80 columns x 4 lines
  */
 JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_typeToString(JNIEnv *env, jclass, jint tau) {
+  TRACE_NATIVE();
   char *s;
   jstring result;
 
@@ -990,18 +1879,18 @@ JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_typeToString(JNIEnv *env, jcl
  * Parse s as type using the Yices syntax
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_parseType(JNIEnv *env, jclass, jstring s) {
+  TRACE_NATIVE();
   jint result = -1;
-  const char *aux = env->GetStringUTFChars(s, NULL);
+  utf_chars aux(env, s);
 
-  if (aux == NULL) {
+  if (aux.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     try {
-      result = yices_parse_type(aux);
+      result = yices_parse_type(aux.get());
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    env->ReleaseStringUTFChars(s, aux);
   }
 
   return result;
@@ -1012,14 +1901,17 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_parseType(JNIEnv *env, jclass, j
  * GENERIC TERM CONSTRUCTORS
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_mkTrue(JNIEnv *, jclass) {
+  TRACE_NATIVE();
   return yices_true(); // Can't cause out-of-mem error
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_mkFalse(JNIEnv *, jclass) {
+  TRACE_NATIVE();
   return yices_false();
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_mkConstant(JNIEnv *env, jclass, jint tau, jint idx) {
+  TRACE_NATIVE();
   try {
     return yices_constant(tau, idx);
   } catch (std::bad_alloc &ba) {
@@ -1029,6 +1921,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_mkConstant(JNIEnv *env, jclass,
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_newUninterpretedTerm(JNIEnv *env, jclass, jint tau) {
+  TRACE_NATIVE();
   try {
     return yices_new_uninterpreted_term(tau);
   } catch (std::bad_alloc &ba) {
@@ -1038,6 +1931,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_newUninterpretedTerm(JNIEnv *env
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_newVariable(JNIEnv *env, jclass, jint tau) {
+  TRACE_NATIVE();
   try {
     return yices_new_variable(tau);
   } catch (std::bad_alloc &ba) {
@@ -1047,25 +1941,40 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_newVariable(JNIEnv *env, jclass,
 }
 
 // function application: f = function, arg = arguments
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_funApplication(JNIEnv *env, jclass, jint f, jintArray arg) {
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_funApplication__I_3I(JNIEnv *env, jclass, jint f, jintArray arg) {
+  TRACE_NATIVE();
   jsize n = env->GetArrayLength(arg);
-  term_t *a = array2terms(env, arg, NULL);
+  term_t *a = scratch_copy(env, arg, n);
   jint result = -1;
 
-  if (a == NULL) {
-    out_of_mem_exception(env);
-  } else {
+  if (a != NULL) {
+    try {
+      result = yices_application(f, n, a);
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+    scratch_free(a);
+  }
+  return result;
+}
+
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_funApplication__ILjava_nio_IntBuffer_2II(JNIEnv *env, jclass, jint f, jobject arg, jint offset, jint n) {
+  TRACE_NATIVE();
+  const term_t *a = direct_int_buffer(env, arg, offset, n);
+  jint result = -1;
+
+  if (a != NULL) {
     try {
       result = yices_application(f, n, a);
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    env->ReleaseIntArrayElements(arg, a, JNI_ABORT);
   }
   return result;
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_ifThenElse(JNIEnv *env, jclass, jint cond, jint iftrue, jint iffalse) {
+  TRACE_NATIVE();
   try {
     return yices_ite(cond, iftrue, iffalse);
   } catch (std::bad_alloc &ba) {
@@ -1075,6 +1984,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_ifThenElse(JNIEnv *env, jclass,
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_eq(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_eq(left, right);
   } catch (std::bad_alloc &ba) {
@@ -1084,6 +1994,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_eq(JNIEnv *env, jclass, jint lef
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_neq(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_neq(left, right);
   } catch (std::bad_alloc &ba) {
@@ -1093,94 +2004,47 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_neq(JNIEnv *env, jclass, jint le
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_not(JNIEnv *, jclass, jint arg) {
+  TRACE_NATIVE();
   return yices_not(arg); // can't cause out-of-mem
 }
 
 
 /*
- * For and/or/xor, we make a copy of the arg array (otherwise the array may be modified).
+ * For and/or/xor, Yices may modify the argument array so nary_term and
+ * direct_nary_term give it a copy.
  */
-#define AUX_SIZE 10
-
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_and(JNIEnv *env, jclass, jintArray arg) {
-  int32_t aux[AUX_SIZE]; // avoid alloc if arg is small
-  jint result = -1;
-  jsize n = env->GetArrayLength(arg);
-
-  if (n <= AUX_SIZE) {
-    array2int_region(env, arg, 0, n, aux);
-    try {
-      result = yices_and(n, aux);
-    } catch (std::bad_alloc &ba) {
-      out_of_mem_exception(env);
-    }
-  } else {
-    jboolean copy;
-    int32_t *a = cloneIntArray(env, arg, &copy);
-    try {
-      result = yices_and(n, a);
-    } catch (std::bad_alloc &ba) {
-      out_of_mem_exception(env);
-    }
-    freeClonedIntArray(env, arg, a, &copy);
-  }
-
-  return result;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_and___3I(JNIEnv *env, jclass, jintArray arg) {
+  TRACE_NATIVE();
+  return nary_term(env, yices_and, arg);
 }
 
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_or(JNIEnv *env, jclass, jintArray arg) {
-  int32_t aux[AUX_SIZE]; // avoid malloc if we can
-  jint result = -1;
-  jsize n = env->GetArrayLength(arg);
-
-  if (n < AUX_SIZE) {
-    array2int_region(env, arg, 0, n, aux);
-    try {
-      result = yices_or(n, aux);
-    } catch (std::bad_alloc &ba) {
-      out_of_mem_exception(env);
-    }
-  } else {
-    jboolean copy;
-    int32_t *a = cloneIntArray(env, arg, &copy);
-    try {
-      result = yices_or(n, a);
-    } catch (std::bad_alloc &ba) {
-      out_of_mem_exception(env);
-    }
-    freeClonedIntArray(env, arg, a, &copy);
-  }
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_and__Ljava_nio_IntBuffer_2II(JNIEnv *env, jclass, jobject arg, jint offset, jint n) {
+  TRACE_NATIVE();
+  return direct_nary_term(env, yices_and, arg, offset, n);
+}
 
-  return result;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_or___3I(JNIEnv *env, jclass, jintArray arg) {
+  TRACE_NATIVE();
+  return nary_term(env, yices_or, arg);
 }
 
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_xor(JNIEnv *env, jclass, jintArray arg) {
-  int32_t aux[AUX_SIZE]; // avoid malloc if we can
-  jint result = -1;
-  jsize n = env->GetArrayLength(arg);
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_or__Ljava_nio_IntBuffer_2II(JNIEnv *env, jclass, jobject arg, jint offset, jint n) {
+  TRACE_NATIVE();
+  return direct_nary_term(env, yices_or, arg, offset, n);
+}
 
-  if (n < AUX_SIZE) {
-    array2int_region(env, arg, 0, n, aux);
-    try {
-      result = yices_xor(n, aux);
-    } catch (std::bad_alloc &ba) {
-      out_of_mem_exception(env);
-    }
-  } else {
-    jboolean copy;
-    int32_t *a = cloneIntArray(env, arg, &copy);
-    try {
-      result = yices_xor(n, a);
-    } catch (std::bad_alloc &ba) {
-      out_of_mem_exception(env);
-    }
-    freeClonedIntArray(env, arg, a, &copy);
-  }
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_xor___3I(JNIEnv *env, jclass, jintArray arg) {
+  TRACE_NATIVE();
+  return nary_term(env, yices_xor, arg);
+}
 
-  return result;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_xor__Ljava_nio_IntBuffer_2II(JNIEnv *env, jclass, jobject arg, jint offset, jint n) {
+  TRACE_NATIVE();
+  return direct_nary_term(env, yices_xor, arg, offset, n);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_iff(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_iff(left, right);
   } catch (std::bad_alloc &ba) {
@@ -1190,6 +2054,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_iff(JNIEnv *env, jclass, jint le
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_implies(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_implies(left, right);
   } catch (std::bad_alloc &ba) {
@@ -1198,25 +2063,18 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_implies(JNIEnv *env, jclass, jin
   }
 }
 
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_tuple(JNIEnv *env, jclass, jintArray arg) {
-  jsize n = env->GetArrayLength(arg);
-  term_t *a = array2terms(env, arg, NULL);
-  jint result = -1;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_tuple___3I(JNIEnv *env, jclass, jintArray arg) {
+  TRACE_NATIVE();
+  return nary_term(env, yices_tuple, arg);
+}
 
-  if (a == NULL) {
-    out_of_mem_exception(env);
-  } else {
-    try {
-      result = yices_tuple(n, a);
-    } catch (std::bad_alloc &ba) {
-      out_of_mem_exception(env);
-    }
-    release_term_elems(env, arg, a);
-  }
-  return result;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_tuple__Ljava_nio_IntBuffer_2II(JNIEnv *env, jclass, jobject arg, jint offset, jint n) {
+  TRACE_NATIVE();
+  return direct_nary_term(env, yices_tuple, arg, offset, n);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_select(JNIEnv *env, jclass, jint idx, jint tuple) {
+  TRACE_NATIVE();
   try {
     return yices_select(idx, tuple);
   } catch (std::bad_alloc &ba) {
@@ -1226,6 +2084,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_select(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_tupleUpdate(JNIEnv *env, jclass, jint tuple, jint idx, jint newval) {
+  TRACE_NATIVE();
   try {
     return yices_tuple_update(tuple, idx, newval);
   } catch (std::bad_alloc &ba) {
@@ -1235,25 +2094,25 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_tupleUpdate(JNIEnv *env, jclass,
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_functionUpdate(JNIEnv *env, jclass, jint fun, jintArray arg, jint newval) {
+  TRACE_NATIVE();
   jsize n = env->GetArrayLength(arg);
-  term_t *a = array2terms(env, arg, NULL);
+  term_t *a = scratch_copy(env, arg, n);
   jint result = -1;
 
-  if (a == NULL) {
-    out_of_mem_exception(env);
-  } else {
+  if (a != NULL) {
     try {
       result = yices_update(fun, n, a, newval);
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    release_term_elems(env, arg, a);
+    scratch_free(a);
   }
   return result;
 }
 
 // common variant: corresponding to array update (i.e., fun has arity one)
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_functionUpdate1(JNIEnv *env, jclass, jint fun, jint arg, jint newval) {
+  TRACE_NATIVE();
   try {
     return yices_update1(fun, arg, newval);
   } catch (std::bad_alloc &ba) {
@@ -1263,100 +2122,66 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_functionUpdate1(JNIEnv *env, jcl
 }
 
 // yices_distinct may modify its argument so we make a copy of arg here
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_distinct(JNIEnv *env, jclass, jintArray arg) {
-  int32_t aux[AUX_SIZE]; // avoid malloc if we can
-  jint result = -1;
-  jsize n = env->GetArrayLength(arg);
-
-  if (n < AUX_SIZE) {
-    array2int_region(env, arg, 0, n, aux);
-    try {
-      result = yices_distinct(n, aux);
-    } catch (std::bad_alloc &ba) {
-      out_of_mem_exception(env);
-    }
-  } else {
-    jboolean copy;
-    int32_t *a = cloneIntArray(env, arg, &copy);
-    try {
-      result = yices_distinct(n, a);
-    } catch (std::bad_alloc &ba) {
-      out_of_mem_exception(env);
-    }
-    freeClonedIntArray(env, arg, a, &copy);
-  }
+// yices_distinct may modify its argument so nary_term makes a copy of arg here
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_distinct___3I(JNIEnv *env, jclass, jintArray arg) {
+  TRACE_NATIVE();
+  return nary_term(env, yices_distinct, arg);
+}
 
-  return result;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_distinct__Ljava_nio_IntBuffer_2II(JNIEnv *env, jclass, jobject arg, jint offset, jint n) {
+  TRACE_NATIVE();
+  return direct_nary_term(env, yices_distinct, arg, offset, n);
 }
 
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_forall(JNIEnv *env, jclass, jintArray var, jint body) {
-  int32_t aux[AUX_SIZE]; // avoid malloc if we can
-  jint result = -1;
+  TRACE_NATIVE();
   jsize n = env->GetArrayLength(var);
+  term_t *a = scratch_copy(env, var, n);
+  jint result = -1;
 
-  if (n < AUX_SIZE) {
-    array2int_region(env, var, 0, n, aux);
-    try {
-      result = yices_forall(n, aux, body);
-    } catch (std::bad_alloc &ba) {
-      out_of_mem_exception(env);
-    }
-  } else {
-    jboolean copy;
-    int32_t *a = cloneIntArray(env, var, &copy);
+  if (a != NULL) {
     try {
       result = yices_forall(n, a, body);
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    freeClonedIntArray(env, var, a, &copy);
+    scratch_free(a);
   }
-
   return result;
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_exists(JNIEnv *env, jclass, jintArray var, jint body) {
-  int32_t aux[AUX_SIZE]; // avoid malloc if we can
-  jint result = -1;
+  TRACE_NATIVE();
   jsize n = env->GetArrayLength(var);
+  term_t *a = scratch_copy(env, var, n);
+  jint result = -1;
 
-  if (n < AUX_SIZE) {
-    array2int_region(env, var, 0, n, aux);
-    try {
-      result = yices_exists(n, aux, body);
-    } catch (std::bad_alloc &ba) {
-      out_of_mem_exception(env);
-    }
-  } else {
-    jboolean copy;
-    int32_t *a = cloneIntArray(env, var, &copy);
+  if (a != NULL) {
     try {
       result = yices_exists(n, a, body);
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    freeClonedIntArray(env, var, a, &copy);
+    scratch_free(a);
   }
-
   return result;
 }
 
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_lambda(JNIEnv *env, jclass, jintArray var, jint body) {
+  TRACE_NATIVE();
   jsize n = env->GetArrayLength(var);
-  term_t *a = array2terms(env, var, NULL);
+  term_t *a = scratch_copy(env, var, n);
   jint result = -1;
 
-  if (a == NULL) {
-    out_of_mem_exception(env);
-  } else {
+  if (a != NULL) {
     try {
       result = yices_lambda(n, a, body);
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    release_term_elems(env, var, a);
+    scratch_free(a);
   }
   return result;
 }
@@ -1366,6 +2191,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_lambda(JNIEnv *env, jclass, jint
  * ARITHMETIC TERMS
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_zero(JNIEnv *env, jclass) {
+  TRACE_NATIVE();
   try {
     return yices_zero();
   } catch (std::bad_alloc &ba) {
@@ -1376,6 +2202,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_zero(JNIEnv *env, jclass) {
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_mkIntConstant(JNIEnv *env, jclass, jlong x) {
+  TRACE_NATIVE();
   try {
     return yices_int64(x);
   } catch (std::bad_alloc &ba) {
@@ -1385,6 +2212,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_mkIntConstant(JNIEnv *env, jclas
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_mkRationalConstant(JNIEnv *env, jclass, jlong num, jlong den) {
+  TRACE_NATIVE();
   /*
    * Yices wants the denominator to be non-negative
    * We could try to negate both num and den is den < 0,
@@ -1405,42 +2233,43 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_mkRationalConstant(JNIEnv *env,
 
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_parseRational(JNIEnv *env, jclass, jstring s) {
+  TRACE_NATIVE();
   jint result = -1;
-  const char *aux = env->GetStringUTFChars(s, NULL);
+  utf_chars aux(env, s);
 
-  if (aux == NULL) {
+  if (aux.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     try {
-      result = yices_parse_rational(aux);
+      result = yices_parse_rational(aux.get());
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    env->ReleaseStringUTFChars(s, aux);
   }
 
   return result;
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_parseFloat(JNIEnv *env, jclass, jstring s) {
+  TRACE_NATIVE();
   jint result = -1;
-  const char *aux = env->GetStringUTFChars(s, NULL);
+  utf_chars aux(env, s);
 
-  if (aux == NULL) {
+  if (aux.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     try {
-      result = yices_parse_float(aux);
+      result = yices_parse_float(aux.get());
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    env->ReleaseStringUTFChars(s, aux);
   }
 
   return result;
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_add__II(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_add(left, right);
   } catch (std::bad_alloc &ba) {
@@ -1450,6 +2279,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_add__II(JNIEnv *env, jclass, jin
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_sub(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_sub(left, right);
   } catch (std::bad_alloc &ba) {
@@ -1459,6 +2289,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_sub(JNIEnv *env, jclass, jint le
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_neg(JNIEnv *env, jclass, jint arg) {
+  TRACE_NATIVE();
   try {
     return yices_neg(arg);
   } catch (std::bad_alloc &ba) {
@@ -1468,6 +2299,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_neg(JNIEnv *env, jclass, jint ar
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_mul__II(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_mul(left, right);
   } catch (std::bad_alloc &ba) {
@@ -1477,6 +2309,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_mul__II(JNIEnv *env, jclass, jin
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_square(JNIEnv *env, jclass, jint arg) {
+  TRACE_NATIVE();
   try {
     return yices_square(arg);
   } catch (std::bad_alloc &ba) {
@@ -1486,6 +2319,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_square(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_power(JNIEnv *env, jclass, jint arg, jint exponent) {
+  TRACE_NATIVE();
   if (exponent < 0) {
     return -1; // negative exponents are not supported
   }
@@ -1498,42 +2332,27 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_power(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_add___3I(JNIEnv *env, jclass, jintArray arg) {
-  jsize n = env->GetArrayLength(arg);
-  term_t *a = array2terms(env, arg, NULL);
-  jint result = -1;
+  TRACE_NATIVE();
+  return nary_term(env, yices_sum, arg);
+}
 
-  if (a == NULL) {
-    out_of_mem_exception(env);
-  } else {
-    try {
-      result = yices_sum(n, a);
-    } catch (std::bad_alloc &ba) {
-      out_of_mem_exception(env);
-    }
-    release_term_elems(env, arg, a);
-  }
-  return result;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_add__Ljava_nio_IntBuffer_2II(JNIEnv *env, jclass, jobject arg, jint offset, jint n) {
+  TRACE_NATIVE();
+  return direct_nary_term(env, yices_sum, arg, offset, n);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_mul___3I(JNIEnv *env, jclass, jintArray arg) {
-  jsize n = env->GetArrayLength(arg);
-  term_t *a = array2terms(env, arg, NULL);
-  jint result = -1;
+  TRACE_NATIVE();
+  return nary_term(env, yices_product, arg);
+}
 
-  if (a == NULL) {
-    out_of_mem_exception(env);
-  } else {
-    try {
-      result = yices_product(n, a);
-    } catch (std::bad_alloc &ba) {
-      out_of_mem_exception(env);
-    }
-    release_term_elems(env, arg, a);
-  }
-  return result;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_mul__Ljava_nio_IntBuffer_2II(JNIEnv *env, jclass, jobject arg, jint offset, jint n) {
+  TRACE_NATIVE();
+  return direct_nary_term(env, yices_product, arg, offset, n);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_div(JNIEnv *env, jclass, jint x, jint y) {
+  TRACE_NATIVE();
   try {
     return yices_division(x, y);
   } catch (std::bad_alloc &ba) {
@@ -1543,6 +2362,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_div(JNIEnv *env, jclass, jint x,
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_idiv(JNIEnv *env, jclass, jint x, jint y) {
+  TRACE_NATIVE();
   try {
     return yices_idiv(x, y);
   } catch (std::bad_alloc &ba) {
@@ -1552,6 +2372,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_idiv(JNIEnv *env, jclass, jint x
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_imod(JNIEnv *env, jclass, jint x, jint y) {
+  TRACE_NATIVE();
   try {
     return yices_imod(x, y);
   } catch (std::bad_alloc &ba) {
@@ -1561,6 +2382,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_imod(JNIEnv *env, jclass, jint x
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_abs(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   try {
     return yices_abs(x);
   } catch (std::bad_alloc &ba) {
@@ -1570,6 +2392,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_abs(JNIEnv *env, jclass, jint x)
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_floor(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   try {
     return yices_floor(x);
   } catch (std::bad_alloc &ba) {
@@ -1579,6 +2402,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_floor(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_ceil(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   try {
     return yices_ceil(x);
   } catch (std::bad_alloc &ba) {
@@ -1588,6 +2412,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_ceil(JNIEnv *env, jclass, jint x
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_intPoly(JNIEnv *env, jclass, jlongArray coeff, jintArray t) {
+  TRACE_NATIVE();
   jint result = -1;
   jsize n = env->GetArrayLength(coeff);
 
@@ -1595,20 +2420,19 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_intPoly(JNIEnv *env, jclass, jlo
     // the two arrays must have the same size
     /*
      * TODO: we could filter out the case n=0
-     * or use AUX_SIZE'd arrays for n small?
+     * or copy the arrays into scratch buffers?
      */
     int32_t *a = array2int32(env, t, NULL);
-    jlong *c = env->GetLongArrayElements(coeff, NULL);
-    if (a == NULL || c == NULL) {
+    pinned_array<jlongArray> c(env, coeff);
+    if (a == NULL || c.get() == NULL) {
       out_of_mem_exception(env);
     } else {
       try {
-        result = yices_poly_int64(n, reinterpret_cast<int64_t*>(c), a);
+        result = yices_poly_int64(n, reinterpret_cast<int64_t*>(c.get()), a);
       } catch (std::bad_alloc &ba) {
         out_of_mem_exception(env);
       }
     }
-    if (c != NULL) env->ReleaseLongArrayElements(coeff, c, JNI_ABORT);
     if (a != NULL) release_int32_elems(env, t, a);
   }
 
@@ -1617,6 +2441,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_intPoly(JNIEnv *env, jclass, jlo
 
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_rationalPoly(JNIEnv *env, jclass, jlongArray num, jlongArray den, jintArray t) {
+  TRACE_NATIVE();
   jint result = -1;
   jsize n = env->GetArrayLength(num);
 
@@ -1625,23 +2450,21 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_rationalPoly(JNIEnv *env, jclass
     // the three arrays must have the same size
     /*
      * TODO: we could filter out the case n=0
-     * or use AUX_SIZE'd arrays for n small?
+     * or copy the arrays into scratch buffers?
      */
     int32_t *a = array2int32(env, t, NULL);
-    jlong *p = env->GetLongArrayElements(num, NULL);
-    jlong *q = env->GetLongArrayElements(den, NULL);
-    if (a == NULL || p == NULL || q == NULL) {
+    pinned_array<jlongArray> p(env, num);
+    pinned_array<jlongArray> q(env, den);
+    if (a == NULL || p.get() == NULL || q.get() == NULL) {
       out_of_mem_exception(env);
-    } else if (all_positive_longs(n, q)) {
+    } else if (all_positive_longs(n, q.get())) {
       // fail if den[i] < 0 for some i
       try {
-        result = yices_poly_rational64(n, reinterpret_cast<int64_t*>(p), reinterpret_cast<uint64_t*>(q), a);
+        result = yices_poly_rational64(n, reinterpret_cast<int64_t*>(p.get()), reinterpret_cast<uint64_t*>(q.get()), a);
       } catch (std::bad_alloc &ba) {
         out_of_mem_exception(env);
       }
     }
-    if (q != NULL) env->ReleaseLongArrayElements(den, q, JNI_ABORT);
-    if (p != NULL) env->ReleaseLongArrayElements(num, p, JNI_ABORT);
     if (a != NULL) release_int32_elems(env, t, a);
   }
 
@@ -1649,6 +2472,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_rationalPoly(JNIEnv *env, jclass
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_divides(JNIEnv *env, jclass, jint x, jint y) {
+  TRACE_NATIVE();
   try {
     return yices_divides_atom(x, y);
   } catch (std::bad_alloc &ba) {
@@ -1658,6 +2482,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_divides(JNIEnv *env, jclass, jin
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_isInt(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   try {
     return yices_is_int_atom(x);
   } catch (std::bad_alloc &ba) {
@@ -1667,6 +2492,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_isInt(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithEq(JNIEnv *env, jclass, jint x, jint y) {
+  TRACE_NATIVE();
   try {
     return yices_arith_eq_atom(x, y);
   } catch (std::bad_alloc &ba) {
@@ -1676,6 +2502,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithEq(JNIEnv *env, jclass, jin
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithNeq(JNIEnv *env, jclass, jint x, jint y) {
+  TRACE_NATIVE();
   try {
     return yices_arith_neq_atom(x, y);
   } catch (std::bad_alloc &ba) {
@@ -1685,6 +2512,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithNeq(JNIEnv *env, jclass, ji
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithGeq(JNIEnv *env, jclass, jint x, jint y) {
+  TRACE_NATIVE();
   try {
     return yices_arith_geq_atom(x, y);
   } catch (std::bad_alloc &ba) {
@@ -1694,6 +2522,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithGeq(JNIEnv *env, jclass, ji
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithLeq(JNIEnv *env, jclass, jint x, jint y) {
+  TRACE_NATIVE();
   try {
     return yices_arith_leq_atom(x, y);
   } catch (std::bad_alloc &ba) {
@@ -1703,6 +2532,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithLeq(JNIEnv *env, jclass, ji
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithGt(JNIEnv *env, jclass, jint x, jint y) {
+  TRACE_NATIVE();
   try {
     return yices_arith_gt_atom(x, y);
   } catch (std::bad_alloc &ba) {
@@ -1712,6 +2542,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithGt(JNIEnv *env, jclass, jin
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithLt(JNIEnv *env, jclass, jint x, jint y) {
+  TRACE_NATIVE();
   try {
     return yices_arith_lt_atom(x, y);
   } catch (std::bad_alloc &ba) {
@@ -1721,6 +2552,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithLt(JNIEnv *env, jclass, jin
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithEq0(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   try {
     return yices_arith_eq0_atom(x);
   } catch (std::bad_alloc &ba) {
@@ -1730,6 +2562,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithEq0(JNIEnv *env, jclass, ji
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithNeq0(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   try {
     return yices_arith_neq0_atom(x);
   } catch (std::bad_alloc &ba) {
@@ -1739,6 +2572,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithNeq0(JNIEnv *env, jclass, j
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithGeq0(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   try {
     return yices_arith_geq0_atom(x);
   } catch (std::bad_alloc &ba) {
@@ -1748,6 +2582,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithGeq0(JNIEnv *env, jclass, j
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithLeq0(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   try {
     return yices_arith_leq0_atom(x);
   } catch (std::bad_alloc &ba) {
@@ -1757,6 +2592,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithLeq0(JNIEnv *env, jclass, j
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithGt0(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   try {
     return yices_arith_gt0_atom(x);
   } catch (std::bad_alloc &ba) {
@@ -1766,6 +2602,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithGt0(JNIEnv *env, jclass, ji
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithLt0(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   try {
     return yices_arith_lt0_atom(x);
   } catch (std::bad_alloc &ba) {
@@ -1779,6 +2616,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_arithLt0(JNIEnv *env, jclass, ji
  */
 // convert x to a bitvector od n bits
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvConst(JNIEnv *env, jclass, jint n, jlong x) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (n > 0) {
@@ -1792,6 +2630,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvConst(JNIEnv *env, jclass, jin
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvZero(JNIEnv *env, jclass, jint n) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (n > 0) {
@@ -1805,6 +2644,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvZero(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvOne(JNIEnv *env, jclass, jint n) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (n > 0) {
@@ -1818,6 +2658,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvOne(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvMinusOne(JNIEnv *env, jclass, jint n) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (n > 0) {
@@ -1831,6 +2672,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvMinusOne(JNIEnv *env, jclass,
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvConstFromIntArray(JNIEnv *env, jclass, jintArray arg) {
+  TRACE_NATIVE();
   jint result = -1;
   jsize n = env->GetArrayLength(arg);
 
@@ -1851,44 +2693,101 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvConstFromIntArray(JNIEnv *env,
   return result;
 }
 
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_parseBvBin(JNIEnv *env, jclass, jstring s) {
+/*
+ * Constant of n bits from packed words or bytes
+ * - bit i is bit (i % 64) of w[i/64] (or bit (i % 8) of byte i/8 in the buffer)
+ * - return -1 if n <= 0 or there are not enough words or bytes
+ */
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvConstFromWords(JNIEnv *env, jclass, jint n, jlongArray w) {
+  TRACE_NATIVE();
   jint result = -1;
-  const char *aux = env->GetStringUTFChars(s, NULL);
 
-  if (aux == NULL) {
-    out_of_mem_exception(env);
-  } else {
+  if (n > 0 && env->GetArrayLength(w) >= n/64 + (n % 64 != 0)) {
+    jsize nw = n/64 + (n % 64 != 0);
+    uint64_t *aux = NULL;
+    int32_t *a = NULL;
     try {
-      result = yices_parse_bvbin(aux);
+      aux = new uint64_t[nw];
+      assert(sizeof(uint64_t) == sizeof(jlong));
+      env->GetLongArrayRegion(w, 0, nw, reinterpret_cast<jlong*>(aux));
+      if (n <= 64) {
+        result = yices_bvconst_uint64(n, aux[0]);
+      } else {
+        a = scratch_alloc(n);
+        unpack_bits(n, aux, a);
+        result = yices_bvconst_from_array(n, a);
+      }
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    env->ReleaseStringUTFChars(s, aux);
+    if (a != NULL) scratch_free(a);
+    delete [] aux;
   }
 
   return result;
 }
 
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_parseBvHex(JNIEnv *env, jclass, jstring s) {
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvConstFromBytes(JNIEnv *env, jclass, jint n, jobject buffer, jint offset) {
+  TRACE_NATIVE();
+  jint result = -1;
+
+  if (n > 0) {
+    const uint8_t *b = direct_byte_buffer(env, buffer, offset, n/8 + (n % 8 != 0));
+    if (b != NULL) {
+      int32_t *a = NULL;
+      try {
+        a = scratch_alloc(n);
+        unpack_bits(n, b, a);
+        result = yices_bvconst_from_array(n, a);
+      } catch (std::bad_alloc &ba) {
+        out_of_mem_exception(env);
+      }
+      if (a != NULL) scratch_free(a);
+    }
+  }
+
+  return result;
+}
+
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_parseBvBin(JNIEnv *env, jclass, jstring s) {
+  TRACE_NATIVE();
   jint result = -1;
-  const char *aux = env->GetStringUTFChars(s, NULL);
+  utf_chars aux(env, s);
 
-  if (aux == NULL) {
+  if (aux.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     try {
-      result = yices_parse_bvhex(aux);
+      result = yices_parse_bvbin(aux.get());
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    env->ReleaseStringUTFChars(s, aux);
   }
 
   return result;
 }
 
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvAdd__II(JNIEnv *env, jclass, jint left, jint right) {
-  try {
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_parseBvHex(JNIEnv *env, jclass, jstring s) {
+  TRACE_NATIVE();
+  jint result = -1;
+  utf_chars aux(env, s);
+
+  if (aux.get() == NULL) {
+    out_of_mem_exception(env);
+  } else {
+    try {
+      result = yices_parse_bvhex(aux.get());
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+  }
+
+  return result;
+}
+
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvAdd__II(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
+  try {
     return yices_bvadd(left, right);
   } catch (std::bad_alloc &ba) {
     out_of_mem_exception(env);
@@ -1897,6 +2796,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvAdd__II(JNIEnv *env, jclass, j
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSub(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvsub(left, right);
   } catch (std::bad_alloc &ba) {
@@ -1906,6 +2806,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSub(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvNeg(JNIEnv *env, jclass, jint arg) {
+  TRACE_NATIVE();
   try {
     return yices_bvneg(arg);
   } catch (std::bad_alloc &ba) {
@@ -1915,6 +2816,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvNeg(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvMul__II(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvmul(left, right);
   } catch (std::bad_alloc &ba) {
@@ -1924,6 +2826,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvMul__II(JNIEnv *env, jclass, j
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSquare(JNIEnv *env, jclass, jint arg) {
+  TRACE_NATIVE();
   try {
     return yices_bvsquare(arg);
   } catch (std::bad_alloc &ba) {
@@ -1933,6 +2836,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSquare(JNIEnv *env, jclass, ji
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvPower(JNIEnv *env, jclass, jint arg, jint exponent) {
+  TRACE_NATIVE();
   if (exponent < 0) {
     return -1; // negative exponents are not supported
   }
@@ -1945,6 +2849,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvPower(JNIEnv *env, jclass, jin
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvDiv(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvdiv(left, right);
   } catch (std::bad_alloc &ba) {
@@ -1954,6 +2859,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvDiv(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvRem(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvrem(left, right);
   } catch (std::bad_alloc &ba) {
@@ -1963,6 +2869,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvRem(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSDiv(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvsdiv(left, right);
   } catch (std::bad_alloc &ba) {
@@ -1972,6 +2879,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSDiv(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSRem(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvsrem(left, right);
   } catch (std::bad_alloc &ba) {
@@ -1981,6 +2889,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSRem(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSMod(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvsmod(left, right);
   } catch (std::bad_alloc &ba) {
@@ -1990,6 +2899,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSMod(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvNot(JNIEnv *env, jclass, jint arg) {
+  TRACE_NATIVE();
   try {
     return yices_bvnot(arg);
   } catch (std::bad_alloc &ba) {
@@ -1999,6 +2909,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvNot(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvAnd__II(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvand2(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2008,6 +2919,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvAnd__II(JNIEnv *env, jclass, j
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvOr__II(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvor2(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2017,6 +2929,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvOr__II(JNIEnv *env, jclass, ji
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvXor__II(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvxor2(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2026,6 +2939,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvXor__II(JNIEnv *env, jclass, j
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvNand(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvnand(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2035,6 +2949,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvNand(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvNor(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvnor(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2044,6 +2959,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvNor(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvXNor(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvxnor(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2053,6 +2969,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvXNor(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvShl(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvshl(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2062,6 +2979,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvShl(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvLshr(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvlshr(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2071,6 +2989,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvLshr(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvAshr(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvashr(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2080,106 +2999,67 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvAshr(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvAdd___3I(JNIEnv *env, jclass, jintArray arg) {
-  jint result = -1;
-  jsize n = env->GetArrayLength(arg);
+  TRACE_NATIVE();
+  if (env->GetArrayLength(arg) == 0) return -1;
+  return nary_term(env, yices_bvsum, arg);
+}
 
-  if (n > 0) {
-    term_t *a = array2terms(env, arg, NULL);
-    if (a == NULL) {
-      out_of_mem_exception(env);
-    } else {
-      try {
-        result = yices_bvsum(n, a);
-      } catch (std::bad_alloc &ba) {
-        out_of_mem_exception(env);
-      }
-      release_term_elems(env, arg, a);
-    }
-  }
-  return result;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvAdd__Ljava_nio_IntBuffer_2II(JNIEnv *env, jclass, jobject arg, jint offset, jint n) {
+  TRACE_NATIVE();
+  if (n <= 0) return -1;
+  return direct_nary_term(env, yices_bvsum, arg, offset, n);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvMul___3I(JNIEnv *env, jclass, jintArray arg) {
-  jint result = -1;
-  jsize n = env->GetArrayLength(arg);
+  TRACE_NATIVE();
+  if (env->GetArrayLength(arg) == 0) return -1;
+  return nary_term(env, yices_bvproduct, arg);
+}
 
-  if (n > 0) {
-    term_t *a = array2terms(env, arg, NULL);
-    if (a == NULL) {
-      out_of_mem_exception(env);
-    } else {
-      try {
-        result = yices_bvproduct(n, a);
-      } catch (std::bad_alloc &ba) {
-        out_of_mem_exception(env);
-      }
-      release_term_elems(env, arg, a);
-    }
-  }
-  return result;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvMul__Ljava_nio_IntBuffer_2II(JNIEnv *env, jclass, jobject arg, jint offset, jint n) {
+  TRACE_NATIVE();
+  if (n <= 0) return -1;
+  return direct_nary_term(env, yices_bvproduct, arg, offset, n);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvAnd___3I(JNIEnv *env, jclass, jintArray arg) {
-  jint result = -1;
-  jsize n = env->GetArrayLength(arg);
+  TRACE_NATIVE();
+  if (env->GetArrayLength(arg) == 0) return -1;
+  return nary_term(env, yices_bvand, arg);
+}
 
-  if (n > 0) {
-    term_t *a = array2terms(env, arg, NULL);
-    if (a == NULL) {
-      out_of_mem_exception(env);
-    } else {
-      try {
-        result = yices_bvand(n, a);
-      } catch (std::bad_alloc &ba) {
-        out_of_mem_exception(env);
-      }
-      release_term_elems(env, arg, a);
-    }
-  }
-  return result;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvAnd__Ljava_nio_IntBuffer_2II(JNIEnv *env, jclass, jobject arg, jint offset, jint n) {
+  TRACE_NATIVE();
+  if (n <= 0) return -1;
+  return direct_nary_term(env, yices_bvand, arg, offset, n);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvOr___3I(JNIEnv *env, jclass, jintArray arg) {
-  jint result = -1;
-  jsize n = env->GetArrayLength(arg);
+  TRACE_NATIVE();
+  if (env->GetArrayLength(arg) == 0) return -1;
+  return nary_term(env, yices_bvor, arg);
+}
 
-  if (n > 0) {
-    term_t *a = array2terms(env, arg, NULL);
-    if (a == NULL) {
-      out_of_mem_exception(env);
-    } else {
-      try {
-        result = yices_bvor(n, a);
-      } catch (std::bad_alloc &ba) {
-        out_of_mem_exception(env);
-      }
-      release_term_elems(env, arg, a);
-    }
-  }
-  return result;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvOr__Ljava_nio_IntBuffer_2II(JNIEnv *env, jclass, jobject arg, jint offset, jint n) {
+  TRACE_NATIVE();
+  if (n <= 0) return -1;
+  return direct_nary_term(env, yices_bvor, arg, offset, n);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvXor___3I(JNIEnv *env, jclass, jintArray arg) {
-  jint result = -1;
-  jsize n = env->GetArrayLength(arg);
+  TRACE_NATIVE();
+  if (env->GetArrayLength(arg) == 0) return -1;
+  return nary_term(env, yices_bvxor, arg);
+}
 
-  if (n > 0) {
-    term_t *a = array2terms(env, arg, NULL);
-    if (a == NULL) {
-      out_of_mem_exception(env);
-    } else {
-      try {
-        result = yices_bvxor(n, a);
-      } catch (std::bad_alloc &ba) {
-        out_of_mem_exception(env);
-      }
-      release_term_elems(env, arg, a);
-    }
-  }
-  return result;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvXor__Ljava_nio_IntBuffer_2II(JNIEnv *env, jclass, jobject arg, jint offset, jint n) {
+  TRACE_NATIVE();
+  if (n <= 0) return -1;
+  return direct_nary_term(env, yices_bvxor, arg, offset, n);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvShiftLeft0(JNIEnv *env, jclass, jint arg, jint n) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (n >= 0) {
@@ -2193,6 +3073,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvShiftLeft0(JNIEnv *env, jclass
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvShiftLeft1(JNIEnv *env, jclass, jint arg, jint n) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (n >= 0) {
@@ -2206,6 +3087,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvShiftLeft1(JNIEnv *env, jclass
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvShiftRight0(JNIEnv *env, jclass, jint arg, jint n) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (n >= 0) {
@@ -2219,6 +3101,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvShiftRight0(JNIEnv *env, jclas
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvShiftRight1(JNIEnv *env, jclass, jint arg, jint n) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (n >= 0) {
@@ -2232,6 +3115,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvShiftRight1(JNIEnv *env, jclas
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvAShiftRight(JNIEnv *env, jclass, jint arg, jint n) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (n >= 0) {
@@ -2245,6 +3129,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvAShiftRight(JNIEnv *env, jclas
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvRotateLeft(JNIEnv *env, jclass, jint arg, jint n) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (n >= 0) {
@@ -2258,6 +3143,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvRotateLeft(JNIEnv *env, jclass
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvRotateRight(JNIEnv *env, jclass, jint arg, jint n) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (n >= 0) {
@@ -2271,6 +3157,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvRotateRight(JNIEnv *env, jclas
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvExtract(JNIEnv *env, jclass, jint arg, jint i, jint j) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (i >= 0 && j >= 0) {
@@ -2284,6 +3171,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvExtract(JNIEnv *env, jclass, j
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvExtractBit(JNIEnv *env, jclass, jint arg, jint i) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (i >= 0) {
@@ -2296,27 +3184,20 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvExtractBit(JNIEnv *env, jclass
   return result;
 }
 
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvFromBoolArray(JNIEnv *env, jclass, jintArray arg) {
-  jint result = -1;
-  jsize n = env->GetArrayLength(arg);
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvFromBoolArray___3I(JNIEnv *env, jclass, jintArray arg) {
+  TRACE_NATIVE();
+  if (env->GetArrayLength(arg) == 0) return -1;
+  return nary_term(env, yices_bvarray, arg);
+}
 
-  if (n > 0) {
-    term_t *a = array2terms(env, arg, NULL);
-    if (a == NULL) {
-      out_of_mem_exception(env);
-    } else {
-      try {
-        result = yices_bvarray(n, a);
-      } catch (std::bad_alloc &ba) {
-        out_of_mem_exception(env);
-      }
-      release_term_elems(env, arg, a);
-    }
-  }
-  return result;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvFromBoolArray__Ljava_nio_IntBuffer_2II(JNIEnv *env, jclass, jobject arg, jint offset, jint n) {
+  TRACE_NATIVE();
+  if (n <= 0) return -1;
+  return direct_nary_term(env, yices_bvarray, arg, offset, n);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvConcat__II(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvconcat2(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2326,26 +3207,19 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvConcat__II(JNIEnv *env, jclass
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvConcat___3I(JNIEnv *env, jclass, jintArray arg) {
-  jint result = -1;
-  jsize n = env->GetArrayLength(arg);
+  TRACE_NATIVE();
+  if (env->GetArrayLength(arg) == 0) return -1;
+  return nary_term(env, yices_bvconcat, arg);
+}
 
-  if (n > 0) {
-    term_t *a = array2terms(env, arg, NULL);
-    if (a == NULL) {
-      out_of_mem_exception(env);
-    } else {
-      try {
-        result = yices_bvconcat(n, a);
-      } catch (std::bad_alloc &ba) {
-        out_of_mem_exception(env);
-      }
-      release_term_elems(env, arg, a);
-    }
-  }
-  return result;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvConcat__Ljava_nio_IntBuffer_2II(JNIEnv *env, jclass, jobject arg, jint offset, jint n) {
+  TRACE_NATIVE();
+  if (n <= 0) return -1;
+  return direct_nary_term(env, yices_bvconcat, arg, offset, n);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvRepeat(JNIEnv *env, jclass, jint arg, jint n) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (n >= 0) {
@@ -2359,6 +3233,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvRepeat(JNIEnv *env, jclass, ji
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSignExtend(JNIEnv *env, jclass, jint arg, jint n) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (n >= 0) {
@@ -2372,6 +3247,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSignExtend(JNIEnv *env, jclass
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvZeroExtend(JNIEnv *env, jclass, jint arg, jint n) {
+  TRACE_NATIVE();
   jint result = -1;
 
   if (n >= 0) {
@@ -2385,6 +3261,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvZeroExtend(JNIEnv *env, jclass
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvRedAnd(JNIEnv *env, jclass, jint arg) {
+  TRACE_NATIVE();
   try {
     return yices_redand(arg);
   } catch (std::bad_alloc &ba) {
@@ -2394,6 +3271,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvRedAnd(JNIEnv *env, jclass, ji
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvRedOr(JNIEnv *env, jclass, jint arg) {
+  TRACE_NATIVE();
   try {
     return yices_redor(arg);
   } catch (std::bad_alloc &ba) {
@@ -2403,6 +3281,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvRedOr(JNIEnv *env, jclass, jin
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvRedComp(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_redcomp(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2412,6 +3291,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvRedComp(JNIEnv *env, jclass, j
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvEq(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bveq_atom(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2421,6 +3301,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvEq(JNIEnv *env, jclass, jint l
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvNeq(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvneq_atom(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2430,6 +3311,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvNeq(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvGe(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvge_atom(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2439,6 +3321,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvGe(JNIEnv *env, jclass, jint l
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvGt(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvgt_atom(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2448,6 +3331,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvGt(JNIEnv *env, jclass, jint l
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvLe(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvle_atom(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2457,6 +3341,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvLe(JNIEnv *env, jclass, jint l
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvLt(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvlt_atom(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2466,6 +3351,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvLt(JNIEnv *env, jclass, jint l
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSGe(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvsge_atom(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2475,6 +3361,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSGe(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSGt(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvsgt_atom(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2484,6 +3371,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSGt(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSLe(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvsle_atom(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2493,6 +3381,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSLe(JNIEnv *env, jclass, jint
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSLt(JNIEnv *env, jclass, jint left, jint right) {
+  TRACE_NATIVE();
   try {
     return yices_bvslt_atom(left, right);
   } catch (std::bad_alloc &ba) {
@@ -2502,53 +3391,398 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_bvSLt(JNIEnv *env, jclass, jint
 }
 
 
+/*
+ * BATCH CONSTRUCTION
+ */
+
+/*
+ * A batch program is an array of instructions. Each instruction is
+ *   op, m, x[0], ..., x[m-1]
+ * where op is one of the codes below and x[0 ... m-1] are the operands.
+ *
+ * Term operands are interpreted as follows:
+ * - x >= 0 is a term index
+ * - x < 0 denotes the result of instruction ~x (i.e., -(x+1)) in the same batch.
+ *   This instruction must precede the current one, otherwise the operand is
+ *   replaced by NULL_TERM and Yices reports an error.
+ * Some operations also take immediate (non-term) operands: bit sizes, indices,
+ * shift amounts, exponents, etc.
+ *
+ * The op codes must match the constants defined in TermBatch.java.
+ */
+enum batch_op {
+  // Boolean and generic: NOT t, AND t ..., OR t ..., XOR t ..., IFF t u,
+  // IMPLIES t u, ITE c t u, EQ t u, NEQ t u, DISTINCT t ...
+  BATCH_NOT = 0,
+  BATCH_AND,
+  BATCH_OR,
+  BATCH_XOR,
+  BATCH_IFF,
+  BATCH_IMPLIES,
+  BATCH_ITE,
+  BATCH_EQ,
+  BATCH_NEQ,
+  BATCH_DISTINCT,
+  // tuples and functions: TUPLE t ..., SELECT idx t, TUPLE_UPDATE t idx v,
+  // APPLY f t ..., UPDATE f t ... v, FORALL/EXISTS/LAMBDA var ... body
+  BATCH_TUPLE,
+  BATCH_SELECT,
+  BATCH_TUPLE_UPDATE,
+  BATCH_APPLY,
+  BATCH_UPDATE,
+  BATCH_FORALL,
+  BATCH_EXISTS,
+  BATCH_LAMBDA,
+  // fresh terms: UNINTERPRETED tau, VARIABLE tau
+  BATCH_UNINTERPRETED,
+  BATCH_VARIABLE,
+  // arithmetic: INT lo hi (64bit constant = hi * 2^32 + lo), POWER t d
+  BATCH_INT,
+  BATCH_ADD,
+  BATCH_SUB,
+  BATCH_NEG,
+  BATCH_MUL,
+  BATCH_SQUARE,
+  BATCH_POWER,
+  BATCH_DIV,
+  BATCH_IDIV,
+  BATCH_IMOD,
+  BATCH_ABS,
+  BATCH_FLOOR,
+  BATCH_CEIL,
+  BATCH_DIVIDES,
+  BATCH_IS_INT,
+  BATCH_ARITH_EQ,
+  BATCH_ARITH_NEQ,
+  BATCH_ARITH_GEQ,
+  BATCH_ARITH_LEQ,
+  BATCH_ARITH_GT,
+  BATCH_ARITH_LT,
+  // bitvectors: BV_CONST n lo hi, BV_POWER t d, shifts/rotate t n,
+  // BV_EXTRACT t i j, BV_EXTRACT_BIT t i, BV_REPEAT/SIGN_EXTEND/ZERO_EXTEND t n
+  BATCH_BV_CONST,
+  BATCH_BV_ADD,
+  BATCH_BV_SUB,
+  BATCH_BV_NEG,
+  BATCH_BV_MUL,
+  BATCH_BV_SQUARE,
+  BATCH_BV_POWER,
+  BATCH_BV_DIV,
+  BATCH_BV_REM,
+  BATCH_BV_SDIV,
+  BATCH_BV_SREM,
+  BATCH_BV_SMOD,
+  BATCH_BV_NOT,
+  BATCH_BV_AND,
+  BATCH_BV_OR,
+  BATCH_BV_XOR,
+  BATCH_BV_NAND,
+  BATCH_BV_NOR,
+  BATCH_BV_XNOR,
+  BATCH_BV_SHL,
+  BATCH_BV_LSHR,
+  BATCH_BV_ASHR,
+  BATCH_BV_SHIFT_LEFT0,
+  BATCH_BV_SHIFT_LEFT1,
+  BATCH_BV_SHIFT_RIGHT0,
+  BATCH_BV_SHIFT_RIGHT1,
+  BATCH_BV_ASHIFT_RIGHT,
+  BATCH_BV_ROTATE_LEFT,
+  BATCH_BV_ROTATE_RIGHT,
+  BATCH_BV_EXTRACT,
+  BATCH_BV_EXTRACT_BIT,
+  BATCH_BV_FROM_BOOL_ARRAY,
+  BATCH_BV_CONCAT,
+  BATCH_BV_REPEAT,
+  BATCH_BV_SIGN_EXTEND,
+  BATCH_BV_ZERO_EXTEND,
+  BATCH_BV_RED_AND,
+  BATCH_BV_RED_OR,
+  BATCH_BV_RED_COMP,
+  BATCH_BV_EQ,
+  BATCH_BV_NEQ,
+  BATCH_BV_GE,
+  BATCH_BV_GT,
+  BATCH_BV_LE,
+  BATCH_BV_LT,
+  BATCH_BV_SGE,
+  BATCH_BV_SGT,
+  BATCH_BV_SLE,
+  BATCH_BV_SLT,
+};
+
+// operand x of instruction k: r[0 ... k-1] = results of the previous instructions
+static inline term_t batch_operand(const term_t *r, int32_t k, int32_t x) {
+  if (x >= 0) return x;
+  x = ~x;
+  return (x < k) ? r[x] : NULL_TERM;
+}
+
+// copy the m term operands x[0 ... m-1] into a
+static void batch_operands(term_t *a, int32_t m, const int32_t *x, const term_t *r, int32_t k) {
+  for (int32_t i=0; i<m; i++) {
+    a[i] = batch_operand(r, k, x[i]);
+  }
+}
+
+/*
+ * Execute one instruction: op, m, x[0 ... m-1]
+ * - r = results of the previous k instructions
+ * - a = auxiliary buffer of size >= m
+ * - return the new term or NULL_TERM if something goes wrong.
+ *
+ * If the operands are wrong (e.g., the arity or an immediate operand is invalid)
+ * the function returns NULL_TERM without calling Yices. This matches what
+ * the corresponding single-term natives do.
+ */
+static term_t batch_instruction(int32_t op, int32_t m, const int32_t *x, const term_t *r, int32_t k, term_t *a) {
+
+#define ARG(i) batch_operand(r, k, x[i])
+#define UNARY(f) return (m == 1) ? f(ARG(0)) : NULL_TERM
+#define BINARY(f) return (m == 2) ? f(ARG(0), ARG(1)) : NULL_TERM
+#define NARY(f) batch_operands(a, m, x, r, k); return f(m, a)
+#define BV_NARY(f) if (m <= 0) return NULL_TERM; batch_operands(a, m, x, r, k); return f(m, a)
+#define IMMEDIATE(f) return (m == 2 && x[1] >= 0) ? f(ARG(0), x[1]) : NULL_TERM
+
+  switch (op) {
+  case BATCH_NOT: UNARY(yices_not);
+  case BATCH_AND: NARY(yices_and);
+  case BATCH_OR: NARY(yices_or);
+  case BATCH_XOR: NARY(yices_xor);
+  case BATCH_IFF: BINARY(yices_iff);
+  case BATCH_IMPLIES: BINARY(yices_implies);
+  case BATCH_ITE: return (m == 3) ? yices_ite(ARG(0), ARG(1), ARG(2)) : NULL_TERM;
+  case BATCH_EQ: BINARY(yices_eq);
+  case BATCH_NEQ: BINARY(yices_neq);
+  case BATCH_DISTINCT: NARY(yices_distinct);
+
+  case BATCH_TUPLE: NARY(yices_tuple);
+  case BATCH_SELECT: return (m == 2 && x[0] >= 0) ? yices_select(x[0], ARG(1)) : NULL_TERM;
+  case BATCH_TUPLE_UPDATE: return (m == 3 && x[1] >= 0) ? yices_tuple_update(ARG(0), x[1], ARG(2)) : NULL_TERM;
+  case BATCH_APPLY:
+    if (m < 2) return NULL_TERM;
+    batch_operands(a, m-1, x+1, r, k);
+    return yices_application(ARG(0), m-1, a);
+  case BATCH_UPDATE:
+    if (m < 3) return NULL_TERM;
+    batch_operands(a, m-2, x+1, r, k);
+    return yices_update(ARG(0), m-2, a, ARG(m-1));
+  case BATCH_FORALL:
+  case BATCH_EXISTS:
+  case BATCH_LAMBDA:
+    if (m < 2) return NULL_TERM;
+    batch_operands(a, m-1, x, r, k);
+    if (op == BATCH_FORALL) return yices_forall(m-1, a, ARG(m-1));
+    if (op == BATCH_EXISTS) return yices_exists(m-1, a, ARG(m-1));
+    return yices_lambda(m-1, a, ARG(m-1));
+
+  case BATCH_UNINTERPRETED: return (m == 1) ? yices_new_uninterpreted_term(x[0]) : NULL_TERM;
+  case BATCH_VARIABLE: return (m == 1) ? yices_new_variable(x[0]) : NULL_TERM;
+
+  case BATCH_INT:
+    return (m == 2) ? yices_int64((int64_t) (((uint64_t) (uint32_t) x[1]) << 32 | (uint32_t) x[0])) : NULL_TERM;
+  case BATCH_ADD: NARY(yices_sum);
+  case BATCH_SUB: BINARY(yices_sub);
+  case BATCH_NEG: UNARY(yices_neg);
+  case BATCH_MUL: NARY(yices_product);
+  case BATCH_SQUARE: UNARY(yices_square);
+  case BATCH_POWER: IMMEDIATE(yices_power);
+  case BATCH_DIV: BINARY(yices_division);
+  case BATCH_IDIV: BINARY(yices_idiv);
+  case BATCH_IMOD: BINARY(yices_imod);
+  case BATCH_ABS: UNARY(yices_abs);
+  case BATCH_FLOOR: UNARY(yices_floor);
+  case BATCH_CEIL: UNARY(yices_ceil);
+  case BATCH_DIVIDES: BINARY(yices_divides_atom);
+  case BATCH_IS_INT: UNARY(yices_is_int_atom);
+  case BATCH_ARITH_EQ: BINARY(yices_arith_eq_atom);
+  case BATCH_ARITH_NEQ: BINARY(yices_arith_neq_atom);
+  case BATCH_ARITH_GEQ: BINARY(yices_arith_geq_atom);
+  case BATCH_ARITH_LEQ: BINARY(yices_arith_leq_atom);
+  case BATCH_ARITH_GT: BINARY(yices_arith_gt_atom);
+  case BATCH_ARITH_LT: BINARY(yices_arith_lt_atom);
+
+  case BATCH_BV_CONST:
+    if (m != 3 || x[0] <= 0) return NULL_TERM;
+    return yices_bvconst_int64(x[0], (int64_t) (((uint64_t) (uint32_t) x[2]) << 32 | (uint32_t) x[1]));
+  case BATCH_BV_ADD: BV_NARY(yices_bvsum);
+  case BATCH_BV_SUB: BINARY(yices_bvsub);
+  case BATCH_BV_NEG: UNARY(yices_bvneg);
+  case BATCH_BV_MUL: BV_NARY(yices_bvproduct);
+  case BATCH_BV_SQUARE: UNARY(yices_bvsquare);
+  case BATCH_BV_POWER: IMMEDIATE(yices_bvpower);
+  case BATCH_BV_DIV: BINARY(yices_bvdiv);
+  case BATCH_BV_REM: BINARY(yices_bvrem);
+  case BATCH_BV_SDIV: BINARY(yices_bvsdiv);
+  case BATCH_BV_SREM: BINARY(yices_bvsrem);
+  case BATCH_BV_SMOD: BINARY(yices_bvsmod);
+  case BATCH_BV_NOT: UNARY(yices_bvnot);
+  case BATCH_BV_AND: BV_NARY(yices_bvand);
+  case BATCH_BV_OR: BV_NARY(yices_bvor);
+  case BATCH_BV_XOR: BV_NARY(yices_bvxor);
+  case BATCH_BV_NAND: BINARY(yices_bvnand);
+  case BATCH_BV_NOR: BINARY(yices_bvnor);
+  case BATCH_BV_XNOR: BINARY(yices_bvxnor);
+  case BATCH_BV_SHL: BINARY(yices_bvshl);
+  case BATCH_BV_LSHR: BINARY(yices_bvlshr);
+  case BATCH_BV_ASHR: BINARY(yices_bvashr);
+  case BATCH_BV_SHIFT_LEFT0: IMMEDIATE(yices_shift_left0);
+  case BATCH_BV_SHIFT_LEFT1: IMMEDIATE(yices_shift_left1);
+  case BATCH_BV_SHIFT_RIGHT0: IMMEDIATE(yices_shift_right0);
+  case BATCH_BV_SHIFT_RIGHT1: IMMEDIATE(yices_shift_right1);
+  case BATCH_BV_ASHIFT_RIGHT: IMMEDIATE(yices_ashift_right);
+  case BATCH_BV_ROTATE_LEFT: IMMEDIATE(yices_rotate_left);
+  case BATCH_BV_ROTATE_RIGHT: IMMEDIATE(yices_rotate_right);
+  case BATCH_BV_EXTRACT:
+    return (m == 3 && x[1] >= 0 && x[2] >= 0) ? yices_bvextract(ARG(0), x[1], x[2]) : NULL_TERM;
+  case BATCH_BV_EXTRACT_BIT: IMMEDIATE(yices_bitextract);
+  case BATCH_BV_FROM_BOOL_ARRAY: BV_NARY(yices_bvarray);
+  case BATCH_BV_CONCAT: BV_NARY(yices_bvconcat);
+  case BATCH_BV_REPEAT: IMMEDIATE(yices_bvrepeat);
+  case BATCH_BV_SIGN_EXTEND: IMMEDIATE(yices_sign_extend);
+  case BATCH_BV_ZERO_EXTEND: IMMEDIATE(yices_zero_extend);
+  case BATCH_BV_RED_AND: UNARY(yices_redand);
+  case BATCH_BV_RED_OR: UNARY(yices_redor);
+  case BATCH_BV_RED_COMP: BINARY(yices_redcomp);
+  case BATCH_BV_EQ: BINARY(yices_bveq_atom);
+  case BATCH_BV_NEQ: BINARY(yices_bvneq_atom);
+  case BATCH_BV_GE: BINARY(yices_bvge_atom);
+  case BATCH_BV_GT: BINARY(yices_bvgt_atom);
+  case BATCH_BV_LE: BINARY(yices_bvle_atom);
+  case BATCH_BV_LT: BINARY(yices_bvlt_atom);
+  case BATCH_BV_SGE: BINARY(yices_bvsge_atom);
+  case BATCH_BV_SGT: BINARY(yices_bvsgt_atom);
+  case BATCH_BV_SLE: BINARY(yices_bvsle_atom);
+  case BATCH_BV_SLT: BINARY(yices_bvslt_atom);
+  default:
+    return NULL_TERM;
+  }
+
+#undef ARG
+#undef UNARY
+#undef BINARY
+#undef NARY
+#undef BV_NARY
+#undef IMMEDIATE
+}
+
+/*
+ * Run the n instructions stored in program and return the n resulting terms.
+ * - return NULL if an instruction fails or if program is malformed
+ *   (i.e., it contains fewer than n instructions).
+ * The Yices error is cleared first: if it's still 0 when this returns NULL,
+ * then the program is malformed (bad op, arity, or immediate operand).
+ */
+JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_termBatch(JNIEnv *env, jclass, jintArray program, jint n) {
+  TRACE_NATIVE();
+  jintArray result = NULL;
+  jsize len = env->GetArrayLength(program);
+
+  if (n < 0) return NULL;
+
+  int32_t *p = array2int32(env, program, NULL);
+  if (p == NULL) {
+    out_of_mem_exception(env);
+    return NULL;
+  }
+
+  term_t *r = NULL;
+  term_t *a = NULL;
+  int32_t size = ARENA_INIT_SIZE;
+  yices_clear_error();
+  try {
+    r = new term_t[n];
+    a = scratch_alloc(size);
+    int32_t i = 0;
+    int32_t k;
+    for (k=0; k<n; k++) {
+      if (len - i < 2) break;
+      int32_t op = p[i];
+      int32_t m = p[i+1];
+      if (m < 0 || m > len - i - 2) break;
+      if (m > size) {
+        scratch_free(a);
+        a = NULL;
+        a = scratch_alloc(m);
+        size = m;
+      }
+      r[k] = batch_instruction(op, m, p + i + 2, r, k, a);
+      if (r[k] < 0) break;
+      i += 2 + m;
+    }
+    if (k == n) {
+      result = convertToIntArray(env, n, r);
+    }
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+
+  if (a != NULL) scratch_free(a);
+  delete [] r;
+  release_int32_elems(env, program, p);
+
+  return result;
+}
+
+
 /*
  * ACCESSORS AND CHECKS
  */
 
 // These shouldn't caue out-of-memory exception
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_typeOfTerm(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_type_of_term(x);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsBool(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_is_bool(x);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsInt(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_is_int(x);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsReal(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_is_real(x);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsArithmetic(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_is_arithmetic(x);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsBitvector(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_is_bitvector(x);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsTuple(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_is_tuple(x);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsFunction(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_is_function(x);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsScalar(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_is_scalar(x);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_termBitSize(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_bitsize(x);
 }
 
 // this one allocates auxiliary data structures
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsGround(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   try {
     return yices_term_is_ground(x);
   } catch (std::bad_alloc &ba) {
@@ -2558,39 +3792,48 @@ JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsGround(JNIEnv *env, jc
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsAtomic(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_is_atomic(x);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsComposite(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_is_composite(x);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsProjection(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_is_projection(x);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsSum(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_is_sum(x);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsBvSum(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_is_bvsum(x);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_termIsProduct(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_is_product(x);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_termConstructor(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   // we just return the Yices constructor code here
   return yices_term_constructor(x);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_termNumChildren(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_term_num_children(x);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_termChild(JNIEnv *env, jclass, jint x, jint idx) {
+  TRACE_NATIVE();
   return yices_term_child(x, idx);
 }
 
@@ -2599,6 +3842,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_termChild(JNIEnv *env, jclass, j
  * return NULL is t is not a valid term
  */
 JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_termChildren(JNIEnv *env, jclass, jint t) {
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_2
   term_vector_t aux;
   jintArray result = NULL;
@@ -2623,104 +3867,1125 @@ JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_termChildren(JNIEnv *env, j
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_termProjIndex(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_proj_index(x);
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_termProjArg(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
   return yices_proj_arg(x);
 }
 
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_boolConstValue(JNIEnv *env, jclass, jint x) {
-  int32_t val;
-  jint result;
-
-  result = yices_bool_const_value(x, &val);
-  if (result == 0) {
-    result = val;
-  }
-  return result;
-}
+/*
+ * Everything about term x in one call (cf. TermInfo.java):
+ *   r[0] = constructor
+ *   r[1] = type
+ *   r[2] = number of bits (0 if x is not a bitvector)
+ *   r[3] = flags (one bit per termIsXXX test)
+ *   r[4] = number of children (as in termNumChildren)
+ *   r[5] = projection index (-1 if x is not a projection)
+ *   r[6 ...] = the children if x is composite, or the argument if x is a projection
+ * Returns NULL if x is not a valid term.
+ */
+#define TERM_INFO_HEADER 6
 
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_scalarConstantIndex(JNIEnv *env, jclass, jint x) {
-  int32_t val;
-  jint result;
+JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_termInfo(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
+  jintArray result = NULL;
 
-  result = yices_scalar_const_value(x, &val);
-  if (result == 0) {
-    result = val;
+  type_t tau = yices_type_of_term(x);
+  if (tau < 0) return NULL;
+
+  try {
+    int32_t flags = 0;
+    if (yices_term_is_bool(x)) flags |= 0x1;
+    if (yices_term_is_int(x)) flags |= 0x2;
+    if (yices_term_is_real(x)) flags |= 0x4;
+    if (yices_term_is_arithmetic(x)) flags |= 0x8;
+    if (yices_term_is_bitvector(x)) flags |= 0x10;
+    if (yices_term_is_tuple(x)) flags |= 0x20;
+    if (yices_term_is_function(x)) flags |= 0x40;
+    if (yices_term_is_scalar(x)) flags |= 0x80;
+    if (yices_term_is_ground(x)) flags |= 0x100;
+    if (yices_term_is_atomic(x)) flags |= 0x200;
+    if (yices_term_is_composite(x)) flags |= 0x400;
+    if (yices_term_is_projection(x)) flags |= 0x800;
+    if (yices_term_is_sum(x)) flags |= 0x1000;
+    if (yices_term_is_bvsum(x)) flags |= 0x2000;
+    if (yices_term_is_product(x)) flags |= 0x4000;
+
+    int32_t nchildren = yices_term_num_children(x);
+    std::vector<int32_t> r(TERM_INFO_HEADER);
+    r[0] = yices_term_constructor(x);
+    r[1] = tau;
+    r[2] = (flags & 0x10) ? yices_term_bitsize(x) : 0;
+    r[3] = flags;
+    r[4] = nchildren;
+    r[5] = -1;
+    if (flags & 0x400) {
+      for (int32_t i=0; i<nchildren; i++) {
+        r.push_back(yices_term_child(x, i));
+      }
+    } else if (flags & 0x800) {
+      r[5] = yices_proj_index(x);
+      r.push_back(yices_proj_arg(x));
+    }
+    result = convertToIntArray(env, r.size(), r.data());
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
   }
   return result;
 }
 
-JNIEXPORT jbooleanArray JNICALL Java_com_sri_yices_Yices_bvConstValue(JNIEnv *env, jclass, jint x) {
-  jbooleanArray result = NULL;
-
-  if (yices_term_constructor(x) == YICES_BV_CONSTANT) {
-    int32_t n = yices_term_bitsize(x);
 
-    assert(n >= 0);
+/*
+ * DAG TRAVERSAL
+ */
 
-    if (n <= 64) {
-      // this should be the common case
-      int32_t a[64];
-      int32_t code = yices_bv_const_value(x, a);
-      assert(code >= 0);
-      result = convertToBoolArray(env, n, a);
+/*
+ * Children of t in the term DAG:
+ * - the children of a composite term
+ * - the argument of a projection
+ * - the non-constant terms of a sum, bitvector sum, or power product
+ *   (the coefficients and exponents are dropped)
+ * Returns false if t is not a valid term.
+ */
+static bool dag_children(term_t t, std::vector<term_t> &v) {
+  v.clear();
+  if (yices_term_is_composite(t)) {
+    int32_t n = yices_term_num_children(t);
+    for (int32_t i=0; i<n; i++) {
+      term_t c = yices_term_child(t, i);
+      if (c < 0) return false;
+      v.push_back(c);
+    }
+  } else if (yices_term_is_projection(t)) {
+    term_t c = yices_proj_arg(t);
+    if (c < 0) return false;
+    v.push_back(c);
+  } else if (yices_term_is_sum(t)) {
+    int32_t n = yices_term_num_children(t);
+    mpq_t q;
+    mpq_init(q);
+    for (int32_t i=0; i<n; i++) {
+      term_t c;
+      if (yices_sum_component(t, i, q, &c) < 0) {
+        mpq_clear(q);
+        return false;
+      }
+      if (c != NULL_TERM) v.push_back(c);
+    }
+    mpq_clear(q);
+  } else if (yices_term_is_bvsum(t)) {
+    int32_t n = yices_term_num_children(t);
+    std::vector<int32_t> val(yices_term_bitsize(t));
+    for (int32_t i=0; i<n; i++) {
+      term_t c;
+      if (yices_bvsum_component(t, i, val.data(), &c) < 0) return false;
+      if (c != NULL_TERM) v.push_back(c);
+    }
+  } else if (yices_term_is_product(t)) {
+    int32_t n = yices_term_num_children(t);
+    for (int32_t i=0; i<n; i++) {
+      term_t c;
+      uint32_t e;
+      if (yices_product_component(t, i, &c, &e) < 0) return false;
+      v.push_back(c);
+    }
+  } else if (yices_term_constructor(t) < 0) {
+    return false;
+  }
+  return true;
+}
 
+/*
+ * Sub-DAG reachable from roots[0 ... n-1] in topological order (children first)
+ * - order[i] = term of index i
+ * - the children of order[i] are kids[coff[i] ... coff[i+1]-1] (as indices in order)
+ * - index maps terms to their index
+ * Returns false if one of the terms is invalid.
+ */
+struct term_dag {
+  std::vector<term_t> order;
+  std::vector<int32_t> coff;
+  std::vector<int32_t> kids;
+  std::unordered_map<term_t, int32_t> index;
+};
+
+static bool collect_dag(const term_t *roots, jsize n, term_dag &dag) {
+  std::vector<std::pair<term_t, bool>> stack;
+  std::vector<term_t> children;
+
+  dag.coff.push_back(0);
+  for (jsize i=n; i>0; i--) {
+    stack.push_back(std::make_pair(roots[i-1], false));
+  }
+  while (!stack.empty()) {
+    term_t t = stack.back().first;
+    bool expanded = stack.back().second;
+    stack.pop_back();
+    if (dag.index.find(t) != dag.index.end()) continue;
+    if (!dag_children(t, children)) return false;
+    if (expanded) {
+      // all the children have an index now
+      for (term_t c: children) {
+        dag.kids.push_back(dag.index[c]);
+      }
+      dag.index[t] = dag.order.size();
+      dag.order.push_back(t);
+      dag.coff.push_back(dag.kids.size());
     } else {
-      try {
-        int32_t *tmp =  new int32_t[n];
-        int32_t code = yices_bv_const_value(x, tmp);
-        assert(code >= 0);
-        result = convertToBoolArray(env, n, tmp);
-        delete [] tmp;
-      } catch (std::bad_alloc) {
-        out_of_mem_exception(env);
+      stack.push_back(std::make_pair(t, true));
+      for (size_t j=children.size(); j>0; j--) {
+        if (dag.index.find(children[j-1]) == dag.index.end()) {
+          stack.push_back(std::make_pair(children[j-1], false));
+        }
       }
     }
   }
-
-  return result;
+  return true;
 }
 
-
 /*
- * Numerator of a rational constant x
- * - return NULL if x is not a rational constant
- * - return a byte array that contains the numerator otherwise
+ * Sub-DAG reachable from roots, in topological order (children before parents).
+ * The result r contains:
+ *   r[0] = n = number of terms
+ *   r[1 ... n] = the terms
+ *   r[n+1 ... 2n] = their constructors
+ *   r[2n+1 ... 3n+1] = n+1 offsets into r: r[r[2n+1+i] ... r[2n+2+i]-1] are the
+ *   children of term i as indices between 0 and n-1
+ * Returns NULL if one of the terms is invalid.
  */
-JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_rationalConstNumAsBytes(JNIEnv *env, jclass, jint x) {
-  jbyteArray result = NULL;
-  mpq_t q;
+JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_termDag(JNIEnv *env, jclass, jintArray roots) {
+  TRACE_NATIVE();
+  jsize n = env->GetArrayLength(roots);
+  term_t *a = scratch_copy(env, roots, n);
+  jintArray result = NULL;
 
-  mpq_init(q);
-  if (yices_rational_const_value(x, q) >= 0) {
-    result = mpz_to_byte_array(env, mpq_numref(q));
+  if (a != NULL) {
+    try {
+      term_dag dag;
+      if (collect_dag(a, n, dag)) {
+        jsize m = dag.order.size();
+        jsize base = 2 + 3 * m;
+        std::vector<int32_t> r;
+        r.reserve(base + dag.kids.size());
+        r.push_back(m);
+        r.insert(r.end(), dag.order.begin(), dag.order.end());
+        for (term_t t: dag.order) r.push_back(yices_term_constructor(t));
+        for (int32_t k: dag.coff) r.push_back(base + k);
+        r.insert(r.end(), dag.kids.begin(), dag.kids.end());
+        result = convertToIntArray(env, r.size(), r.data());
+      }
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+    scratch_free(a);
   }
-  mpq_clear(q);
-
   return result;
 }
 
-
 /*
- * Denominator as an array of bytes
+ * Uninterpreted terms and free variables that occur in roots (each one once).
+ * - a variable is free if it occurs outside the scope of a quantifier or lambda that binds it
+ * - r[0] = k = number of uninterpreted terms
+ *   r[1 ... k] = the uninterpreted terms
+ *   r[k+1 ...] = the free variables
+ * Returns NULL if one of the terms is invalid.
  */
-JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_rationalConstDenAsBytes(JNIEnv *env, jclass, jint x) {
-  jbyteArray result = NULL;
-  mpq_t q;
+JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_termSymbols(JNIEnv *env, jclass, jintArray roots) {
+  TRACE_NATIVE();
+  jsize n = env->GetArrayLength(roots);
+  term_t *a = scratch_copy(env, roots, n);
+  jintArray result = NULL;
 
-  mpq_init(q);
-  if (yices_rational_const_value(x, q) >= 0) {
-    result = mpz_to_byte_array(env, mpq_denref(q));
+  if (a != NULL) {
+    try {
+      term_dag dag;
+      if (collect_dag(a, n, dag)) {
+        jsize m = dag.order.size();
+        std::vector<int32_t> r(1);
+        // free[i] = sorted free variables of term i
+        std::vector<std::vector<term_t>> free(m);
+        std::vector<term_t> aux;
+
+        for (jsize i=0; i<m; i++) {
+          term_t t = dag.order[i];
+          term_constructor_t c = yices_term_constructor(t);
+          if (c == YICES_UNINTERPRETED_TERM) {
+            r.push_back(t);
+          } else if (c == YICES_VARIABLE) {
+            free[i].push_back(t);
+          } else if (!yices_term_is_ground(t)) {
+            int32_t start = dag.coff[i];
+            int32_t end = dag.coff[i+1];
+            for (int32_t j=start; j<end; j++) {
+              const std::vector<term_t> &f = free[dag.kids[j]];
+              aux.clear();
+              std::set_union(free[i].begin(), free[i].end(), f.begin(), f.end(), std::back_inserter(aux));
+              free[i].swap(aux);
+            }
+            if (c == YICES_FORALL_TERM || c == YICES_LAMBDA_TERM) {
+              // the bound variables are all the children but the last one
+              for (int32_t j=start; j<end-1; j++) {
+                term_t x = dag.order[dag.kids[j]];
+                std::vector<term_t>::iterator it = std::lower_bound(free[i].begin(), free[i].end(), x);
+                if (it != free[i].end() && *it == x) free[i].erase(it);
+              }
+            }
+          }
+        }
+        r[0] = r.size() - 1;
+
+        aux.clear();
+        for (jsize i=0; i<n; i++) {
+          const std::vector<term_t> &f = free[dag.index[a[i]]];
+          std::vector<term_t> u;
+          std::set_union(aux.begin(), aux.end(), f.begin(), f.end(), std::back_inserter(u));
+          aux.swap(u);
+        }
+        r.insert(r.end(), aux.begin(), aux.end());
+        result = convertToIntArray(env, r.size(), r.data());
+      }
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+    scratch_free(a);
   }
-  mpq_clear(q);
-
   return result;
 }
 
-
-
+/*
+ * Size of roots:
+ * - size[0] = number of distinct subterms (i.e., size of the DAG)
+ * - size[1] = size of the roots as trees (shared subterms are counted as many times
+ *   as they occur), or Long.MAX_VALUE if that's too large
+ * Returns -1 if one of the terms is invalid, 0 otherwise.
+ */
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_termSize(JNIEnv *env, jclass, jintArray roots, jlongArray size) {
+  TRACE_NATIVE();
+  jsize n = env->GetArrayLength(roots);
+  term_t *a = scratch_copy(env, roots, n);
+  jint result = -1;
+
+  if (a != NULL) {
+    try {
+      term_dag dag;
+      if (collect_dag(a, n, dag)) {
+        const uint64_t max = std::numeric_limits<jlong>::max();
+        jsize m = dag.order.size();
+        std::vector<uint64_t> tree(m);
+        for (jsize i=0; i<m; i++) {
+          uint64_t s = 1;
+          for (int32_t j=dag.coff[i]; j<dag.coff[i+1]; j++) {
+            s += tree[dag.kids[j]];
+            if (s > max) s = max;
+          }
+          tree[i] = s;
+        }
+        uint64_t total = 0;
+        for (jsize i=0; i<n; i++) {
+          total += tree[dag.index[a[i]]];
+          if (total > max) total = max;
+        }
+        jlong r[2] = { (jlong) m, (jlong) total };
+        env->SetLongArrayRegion(size, 0, 2, r);
+        result = 0;
+      }
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+    scratch_free(a);
+  }
+  return result;
+}
+
+
+/*
+ * TERM SNAPSHOTS
+ *
+ * A snapshot is a binary encoding of the DAG reachable from a set of root terms,
+ * the types it uses, and their names. All entries are 32-bit words in native byte order:
+ * - header: magic, version, number of types, of terms, of names, and of roots
+ * - names: kind (0 for a type, 1 for a term), index, length, then the bytes
+ *   (padded to a multiple of four)
+ * - types: tag then payload
+ * - terms: constructor then payload
+ * - roots: term indices
+ * A type or term refers to earlier types and terms by their index, so a snapshot
+ * is loaded in one pass, by calling the term constructors in order.
+ *
+ * Rationals are written as sign, numerator, denominator where the numbers are
+ * magnitudes written as a word count followed by the words (least significant first).
+ * Bitvector constants are written as a bit count followed by the bits packed in words.
+ */
+#define SNAPSHOT_MAGIC 0x47414459      // "YDAG" on little-endian machines
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_NONE 0xFFFFFFFF       // no term in a sum component
+
+enum snapshot_type_tag {
+  SNAP_BOOL, SNAP_INT, SNAP_REAL, SNAP_BV, SNAP_SCALAR, SNAP_UNINTERPRETED, SNAP_TUPLE, SNAP_FUNCTION
+};
+
+struct snapshot_writer {
+  bool with_names;
+  uint32_t ntypes;
+  uint32_t nnames;
+  std::vector<uint32_t> names;
+  std::vector<uint32_t> types;
+  std::vector<uint32_t> terms;
+  std::unordered_map<type_t, uint32_t> type_index;
+  std::vector<int32_t> bits;
+};
+
+static void snapshot_name(snapshot_writer &w, uint32_t kind, uint32_t index, const char *name) {
+  size_t len = strlen(name);
+  w.names.push_back(kind);
+  w.names.push_back(index);
+  w.names.push_back(len);
+  size_t k = w.names.size();
+  w.names.resize(k + (len + 3)/4, 0);
+  memcpy(w.names.data() + k, name, len);
+  w.nnames ++;
+}
+
+static void snapshot_mpz(std::vector<uint32_t> &out, mpz_t z) {
+  size_t k = (mpz_sizeinbase(z, 2) + 31) >> 5;
+  size_t pos = out.size();
+  size_t count = 0;
+  out.resize(pos + 1 + k, 0);
+  mpz_export(out.data() + pos + 1, &count, -1, sizeof(uint32_t), 0, 0, z);
+  out[pos] = count;
+  out.resize(pos + 1 + count);
+}
+
+static void snapshot_rational(std::vector<uint32_t> &out, mpq_t q) {
+  out.push_back(mpq_sgn(q) < 0);
+  snapshot_mpz(out, mpq_numref(q));
+  snapshot_mpz(out, mpq_denref(q));
+}
+
+// bits[0 ... n-1] packed in words
+static void snapshot_bits(std::vector<uint32_t> &out, const int32_t *bits, uint32_t n) {
+  size_t pos = out.size();
+  out.resize(pos + (n + 31)/32, 0);
+  for (uint32_t i=0; i<n; i++) {
+    if (bits[i]) out[pos + i/32] |= ((uint32_t) 1) << (i % 32);
+  }
+}
+
+/*
+ * Index of tau in the snapshot: tau and its children are added if needed.
+ * Returns -1 if tau is not a valid type.
+ */
+static int64_t snapshot_type(snapshot_writer &w, type_t tau) {
+  std::unordered_map<type_t, uint32_t>::iterator it = w.type_index.find(tau);
+  if (it != w.type_index.end()) return it->second;
+
+  std::vector<uint32_t> rec;
+  if (yices_type_is_bool(tau)) {
+    rec.push_back(SNAP_BOOL);
+  } else if (yices_type_is_int(tau)) {
+    rec.push_back(SNAP_INT);
+  } else if (yices_type_is_real(tau)) {
+    rec.push_back(SNAP_REAL);
+  } else if (yices_type_is_bitvector(tau)) {
+    rec.push_back(SNAP_BV);
+    rec.push_back(yices_bvtype_size(tau));
+  } else if (yices_type_is_uninterpreted(tau)) {
+    rec.push_back(SNAP_UNINTERPRETED);
+  } else if (yices_type_is_scalar(tau)) {
+    rec.push_back(SNAP_SCALAR);
+    rec.push_back(yices_scalar_type_card(tau));
+  } else if (yices_type_is_tuple(tau) || yices_type_is_function(tau)) {
+    int32_t n = yices_type_num_children(tau);
+    rec.push_back(yices_type_is_tuple(tau) ? SNAP_TUPLE : SNAP_FUNCTION);
+    rec.push_back(n);
+    for (int32_t i=0; i<n; i++) {
+      int64_t c = snapshot_type(w, yices_type_child(tau, i));
+      if (c < 0) return -1;
+      rec.push_back(c);
+    }
+  } else {
+    return -1;
+  }
+
+  uint32_t idx = w.ntypes ++;
+  w.types.insert(w.types.end(), rec.begin(), rec.end());
+  w.type_index[tau] = idx;
+  if (w.with_names) {
+    const char *name = yices_get_type_name(tau);
+    if (name != NULL) snapshot_name(w, 0, idx, name);
+  }
+  return idx;
+}
+
+/*
+ * Encode term t: all its children must be in dag.index already
+ * Returns false if t can't be encoded.
+ */
+static bool snapshot_term(snapshot_writer &w, term_dag &dag, term_t t, mpq_t q) {
+  std::vector<uint32_t> &out = w.terms;
+  term_constructor_t c = yices_term_constructor(t);
+  int32_t n = yices_term_num_children(t);
+  int64_t tau;
+  int32_t v;
+
+  out.push_back(c);
+  switch (c) {
+  case YICES_BOOL_CONSTANT:
+    if (yices_bool_const_value(t, &v) < 0) return false;
+    out.push_back(v);
+    break;
+
+  case YICES_ARITH_CONSTANT:
+    if (yices_rational_const_value(t, q) < 0) return false;
+    snapshot_rational(out, q);
+    break;
+
+  case YICES_BV_CONSTANT:
+    n = yices_term_bitsize(t);
+    w.bits.resize(n);
+    if (yices_bv_const_value(t, w.bits.data()) < 0) return false;
+    out.push_back(n);
+    snapshot_bits(out, w.bits.data(), n);
+    break;
+
+  case YICES_SCALAR_CONSTANT:
+    tau = snapshot_type(w, yices_type_of_term(t));
+    if (tau < 0 || yices_scalar_const_value(t, &v) < 0) return false;
+    out.push_back(tau);
+    out.push_back(v);
+    break;
+
+  case YICES_VARIABLE:
+  case YICES_UNINTERPRETED_TERM:
+    tau = snapshot_type(w, yices_type_of_term(t));
+    if (tau < 0) return false;
+    out.push_back(tau);
+    break;
+
+  case YICES_SELECT_TERM:
+  case YICES_BIT_TERM:
+    out.push_back(yices_proj_index(t));
+    out.push_back(dag.index[yices_proj_arg(t)]);
+    break;
+
+  case YICES_BV_SUM: {
+    uint32_t nbits = yices_term_bitsize(t);
+    w.bits.resize(nbits);
+    out.push_back(n);
+    out.push_back(nbits);
+    for (int32_t i=0; i<n; i++) {
+      term_t x;
+      if (yices_bvsum_component(t, i, w.bits.data(), &x) < 0) return false;
+      out.push_back(x == NULL_TERM ? SNAPSHOT_NONE : dag.index[x]);
+      snapshot_bits(out, w.bits.data(), nbits);
+    }
+    break;
+  }
+
+  case YICES_ARITH_SUM:
+    out.push_back(n);
+    for (int32_t i=0; i<n; i++) {
+      term_t x;
+      if (yices_sum_component(t, i, q, &x) < 0) return false;
+      out.push_back(x == NULL_TERM ? SNAPSHOT_NONE : dag.index[x]);
+      snapshot_rational(out, q);
+    }
+    break;
+
+  case YICES_POWER_PRODUCT:
+    out.push_back(n);
+    for (int32_t i=0; i<n; i++) {
+      term_t x;
+      uint32_t e;
+      if (yices_product_component(t, i, &x, &e) < 0) return false;
+      out.push_back(dag.index[x]);
+      out.push_back(e);
+    }
+    break;
+
+  case YICES_ARITH_ROOT_ATOM:
+  case YICES_CONSTRUCTOR_ERROR:
+    return false;
+
+  default:
+    if (!yices_term_is_composite(t)) return false;
+    out.push_back(n);
+    for (int32_t i=0; i<n; i++) {
+      out.push_back(dag.index[yices_term_child(t, i)]);
+    }
+    break;
+  }
+
+  if (w.with_names) {
+    const char *name = yices_get_term_name(t);
+    if (name != NULL) snapshot_name(w, 1, dag.index[t], name);
+  }
+  return true;
+}
+
+/*
+ * Snapshot of the DAG reachable from roots (and the names of its terms and types if
+ * names is true). Returns NULL if one of the roots is invalid or uses a construct that
+ * can't be saved (i.e., algebraic root atoms).
+ */
+JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_snapshotSave(JNIEnv *env, jclass, jintArray roots, jboolean names) {
+  TRACE_NATIVE();
+  jsize n = env->GetArrayLength(roots);
+  term_t *a = scratch_copy(env, roots, n);
+  jbyteArray result = NULL;
+
+  if (a != NULL) {
+    try {
+      // TermSnapshot.save reads the error code if this fails: an old error must not show up
+      yices_clear_error();
+      term_dag dag;
+      if (collect_dag(a, n, dag)) {
+        snapshot_writer w;
+        w.with_names = names;
+        w.ntypes = 0;
+        w.nnames = 0;
+
+        bool ok = true;
+        mpq_t q;
+        mpq_init(q);
+        for (size_t i=0; i<dag.order.size() && ok; i++) {
+          ok = snapshot_term(w, dag, dag.order[i], q);
+        }
+        mpq_clear(q);
+
+        if (ok) {
+          std::vector<uint32_t> out;
+          out.push_back(SNAPSHOT_MAGIC);
+          out.push_back(SNAPSHOT_VERSION);
+          out.push_back(w.ntypes);
+          out.push_back(dag.order.size());
+          out.push_back(w.nnames);
+          out.push_back(n);
+          out.insert(out.end(), w.names.begin(), w.names.end());
+          out.insert(out.end(), w.types.begin(), w.types.end());
+          out.insert(out.end(), w.terms.begin(), w.terms.end());
+          for (jsize i=0; i<n; i++) out.push_back(dag.index[a[i]]);
+
+          size_t nbytes = out.size() * sizeof(uint32_t);
+          if (nbytes > static_cast<size_t>(std::numeric_limits<jsize>::max())) throw std::bad_alloc();
+          result = env->NewByteArray(nbytes);
+          if (result == NULL) {
+            out_of_mem_exception(env);
+          } else {
+            env->SetByteArrayRegion(result, 0, nbytes, reinterpret_cast<jbyte *>(out.data()));
+          }
+        }
+      }
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+    scratch_free(a);
+  }
+  return result;
+}
+
+
+/*
+ * Reader: all reads are bounds-checked. ok is false after an out-of-bound read.
+ * A length read from the snapshot can be anything up to UINT32_MAX: the number
+ * of words it covers must be computed on 64 bits before it's compared with n - pos.
+ */
+struct snapshot_reader {
+  const uint32_t *w;
+  size_t n;
+  size_t pos;
+  bool ok;
+
+  uint32_t next() {
+    if (pos < n) return w[pos++];
+    ok = false;
+    return 0;
+  }
+
+  // element of v: -1 if the index is out of bounds
+  int32_t elem(const std::vector<int32_t> &v) {
+    uint32_t i = next();
+    if (i >= v.size()) {
+      ok = false;
+      return -1;
+    }
+    return v[i];
+  }
+};
+
+static void load_mpz(snapshot_reader &r, mpz_t z) {
+  uint32_t k = r.next();
+  if (k > r.n - r.pos) {
+    r.ok = false;
+    return;
+  }
+  mpz_import(z, k, -1, sizeof(uint32_t), 0, 0, r.w + r.pos);
+  r.pos += k;
+}
+
+static void load_rational(snapshot_reader &r, mpq_t q) {
+  uint32_t neg = r.next();
+  load_mpz(r, mpq_numref(q));
+  load_mpz(r, mpq_denref(q));
+  if (neg) mpq_neg(q, q);
+  if (mpz_sgn(mpq_denref(q)) == 0) r.ok = false;
+}
+
+// n bits into bits[0 ... n-1]
+static void load_bits(snapshot_reader &r, std::vector<int32_t> &bits, uint32_t n) {
+  // 64-bit arithmetic: (n + 31) must not wrap around
+  uint64_t k = (static_cast<uint64_t>(n) + 31)/32;
+  if (k > r.n - r.pos) {
+    r.ok = false;
+    return;
+  }
+  bits.resize(n);
+  for (uint32_t i=0; i<n; i++) {
+    bits[i] = (r.w[r.pos + i/32] >> (i % 32)) & 1;
+  }
+  r.pos += k;
+}
+
+// term arguments: k indices smaller than bound
+static bool load_args(snapshot_reader &r, const std::vector<term_t> &terms, uint32_t k, std::vector<term_t> &args) {
+  if (k > r.n - r.pos) return false;
+  args.resize(k);
+  for (uint32_t i=0; i<k; i++) {
+    args[i] = r.elem(terms);
+  }
+  return r.ok;
+}
+
+static term_t load_composite(term_constructor_t c, uint32_t n, std::vector<term_t> &a) {
+  // minimal number of children
+  uint32_t min = 1;
+  switch (c) {
+  case YICES_ITE_TERM: min = 3; break;
+  case YICES_APP_TERM:
+  case YICES_FORALL_TERM:
+  case YICES_LAMBDA_TERM: min = 2; break;
+  case YICES_UPDATE_TERM: min = 3; break;
+  case YICES_EQ_TERM:
+  case YICES_BV_DIV:
+  case YICES_BV_REM:
+  case YICES_BV_SDIV:
+  case YICES_BV_SREM:
+  case YICES_BV_SMOD:
+  case YICES_BV_SHL:
+  case YICES_BV_LSHR:
+  case YICES_BV_ASHR:
+  case YICES_BV_GE_ATOM:
+  case YICES_BV_SGE_ATOM:
+  case YICES_RDIV:
+  case YICES_IDIV:
+  case YICES_IMOD:
+  case YICES_DIVIDES_ATOM: min = 2; break;
+  default: break;
+  }
+  if (n < min) return NULL_TERM;
+
+  term_t *x = a.data();
+  switch (c) {
+  case YICES_ITE_TERM: return yices_ite(x[0], x[1], x[2]);
+  case YICES_APP_TERM: return yices_application(x[0], n-1, x+1);
+  case YICES_UPDATE_TERM: return yices_update(x[0], n-2, x+1, x[n-1]);
+  case YICES_TUPLE_TERM: return yices_tuple(n, x);
+  case YICES_EQ_TERM: return yices_eq(x[0], x[1]);
+  case YICES_DISTINCT_TERM: return yices_distinct(n, x);
+  case YICES_FORALL_TERM: return yices_forall(n-1, x, x[n-1]);
+  case YICES_LAMBDA_TERM: return yices_lambda(n-1, x, x[n-1]);
+  case YICES_NOT_TERM: return yices_not(x[0]);
+  case YICES_OR_TERM: return yices_or(n, x);
+  case YICES_XOR_TERM: return yices_xor(n, x);
+  case YICES_BV_ARRAY: return yices_bvarray(n, x);
+  case YICES_BV_DIV: return yices_bvdiv(x[0], x[1]);
+  case YICES_BV_REM: return yices_bvrem(x[0], x[1]);
+  case YICES_BV_SDIV: return yices_bvsdiv(x[0], x[1]);
+  case YICES_BV_SREM: return yices_bvsrem(x[0], x[1]);
+  case YICES_BV_SMOD: return yices_bvsmod(x[0], x[1]);
+  case YICES_BV_SHL: return yices_bvshl(x[0], x[1]);
+  case YICES_BV_LSHR: return yices_bvlshr(x[0], x[1]);
+  case YICES_BV_ASHR: return yices_bvashr(x[0], x[1]);
+  case YICES_BV_GE_ATOM: return yices_bvge_atom(x[0], x[1]);
+  case YICES_BV_SGE_ATOM: return yices_bvsge_atom(x[0], x[1]);
+  case YICES_ARITH_GE_ATOM: return n == 1 ? yices_arith_geq0_atom(x[0]) : yices_arith_geq_atom(x[0], x[1]);
+  case YICES_ABS: return yices_abs(x[0]);
+  case YICES_CEIL: return yices_ceil(x[0]);
+  case YICES_FLOOR: return yices_floor(x[0]);
+  case YICES_RDIV: return yices_division(x[0], x[1]);
+  case YICES_IDIV: return yices_idiv(x[0], x[1]);
+  case YICES_IMOD: return yices_imod(x[0], x[1]);
+  case YICES_IS_INT_ATOM: return yices_is_int_atom(x[0]);
+  case YICES_DIVIDES_ATOM: return yices_divides_atom(x[0], x[1]);
+  default: return NULL_TERM;
+  }
+}
+
+/*
+ * Rebuild the terms in a snapshot
+ * - named types, uninterpreted terms, and variables are reused if a type or term
+ *   of the same name (and same kind) exists. Otherwise, new ones are created.
+ * - the names in the snapshot are given to the other terms
+ * Returns false if the snapshot is malformed or if a term constructor fails.
+ */
+static bool load_snapshot(snapshot_reader &r, std::vector<term_t> &roots) {
+  if (r.next() != SNAPSHOT_MAGIC || r.next() != SNAPSHOT_VERSION) return false;
+  uint32_t ntypes = r.next();
+  uint32_t nterms = r.next();
+  uint32_t nnames = r.next();
+  uint32_t nroots = r.next();
+  if (!r.ok || ntypes > r.n || nterms > r.n || nroots > r.n) return false;
+
+  std::unordered_map<uint32_t, std::string> type_names;
+  std::unordered_map<uint32_t, std::string> term_names;
+  for (uint32_t i=0; i<nnames && r.ok; i++) {
+    uint32_t kind = r.next();
+    uint32_t index = r.next();
+    uint32_t len = r.next();
+    uint64_t k = (static_cast<uint64_t>(len) + 3)/4;
+    if (!r.ok || k > r.n - r.pos) return false;
+    std::string name(reinterpret_cast<const char *>(r.w + r.pos), len);
+    r.pos += k;
+    if (kind == 0) {
+      type_names[index] = name;
+    } else {
+      term_names[index] = name;
+    }
+  }
+
+  std::vector<type_t> types;
+  std::vector<type_t> targs;
+  for (uint32_t i=0; i<ntypes && r.ok; i++) {
+    std::unordered_map<uint32_t, std::string>::iterator nm = type_names.find(i);
+    const char *name = nm == type_names.end() ? NULL : nm->second.c_str();
+    type_t tau = NULL_TYPE;
+    uint32_t tag = r.next();
+    switch (tag) {
+    case SNAP_BOOL: tau = yices_bool_type(); break;
+    case SNAP_INT: tau = yices_int_type(); break;
+    case SNAP_REAL: tau = yices_real_type(); break;
+    case SNAP_BV: tau = yices_bv_type(r.next()); break;
+    case SNAP_SCALAR:
+    case SNAP_UNINTERPRETED: {
+      uint32_t card = tag == SNAP_SCALAR ? r.next() : 0;
+      if (name != NULL) {
+        tau = yices_get_type_by_name(name);
+        if (tau != NULL_TYPE &&
+            !(tag == SNAP_SCALAR ? yices_type_is_scalar(tau) && (uint32_t) yices_scalar_type_card(tau) == card
+                                 : yices_type_is_uninterpreted(tau))) {
+          tau = NULL_TYPE;
+        }
+      }
+      if (tau == NULL_TYPE) {
+        tau = tag == SNAP_SCALAR ? yices_new_scalar_type(card) : yices_new_uninterpreted_type();
+      }
+      break;
+    }
+    case SNAP_TUPLE:
+    case SNAP_FUNCTION: {
+      uint32_t k = r.next();
+      if (k > r.n - r.pos || k < (tag == SNAP_TUPLE ? 1 : 2)) return false;
+      targs.resize(k);
+      for (uint32_t j=0; j<k; j++) targs[j] = r.elem(types);
+      if (!r.ok) return false;
+      tau = tag == SNAP_TUPLE ? yices_tuple_type(k, targs.data()) : yices_function_type(k-1, targs.data(), targs[k-1]);
+      break;
+    }
+    default:
+      return false;
+    }
+    if (tau < 0) return false;
+    if (name != NULL && yices_get_type_by_name(name) != tau && yices_set_type_name(tau, name) < 0) return false;
+    types.push_back(tau);
+  }
+
+  std::vector<term_t> terms;
+  std::vector<term_t> args;
+  std::vector<int32_t> bits;
+  mpq_t q;
+  mpq_init(q);
+  for (uint32_t i=0; i<nterms && r.ok; i++) {
+    std::unordered_map<uint32_t, std::string>::iterator nm = term_names.find(i);
+    const char *name = nm == term_names.end() ? NULL : nm->second.c_str();
+    term_t t = NULL_TERM;
+    term_constructor_t c = (term_constructor_t) r.next();
+    switch (c) {
+    case YICES_BOOL_CONSTANT:
+      t = r.next() ? yices_true() : yices_false();
+      break;
+
+    case YICES_ARITH_CONSTANT:
+      load_rational(r, q);
+      if (r.ok) t = yices_mpq(q);
+      break;
+
+    case YICES_BV_CONSTANT: {
+      uint32_t n = r.next();
+      load_bits(r, bits, n);
+      if (r.ok) t = yices_bvconst_from_array(n, bits.data());
+      break;
+    }
+
+    case YICES_SCALAR_CONSTANT: {
+      type_t tau = r.elem(types);
+      int32_t idx = r.next();
+      if (r.ok) t = yices_constant(tau, idx);
+      break;
+    }
+
+    case YICES_VARIABLE:
+    case YICES_UNINTERPRETED_TERM: {
+      type_t tau = r.elem(types);
+      if (!r.ok) break;
+      if (name != NULL) {
+        t = yices_get_term_by_name(name);
+        if (t != NULL_TERM && (yices_type_of_term(t) != tau || yices_term_constructor(t) != c)) {
+          t = NULL_TERM;
+        }
+      }
+      if (t == NULL_TERM) {
+        t = c == YICES_VARIABLE ? yices_new_variable(tau) : yices_new_uninterpreted_term(tau);
+      }
+      break;
+    }
+
+    case YICES_SELECT_TERM:
+    case YICES_BIT_TERM: {
+      uint32_t idx = r.next();
+      term_t x = r.elem(terms);
+      if (r.ok) t = c == YICES_SELECT_TERM ? yices_select(idx + 1, x) : yices_bitextract(x, idx);
+      break;
+    }
+
+    case YICES_BV_SUM: {
+      uint32_t n = r.next();
+      uint32_t nbits = r.next();
+      if (n == 0 || n > r.n - r.pos) break;
+      args.resize(n);
+      for (uint32_t j=0; j<n && r.ok; j++) {
+        uint32_t x = r.next();
+        load_bits(r, bits, nbits);
+        if (!r.ok) break;
+        term_t a = yices_bvconst_from_array(nbits, bits.data());
+        if (x != SNAPSHOT_NONE) {
+          a = x < terms.size() ? yices_bvmul(a, terms[x]) : NULL_TERM;
+        }
+        if (a < 0) r.ok = false;
+        args[j] = a;
+      }
+      if (r.ok) t = yices_bvsum(n, args.data());
+      break;
+    }
+
+    case YICES_ARITH_SUM: {
+      uint32_t n = r.next();
+      if (n == 0 || n > r.n - r.pos) break;
+      args.resize(n);
+      for (uint32_t j=0; j<n && r.ok; j++) {
+        uint32_t x = r.next();
+        load_rational(r, q);
+        if (!r.ok) break;
+        term_t a = yices_mpq(q);
+        if (x != SNAPSHOT_NONE) {
+          a = x < terms.size() ? yices_mul(a, terms[x]) : NULL_TERM;
+        }
+        if (a < 0) r.ok = false;
+        args[j] = a;
+      }
+      if (r.ok) t = yices_sum(n, args.data());
+      break;
+    }
+
+    case YICES_POWER_PRODUCT: {
+      uint32_t n = r.next();
+      if (n == 0 || n > r.n - r.pos) break;
+      args.resize(n);
+      for (uint32_t j=0; j<n && r.ok; j++) {
+        term_t x = r.elem(terms);
+        uint32_t e = r.next();
+        if (!r.ok) break;
+        args[j] = yices_term_is_bitvector(x) ? yices_bvpower(x, e) : yices_power(x, e);
+        if (args[j] < 0) r.ok = false;
+      }
+      if (r.ok) t = yices_term_is_bitvector(args[0]) ? yices_bvproduct(n, args.data()) : yices_product(n, args.data());
+      break;
+    }
+
+    default: {
+      uint32_t n = r.next();
+      if (r.ok && load_args(r, terms, n, args)) t = load_composite(c, n, args);
+      break;
+    }
+    }
+
+    if (!r.ok || t < 0) break;
+    if (name != NULL && yices_get_term_by_name(name) != t && yices_set_term_name(t, name) < 0) break;
+    terms.push_back(t);
+  }
+  mpq_clear(q);
+  if (!r.ok || terms.size() != nterms) return false;
+
+  for (uint32_t i=0; i<nroots; i++) {
+    roots.push_back(r.elem(terms));
+  }
+  return r.ok;
+}
+
+/*
+ * Load a snapshot from buffer[offset ... offset + n - 1]: buffer must be a direct buffer
+ * - returns the root terms, or NULL if the snapshot is malformed or if something fails
+ *   (then the Yices error is set if a term constructor failed)
+ */
+JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_snapshotLoad(JNIEnv *env, jclass, jobject buffer, jint offset, jint n) {
+  TRACE_NATIVE();
+  jintArray result = NULL;
+  const uint8_t *b = direct_byte_buffer(env, buffer, offset, n);
+
+  if (b == NULL || n % sizeof(uint32_t) != 0) return NULL;
+
+  try {
+    std::vector<uint32_t> copy;
+    snapshot_reader r;
+    r.n = n / sizeof(uint32_t);
+    r.pos = 0;
+    r.ok = true;
+    if (reinterpret_cast<uintptr_t>(b) % alignof(uint32_t) == 0) {
+      r.w = reinterpret_cast<const uint32_t *>(b);
+    } else {
+      copy.resize(r.n);
+      memcpy(copy.data(), b, n);
+      r.w = copy.data();
+    }
+
+    yices_clear_error();
+    std::vector<term_t> roots;
+    if (load_snapshot(r, roots)) {
+      result = convertToIntArray(env, roots.size(), roots.data());
+    }
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  return result;
+}
+
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_boolConstValue(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
+  int32_t val;
+  jint result;
+
+  result = yices_bool_const_value(x, &val);
+  if (result == 0) {
+    result = val;
+  }
+  return result;
+}
+
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_scalarConstantIndex(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
+  int32_t val;
+  jint result;
+
+  result = yices_scalar_const_value(x, &val);
+  if (result == 0) {
+    result = val;
+  }
+  return result;
+}
+
+JNIEXPORT jbooleanArray JNICALL Java_com_sri_yices_Yices_bvConstValue(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
+  jbooleanArray result = NULL;
+
+  if (yices_term_constructor(x) == YICES_BV_CONSTANT) {
+    int32_t n = yices_term_bitsize(x);
+
+    assert(n >= 0);
+
+    if (n <= 64) {
+      // this should be the common case
+      int32_t a[64];
+      int32_t code = yices_bv_const_value(x, a);
+      assert(code >= 0);
+      result = convertToBoolArray(env, n, a);
+
+    } else {
+      try {
+        int32_t *tmp =  new int32_t[n];
+        int32_t code = yices_bv_const_value(x, tmp);
+        assert(code >= 0);
+        result = convertToBoolArray(env, n, tmp);
+        delete [] tmp;
+      } catch (std::bad_alloc) {
+        out_of_mem_exception(env);
+      }
+    }
+  }
+
+  return result;
+}
+
+
+/*
+ * Numerator of a rational constant x
+ * - return NULL if x is not a rational constant
+ * - return a byte array that contains the numerator otherwise
+ */
+JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_rationalConstNumAsBytes(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
+  jbyteArray result = NULL;
+  mpq_t q;
+
+  mpq_init(q);
+  if (yices_rational_const_value(x, q) >= 0) {
+    result = mpz_to_byte_array(env, mpq_numref(q));
+  }
+  mpq_clear(q);
+
+  return result;
+}
+
+
+/*
+ * Denominator as an array of bytes
+ */
+JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_rationalConstDenAsBytes(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
+  jbyteArray result = NULL;
+  mpq_t q;
+
+  mpq_init(q);
+  if (yices_rational_const_value(x, q) >= 0) {
+    result = mpz_to_byte_array(env, mpq_denref(q));
+  }
+  mpq_clear(q);
+
+  return result;
+}
+
+
+/*
+ * Numerator and denominator of a rational constant x, as limbs (cf. mpq_to_limbs)
+ * - return NULL if x is not a rational constant
+ */
+JNIEXPORT jlongArray JNICALL Java_com_sri_yices_Yices_rationalConstLimbs(JNIEnv *env, jclass, jint x) {
+  TRACE_NATIVE();
+  jlongArray result = NULL;
+
+  try {
+    if (yices_rational_const_value(x, scratch_q.q) >= 0) {
+      result = mpq_to_limbs(env, scratch_q.q);
+    }
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  return result;
+}
+
+
+
 /*
  * TERM NAMES
  */
@@ -2729,18 +4994,18 @@ JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_rationalConstDenAsBytes(JN
  * Give a a name to term t
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_setTermName(JNIEnv *env, jclass, jint t, jstring name) {
+  TRACE_NATIVE();
   jint code = -1;
-  const char *s = env->GetStringUTFChars(name, NULL);
+  utf_chars s(env, name);
 
-  if (s == NULL) {
+  if (s.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     try {
-      code = yices_set_term_name(t, s);
+      code = yices_set_term_name(t, s.get());
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    env->ReleaseStringUTFChars(name, s);
   }
 
   return code;
@@ -2751,37 +5016,39 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_setTermName(JNIEnv *env, jclass,
  * Remove the mapping from name to a term
  */
 JNIEXPORT void JNICALL Java_com_sri_yices_Yices_removeTermName(JNIEnv *env, jclass, jstring name) {
-  const char *s = env->GetStringUTFChars(name, NULL);
+  TRACE_NATIVE();
+  utf_chars s(env, name);
 
-  if (s == NULL) {
+  if (s.get() == NULL) {
     out_of_mem_exception(env);
   } else {
-    yices_remove_term_name(s);
-    env->ReleaseStringUTFChars(name, s);
+    yices_remove_term_name(s.get());
   }
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_clearTermName(JNIEnv *env, jclass, jint t) {
+  TRACE_NATIVE();
   return yices_clear_term_name(t);
 }
 
 JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_getTermName(JNIEnv *env, jclass, jint t) {
+  TRACE_NATIVE();
   return convertToString(env, yices_get_term_name(t));
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getTermByName(JNIEnv *env, jclass, jstring name) {
+  TRACE_NATIVE();
   jint t = -1;
-  const char *s = env->GetStringUTFChars(name, NULL);
+  utf_chars s(env, name);
 
-  if (s == NULL) {
+  if (s.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     try {
-      t = yices_get_term_by_name(s);
+      t = yices_get_term_by_name(s.get());
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    env->ReleaseStringUTFChars(name, s);
   }
 
   return t;
@@ -2792,6 +5059,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getTermByName(JNIEnv *env, jclas
  * We print into an array of 80 columns x 30 lines
  */
 JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_termToString__III(JNIEnv *env, jclass, jint t, jint columns, jint lines) {
+  TRACE_NATIVE();
   char *s;
   jstring result;
 
@@ -2804,89 +5072,421 @@ JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_termToString__III(JNIEnv *env
   return result;
 }
 
-JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_termToString__I(JNIEnv *env, jclass, jint t) {
-  char *s;
-  jstring result;
+JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_termToString__I(JNIEnv *env, jclass, jint t) {
+  TRACE_NATIVE();
+  char *s;
+  jstring result;
+
+  s = yices_term_to_string(t, 80, 30, 0);
+  result = convertToString(env, s);
+  yices_free_string(s); // this is safe even if s is NULL
+
+  return result;
+}
+
+/*
+ * Parse s as term using the Yices syntax
+ */
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_parseTerm(JNIEnv *env, jclass, jstring s) {
+  TRACE_NATIVE();
+  jint result = -1;
+  utf_chars aux(env, s);
+
+  if (aux.get() == NULL) {
+    out_of_mem_exception(env);
+  } else {
+    try {
+      result = yices_parse_term(aux.get());
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+  }
+
+  return result;
+}
+
+
+/*
+ * Batch parsing: b[0 ... n-1] contains a sequence of terms (or types) in UTF-8.
+ * - the items are the top-level atoms or parenthesized expressions, separated by
+ *   white space. Comments (from ';' to the end of the line) are skipped.
+ * - each item is parsed with yices_parse_term (or yices_parse_type). A parse error
+ *   is recorded and the parsing continues with the next item.
+ * The result r has six entries per item:
+ *   r[0] = number of items
+ *   r[1 + 6i ... 6 + 6i] = term or type, error code (0 if no error), start and end
+ *   of the item in b, and line and column of the error (as in the error report)
+ */
+#define PARSE_ITEM_SIZE 6
+
+static bool is_space(uint8_t c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+static void parse_items(const uint8_t *b, size_t n, bool types, std::vector<int32_t> &r) {
+  std::string item;
+  size_t i = 0;
+
+  r.push_back(0);
+  for (;;) {
+    // skip spaces and comments
+    while (i < n && (is_space(b[i]) || b[i] == ';')) {
+      if (b[i] == ';') {
+        while (i < n && b[i] != '\n') i++;
+      } else {
+        i++;
+      }
+    }
+    if (i == n) break;
+
+    size_t start = i;
+    if (b[i] == '(') {
+      int32_t depth = 0;
+      while (i < n) {
+        uint8_t c = b[i];
+        if (c == ';') {
+          while (i < n && b[i] != '\n') i++;
+          continue;
+        }
+        i++;
+        if (c == '(') {
+          depth ++;
+        } else if (c == ')') {
+          depth --;
+          if (depth == 0) break;
+        }
+      }
+    } else if (b[i] == ')') {
+      // unbalanced: this gives a parse error
+      i++;
+    } else {
+      while (i < n && !is_space(b[i]) && b[i] != '(' && b[i] != ')' && b[i] != ';') i++;
+    }
+
+    item.assign(reinterpret_cast<const char *>(b + start), i - start);
+    int32_t x = types ? yices_parse_type(item.c_str()) : yices_parse_term(item.c_str());
+    int32_t code = 0;
+    int32_t line = 0;
+    int32_t column = 0;
+    if (x < 0) {
+      error_report_t *e = yices_error_report();
+      code = e->code;
+      line = e->line;
+      column = e->column;
+      yices_clear_error();
+    }
+    r.push_back(x);
+    r.push_back(code);
+    r.push_back(start);
+    r.push_back(i);
+    r.push_back(line);
+    r.push_back(column);
+    r[0] ++;
+  }
+}
+
+/*
+ * Items in buffer[offset ... offset + n - 1]: buffer must be a direct buffer
+ * - the start and end of each item are relative to offset
+ * - returns NULL and throws IllegalArgumentException if the buffer is not direct or too small
+ */
+JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_parseBatchBuffer(JNIEnv *env, jclass, jobject buffer, jint offset, jint n, jboolean types) {
+  TRACE_NATIVE();
+  jintArray result = NULL;
+  const uint8_t *b = direct_byte_buffer(env, buffer, offset, n);
+
+  if (b != NULL) {
+    try {
+      std::vector<int32_t> r;
+      parse_items(b, n, types, r);
+      result = convertToIntArray(env, r.size(), r.data());
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+  }
+  return result;
+}
+
+/*
+ * Same thing for a byte array: items in a[offset ... offset + n - 1]
+ */
+JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_parseBatch(JNIEnv *env, jclass, jbyteArray a, jint offset, jint n, jboolean types) {
+  TRACE_NATIVE();
+  jintArray result = NULL;
+
+  if (offset < 0 || n < 0 || env->GetArrayLength(a) < static_cast<jlong>(offset) + n) {
+    return NULL;
+  }
+
+  pinned_array<jbyteArray> b(env, a);
+  if (b.get() == NULL) {
+    out_of_mem_exception(env);
+  } else {
+    try {
+      std::vector<int32_t> r;
+      parse_items(reinterpret_cast<uint8_t *>(b.get()) + offset, n, types, r);
+      result = convertToIntArray(env, r.size(), r.data());
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+  }
+  return result;
+}
+
+
+/*
+ * Substitution defined by v[] and map[] applied to term t
+ */
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_substTerm(JNIEnv *env, jclass, jint t, jintArray v, jintArray map) {
+  TRACE_NATIVE();
+  jint result = -1;
+  jsize n = env->GetArrayLength(v);
+
+  if (n == env->GetArrayLength(map)) {
+    int32_t *vars = NULL;
+    try {
+      // vars = v[0 ... n-1], vals = map[0 ... n-1]
+      vars = scratch_alloc(2 * n);
+      int32_t *vals = vars + n;
+      array2int_region(env, v, 0, n, vars);
+      array2int_region(env, map, 0, n, vals);
+      result = yices_subst_term(n, vars, vals, t);
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+    if (vars != NULL) scratch_free(vars);
+  }
+
+  return result;
+}
+
+/*
+ * Apply the substitution to all elements of array a
+ */
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_substTermArray(JNIEnv *env, jclass, jintArray a, jintArray v, jintArray map) {
+  TRACE_NATIVE();
+  jint result = -1;
+  jsize n = env->GetArrayLength(v);
+
+  if (n == env->GetArrayLength(map)) {
+    jsize m = env->GetArrayLength(a);
+    int32_t *vars = NULL;
+    try {
+      // vars = v[0 ... n-1], vals = map[0 ... n-1], terms = a[0 ... m-1]
+      vars = scratch_alloc(2 * n + m);
+      int32_t *vals = vars + n;
+      int32_t *terms = vals + n;
+      array2int_region(env, v, 0, n, vars);
+      array2int_region(env, map, 0, n, vals);
+      array2int_region(env, a, 0, m, terms);
+      result = yices_subst_term_array(n, vars, vals, m, terms);
+      // copy the result back into a if the substitution worked
+      if (result >= 0) {
+        set_int_region(env, a, 0, m, terms);
+      }
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+    if (vars != NULL) scratch_free(vars);
+  }
+
+  return result;
+}
+
+
+/*
+ * Reusable substitutions
+ *
+ * A substitution object keeps the arrays vars and vals, and a memo table that maps
+ * terms to their images. The substitution is checked once, when it's created, and
+ * the terms of vars and vals are protected from the garbage collector until it is
+ * freed. Each application only calls Yices on the terms that are not in the memo
+ * table; the misses of a batch are substituted with a single call so Yices can
+ * share the work between them.
+ *
+ * The memo table may contain terms that are not protected: it's emptied when the
+ * garbage collector has run since it was filled (cf. gc_epoch).
+ *
+ * After Yices.reset, the terms of vars and vals no longer exist: a substitution
+ * created before the reset can't be applied (subst_apply returns -2) and its
+ * terms are not decref'd when it's freed.
+ */
 
-  s = yices_term_to_string(t, 80, 30, 0);
-  result = convertToString(env, s);
-  yices_free_string(s); // this is safe even if s is NULL
+struct substitution {
+  std::vector<term_t> vars;
+  std::vector<term_t> vals;
+  std::unordered_map<term_t, term_t> memo;
+  uint32_t epoch;
+  uint32_t reset;    // reset_epoch when the substitution was created
+  uint64_t hits;
+  uint64_t misses;
+};
 
-  return result;
+static void subst_check_epoch(substitution *s) {
+  uint32_t e = gc_epoch.load(std::memory_order_relaxed);
+  if (s->epoch != e) {
+    s->memo.clear();
+    s->epoch = e;
+  }
+}
+
+static bool subst_is_stale(const substitution *s) {
+  return s->reset != reset_epoch.load(std::memory_order_relaxed);
 }
 
 /*
- * Parse s as term using the Yices syntax
+ * Apply s to a[0 ... n-1] in place
+ * - return -1 if there's an error (a is unchanged then), 0 otherwise
+ * - return -2 if s was created before Yices.reset
  */
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_parseTerm(JNIEnv *env, jclass, jstring s) {
-  jint result = -1;
-  const char *aux = env->GetStringUTFChars(s, NULL);
+static int32_t subst_apply(substitution *s, term_t *a, uint32_t n) {
+  if (subst_is_stale(s)) return -2;
+  subst_check_epoch(s);
 
-  if (aux == NULL) {
-    out_of_mem_exception(env);
-  } else {
-    try {
-      result = yices_parse_term(aux);
-    } catch (std::bad_alloc &ba) {
-      out_of_mem_exception(env);
+  // collect the distinct terms that are not in the memo table
+  // they are added to the table with NULL_TERM as image for now
+  std::vector<term_t> todo;
+  try {
+    for (uint32_t i = 0; i < n; i++) {
+      if (s->memo.emplace(a[i], NULL_TERM).second) {
+        todo.push_back(a[i]);
+      }
+    }
+    if (! todo.empty()) {
+      std::vector<term_t> image(todo);
+      if (yices_subst_term_array(s->vars.size(), s->vars.data(), s->vals.data(), image.size(), image.data()) < 0) {
+        for (term_t t: todo) s->memo.erase(t);
+        return -1;
+      }
+      for (size_t i = 0; i < todo.size(); i++) {
+        s->memo[todo[i]] = image[i];
+      }
     }
-    env->ReleaseStringUTFChars(s, aux);
+  } catch (std::bad_alloc &ba) {
+    // some terms may be left with NULL_TERM as image
+    s->memo.clear();
+    throw;
   }
+  s->misses += todo.size();
+  s->hits += n - todo.size();
 
-  return result;
+  for (uint32_t i = 0; i < n; i++) {
+    a[i] = s->memo[a[i]];
+  }
+  return 0;
 }
 
-
 /*
- * Substitution defined by v[] and map[] applied to term t
+ * New substitution v[i] := map[i]
+ * - return 0 if the arrays don't have the same length or if Yices rejects the substitution
  */
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_substTerm(JNIEnv *env, jclass, jint t, jintArray v, jintArray map) {
-  jint result = -1;
+JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_newSubstitution(JNIEnv *env, jclass, jintArray v, jintArray map) {
+  TRACE_NATIVE();
   jsize n = env->GetArrayLength(v);
+  if (n != env->GetArrayLength(map)) return 0;
+
+  substitution *s = NULL;
+  try {
+    s = new substitution();
+    s->vars.resize(n);
+    s->vals.resize(n);
+    array2int_region(env, v, 0, n, s->vars.data());
+    array2int_region(env, map, 0, n, s->vals.data());
+    // this checks the substitution
+    if (yices_subst_term(n, s->vars.data(), s->vals.data(), yices_true()) < 0) {
+      delete s;
+      return 0;
+    }
+    for (jsize i = 0; i < n; i++) {
+      yices_incref_term(s->vars[i]);
+      yices_incref_term(s->vals[i]);
+    }
+    s->epoch = gc_epoch.load(std::memory_order_relaxed);
+    s->reset = reset_epoch.load(std::memory_order_relaxed);
+    s->hits = 0;
+    s->misses = 0;
+  } catch (std::bad_alloc &ba) {
+    delete s;
+    out_of_mem_exception(env);
+    return 0;
+  }
+  return reinterpret_cast<jlong>(s);
+}
 
-  if (n == env->GetArrayLength(map)) {
-    int32_t *vars = array2int32(env, v, NULL);
-    int32_t *vals = array2int32(env, map, NULL);
-    if (vars == NULL || vals == NULL) {
-      out_of_mem_exception(env);
-    } else {
-      result = yices_subst_term(n, vars, vals, t);
+JNIEXPORT void JNICALL Java_com_sri_yices_Yices_freeSubstitution(JNIEnv *env, jclass, jlong subst) {
+  TRACE_NATIVE();
+  substitution *s = reinterpret_cast<substitution*>(subst);
+  // after a reset, the ids may belong to new terms
+  if (! subst_is_stale(s)) {
+    for (size_t i = 0; i < s->vars.size(); i++) {
+      yices_decref_term(s->vars[i]);
+      yices_decref_term(s->vals[i]);
     }
-    if (vars != NULL) release_int32_elems(env, v, vars);
-    if (vals != NULL) release_int32_elems(env, map, vals);
   }
+  delete s;
+}
 
-  return result;
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_substitutionApply(JNIEnv *env, jclass, jlong subst, jint t) {
+  TRACE_NATIVE();
+  term_t a = t;
+  try {
+    int32_t code = subst_apply(reinterpret_cast<substitution*>(subst), &a, 1);
+    if (code < 0) return code;
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+    return -1;
+  }
+  return a;
 }
 
 /*
- * Apply the substitution to all elements of array a
+ * Apply the substitution to a[off ... off+n-1] in place
+ * - return -1 if there's an error or if the range is not in a, 0 otherwise
+ * - return -2 if the substitution was created before Yices.reset
  */
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_substTermArray(JNIEnv *env, jclass, jintArray a, jintArray v, jintArray map) {
-  jint result = -1;
-  jsize n = env->GetArrayLength(v);
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_substitutionApplyArray(JNIEnv *env, jclass, jlong subst, jintArray a, jint off, jint n) {
+  TRACE_NATIVE();
+  if (off < 0 || n < 0 || n > env->GetArrayLength(a) - off) return -1;
 
-  if (n == env->GetArrayLength(map)) {
-    int32_t *vars = array2int32(env, v, NULL);
-    int32_t *vals = array2int32(env, map, NULL);
-    int32_t *terms = array2terms(env, a, NULL);
-    jsize m = env->GetArrayLength(a);
-    if (vars == NULL || vals == NULL || terms == NULL) {
-      out_of_mem_exception(env);
-    } else {
-      result = yices_subst_term_array(n, vars, vals, m, terms);
-      jint mode = result < 0 ? JNI_ABORT : 0;
-      // copy the result back into a if the substitution worked
-      // just release the array otherwise.
-      release_term_elems(env, a, terms, mode);
+  jint result = -1;
+  term_t *terms = NULL;
+  try {
+    terms = scratch_alloc(n);
+    array2int_region(env, a, off, n, terms);
+    result = subst_apply(reinterpret_cast<substitution*>(subst), terms, n);
+    if (result >= 0) {
+      set_int_region(env, a, off, n, terms);
     }
-    if (vars != NULL) release_int32_elems(env, v, vars);
-    if (vals != NULL) release_int32_elems(env, map, vals);
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
   }
+  if (terms != NULL) scratch_free(terms);
 
   return result;
 }
 
+/*
+ * Statistics: stats[0] = memo hits, stats[1] = misses, stats[2] = size of the memo table
+ */
+JNIEXPORT void JNICALL Java_com_sri_yices_Yices_substitutionStats(JNIEnv *env, jclass, jlong subst, jlongArray stats) {
+  TRACE_NATIVE();
+  substitution *s = reinterpret_cast<substitution*>(subst);
+  subst_check_epoch(s);
+  jlong tmp[3];
+  tmp[0] = s->hits;
+  tmp[1] = s->misses;
+  tmp[2] = s->memo.size();
+  env->SetLongArrayRegion(stats, 0, 3, tmp);
+}
+
+JNIEXPORT void JNICALL Java_com_sri_yices_Yices_substitutionClear(JNIEnv *env, jclass, jlong subst) {
+  TRACE_NATIVE();
+  substitution *s = reinterpret_cast<substitution*>(subst);
+  s->memo.clear();
+  s->hits = 0;
+  s->misses = 0;
+}
+
 
 /*
  * GARBAGE COLLECTION
@@ -2894,16 +5494,19 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_substTermArray(JNIEnv *env, jcla
 
 // number of terms. The result is uint32 but it can be safely converted to int32.
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_yicesNumTerms(JNIEnv *, jclass) {
+  TRACE_NATIVE();
   return yices_num_terms();
 }
 
 // number of types.
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_yicesNumTypes(JNIEnv *, jclass) {
+  TRACE_NATIVE();
   return yices_num_types();
 }
 
 // increment the reference counter for term t. Yices may allocate memory.
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_yicesIncrefTerm(JNIEnv *env, jclass, jint t) {
+  TRACE_NATIVE();
   int result;
   try {
     result = yices_incref_term(t);
@@ -2915,11 +5518,13 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_yicesIncrefTerm(JNIEnv *env, jcl
 
 // decrement the reference counter: doesn't allocate memory
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_yicesDecrefTerm(JNIEnv *, jclass, jint t) {
+  TRACE_NATIVE();
   return yices_decref_term(t);
 }
 
 // increment the reference counter of type tau.
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_yicesIncrefType(JNIEnv *env, jclass, jint tau) {
+  TRACE_NATIVE();
   int result;
   try {
     result = yices_incref_type(tau);
@@ -2931,22 +5536,66 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_yicesIncrefType(JNIEnv *env, jcl
 
 // decrement the reference counter of type tau.
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_yicesDecrefType(JNIEnv *, jclass, jint tau) {
+  TRACE_NATIVE();
   return yices_decref_type(tau);
 }
 
 // number of terms with a positive reference counter.
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_yicesNumPosrefTerms(JNIEnv *, jclass) {
+  TRACE_NATIVE();
   return yices_num_posref_terms();
 }
 
 // number of types with a postive reference counter.
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_yicesNumPosrefTypes(JNIEnv *, jclass) {
+  TRACE_NATIVE();
   return yices_num_posref_types();
 }
 
-// call the garbage collector
-JNIEXPORT void JNICALL Java_com_sri_yices_Yices_yicesGarbageCollect(JNIEnv *env, jclass,
-                                                                    jintArray rootTerms, jintArray rootTypes, jboolean keepNamed) {
+/*
+ * Batch of reference-counter updates (cf. RefQueue.java)
+ * - ops[i] = (x << 2) | k where x is a term or type and k is
+ *   0: incref term x, 1: decref term x, 2: incref type x, 3: decref type x
+ * - only the first n elements of ops are used
+ * - returns the number of updates that failed (e.g., decref of a term whose
+ *   counter is zero) or -1 if n is out of bounds.
+ * The updates are processed in order. Failures are not reported as errors:
+ * the error report is cleared.
+ */
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_updateRefs(JNIEnv *env, jclass, jintArray ops, jint n) {
+  TRACE_NATIVE();
+  if (n < 0 || n > env->GetArrayLength(ops)) return -1;
+  if (n == 0) return 0;
+
+  int32_t *a = scratch_copy(env, ops, n);
+  if (a == NULL) return -1;
+
+  jint failed = 0;
+  try {
+    for (jint i=0; i<n; i++) {
+      int32_t x = a[i] >> 2;
+      int32_t code;
+      switch (a[i] & 3) {
+      case 0: code = yices_incref_term(x); break;
+      case 1: code = yices_decref_term(x); break;
+      case 2: code = yices_incref_type(x); break;
+      default: code = yices_decref_type(x); break;
+      }
+      if (code < 0) failed ++;
+    }
+    if (failed > 0) yices_clear_error();
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  scratch_free(a);
+
+  return failed;
+}
+
+// call the garbage collector (the Java wrapper flushes the RefQueue first)
+JNIEXPORT void JNICALL Java_com_sri_yices_Yices_garbageCollect(JNIEnv *env, jclass,
+                                                               jintArray rootTerms, jintArray rootTypes, jboolean keepNamed) {
+  TRACE_NATIVE();
 
   // rootTerms and rootTypes may be null.
   // GetArrayLength and GetIntArrayElements seg fault if the array is NULL
@@ -2974,6 +5623,7 @@ JNIEXPORT void JNICALL Java_com_sri_yices_Yices_yicesGarbageCollect(JNIEnv *env,
 
   try {
     yices_garbage_collect(root_terms, num_root_terms, root_types, num_root_types, keepNamed);
+    gc_epoch.fetch_add(1, std::memory_order_relaxed);
   } catch (std::bad_alloc &a) {
     out_of_mem_exception(env);
   }
@@ -2998,6 +5648,7 @@ JNIEXPORT void JNICALL Java_com_sri_yices_Yices_yicesGarbageCollect(JNIEnv *env,
  * - the descriptor is set to the default configuration
  */
 JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_newConfig(JNIEnv *env, jclass) {
+  TRACE_NATIVE();
   jlong result = 0; // NULL pointer
   try {
     result = reinterpret_cast<jlong>(yices_new_config());
@@ -3012,6 +5663,7 @@ JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_newConfig(JNIEnv *env, jclass)
  * Deletion
  */
 JNIEXPORT void JNICALL Java_com_sri_yices_Yices_freeConfig(JNIEnv *env, jclass, jlong config) {
+  TRACE_NATIVE();
   yices_free_config(reinterpret_cast<ctx_config_t*>(config));
 }
 
@@ -3021,17 +5673,16 @@ JNIEXPORT void JNICALL Java_com_sri_yices_Yices_freeConfig(JNIEnv *env, jclass,
  * - value = the value
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_setConfig(JNIEnv *env, jclass, jlong config, jstring name, jstring value) {
+  TRACE_NATIVE();
   jint code = -1;
-  const char *n = env->GetStringUTFChars(name, NULL);
-  const char *v = env->GetStringUTFChars(value, NULL);
-  if (n == NULL || v == NULL) {
+  utf_chars n(env, name);
+  utf_chars v(env, value);
+  if (n.get() == NULL || v.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     // can't cause out-of-mem
-    code = yices_set_config(reinterpret_cast<ctx_config_t*>(config), n, v);
+    code = yices_set_config(reinterpret_cast<ctx_config_t*>(config), n.get(), v.get());
   }
-  if (n != NULL) env->ReleaseStringUTFChars(name, n);
-  if (v != NULL) env->ReleaseStringUTFChars(value, v);
 
   return code;
 }
@@ -3040,19 +5691,20 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_setConfig(JNIEnv *env, jclass, j
  * Set config to a default solver type or solver combination for the given logic
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_defaultConfigForLogic(JNIEnv *env, jclass, jlong config, jstring logic) {
+  TRACE_NATIVE();
   jint code = -1;
-  const char *l = env->GetStringUTFChars(logic, NULL);
-  if (l == NULL) {
+  utf_chars l(env, logic);
+  if (l.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     // can't cause out-of-mem
-    code = yices_default_config_for_logic(reinterpret_cast<ctx_config_t*>(config), l);
-    env->ReleaseStringUTFChars(logic, l);
+    code = yices_default_config_for_logic(reinterpret_cast<ctx_config_t*>(config), l.get());
   }
   return code;
 }
 
 JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_newContext(JNIEnv *env, jclass, jlong config) {
+  TRACE_NATIVE();
   jlong result = 0; // NULL pointer
 
   try {
@@ -3064,18 +5716,22 @@ JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_newContext(JNIEnv *env, jclass,
 }
 
 JNIEXPORT void JNICALL Java_com_sri_yices_Yices_freeContext(JNIEnv *env, jclass, jlong context) {
+  TRACE_NATIVE();
   yices_free_context(reinterpret_cast<context_t*>(context));
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_contextStatus(JNIEnv *env, jclass, jlong ctx) {
+  TRACE_NATIVE();
   return yices_context_status(reinterpret_cast<context_t*>(ctx));
 }
 
 JNIEXPORT void JNICALL Java_com_sri_yices_Yices_resetContext (JNIEnv *env, jclass, jlong ctx) {
+  TRACE_NATIVE();
   yices_reset_context(reinterpret_cast<context_t*>(ctx));
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_push(JNIEnv *env, jclass, jlong ctx) {
+  TRACE_NATIVE();
   jint result = -1;
   try {
     result = yices_push(reinterpret_cast<context_t*>(ctx));
@@ -3086,6 +5742,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_push(JNIEnv *env, jclass, jlong
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_pop(JNIEnv *env, jclass, jlong ctx) {
+  TRACE_NATIVE();
   jint result = -1;
 
   try {
@@ -3097,30 +5754,33 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_pop(JNIEnv *env, jclass, jlong c
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_contextEnableOption(JNIEnv *env, jclass, jlong ctx, jstring opt) {
+  TRACE_NATIVE();
   jint result = -1;
-  const char *option = env->GetStringUTFChars(opt, NULL);
+  utf_chars option(env, opt);
 
-  if (opt == NULL) {
+  if (option.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     // can't cause out-of-mem
-    result = yices_context_enable_option(reinterpret_cast<context_t*>(ctx), option);
+    result = yices_context_enable_option(reinterpret_cast<context_t*>(ctx), option.get());
   }
   return result;
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_contextDisableOption(JNIEnv *env, jclass, jlong ctx, jstring opt) {
+  TRACE_NATIVE();
   jint result = -1;
-  const char *option = env->GetStringUTFChars(opt, NULL);
-  if (opt == NULL) {
+  utf_chars option(env, opt);
+  if (option.get() == NULL) {
     out_of_mem_exception(env);
   } else {
-    result = yices_context_disable_option(reinterpret_cast<context_t*>(ctx), option);
+    result = yices_context_disable_option(reinterpret_cast<context_t*>(ctx), option.get());
   }
   return result;
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_assertFormula(JNIEnv *env, jclass, jlong ctx, jint t) {
+  TRACE_NATIVE();
   jint result = -1;
   try {
     result = yices_assert_formula(reinterpret_cast<context_t*>(ctx), t);
@@ -3130,25 +5790,40 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_assertFormula(JNIEnv *env, jclas
   return result;
 }
 
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_assertFormulas(JNIEnv *env, jclass, jlong ctx, jintArray t) {
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_assertFormulas__J_3I(JNIEnv *env, jclass, jlong ctx, jintArray t) {
+  TRACE_NATIVE();
   jsize n = env->GetArrayLength(t);
-  term_t *a = array2terms(env, t, NULL);
+  term_t *a = scratch_copy(env, t, n);
   jint result = -1;
 
-  if (a == NULL) {
-    out_of_mem_exception(env);
-  } else {
+  if (a != NULL) {
+    try {
+      result = yices_assert_formulas(reinterpret_cast<context_t*>(ctx), n, a);
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+    scratch_free(a);
+  }
+  return result;
+}
+
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_assertFormulas__JLjava_nio_IntBuffer_2II(JNIEnv *env, jclass, jlong ctx, jobject t, jint offset, jint n) {
+  TRACE_NATIVE();
+  const term_t *a = direct_int_buffer(env, t, offset, n);
+  jint result = -1;
+
+  if (a != NULL) {
     try {
       result = yices_assert_formulas(reinterpret_cast<context_t*>(ctx), n, a);
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    release_term_elems(env, t, a);
   }
   return result;
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_checkContext(JNIEnv *env, jclass, jlong ctx, jlong params) {
+  TRACE_NATIVE();
   jint result = -1;
 
   try {
@@ -3161,23 +5836,24 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_checkContext(JNIEnv *env, jclass
 
 //Since 2.?.?  (new in the 2.6.4 bindings)
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_checkContextWithAssumptions(JNIEnv *env, jclass, jlong ctx, jlong params, jintArray t) {
+  TRACE_NATIVE();
   jsize n = env->GetArrayLength(t);
-  term_t *a = array2terms(env, t, NULL);
+  term_t *a = scratch_copy(env, t, n);
   jint result = -1;
-  if (a == NULL) {
-    out_of_mem_exception(env);
-  } else {
+  if (a != NULL) {
 	try {
 	  result = yices_check_context_with_assumptions(reinterpret_cast<context_t*>(ctx), reinterpret_cast<param_t*>(params), n, a);
 	} catch (std::bad_alloc &ba) {
 	  out_of_mem_exception(env);
 	}
+	scratch_free(a);
   }
   return result;
 }
 
 // since 2.6.4
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_checkContextWithModel(JNIEnv *env, jclass, jlong ctx, jlong params, jlong model, jintArray t){
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_4
   jint result = -1;
   jsize n = env->GetArrayLength(t);
@@ -3199,6 +5875,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_checkContextWithModel(JNIEnv *en
 
 // since 2.6.4
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_checkContextWithInterpolation(JNIEnv *env, jclass, jlong ctxA, jlong ctxB, jlong params, jlongArray marr, jintArray interpolant){
+  TRACE_NATIVE();
  #ifdef YICES_AT_LEAST_2_6_4
  jint result = -1;
   jsize i = (interpolant == 0 ? 0 : env->GetArrayLength(interpolant));
@@ -3217,7 +5894,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_checkContextWithInterpolation(JN
 	result = yices_check_context_with_interpolation(&ctx, reinterpret_cast<param_t*>(params), build_model);
 	if (result == STATUS_UNSAT) {
 	  // set the interpolant array
-	  env->SetIntArrayRegion(interpolant, 0, 1, &ctx.interpolant);
+	  set_int_region(env, interpolant, 0, 1, &ctx.interpolant);
 	} else if(build_model && result == STATUS_SAT ) {
 	  model_t *model = ctx.model;
 	  jlong mdl = reinterpret_cast<jlong>(model);
@@ -3234,6 +5911,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_checkContextWithInterpolation(JN
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_assertBlockingClause(JNIEnv *env, jclass, jlong ctx) {
+  TRACE_NATIVE();
   jint result = -1;
 
   try {
@@ -3245,10 +5923,12 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_assertBlockingClause(JNIEnv *env
 }
 
 JNIEXPORT void JNICALL Java_com_sri_yices_Yices_stopSearch(JNIEnv *env, jclass, jlong ctx) {
+  TRACE_NATIVE();
   yices_stop_search(reinterpret_cast<context_t*>(ctx));
 }
 
 JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_newParamRecord(JNIEnv *env, jclass) {
+  TRACE_NATIVE();
   jlong result = 0; // NULL Pointer
 
   try {
@@ -3260,31 +5940,33 @@ JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_newParamRecord(JNIEnv *env, jcl
 }
 
 JNIEXPORT void JNICALL Java_com_sri_yices_Yices_defaultParamsForContext(JNIEnv *env, jclass, jlong ctx, jlong params) {
+  TRACE_NATIVE();
   yices_default_params_for_context(reinterpret_cast<context_t*>(ctx), reinterpret_cast<param_t*>(params));
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_setParam(JNIEnv *env, jclass, jlong p, jstring pname, jstring value) {
+  TRACE_NATIVE();
   jint result = -1;
-  const char *pnm = env->GetStringUTFChars(pname, NULL);
-  const char *val = env->GetStringUTFChars(value, NULL);
+  utf_chars pnm(env, pname);
+  utf_chars val(env, value);
 
-  if (pnm == NULL || val == NULL) {
+  if (pnm.get() == NULL || val.get() == NULL) {
     out_of_mem_exception(env);
   } else {
-    result = yices_set_param(reinterpret_cast<param_t*>(p), pnm, val);
+    result = yices_set_param(reinterpret_cast<param_t*>(p), pnm.get(), val.get());
   }
-  if (pnm != NULL) env->ReleaseStringUTFChars(pname, pnm);
-  if (val != NULL) env->ReleaseStringUTFChars(value, val);
 
   return result;
 }
 
 JNIEXPORT void JNICALL Java_com_sri_yices_Yices_freeParamRecord(JNIEnv *env, jclass, jlong param) {
+  TRACE_NATIVE();
   yices_free_param_record(reinterpret_cast<param_t*>(param));
 }
 
 // since 2.?.?  (new in the 2.6.4 bindings)
 JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_getUnsatCore(JNIEnv *env, jclass, jlong ctx) {
+  TRACE_NATIVE();
   jintArray retval = NULL;
   int32_t code;
   term_vector_t aux;
@@ -3301,8 +5983,144 @@ JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_getUnsatCore(JNIEnv *env, j
   return retval;
 }
 
+/*
+ * Time budget of a native loop, in nanoseconds
+ * - budget <= 0 means no deadline
+ * - so does a budget larger than MAX_BUDGET (about 100 years): now() + budget
+ *   could overflow the clock
+ */
+struct call_budget {
+  static const jlong MAX_BUDGET = 100LL * 365 * 24 * 3600 * 1000000000LL;
+
+  bool limited;
+  std::chrono::steady_clock::time_point deadline;
+
+  explicit call_budget(jlong budget) : limited(budget > 0 && budget <= MAX_BUDGET) {
+    if (limited) deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(budget);
+  }
+
+  bool expired() const {
+    return limited && std::chrono::steady_clock::now() >= deadline;
+  }
+};
+
+/*
+ * Batch of checks with assumptions (all on the same context)
+ * - the assumption sets are in CSR form: set i is assumptions[offsets[i] ... offsets[i+1]-1]
+ *   (offsets has n+1 elements for n sets)
+ * - after each check:
+ *   if the status is UNSAT, the unsat core is stored
+ *   if the status is SAT and modelTerms is not NULL, the values of modelTerms are stored
+ *   (as constant terms)
+ * - budget = time limit in nanoseconds (0 means no limit, cf. call_budget): it's checked
+ *   before each check
+ * - a check that fails (or whose core or model values can't be obtained) is recorded
+ *   with status ERROR and the batch continues
+ *
+ * The result is an array r that contains:
+ *   r[0] = m = number of sets processed (less than n if the budget was exhausted,
+ *              or if a check was interrupted)
+ *   r[1 ... m] = status of each check
+ *   r[m+1 ... 2m+1] = m+1 offsets into r: the core or values for set i are
+ *   r[r[m+1+i] ... r[m+2+i]-1]
+ * Returns NULL if the offsets are not valid.
+ */
+JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_checkWithAssumptionsBatch(JNIEnv *env, jclass, jlong ctx, jlong params, jintArray offsets, jintArray assumptions, jintArray modelTerms, jlong budget) {
+  TRACE_NATIVE();
+  context_t *c = reinterpret_cast<context_t*>(ctx);
+  param_t *p = reinterpret_cast<param_t*>(params);
+  jsize noff = env->GetArrayLength(offsets);
+  jsize total = env->GetArrayLength(assumptions);
+  jsize k = modelTerms == NULL ? 0 : env->GetArrayLength(modelTerms);
+  jintArray result = NULL;
+
+  if (noff == 0) return NULL;
+
+  int32_t *off = NULL;
+  int32_t *a = NULL;
+  int32_t *mt = NULL;
+  term_vector_t core;
+
+  try {
+    yices_init_term_vector(&core);
+    off = new int32_t[noff];
+    a = new int32_t[total > 0 ? total : 1];
+    mt = new int32_t[k > 0 ? k : 1];
+    array2int_region(env, offsets, 0, noff, off);
+    array2int_region(env, assumptions, 0, total, a);
+    if (k > 0) array2int_region(env, modelTerms, 0, k, mt);
+
+    bool valid = off[0] == 0;
+    for (jsize i=1; i<noff && valid; i++) {
+      valid = off[i-1] <= off[i] && off[i] <= total;
+    }
+
+    if (valid) {
+      jsize n = noff - 1;
+      std::vector<int32_t> status;
+      std::vector<int32_t> data_off;
+      std::vector<int32_t> data;
+      std::vector<int32_t> values(k > 0 ? k : 1);
+      call_budget deadline(budget);
+
+      status.reserve(n);
+      data_off.push_back(0);
+      for (jsize i=0; i<n; i++) {
+        if (deadline.expired()) break;
+        smt_status_t st = yices_check_context_with_assumptions(c, p, off[i+1] - off[i], a + off[i]);
+        status.push_back(st);
+        if (st == STATUS_UNSAT) {
+          if (yices_get_unsat_core(c, &core) >= 0) {
+            data.insert(data.end(), core.data, core.data + core.size);
+          } else {
+            status.back() = STATUS_ERROR;
+          }
+        } else if (st == STATUS_SAT && k > 0) {
+          model_t *mdl = yices_get_model(c, 1);
+          if (mdl != NULL) {
+            if (yices_term_array_value(mdl, k, mt, values.data()) >= 0) {
+              data.insert(data.end(), values.begin(), values.begin() + k);
+            } else {
+              status.back() = STATUS_ERROR;
+            }
+            yices_free_model(mdl);
+          } else {
+            status.back() = STATUS_ERROR;
+          }
+        }
+        data_off.push_back(data.size());
+        if (status.back() == STATUS_ERROR) {
+          yices_clear_error();
+        } else if (st == STATUS_INTERRUPTED) {
+          // stopSearch was called
+          break;
+        }
+      }
+
+      jsize m = status.size();
+      jsize base = 2 + 2 * m;
+      std::vector<int32_t> r;
+      r.reserve(base + data.size());
+      r.push_back(m);
+      r.insert(r.end(), status.begin(), status.end());
+      for (jsize i=0; i<=m; i++) r.push_back(base + data_off[i]);
+      r.insert(r.end(), data.begin(), data.end());
+      result = convertToIntArray(env, r.size(), r.data());
+    }
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+
+  yices_delete_term_vector(&core);
+  delete [] mt;
+  delete [] a;
+  delete [] off;
+  return result;
+}
+
 // since 2.6.4
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getModelInterpolant(JNIEnv *env, jclass, jlong ctx) {
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_4
   jint result = -1;
   try {
@@ -3321,6 +6139,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getModelInterpolant(JNIEnv *env,
  * MODELS
  */
 JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_getModel(JNIEnv *env, jclass, jlong ctx, jint keep_subst) {
+  TRACE_NATIVE();
   jlong result = 0; // NULL pointer
 
   try {
@@ -3333,6 +6152,7 @@ JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_getModel(JNIEnv *env, jclass, j
 
 // since 2.6.4
 JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_newModel(JNIEnv *env, jclass){
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_4
   jlong result = 0; // NULL pointer
   try {
@@ -3348,42 +6168,248 @@ JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_newModel(JNIEnv *env, jclass){
 
 
 JNIEXPORT void JNICALL Java_com_sri_yices_Yices_freeModel(JNIEnv *env, jclass, jlong model) {
+  TRACE_NATIVE();
   yices_free_model(reinterpret_cast<model_t*>(model));
 }
 
 JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_modelFromMap(JNIEnv *env, jclass, jintArray var, jintArray map) {
+  TRACE_NATIVE();
   jsize vlen = env->GetArrayLength(var);
   jsize mlen = env->GetArrayLength(map);
   jlong result = 0; // NULL pointer
 
-  if (vlen == mlen) {
-    term_t *v = array2terms(env, var, NULL);
-    term_t *m = array2terms(env, map, NULL);
-    if (v == NULL || m == NULL) {
-      out_of_mem_exception(env);
-    } else {
+  if (vlen == mlen) {
+    term_t *v = array2terms(env, var, NULL);
+    term_t *m = array2terms(env, map, NULL);
+    if (v == NULL || m == NULL) {
+      out_of_mem_exception(env);
+    } else {
+      try {
+        result = reinterpret_cast<jlong>(yices_model_from_map(vlen, v, m));
+      } catch (std::bad_alloc &ba) {
+        out_of_mem_exception(env);
+      }
+    }
+
+    if (v != NULL) release_term_elems(env, var, v);
+    if (m != NULL) release_term_elems(env, map, m);
+  }
+
+  return result;
+}
+
+// Since 2.6.4
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetBool(JNIEnv *env, jclass, jlong model, jint var, jint val) {
+  TRACE_NATIVE();
+#ifdef YICES_AT_LEAST_2_6_4
+  jint result = -1;
+  try {
+	result = yices_model_set_bool(reinterpret_cast<model_t*>(model), static_cast<term_t>(var), static_cast<int32_t>(val));
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  return result;
+#else
+  return -1;
+#endif
+}
+
+// Since 2.6.4
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetInteger(JNIEnv *env, jclass, jlong model, jint var, jlong val){
+  TRACE_NATIVE();
+#ifdef YICES_AT_LEAST_2_6_4
+  jint result = -1;
+  try {
+	result = yices_model_set_int64(reinterpret_cast<model_t*>(model), static_cast<term_t>(var), val);
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  return result;
+#else
+  return -1;
+#endif
+}
+
+// Since 2.6.4
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetRational(JNIEnv *env, jclass, jlong model, jint var, jlong num, jlong den) {
+  TRACE_NATIVE();
+#ifdef YICES_AT_LEAST_2_6_4
+  jint result = -1;
+  try {
+	result = yices_model_set_rational64(reinterpret_cast<model_t*>(model), static_cast<term_t>(var), num, den);
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  return result;
+#else
+  return -1;
+#endif
+}
+
+// Since 2.6.4
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetBVInteger(JNIEnv *env, jclass, jlong model, jint var, jlong val) {
+  TRACE_NATIVE();
+#ifdef YICES_AT_LEAST_2_6_4
+  jint result = -1;
+  try {
+	result = yices_model_set_bv_uint64(reinterpret_cast<model_t*>(model), static_cast<term_t>(var), val);
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  return result;
+#else
+  return -1;
+#endif
+}
+
+// Since 2.6.4
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetBVFromArray(JNIEnv *env, jclass, jlong model, jint var, jintArray arr) {
+  TRACE_NATIVE();
+#ifdef YICES_AT_LEAST_2_6_4
+  jint result = -1;
+  jsize n = env->GetArrayLength(arr);
+  if (n == 0) {
+    return result;
+  }
+  assert(n > 0);
+  int32_t *vals = array2int32(env, arr, NULL);
+  try {
+	result = yices_model_set_bv_from_array(reinterpret_cast<model_t*>(model), static_cast<term_t>(var), n, vals);
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  release_int32_elems(env, arr, vals);
+  return result;
+#else
+  return -1;
+#endif
+}
+
+/*
+ * Set the value of a bitvector var from packed words or bytes
+ * - the number of bits is the size of var
+ * - return -1 if there's an error, including not enough words or bytes
+ */
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetBVFromWords(JNIEnv *env, jclass, jlong model, jint var, jlongArray w) {
+  TRACE_NATIVE();
+#ifdef YICES_AT_LEAST_2_6_4
+  jint result = -1;
+  uint32_t n = yices_term_bitsize(var);
+
+  if (n > 0 && static_cast<uint32_t>(env->GetArrayLength(w)) >= (n + 63)/64) {
+    jsize nw = (n + 63)/64;
+    uint64_t *aux = NULL;
+    int32_t *a = NULL;
+    try {
+      aux = new uint64_t[nw];
+      assert(sizeof(uint64_t) == sizeof(jlong));
+      env->GetLongArrayRegion(w, 0, nw, reinterpret_cast<jlong*>(aux));
+      if (n <= 64) {
+        result = yices_model_set_bv_uint64(reinterpret_cast<model_t*>(model), var, aux[0]);
+      } else {
+        a = scratch_alloc(n);
+        unpack_bits(n, aux, a);
+        result = yices_model_set_bv_from_array(reinterpret_cast<model_t*>(model), var, n, a);
+      }
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+    if (a != NULL) scratch_free(a);
+    delete [] aux;
+  }
+  return result;
+#else
+  return -1;
+#endif
+}
+
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetBVFromBytes(JNIEnv *env, jclass, jlong model, jint var, jobject buffer, jint offset) {
+  TRACE_NATIVE();
+#ifdef YICES_AT_LEAST_2_6_4
+  jint result = -1;
+  uint32_t n = yices_term_bitsize(var);
+
+  if (n > 0) {
+    const uint8_t *b = direct_byte_buffer(env, buffer, offset, (n + 7)/8);
+    if (b != NULL) {
+      int32_t *a = NULL;
       try {
-        result = reinterpret_cast<jlong>(yices_model_from_map(vlen, v, m));
+        a = scratch_alloc(n);
+        unpack_bits(n, b, a);
+        result = yices_model_set_bv_from_array(reinterpret_cast<model_t*>(model), var, n, a);
       } catch (std::bad_alloc &ba) {
         out_of_mem_exception(env);
       }
+      if (a != NULL) scratch_free(a);
     }
-
-    if (v != NULL) release_term_elems(env, var, v);
-    if (m != NULL) release_term_elems(env, map, m);
   }
+  return result;
+#else
+  return -1;
+#endif
+}
+
+
+/*
+ * Bulk setters: assign values to vars[0 ... n-1] in a single call
+ * - the values are in a long array, stride elements per variable
+ * - all variables are processed in order, until one assignment fails
+ * - the result is the number of variables that were assigned: if it's less
+ *   than n then the assignment of vars[result] failed (and the error report
+ *   says why).
+ * - the result is -1 if the arrays don't have the right size
+ */
+#ifdef YICES_AT_LEAST_2_6_4
+template <typename F>
+static jint model_set_all(JNIEnv *env, jintArray vars, jlongArray values, jsize stride, F set) {
+  jsize n = env->GetArrayLength(vars);
+  if (static_cast<jlong>(env->GetArrayLength(values)) < static_cast<jlong>(n) * stride) return -1;
+  if (n == 0) return 0;
 
+  jint result = -1;
+  int32_t *v = scratch_copy(env, vars, n);
+  if (v != NULL) {
+    jlong *a = NULL;
+    try {
+      a = new jlong[n * stride];
+      env->GetLongArrayRegion(values, 0, n * stride, a);
+      result = 0;
+      while (result < n && set(v[result], a + result * stride) >= 0) {
+        result ++;
+      }
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+    delete [] a;
+    scratch_free(v);
+  }
   return result;
 }
+#endif
 
-// Since 2.6.4
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetBool(JNIEnv *env, jclass, jlong model, jint var, jint val) {
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetBools(JNIEnv *env, jclass, jlong model, jintArray vars, jbooleanArray values) {
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_4
+  jsize n = env->GetArrayLength(vars);
+  if (env->GetArrayLength(values) < n) return -1;
+  if (n == 0) return 0;
+
   jint result = -1;
-  try {
-	result = yices_model_set_bool(reinterpret_cast<model_t*>(model), reinterpret_cast<term_t>(var), reinterpret_cast<int32_t>(val));
-  } catch (std::bad_alloc &ba) {
-    out_of_mem_exception(env);
+  int32_t *v = scratch_copy(env, vars, n);
+  if (v != NULL) {
+    jboolean *a = NULL;
+    try {
+      a = new jboolean[n];
+      env->GetBooleanArrayRegion(values, 0, n, a);
+      result = 0;
+      while (result < n && yices_model_set_bool(reinterpret_cast<model_t*>(model), v[result], a[result]) >= 0) {
+        result ++;
+      }
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+    delete [] a;
+    scratch_free(v);
   }
   return result;
 #else
@@ -3391,67 +6417,110 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetBool(JNIEnv *env, jclass
 #endif
 }
 
-// Since 2.6.4
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetInteger(JNIEnv *env, jclass, jlong model, jint var, jlong val){
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetIntegers(JNIEnv *env, jclass, jlong model, jintArray vars, jlongArray values) {
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_4
-  jint result = -1;
-  try {
-	result = yices_model_set_int64(reinterpret_cast<model_t*>(model), reinterpret_cast<term_t>(var), val);
-  } catch (std::bad_alloc &ba) {
-    out_of_mem_exception(env);
-  }
-  return result;
+  model_t *mdl = reinterpret_cast<model_t*>(model);
+  return model_set_all(env, vars, values, 1, [mdl](term_t x, const jlong *a) {
+      return yices_model_set_int64(mdl, x, a[0]);
+    });
 #else
   return -1;
 #endif
 }
 
-// Since 2.6.4
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetRational(JNIEnv *env, jclass, jlong model, jint var, jlong num, jlong den) {
+// values[2i] = numerator, values[2i+1] = denominator for vars[i]
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetRationals(JNIEnv *env, jclass, jlong model, jintArray vars, jlongArray values) {
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_4
-  jint result = -1;
-  try {
-	result = yices_model_set_rational64(reinterpret_cast<model_t*>(model), reinterpret_cast<term_t>(var), num, den);
-  } catch (std::bad_alloc &ba) {
-    out_of_mem_exception(env);
-  }
-  return result;
+  model_t *mdl = reinterpret_cast<model_t*>(model);
+  return model_set_all(env, vars, values, 2, [mdl](term_t x, const jlong *a) {
+      return yices_model_set_rational64(mdl, x, a[0], static_cast<uint64_t>(a[1]));
+    });
 #else
   return -1;
 #endif
 }
 
-// Since 2.6.4
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetBVInteger(JNIEnv *env, jclass, jlong model, jint var, jlong val) {
+// bitvectors of at most 64 bits: same as modelSetBVInteger
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetBVIntegers(JNIEnv *env, jclass, jlong model, jintArray vars, jlongArray values) {
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_4
-  jint result = -1;
-  try {
-	result = yices_model_set_bv_uint64(reinterpret_cast<model_t*>(model), reinterpret_cast<term_t>(var), val);
-  } catch (std::bad_alloc &ba) {
-    out_of_mem_exception(env);
-  }
-  return result;
+  model_t *mdl = reinterpret_cast<model_t*>(model);
+  return model_set_all(env, vars, values, 1, [mdl](term_t x, const jlong *a) {
+      return yices_model_set_bv_uint64(mdl, x, static_cast<uint64_t>(a[0]));
+    });
 #else
   return -1;
 #endif
 }
 
-// Since 2.6.4
-JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetBVFromArray(JNIEnv *env, jclass, jlong model, jint var, jintArray arr) {
+/*
+ * Bitvectors of any size: the words of vars[0], vars[1], ... are stored one after
+ * the other in words. A variable of n bits uses (n + 63)/64 words (same layout as
+ * in modelSetBVFromWords). The result is -2 and nothing is assigned if words
+ * is too small. Otherwise, it's the number of variables assigned (the first failure
+ * is a variable that's not a bitvector or an assignment that fails), or -1 if we
+ * run out of memory.
+ */
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetBVWords(JNIEnv *env, jclass, jlong model, jintArray vars, jlongArray words) {
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_4
+  model_t *mdl = reinterpret_cast<model_t*>(model);
+  jsize n = env->GetArrayLength(vars);
+  jsize nw = env->GetArrayLength(words);
+  if (n == 0) return 0;
+
   jint result = -1;
-  jsize n = env->GetArrayLength(arr);
-  if (n == 0) {
-    return result;
-  }
-  assert(n > 0);
-  int32_t *vals = array2int32(env, arr, NULL);
-  try {
-	result = yices_model_set_bv_from_array(reinterpret_cast<model_t*>(model), reinterpret_cast<term_t>(var), n, vals);
-  } catch (std::bad_alloc &ba) {
-    out_of_mem_exception(env);
+  int32_t *v = scratch_copy(env, vars, n);
+  if (v != NULL) {
+    uint64_t *w = NULL;
+    int32_t *bits = NULL;
+    uint32_t max_bits = 0;
+    try {
+      // first pass: check that we have enough words
+      // limit = index of the first variable that's not a bitvector (or n)
+      jsize limit = 0;
+      jlong needed = 0;
+      while (limit < n) {
+        uint32_t size = yices_term_bitsize(v[limit]);
+        if (size == 0) break;
+        needed += (size + 63)/64;
+        if (size > max_bits) max_bits = size;
+        limit ++;
+      }
+      if (needed <= nw) {
+        w = new uint64_t[nw > 0 ? nw : 1];
+        env->GetLongArrayRegion(words, 0, nw, reinterpret_cast<jlong*>(w));
+        // bits can't come from the scratch arena since that holds v
+        if (max_bits > 64) bits = new int32_t[max_bits];
+
+        result = 0;
+        const uint64_t *p = w;
+        while (result < limit) {
+          term_t x = v[result];
+          uint32_t size = yices_term_bitsize(x);
+          int32_t code;
+          if (size <= 64) {
+            code = yices_model_set_bv_uint64(mdl, x, p[0]);
+          } else {
+            unpack_bits(size, p, bits);
+            code = yices_model_set_bv_from_array(mdl, x, size, bits);
+          }
+          if (code < 0) break;
+          p += (size + 63)/64;
+          result ++;
+        }
+      } else {
+        result = -2;
+      }
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+    delete [] bits;
+    delete [] w;
+    scratch_free(v);
   }
-  release_int32_elems(env, arr, vals);
   return result;
 #else
   return -1;
@@ -3460,6 +6529,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_modelSetBVFromArray(JNIEnv *env,
 
 // since 2.?.? (new in 2.6.4 bindings)
 JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_modelCollectDefinedTerms(JNIEnv *env, jclass, jlong model) {
+  TRACE_NATIVE();
   term_vector_t aux;
   jintArray result = NULL;
   try {
@@ -3478,6 +6548,7 @@ JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_modelCollectDefinedTerms(JN
 
 // returns -1 for error, 0 for false, +1 for true
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getBoolValue(JNIEnv *env, jclass, jlong model, jint t) {
+  TRACE_NATIVE();
   int32_t val = -1;
   jint err;
 
@@ -3504,6 +6575,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getBoolValue(JNIEnv *env, jclass
  *   fit in 64 bits
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getIntegerValue(JNIEnv *env, jclass, jlong model, jint t, jlongArray a) {
+  TRACE_NATIVE();
   jlong  aux;
   jint result;
 
@@ -3535,6 +6607,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getIntegerValue(JNIEnv *env, jcl
  *   converted to jlong (signed 64bits).
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getRationalValue(JNIEnv *env, jclass, jlong model, jint t, jlongArray a) {
+  TRACE_NATIVE();
   int64_t num;
   uint64_t den;
   jlong aux[2];
@@ -3569,6 +6642,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getRationalValue(JNIEnv *env, jc
  * - a is an empty array or error for yices
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getDoubleValue(JNIEnv *env, jclass, jlong model, jint t, jdoubleArray a) {
+  TRACE_NATIVE();
   double aux;
   jint result;
 
@@ -3594,6 +6668,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getDoubleValue(JNIEnv *env, jcla
  * Return null if there's an error.
  */
 JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_getIntegerValueAsBytes(JNIEnv *env, jclass, jlong model, jint t) {
+  TRACE_NATIVE();
   jbyteArray result = NULL;
   mpz_t z;
 
@@ -3616,6 +6691,7 @@ JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_getIntegerValueAsBytes(JNI
  * - we return t's value in two steps: one call to get the numerator, one call to get the denominator.
  */
 JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_getRationalValueNumAsBytes(JNIEnv *env, jclass, jlong model, jint t) {
+  TRACE_NATIVE();
   jbyteArray result = NULL;
   mpq_t q;
 
@@ -3633,6 +6709,7 @@ JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_getRationalValueNumAsBytes
 }
 
 JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_getRationalValueDenAsBytes(JNIEnv *env, jclass, jlong model, jint t) {
+  TRACE_NATIVE();
   jbyteArray result = NULL;
   mpq_t q;
 
@@ -3649,7 +6726,34 @@ JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_getRationalValueDenAsBytes
   return result;
 }
 
+
+/*
+ * Value of t as limbs: this tries the 64-bit version first
+ */
+JNIEXPORT jlongArray JNICALL Java_com_sri_yices_Yices_getRationalValueLimbs(JNIEnv *env, jclass, jlong model, jint t) {
+  TRACE_NATIVE();
+  model_t *mdl = reinterpret_cast<model_t *>(model);
+  jlongArray result = NULL;
+  int64_t num;
+  uint64_t den;
+
+  try {
+    if (yices_get_rational64_value(mdl, t, &num, &den) >= 0) {
+      result = rational64_to_limbs(env, num, den);
+    } else if (yices_error_code() == EVAL_OVERFLOW) {
+      yices_clear_error();
+      if (yices_get_mpq_value(mdl, t, scratch_q.q) >= 0) {
+        result = mpq_to_limbs(env, scratch_q.q);
+      }
+    }
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  return result;
+}
+
 JNIEXPORT jbooleanArray JNICALL Java_com_sri_yices_Yices_getBvValue(JNIEnv *env, jclass, jlong model, jint t) {
+  TRACE_NATIVE();
   jbooleanArray result = NULL;
   uint32_t n = yices_term_bitsize(t);
 
@@ -3678,7 +6782,83 @@ JNIEXPORT jbooleanArray JNICALL Java_com_sri_yices_Yices_getBvValue(JNIEnv *env,
   return result;
 }
 
+/*
+ * Value of a bitvector term, packed in 64-bit words or in bytes (little endian)
+ * - bv_value_bits returns the value as an array of n bits, in a scratch buffer,
+ *   or NULL if there's an error.
+ */
+static int32_t *bv_value_bits(model_t *mdl, term_t t, uint32_t *n) {
+  *n = yices_term_bitsize(t);
+  if (*n == 0) return NULL;
+
+  int32_t *a = scratch_alloc(*n);
+  if (yices_get_bv_value(mdl, t, a) < 0) {
+    scratch_free(a);
+    return NULL;
+  }
+  return a;
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_sri_yices_Yices_getBvValueWords(JNIEnv *env, jclass, jlong model, jint t) {
+  TRACE_NATIVE();
+  jlongArray result = NULL;
+  int32_t *a = NULL;
+  uint64_t *w = NULL;
+  uint32_t n;
+
+  try {
+    a = bv_value_bits(reinterpret_cast<model_t*>(model), t, &n);
+    if (a != NULL) {
+      jsize nw = (n + 63)/64;
+      w = new uint64_t[nw];
+      pack_bits(n, a, w);
+      result = env->NewLongArray(nw);
+      if (result == NULL) {
+        out_of_mem_exception(env);
+      } else {
+        assert(sizeof(uint64_t) == sizeof(jlong));
+        env->SetLongArrayRegion(result, 0, nw, reinterpret_cast<jlong*>(w));
+      }
+    }
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  if (a != NULL) scratch_free(a);
+  delete [] w;
+
+  return result;
+}
+
+/*
+ * Store the value in a direct byte buffer, starting at offset
+ * - return the number of bytes used or -1 if there's an error
+ *   (IllegalArgumentException is thrown if the buffer is too small)
+ */
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getBvValueBytes(JNIEnv *env, jclass, jlong model, jint t, jobject buffer, jint offset) {
+  TRACE_NATIVE();
+  jint result = -1;
+  int32_t *a = NULL;
+  uint32_t n;
+
+  try {
+    a = bv_value_bits(reinterpret_cast<model_t*>(model), t, &n);
+    if (a != NULL) {
+      uint8_t *b = direct_byte_buffer(env, buffer, offset, (n + 7)/8);
+      if (b != NULL) {
+        pack_bits(n, a, b);
+        result = (n + 7)/8;
+      }
+    }
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  if (a != NULL) scratch_free(a);
+
+  return result;
+}
+
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getScalarValue(JNIEnv *env, jclass, jlong model, jint t) {
+  TRACE_NATIVE();
   int32_t val = -1;
   int32_t code;
 
@@ -3693,6 +6873,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getScalarValue(JNIEnv *env, jcla
 
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valueAsTerm(JNIEnv *env, jclass, jlong model, jint t) {
+  TRACE_NATIVE();
   int32_t result = -1;
 
   try {
@@ -3704,11 +6885,11 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valueAsTerm(JNIEnv *env, jclass,
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valuesAsTerms(JNIEnv *env, jclass, jlong model, jintArray input, jintArray output){
+  TRACE_NATIVE();
   jsize in;
   jsize on;
   term_t *itarr = NULL;
-  term_t *otarr = NULL;
-  int32_t code;
+  int32_t code = -1;
   in = env->GetArrayLength(input);
   if (in == 0) {
       return -1;
@@ -3717,22 +6898,351 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valuesAsTerms(JNIEnv *env, jclas
   if (on < in) {
       return -2;
   }
-  itarr = array2terms(env, input, NULL);
-  otarr = new int[in];
   try {
-	code = yices_term_array_value(reinterpret_cast<model_t*>(model), in, itarr, otarr);
-	if (code == 0){
-	  env->SetIntArrayRegion(output, 0, in, otarr);
-	}
+    // itarr = input terms, otarr = their values
+    itarr = scratch_alloc(2 * in);
+    term_t *otarr = itarr + in;
+    array2int_region(env, input, 0, in, itarr);
+    code = yices_term_array_value(reinterpret_cast<model_t*>(model), in, itarr, otarr);
+    if (code == 0){
+      set_int_region(env, output, 0, in, otarr);
+    }
   } catch (std::bad_alloc &ba) {
-	out_of_mem_exception(env);
+    out_of_mem_exception(env);
   }
-  delete otarr;
-  release_term_elems(env, input, itarr);
+  if (itarr != NULL) scratch_free(itarr);
   return code;
 }
 
+/*
+ * Bulk evaluation: values of t[0 ... n-1] in model
+ * - values and kinds must have length >= n
+ * - bits receives the bitvector values (it can be null if no t[i] is a bitvector)
+ *
+ * For each i, kinds[i] is one of the codes below (they must match ModelValues.java)
+ * and values[i] is:
+ * - VALUE_BOOL: 0 or 1
+ * - VALUE_INTEGER: t[i]'s value
+ * - VALUE_SCALAR: the index of t[i]'s value
+ * - VALUE_BITVECTOR: (width << 32) | offset where width = number of bits in t[i]
+ *   and the value is stored in bits[offset ... offset + (width+63)/64 - 1]
+ *   as 64-bit words, little endian (cf. pack_bits)
+ * - VALUE_OVERFLOW: 0. This is for arithmetic terms whose value is not an integer
+ *   or does not fit in 64 bits.
+ * - VALUE_OTHER: 0. This is for tuples and functions.
+ *
+ * Bits are attributed to the bitvector terms before anything is evaluated.
+ * If bits is too small for all of them, nothing is stored and the function
+ * returns the required size (i.e., a number larger than bits.length).
+ *
+ * Returns the number of words used in bits or -1 if there's an error.
+ */
+enum value_kind {
+  VALUE_BOOL = 0,
+  VALUE_INTEGER = 1,
+  VALUE_BITVECTOR = 2,
+  VALUE_SCALAR = 3,
+  VALUE_OVERFLOW = 4,
+  VALUE_OTHER = 5,
+};
+
+/*
+ * First pass: set kind[i] and attribute words to the bitvector terms
+ * - for a bitvector, val[i] is set to (width << 32) | offset, all other val[i] are 0
+ * - max_width is set to the largest bitvector width
+ * - return the total number of words or -1 if some a[i] is not a valid term
+ */
+static jlong classify_values(jsize n, const term_t *a, jlong *val, jbyte *kind, uint32_t *max_width) {
+  jlong nwords = 0;
+
+  *max_width = 0;
+  for (jsize i=0; i<n; i++) {
+    val[i] = 0;
+    if (yices_type_of_term(a[i]) < 0) return -1;
+    if (yices_term_is_bool(a[i])) {
+      kind[i] = VALUE_BOOL;
+    } else if (yices_term_is_arithmetic(a[i])) {
+      kind[i] = VALUE_INTEGER;
+    } else if (yices_term_is_bitvector(a[i])) {
+      uint32_t width = yices_term_bitsize(a[i]);
+      kind[i] = VALUE_BITVECTOR;
+      val[i] = (static_cast<jlong>(width) << 32) | nwords;
+      nwords += (width + 63)/64;
+      if (width > *max_width) *max_width = width;
+    } else if (yices_term_is_scalar(a[i])) {
+      kind[i] = VALUE_SCALAR;
+    } else {
+      kind[i] = VALUE_OTHER;
+    }
+  }
+  return nwords;
+}
+
+/*
+ * Second pass: evaluate
+ * - w = array of words for the bitvector values
+ * - aux = buffer large enough for the widest bitvector
+ * - return false if there's an error
+ */
+static bool eval_values(model_t *mdl, jsize n, const term_t *a, jlong *val, jbyte *kind, uint64_t *w, int32_t *aux) {
+  int32_t b;
+  int64_t x;
+
+  for (jsize i=0; i<n; i++) {
+    switch (kind[i]) {
+    case VALUE_BOOL:
+      if (yices_get_bool_value(mdl, a[i], &b) < 0) return false;
+      val[i] = b;
+      break;
+
+    case VALUE_INTEGER:
+      if (yices_get_int64_value(mdl, a[i], &x) >= 0) {
+        val[i] = x;
+      } else if (yices_error_code() == EVAL_OVERFLOW || yices_error_code() == EVAL_CONVERSION_FAILED) {
+        // not an integer or too large: the caller will have to use getRationalValue
+        kind[i] = VALUE_OVERFLOW;
+        yices_clear_error();
+      } else {
+        return false;
+      }
+      break;
+
+    case VALUE_BITVECTOR:
+      if (yices_get_bv_value(mdl, a[i], aux) < 0) return false;
+      pack_bits(static_cast<uint32_t>(val[i] >> 32), aux, w + (val[i] & 0xFFFFFFFF));
+      break;
+
+    case VALUE_SCALAR:
+      if (yices_get_scalar_value(mdl, a[i], &b) < 0) return false;
+      val[i] = b;
+      break;
+
+    default:
+      break;
+    }
+  }
+  return true;
+}
+
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_getValues(JNIEnv *env, jclass, jlong model, jintArray t, jlongArray values, jbyteArray kinds, jlongArray bits) {
+  TRACE_NATIVE();
+  jsize n = env->GetArrayLength(t);
+  jint result = -1;
+
+  if (env->GetArrayLength(values) < n || env->GetArrayLength(kinds) < n) {
+    return -1;
+  }
+
+  term_t *a = scratch_copy(env, t, n);
+  if (a == NULL) return -1;
+
+  jlong *val = NULL;
+  jbyte *kind = NULL;
+  uint64_t *w = NULL;
+  int32_t *aux = NULL;
+
+  try {
+    val = new jlong[n > 0 ? n : 1];
+    kind = new jbyte[n > 0 ? n : 1];
+
+    uint32_t max_width;
+    jlong nwords = classify_values(n, a, val, kind, &max_width);
+    if (nwords > std::numeric_limits<jint>::max()) {
+      // too many bits for a Java array
+      nwords = -1;
+    }
+
+    if (nwords > 0 && (bits == NULL || env->GetArrayLength(bits) < nwords)) {
+      // tell the caller how many words are needed
+      result = nwords;
+    } else if (nwords >= 0) {
+      if (nwords > 0) {
+        w = new uint64_t[nwords];
+        aux = new int32_t[max_width];
+      }
+      if (eval_values(reinterpret_cast<model_t*>(model), n, a, val, kind, w, aux)) {
+        env->SetLongArrayRegion(values, 0, n, val);
+        env->SetByteArrayRegion(kinds, 0, n, kind);
+        if (nwords > 0) {
+          assert(sizeof(uint64_t) == sizeof(jlong));
+          env->SetLongArrayRegion(bits, 0, nwords, reinterpret_cast<jlong*>(w));
+        }
+        result = nwords;
+      }
+    }
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+
+  delete [] aux;
+  delete [] w;
+  delete [] kind;
+  delete [] val;
+  scratch_free(a);
+
+  return result;
+}
+
+/*
+ * All-SAT with projection: enumerate up to max_models models of context ctx.
+ *
+ * After each model, the context is given a clause that blocks the values of the
+ * projection terms (or the whole model if there are no projection terms, as in
+ * assertBlockingClause), and it's checked again. This stops when the context is
+ * not SAT anymore, after max_models models, when the budget (in nanoseconds,
+ * 0 means no budget) is exhausted, or when there's an error.
+ *
+ * The values of the k projection terms in model i are stored in row i of the output
+ * arrays, i.e., at indices i*k ... i*k + k-1 of values, kinds, and valueTerms. The encoding
+ * is the same as in getValues except that the bitvector offsets of row i are relative
+ * to i * nwords in bits, where nwords is the number of words per model. The arrays
+ * grow as the models are found: they are created at the end, with exactly one row
+ * per model, and stored in out[0 ... 3] = values, kinds, bits, valueTerms (bits is
+ * NULL if nwords is 0).
+ * - info[0] = status of the last check: UNSAT if all models were found, SAT if
+ *   we stopped after max_models models, INTERRUPTED if the budget was exhausted,
+ *   ERROR if an error stopped the enumeration (the Yices error is then set).
+ * - info[1] = nwords.
+ *
+ * Returns the number of models found, even if there was an error after some
+ * models (their blocking clauses are in the context), or -1 if the arguments
+ * are not valid.
+ */
+JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_enumerateModels(JNIEnv *env, jclass, jlong ctx, jlong params, jintArray projection,
+                                                                jint maxModels, jlong budget, jobjectArray out, jintArray info) {
+  TRACE_NATIVE();
+  context_t *c = reinterpret_cast<context_t*>(ctx);
+  param_t *p = reinterpret_cast<param_t*>(params);
+  jsize k = env->GetArrayLength(projection);
+
+  if (maxModels < 0 || env->GetArrayLength(out) < 4 || env->GetArrayLength(info) < 2) {
+    return -1;
+  }
+
+  term_t *a = scratch_copy(env, projection, k);
+  if (a == NULL) return -1;
+
+  jint result = -1;
+  jint res_info[2] = { STATUS_ERROR, 0 };
+
+  try {
+    uint32_t max_width;
+    // row and row_kind: initial values and kinds for every model
+    std::vector<jlong> row(k > 0 ? k : 1);
+    std::vector<jbyte> row_kind(k > 0 ? k : 1);
+    jlong nwords = classify_values(k, a, row.data(), row_kind.data(), &max_width);
+    res_info[1] = nwords;
+
+    if (nwords >= 0) {
+      std::vector<jlong> val;
+      std::vector<jbyte> kind;
+      std::vector<term_t> vt;
+      std::vector<uint64_t> w;
+      std::vector<int32_t> aux(nwords > 0 ? max_width : 1);
+      std::vector<term_t> lits(k > 0 ? k : 1);
+
+      call_budget deadline(budget);
+      jint count = 0;
+      bool ok = true;
+      smt_status_t status = STATUS_SAT;
+
+      while (ok && count < maxModels) {
+        // the arrays must fit in Java arrays
+        if (static_cast<jlong>(count + 1) * k > std::numeric_limits<jint>::max() ||
+            static_cast<jlong>(count + 1) * nwords > std::numeric_limits<jint>::max()) {
+          status = STATUS_SAT;
+          break;
+        }
+        if (deadline.expired()) {
+          status = STATUS_INTERRUPTED;
+          break;
+        }
+        status = yices_check_context(c, p);
+        if (status != STATUS_SAT) {
+          ok = status != STATUS_ERROR;
+          break;
+        }
+        model_t *mdl = yices_get_model(c, 1);
+        if (mdl == NULL) {
+          ok = false;
+          break;
+        }
+
+        // values of row count
+        size_t base = static_cast<size_t>(count) * k;
+        val.insert(val.end(), row.begin(), row.begin() + k);
+        kind.insert(kind.end(), row_kind.begin(), row_kind.begin() + k);
+        vt.resize(base + k);
+        w.resize(static_cast<size_t>(count + 1) * nwords);
+        ok = eval_values(mdl, k, a, val.data() + base, kind.data() + base, w.data() + count * nwords, aux.data()) &&
+          yices_term_array_value(mdl, k, a, vt.data() + base) >= 0;
+
+        // block it
+        if (ok && k > 0) {
+          for (jsize j=0; j<k; j++) {
+            lits[j] = yices_neq(a[j], vt[base + j]);
+          }
+          term_t clause = yices_or(k, lits.data());
+          ok = clause >= 0 && yices_assert_formula(c, clause) >= 0;
+        } else if (ok) {
+          ok = yices_assert_blocking_clause(c) >= 0;
+        }
+        yices_free_model(mdl);
+        if (ok) count ++;
+      }
+
+      if (!ok) {
+        res_info[0] = STATUS_ERROR;
+      } else if (count == maxModels && status == STATUS_SAT) {
+        // we don't know whether there are more models
+        res_info[0] = STATUS_SAT;
+      } else {
+        res_info[0] = status;
+      }
+
+      // the rows of the models that were found (the others are dropped)
+      // (each conversion throws OutOfMemoryError if it fails: then we stop)
+      jsize cells = count * k;
+      jlongArray values = NULL;
+      jbyteArray kinds = NULL;
+      jintArray terms = NULL;
+      jlongArray bits = NULL;
+      values = convertToLongArray(env, cells, val.data());
+      if (values != NULL) {
+        kinds = env->NewByteArray(cells);
+        if (kinds == NULL) {
+          out_of_mem_exception(env);
+        } else {
+          env->SetByteArrayRegion(kinds, 0, cells, kind.data());
+        }
+      }
+      if (kinds != NULL) {
+        terms = convertToIntArray(env, cells, vt.data());
+      }
+      if (terms != NULL && nwords > 0) {
+        assert(sizeof(uint64_t) == sizeof(jlong));
+        bits = convertToLongArray(env, count * nwords, reinterpret_cast<jlong*>(w.data()));
+      }
+      if (terms != NULL && (nwords == 0 || bits != NULL)) {
+        env->SetObjectArrayElement(out, 0, values);
+        env->SetObjectArrayElement(out, 1, kinds);
+        env->SetObjectArrayElement(out, 2, bits);
+        env->SetObjectArrayElement(out, 3, terms);
+        result = count;
+      }
+    }
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+
+  env->SetIntArrayRegion(info, 0, 2, res_info);
+  scratch_free(a);
+
+  return result;
+}
+
 JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_modelToString__JII(JNIEnv *env, jclass, jlong model, jint columns, jint lines) {
+  TRACE_NATIVE();
   char *s;
   jstring result = NULL;
 
@@ -3750,6 +7260,7 @@ JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_modelToString__JII(JNIEnv *en
 }
 
 JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_modelToString__J(JNIEnv *env, jclass, jlong model) {
+  TRACE_NATIVE();
   char *s;
   jstring result = NULL;
 
@@ -3766,18 +7277,18 @@ JNIEXPORT jstring JNICALL Java_com_sri_yices_Yices_modelToString__J(JNIEnv *env,
 
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_hasDelegate(JNIEnv *env, jclass, jstring delegate){
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_2
   jint code = 0;
-  const char *s = env->GetStringUTFChars(delegate, NULL);
-  if (s == NULL) {
+  utf_chars s(env, delegate);
+  if (s.get() == NULL) {
     out_of_mem_exception(env);
   } else {
     try {
-      code = yices_has_delegate(s);
+      code = yices_has_delegate(s.get());
     } catch (std::bad_alloc &ba) {
       out_of_mem_exception(env);
     }
-    env->ReleaseStringUTFChars(delegate, s);
   }
   return (jboolean) code;
 #else
@@ -3789,43 +7300,33 @@ return (jboolean) 0;
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_checkFormula(JNIEnv *env, jclass, jint formula, jstring logic, jstring delegate, jlongArray marr){
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_2
-  int32_t code;
-  const char *ds;
-  const char *ls;
-  jsize n;
+  int32_t code = -1;
   bool wantModel = false;
   model_t *model = NULL;
-  jlong mdl;
   if (marr != NULL) {
-    n = env->GetArrayLength(marr);
-    if (n == 0) {
+    if (env->GetArrayLength(marr) == 0) {
       return -1;
     }
     wantModel = true;
   }
-  //delegate string
-  ds = env->GetStringUTFChars(delegate, NULL);
-  if (ds == NULL) {
+  // logic and delegate may be null
+  utf_chars ls(env, logic);
+  utf_chars ds(env, delegate);
+  if ((logic != NULL && ls.get() == NULL) || (delegate != NULL && ds.get() == NULL)) {
     out_of_mem_exception(env);
+    return -1;
   }
-  //logic string
-  ls = env->GetStringUTFChars(logic, NULL);
-  if (ls == NULL) {
-    env->ReleaseStringUTFChars(delegate, ds);
+  try {
+    code = yices_check_formula(formula, ls.get(), wantModel ? &model : NULL, ds.get());
+  } catch (std::bad_alloc &ba) {
     out_of_mem_exception(env);
   }
-  if (wantModel) {
-    code = yices_check_formula(formula, ls, &model, ds);
-    if (code == STATUS_SAT) {
-      mdl = reinterpret_cast<jlong>(model);
-      env->SetLongArrayRegion(marr, 0, 1, &mdl);
-    }
-  } else {
-    code = yices_check_formula(formula, ls, NULL, ds);
+  if (wantModel && code == STATUS_SAT) {
+    jlong mdl = reinterpret_cast<jlong>(model);
+    env->SetLongArrayRegion(marr, 0, 1, &mdl);
   }
-  env->ReleaseStringUTFChars(logic, ls);
-  env->ReleaseStringUTFChars(delegate, ds);
   return code;
 #else
   return YICES_ERROR_REQUIRES_AT_LEAST_2_6_2;
@@ -3833,56 +7334,40 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_checkFormula(JNIEnv *env, jclass
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_checkFormulas(JNIEnv *env, jclass, jintArray formulas, jstring logic, jstring delegate, jlongArray marr){
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_2
-  int32_t code;
-  const char *ds = NULL;
-  const char *ls = NULL;
-  jsize n;
+  int32_t code = -1;
   bool wantModel = false;
   model_t *model = NULL;
-  jlong mdl;
-  term_t *tarr;
   if (marr != NULL) {
-    n = env->GetArrayLength(marr);
-    if (n == 0) {
+    if (env->GetArrayLength(marr) == 0) {
       return -1;
     }
     wantModel = true;
-    assert(n > 0);
   }
-  n = env->GetArrayLength(formulas);
-  if (n == 0) {
-    return -2;
-  }
-  assert(n > 0);
-  // term array
-  tarr = array2terms(env, formulas, NULL);
-  if (tarr == NULL) {
-    out_of_mem_exception(env);
-  }
-  //delegate string
-  ds = env->GetStringUTFChars(delegate, NULL);
-  if (ds == NULL) {
-    out_of_mem_exception(env);
+  jsize n = env->GetArrayLength(formulas);
+  if (n == 0) {
+    return -2;
   }
-  //logic string
-  ls = env->GetStringUTFChars(logic, NULL);
-  if (ls == NULL) {
-    env->ReleaseStringUTFChars(delegate, ds);
+  term_t *tarr = scratch_copy(env, formulas, n);
+  if (tarr == NULL) return -1;
+  // logic and delegate may be null
+  utf_chars ls(env, logic);
+  utf_chars ds(env, delegate);
+  if ((logic != NULL && ls.get() == NULL) || (delegate != NULL && ds.get() == NULL)) {
     out_of_mem_exception(env);
-  }
-  if (wantModel) {
-    code = yices_check_formulas(tarr, n, ls, &model, ds);
-    if (code == STATUS_SAT) {
-      mdl = reinterpret_cast<jlong>(model);
+  } else {
+    try {
+      code = yices_check_formulas(tarr, n, ls.get(), wantModel ? &model : NULL, ds.get());
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+    if (wantModel && code == STATUS_SAT) {
+      jlong mdl = reinterpret_cast<jlong>(model);
       env->SetLongArrayRegion(marr, 0, 1, &mdl);
     }
-  } else {
-    code = yices_check_formulas(tarr, n, ls, NULL, ds);
   }
-  env->ReleaseStringUTFChars(logic, ls);
-  env->ReleaseStringUTFChars(delegate, ds);
-  release_term_elems(env, formulas, tarr);
+  scratch_free(tarr);
   return code;
 #else
   return YICES_ERROR_REQUIRES_AT_LEAST_2_6_2;
@@ -3893,6 +7378,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_checkFormulas(JNIEnv *env, jclas
 
 
 JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_implicantForFormula(JNIEnv *env, jclass, jlong model, jint term){
+  TRACE_NATIVE();
   jintArray retval = NULL;
   int32_t code;
   term_vector_t aux;
@@ -3910,6 +7396,7 @@ JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_implicantForFormula(JNIEnv
 }
 
 JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_implicantForFormulas(JNIEnv *env, jclass, jlong model, jintArray terms){
+  TRACE_NATIVE();
   jintArray retval = NULL;
   int32_t code;
   term_vector_t aux;
@@ -3940,6 +7427,7 @@ JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_implicantForFormulas(JNIEnv
 }
 
 JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_generalizeModel__JI_3II(JNIEnv *env, jclass, jlong model, jint term, jintArray elims, jint mode){
+  TRACE_NATIVE();
   jintArray retval = NULL;
   int32_t code;
   term_vector_t aux;
@@ -3969,6 +7457,7 @@ JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_generalizeModel__JI_3II(JNI
 }
 
 JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_generalizeModel__J_3I_3II(JNIEnv *env, jclass, jlong model, jintArray terms, jintArray elims, jint mode){
+  TRACE_NATIVE();
   jintArray retval = NULL;
   int32_t code;
   term_vector_t aux;
@@ -4015,25 +7504,27 @@ JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_generalizeModel__J_3I_3II(J
 
 // returns 1 if the file was written, 0 if the formula is solved, or a negative number indicating an error, the smt_status is stored in status
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_exportToDimacs__ILjava_lang_String_2Z_3I(JNIEnv *env, jclass, jint formula, jstring filename, jboolean simplify, jintArray status){
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_2
   int32_t code = -1;
-  jsize n;
-  const char *file = NULL;
-  smt_status_t stat;
-  n = env->GetArrayLength(status);
-  if (n == 0) {
+  smt_status_t stat = STATUS_ERROR;
+  if (env->GetArrayLength(status) == 0) {
+    return -1;
+  }
+  utf_chars file(env, filename);
+  if (file.get() == NULL) {
+    out_of_mem_exception(env);
     return -1;
   }
-  //filename string
-  file = env->GetStringUTFChars(filename, NULL);
-  if (file == NULL) {
+  try {
+    code = yices_export_formula_to_dimacs(formula, file.get(), simplify, &stat);
+  } catch (std::bad_alloc &ba) {
     out_of_mem_exception(env);
   }
-  code = yices_export_formula_to_dimacs(formula, file, simplify, &stat);
   if (code >=  0) {
-    env->SetIntArrayRegion(status, 0, 1, reinterpret_cast<int32_t *>(&stat));
+    jint st = stat;
+    env->SetIntArrayRegion(status, 0, 1, &st);
   }
-  env->ReleaseStringUTFChars(filename, file);
   return code;
 #else
   return YICES_ERROR_REQUIRES_AT_LEAST_2_6_2;
@@ -4042,35 +7533,34 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_exportToDimacs__ILjava_lang_Stri
 
 // returns 0 on success, or a negative numer indicating an error
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_exportToDimacs___3ILjava_lang_String_2Z_3I(JNIEnv *env, jclass, jintArray formulas, jstring filename, jboolean simplify, jintArray status){
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_2
-  int32_t code;
-  jsize n;
-  term_t *tarr;
-  const char *file = NULL;
-  smt_status_t stat;
-  n = env->GetArrayLength(status);
-  if (n == 0) {
+  int32_t code = -1;
+  smt_status_t stat = STATUS_ERROR;
+  if (env->GetArrayLength(status) == 0) {
     return -1;
   }
-  n = env->GetArrayLength(formulas);
+  jsize n = env->GetArrayLength(formulas);
   if (n == 0) {
     return -2;
   }
-  tarr = array2terms(env, formulas, NULL);
-  if (tarr == NULL) {
+  utf_chars file(env, filename);
+  if (file.get() == NULL) {
     out_of_mem_exception(env);
+    return -1;
   }
-  //filename string
-  file = env->GetStringUTFChars(filename, NULL);
-  if (file == NULL) {
+  term_t *tarr = scratch_copy(env, formulas, n);
+  if (tarr == NULL) return -1;
+  try {
+    code = yices_export_formulas_to_dimacs(tarr, n, file.get(), simplify, &stat);
+  } catch (std::bad_alloc &ba) {
     out_of_mem_exception(env);
   }
-  code = yices_export_formulas_to_dimacs(tarr, n, file, simplify, &stat);
+  scratch_free(tarr);
   if (code >=  0) {
-    env->SetIntArrayRegion(status, 0, 1, reinterpret_cast<int32_t *>(&stat));
+    jint st = stat;
+    env->SetIntArrayRegion(status, 0, 1, &st);
   }
-  env->ReleaseStringUTFChars(filename, file);
-  release_term_elems(env, formulas, tarr);
   return code;
 #else
   return YICES_ERROR_REQUIRES_AT_LEAST_2_6_2;
@@ -4078,7 +7568,313 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_exportToDimacs___3ILjava_lang_St
 }
 
 
+/*
+ * DIMACS export to memory
+ *
+ * Yices can only write the CNF to a named file, so we give it the name of an
+ * in-memory file: a memfd on Linux, a temporary file that's removed when it's
+ * closed on other systems. The result is then mapped in memory (copied on Windows)
+ * and returned as a direct ByteBuffer that must be released by calling freeDimacsBuffer.
+ */
+static int memory_file_open(const char *tag, char *name, size_t size, bool *named) {
+  int fd;
+#ifdef _WIN32
+  const char *dir = getenv("TEMP");
+  if (dir == NULL || dir[0] == '\0') dir = ".";
+  snprintf(name, size, "%s\\%s-XXXXXX", dir, tag);
+  fd = -1;
+  if (_mktemp_s(name, strlen(name) + 1) == 0) {
+    fd = _open(name, _O_RDWR | _O_CREAT | _O_EXCL | _O_BINARY, _S_IREAD | _S_IWRITE);
+  }
+  *named = true;
+  return fd;
+#else
+#if defined(__linux__) && defined(SYS_memfd_create)
+  fd = syscall(SYS_memfd_create, tag, 1); // 1 = MFD_CLOEXEC
+  if (fd >= 0) {
+    snprintf(name, size, "/proc/self/fd/%d", fd);
+    *named = false;
+    return fd;
+  }
+#endif
+  const char *dir = getenv("TMPDIR");
+  if (dir == NULL || dir[0] == '\0') dir = "/tmp";
+  snprintf(name, size, "%s/%s-XXXXXX", dir, tag);
+  fd = mkstemp(name);
+  *named = true;
+  return fd;
+#endif
+}
+
+/*
+ * Close a memory file and remove it if it has a name
+ * (Windows can't remove a file that's still open)
+ */
+static void memory_file_close(int fd, const char *name, bool named) {
+  close(fd);
+  if (named) unlink(name);
+}
+
+/*
+ * Read the first size bytes of fd into b
+ * - returns false if there's an error or if the file is shorter
+ */
+static bool read_memory_file(int fd, uint8_t *b, size_t size) {
+  if (lseek(fd, 0, SEEK_SET) != 0) return false;
+  size_t done = 0;
+  while (done < size) {
+    size_t chunk = size - done;
+    if (chunk > INT32_MAX) chunk = INT32_MAX;
+    int k = read(fd, b + done, chunk);
+    if (k <= 0) return false;
+    done += k;
+  }
+  return true;
+}
+
+/*
+ * Map the content of memory file fd and return it as a direct buffer
+ * - returns NULL if the file is empty
+ * - sets *failed to true if the file can't be mapped
+ */
+static jobject map_memory_file(JNIEnv *env, int fd, bool *failed) {
+  jobject buffer = NULL;
+  struct stat st;
+
+  *failed = false;
+  if (fstat(fd, &st) != 0 || st.st_size > INT32_MAX) {
+    // too large for a ByteBuffer
+    *failed = true;
+  } else if (st.st_size > 0) {
+#ifdef _WIN32
+    uint8_t *map = static_cast<uint8_t *>(malloc(st.st_size));
+    if (map == NULL || !read_memory_file(fd, map, st.st_size)) {
+      free(map);
+      *failed = true;
+    } else {
+      buffer = env->NewDirectByteBuffer(map, st.st_size);
+      if (buffer == NULL) free(map);
+    }
+#else
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+      *failed = true;
+    } else {
+      buffer = env->NewDirectByteBuffer(map, st.st_size);
+      if (buffer == NULL) munmap(map, st.st_size);
+    }
+#endif
+  }
+  return buffer;
+}
+
+/*
+ * Export formulas to memory
+ * - result[0] = code returned by yices_export_formulas_to_dimacs
+ *   (1 if the CNF was constructed, 0 if the formulas were solved, negative if error)
+ *   or -3 if the in-memory file can't be created or mapped
+ * - result[1] = the formulas' status
+ * - returns the CNF as a direct buffer, or NULL if result[0] is not 1 or the CNF is empty
+ */
+JNIEXPORT jobject JNICALL Java_com_sri_yices_Yices_exportToDimacsBuffer(JNIEnv *env, jclass, jintArray formulas, jboolean simplify, jintArray result) {
+  TRACE_NATIVE();
+  jint res[2] = { -1, STATUS_ERROR };
+  jobject buffer = NULL;
+
+  if (env->GetArrayLength(result) < 2) return NULL;
+#ifdef YICES_AT_LEAST_2_6_2
+  jsize n = env->GetArrayLength(formulas);
+  term_t *a = scratch_copy(env, formulas, n);
+  if (a == NULL) return NULL;
+
+  char name[PATH_MAX];
+  bool named;
+  int fd = memory_file_open("yices-dimacs", name, sizeof(name), &named);
+  if (fd < 0) {
+    res[0] = -3;
+  } else {
+    smt_status_t status = STATUS_ERROR;
+    try {
+      res[0] = yices_export_formulas_to_dimacs(a, n, name, simplify, &status);
+    } catch (std::bad_alloc &ba) {
+      out_of_mem_exception(env);
+    }
+    res[1] = status;
+
+    if (res[0] == 1) {
+      bool failed;
+      buffer = map_memory_file(env, fd, &failed);
+      if (failed) res[0] = -3;
+    }
+    memory_file_close(fd, name, named);
+  }
+  scratch_free(a);
+#else
+  res[0] = YICES_ERROR_REQUIRES_AT_LEAST_2_6_2;
+#endif
+  env->SetIntArrayRegion(result, 0, 2, res);
+  return buffer;
+}
+
+// release a buffer returned by map_memory_file
+static void unmap_buffer(JNIEnv *env, jobject buffer) {
+  void *map = env->GetDirectBufferAddress(buffer);
+  jlong size = env->GetDirectBufferCapacity(buffer);
+  if (map != NULL && size > 0) {
+#ifdef _WIN32
+    free(map);
+#else
+    munmap(map, size);
+#endif
+  }
+}
+
+// release a buffer returned by exportToDimacsBuffer
+JNIEXPORT void JNICALL Java_com_sri_yices_Yices_freeDimacsBuffer(JNIEnv *env, jclass, jobject buffer) {
+  TRACE_NATIVE();
+  unmap_buffer(env, buffer);
+}
+
+
+/*
+ * PRETTY PRINTING TO MEMORY
+ *
+ * The pretty printer writes the text in a memory file, then the text is either
+ * copied into a direct buffer supplied by the caller, or mapped and returned
+ * as a direct buffer (to be released by freeMappedBuffer). No C string and
+ * no Java String are built.
+ *
+ * print(fd) must return a negative code if there's an error.
+ */
+
+/*
+ * Copy the text into dst[offset ... offset + capacity - 1]
+ * - returns the size of the text (nothing is copied if it's more than capacity)
+ * - returns -1 if print fails, -2 if dst is not a direct buffer or too small
+ *   (then IllegalArgumentException is pending), -3 if the memory file can't be
+ *   created or read
+ */
+template <typename F>
+static jlong print_to_buffer(JNIEnv *env, F print, jobject dst, jint offset, jint capacity) {
+  uint8_t *b = direct_byte_buffer(env, dst, offset, capacity);
+  if (b == NULL) return -2;
+
+  char name[PATH_MAX];
+  bool named;
+  int fd = memory_file_open("yices-print", name, sizeof(name), &named);
+  if (fd < 0) return -3;
+
+  jlong result = -1;
+  if (print(fd) >= 0) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      result = -3;
+    } else {
+      result = st.st_size;
+      if (result <= capacity && !read_memory_file(fd, b, st.st_size)) {
+        result = -3;
+      }
+    }
+  }
+  memory_file_close(fd, name, named);
+  return result;
+}
+
+/*
+ * Return the text as a mapped buffer
+ * - code[0] = 0 if this works, -1 if print fails, -3 if the memory file can't be
+ *   created or mapped
+ * - the result is NULL if code[0] is negative or if the text is empty
+ */
+template <typename F>
+static jobject print_to_mapped(JNIEnv *env, F print, jintArray code) {
+  jint c = -3;
+  jobject buffer = NULL;
+
+  if (env->GetArrayLength(code) < 1) return NULL;
+
+  char name[PATH_MAX];
+  bool named;
+  int fd = memory_file_open("yices-print", name, sizeof(name), &named);
+  if (fd >= 0) {
+    c = -1;
+    if (print(fd) >= 0) {
+      bool failed;
+      buffer = map_memory_file(env, fd, &failed);
+      c = failed ? -3 : 0;
+    }
+    memory_file_close(fd, name, named);
+  }
+  env->SetIntArrayRegion(code, 0, 1, &c);
+  return buffer;
+}
+
+// negative columns or lines mean default (80 columns, no limit on the number of lines)
+static uint32_t print_width(jint columns) {
+  return columns < 0 ? 80 : columns;
+}
+
+static uint32_t print_height(jint lines) {
+  return lines < 0 ? std::numeric_limits<uint32_t>::max() : lines;
+}
+
+JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_termToBuffer(JNIEnv *env, jclass, jint t, jint columns, jint lines, jobject dst, jint offset, jint capacity) {
+  TRACE_NATIVE();
+  jlong result = -1;
+  try {
+    result = print_to_buffer(env, [=](int fd) { return yices_pp_term_fd(fd, t, print_width(columns), print_height(lines), 0); },
+                             dst, offset, capacity);
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  return result;
+}
+
+JNIEXPORT jlong JNICALL Java_com_sri_yices_Yices_modelToBuffer(JNIEnv *env, jclass, jlong model, jint columns, jint lines, jobject dst, jint offset, jint capacity) {
+  TRACE_NATIVE();
+  model_t *mdl = reinterpret_cast<model_t *>(model);
+  jlong result = -1;
+  try {
+    result = print_to_buffer(env, [=](int fd) { return yices_pp_model_fd(fd, mdl, print_width(columns), print_height(lines), 0); },
+                             dst, offset, capacity);
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  return result;
+}
+
+JNIEXPORT jobject JNICALL Java_com_sri_yices_Yices_termToMappedBuffer(JNIEnv *env, jclass, jint t, jint columns, jint lines, jintArray code) {
+  TRACE_NATIVE();
+  jobject result = NULL;
+  try {
+    result = print_to_mapped(env, [=](int fd) { return yices_pp_term_fd(fd, t, print_width(columns), print_height(lines), 0); }, code);
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  return result;
+}
+
+JNIEXPORT jobject JNICALL Java_com_sri_yices_Yices_modelToMappedBuffer(JNIEnv *env, jclass, jlong model, jint columns, jint lines, jintArray code) {
+  TRACE_NATIVE();
+  model_t *mdl = reinterpret_cast<model_t *>(model);
+  jobject result = NULL;
+  try {
+    result = print_to_mapped(env, [=](int fd) { return yices_pp_model_fd(fd, mdl, print_width(columns), print_height(lines), 0); }, code);
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  return result;
+}
+
+// release a buffer returned by termToMappedBuffer or modelToMappedBuffer
+JNIEXPORT void JNICALL Java_com_sri_yices_Yices_freeMappedBuffer(JNIEnv *env, jclass, jobject buffer) {
+  TRACE_NATIVE();
+  unmap_buffer(env, buffer);
+}
+
+
 JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_getSupport__JI(JNIEnv *env, jclass, jlong model, jint term){
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_2
   term_vector_t aux;
   jintArray result = NULL;
@@ -4101,6 +7897,7 @@ JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_getSupport__JI(JNIEnv *env,
 }
 
 JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_getSupport__J_3I(JNIEnv *env, jclass, jlong model, jintArray terms){
+  TRACE_NATIVE();
 #ifdef YICES_AT_LEAST_2_6_2
   term_vector_t aux;
   jintArray result = NULL;
@@ -4133,15 +7930,224 @@ JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_getSupport__J_3I(JNIEnv *en
 #endif
 }
 
+
+/*
+ * BATCHED MODEL OPERATIONS
+ *
+ * The same operation (implicant, generalization, or support) is applied to the
+ * same terms in many models. Each thread reuses one term vector for all its
+ * models and the results are packed in one array.
+ */
+#define MODEL_BATCH_IMPLICANT  0
+#define MODEL_BATCH_GENERALIZE 1
+#define MODEL_BATCH_SUPPORT    2
+
+struct model_batch {
+  int32_t op;
+  model_t * const *models;
+  uint32_t nterms;
+  const term_t *terms;
+  uint32_t nelims;
+  const term_t *elims;
+  yices_gen_mode_t mode;
+};
+
+/*
+ * Apply the operation to models[i] and store the result in v
+ * - returns a negative code if there's an error
+ */
+static int32_t model_batch_apply(const model_batch &b, int32_t i, term_vector_t *v) {
+  model_t *mdl = b.models[i];
+  switch (b.op) {
+  case MODEL_BATCH_IMPLICANT:
+    return yices_implicant_for_formulas(mdl, b.nterms, b.terms, v);
+  case MODEL_BATCH_GENERALIZE:
+    return yices_generalize_model_array(mdl, b.nterms, b.terms, b.nelims, b.elims, b.mode, v);
+  default:
+#ifdef YICES_AT_LEAST_2_6_2
+    return yices_model_term_array_support(mdl, b.nterms, b.terms, v);
+#else
+    return -1;
+#endif
+  }
+}
+
+/*
+ * Process models[i] for i = first, first + step, first + 2*step, ... < n
+ * - the result for model i is copied into cubes[i], or ok[i] is cleared if there's an error
+ * - sets *oom if we run out of memory (the remaining models are skipped)
+ */
+static void model_batch_run(const model_batch &b, int32_t first, int32_t step, int32_t n,
+                            std::vector<std::vector<int32_t>> &cubes, std::vector<char> &ok, bool *oom) {
+  term_vector_t v;
+  try {
+    yices_init_term_vector(&v);
+    for (int32_t i=first; i<n; i += step) {
+      if (model_batch_apply(b, i, &v) >= 0) {
+        cubes[i].assign(v.data, v.data + v.size);
+      } else {
+        ok[i] = 0;
+      }
+    }
+    yices_delete_term_vector(&v);
+  } catch (std::bad_alloc &ba) {
+    *oom = true;
+  }
+}
+
+/*
+ * Batch operation on n models
+ * - op = MODEL_BATCH_IMPLICANT, MODEL_BATCH_GENERALIZE, or MODEL_BATCH_SUPPORT
+ * - elims and mode are used only for generalization (elims may be null)
+ * - threads = number of threads to use: the call is sequential if threads <= 1
+ *   or if Yices is not thread safe. If fewer threads can be created, the
+ *   calling thread does the rest of the work.
+ *
+ * The result is an array r that contains:
+ *   r[0] = n
+ *   r[1 ... n] = 0 for each model that was processed, -1 for each model where the operation failed
+ *   r[n+1 ... 2n+1] = n+1 offsets into r: the result for model i is r[r[n+1+i] ... r[n+2+i]-1]
+ * If an operation failed, the error report is the one of the first model that failed
+ * (it's computed again on the calling thread if needed).
+ *
+ * Returns NULL if op is not valid or if a model is null.
+ */
+JNIEXPORT jintArray JNICALL Java_com_sri_yices_Yices_modelBatch(JNIEnv *env, jclass, jint op, jlongArray models, jintArray terms, jintArray elims, jint mode, jint threads) {
+  TRACE_NATIVE();
+  jintArray result = NULL;
+
+  if (op < MODEL_BATCH_IMPLICANT || op > MODEL_BATCH_SUPPORT) return NULL;
+#ifndef YICES_AT_LEAST_2_6_2
+  if (op == MODEL_BATCH_SUPPORT) return NULL;
+#endif
+
+  jsize n = env->GetArrayLength(models);
+  jsize nt = env->GetArrayLength(terms);
+  jsize ne = (op != MODEL_BATCH_GENERALIZE || elims == NULL) ? 0 : env->GetArrayLength(elims);
+
+  try {
+    std::vector<model_t *> mdl(n);
+    std::vector<term_t> t(nt > 0 ? nt : 1);
+    std::vector<term_t> e(ne > 0 ? ne : 1);
+    {
+      pinned_array<jlongArray> m(env, models);
+      if (m.get() == NULL) {
+        out_of_mem_exception(env);
+        return NULL;
+      }
+      for (jsize i=0; i<n; i++) {
+        if (m.get()[i] == 0) return NULL;
+        mdl[i] = reinterpret_cast<model_t *>(m.get()[i]);
+      }
+    }
+    if (nt > 0) array2int_region(env, terms, 0, nt, t.data());
+    if (ne > 0) array2int_region(env, elims, 0, ne, e.data());
+
+    model_batch b;
+    b.op = op;
+    b.models = mdl.data();
+    b.nterms = nt;
+    b.terms = t.data();
+    b.nelims = ne;
+    b.elims = e.data();
+    b.mode = static_cast<yices_gen_mode_t>(mode);
+
+    int32_t k = threads;
+    if (k > n) k = n;
+    if (k > 1 && !yices_is_thread_safe()) k = 1;
+
+    std::vector<std::vector<int32_t>> cubes(n);
+    std::vector<char> ok(n, 1);
+    bool oom = false;
+
+    if (k <= 1) {
+      model_batch_run(b, 0, 1, n, cubes, ok, &oom);
+    } else {
+      std::vector<char> oom_flags(k, 0);
+      std::vector<std::thread> workers;
+      workers.reserve(k - 1);
+      // worker j processes models j, j+k, j+2k, ...
+      // if a thread can't be created, the calling thread processes the remaining strides
+      int32_t started = 1;
+      for (int32_t j=1; j<k; j++) {
+        try {
+          workers.emplace_back([&b, j, k, n, &cubes, &ok, &oom_flags]() {
+            bool o = false;
+            model_batch_run(b, j, k, n, cubes, ok, &o);
+            oom_flags[j] = o;
+          });
+        } catch (std::system_error &se) {
+          break;
+        }
+        started ++;
+      }
+      model_batch_run(b, 0, k, n, cubes, ok, &oom);
+      for (int32_t j=started; j<k; j++) {
+        model_batch_run(b, j, k, n, cubes, ok, &oom);
+      }
+      for (std::thread &w : workers) w.join();
+      for (int32_t j=1; j<started; j++) {
+        if (oom_flags[j]) oom = true;
+      }
+      // the error report of a worker thread is lost, and the last error on this
+      // thread may not be the first failure: compute it again here
+      for (jsize i=0; i<n && !oom; i++) {
+        if (!ok[i]) {
+          term_vector_t v;
+          yices_init_term_vector(&v);
+          model_batch_apply(b, i, &v);
+          yices_delete_term_vector(&v);
+          break;
+        }
+      }
+    }
+
+    if (oom) {
+      out_of_mem_exception(env);
+    } else {
+      size_t total = 0;
+      for (jsize i=0; i<n; i++) total += cubes[i].size();
+      jsize base = 2 + 2 * n;
+      if (total > static_cast<size_t>(INT32_MAX - base)) throw std::bad_alloc();
+      std::vector<int32_t> r;
+      r.reserve(base + total);
+      r.push_back(n);
+      for (jsize i=0; i<n; i++) r.push_back(ok[i] ? 0 : -1);
+      int32_t offset = base;
+      for (jsize i=0; i<n; i++) {
+        r.push_back(offset);
+        offset += cubes[i].size();
+      }
+      r.push_back(offset);
+      for (jsize i=0; i<n; i++) r.insert(r.end(), cubes[i].begin(), cubes[i].end());
+      result = convertToIntArray(env, r.size(), r.data());
+    }
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+
+  return result;
+}
+
+
 static jobject makeYVal(JNIEnv *env, yval_t *yval){
-  jclass yvalClass;
-  jmethodID constructor;
-  yvalClass = env->FindClass("com/sri/yices/YVal");
-  assert(yvalClass != NULL);
+  TRACE_MARSHAL();
+  assert(yval_class != NULL && yval_init != NULL);
+  return env->NewObject(yval_class, yval_init, yval->node_tag, yval->node_id);
+}
 
-  constructor = env->GetMethodID(yvalClass, "<init>", "(II)V");
-  assert(constructor != NULL);
-  return env->NewObject(yvalClass, constructor, yval->node_tag, yval->node_id);
+/*
+ * Store a new YVal in array a at index i
+ * - we delete the local reference so that loops over large functions
+ *   or mappings don't exhaust the local reference table
+ */
+static void setYValElement(JNIEnv *env, jobjectArray a, jsize i, yval_t *yval){
+  TRACE_MARSHAL();
+  jobject v = makeYVal(env, yval);
+  if (v != NULL) {
+    env->SetObjectArrayElement(a, i, v);
+    env->DeleteLocalRef(v);
+  }
 }
 
 //returns true if tag is OK, and fills in the slots of yval, false otherwise.
@@ -4155,6 +8161,7 @@ static bool convertToYval(jint tag, jint id, yval_t *yval){
 }
 
 JNIEXPORT jobject JNICALL Java_com_sri_yices_Yices_getValue(JNIEnv *env, jclass, jlong model, jint term){
+  TRACE_NATIVE();
   yval_t yval;
   int32_t code;
   code = yices_get_value(reinterpret_cast<model_t*>(model), term, &yval);
@@ -4165,6 +8172,7 @@ JNIEXPORT jobject JNICALL Java_com_sri_yices_Yices_getValue(JNIEnv *env, jclass,
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_valIsInt(JNIEnv *env, jclass, jlong model, jint tag, jint id){
+  TRACE_NATIVE();
   yval_t yval;
   int32_t code;
   if (!convertToYval(tag, id, &yval) ||  tag != YVAL_RATIONAL) {
@@ -4176,6 +8184,7 @@ JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_valIsInt(JNIEnv *env, jclass
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_valIsLong(JNIEnv *env, jclass, jlong model, jint tag, jint id){
+  TRACE_NATIVE();
   yval_t yval;
   int32_t code;
   if (!convertToYval(tag, id, &yval) ||  tag != YVAL_RATIONAL) {
@@ -4187,6 +8196,7 @@ JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_valIsLong(JNIEnv *env, jclas
 }
 
 JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_valIsInteger(JNIEnv *env, jclass, jlong model, jint tag, jint id){
+  TRACE_NATIVE();
   yval_t yval;
   int32_t code;
   if (!convertToYval(tag, id, &yval) ||  tag != YVAL_RATIONAL) {
@@ -4199,6 +8209,7 @@ JNIEXPORT jboolean JNICALL Java_com_sri_yices_Yices_valIsInteger(JNIEnv *env, jc
 
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valBitSize(JNIEnv *env, jclass, jlong model, jint tag, jint id){
+  TRACE_NATIVE();
   yval_t yval;
   uint32_t code;
   if (!convertToYval(tag, id, &yval) ||  tag != YVAL_BV) {
@@ -4211,6 +8222,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valBitSize(JNIEnv *env, jclass,
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valFunctionArity(JNIEnv *env, jclass, jlong model, jint tag, jint id){
+  TRACE_NATIVE();
   yval_t yval;
   uint32_t code;
   if (!convertToYval(tag, id, &yval) ||  tag != YVAL_FUNCTION) {
@@ -4223,6 +8235,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valFunctionArity(JNIEnv *env, jc
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valTupleArity(JNIEnv *env, jclass, jlong model, jint tag, jint id){
+  TRACE_NATIVE();
   yval_t yval;
   uint32_t code;
   if (!convertToYval(tag, id, &yval) ||  tag != YVAL_TUPLE) {
@@ -4235,6 +8248,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valTupleArity(JNIEnv *env, jclas
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valMappingArity(JNIEnv *env, jclass, jlong model, jint tag, jint id){
+  TRACE_NATIVE();
   yval_t yval;
   uint32_t code;
   if (!convertToYval(tag, id, &yval) ||  tag != YVAL_MAPPING) {
@@ -4247,6 +8261,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valMappingArity(JNIEnv *env, jcl
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valFunctionType(JNIEnv *env, jclass, jlong model, jint tag, jint id){
+  TRACE_NATIVE();
   yval_t yval;
   int32_t code;
   if (!convertToYval(tag, id, &yval) ||  tag != YVAL_FUNCTION) {
@@ -4260,6 +8275,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valFunctionType(JNIEnv *env, jcl
 
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valGetBool(JNIEnv * env, jclass, jlong model, jint tag, jint id){
+  TRACE_NATIVE();
   yval_t yval;
   int32_t val;
   int32_t code;
@@ -4283,6 +8299,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valGetBool(JNIEnv * env, jclass,
  *   fit in 64 bits
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valGetInteger(JNIEnv *env, jclass, jlong model, jint tag, jint id, jlongArray a){
+  TRACE_NATIVE();
   yval_t yval;
   jlong  aux;
   jint result;
@@ -4318,6 +8335,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valGetInteger(JNIEnv *env, jclas
  *   converted to jlong (signed 64bits).
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valGetRational(JNIEnv *env, jclass, jlong model, jint tag, jint id, jlongArray a){
+  TRACE_NATIVE();
   yval_t yval;
   int64_t num;
   uint64_t den;
@@ -4357,6 +8375,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valGetRational(JNIEnv *env, jcla
  * - a is an empty array or error for yices
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valGetDouble(JNIEnv *env, jclass, jlong model, jint tag, jint id, jdoubleArray a){
+  TRACE_NATIVE();
   yval_t yval;
   double aux;
   jint result;
@@ -4379,6 +8398,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valGetDouble(JNIEnv *env, jclass
 }
 
 JNIEXPORT jbooleanArray JNICALL Java_com_sri_yices_Yices_valGetBV(JNIEnv *env, jclass, jlong model, jint tag, jint id){
+  TRACE_NATIVE();
   yval_t yval;
   jbooleanArray result;
   uint32_t n;
@@ -4422,6 +8442,7 @@ JNIEXPORT jbooleanArray JNICALL Java_com_sri_yices_Yices_valGetBV(JNIEnv *env, j
  * stores the scalar val in a[0] and the type in a[1]
  */
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valGetScalar(JNIEnv *env, jclass, jlong model, jint tag, jint id, jintArray a){
+  TRACE_NATIVE();
   yval_t yval;
   int32_t result = -1;
   int32_t code;
@@ -4442,7 +8463,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valGetScalar(JNIEnv *env, jclass
     }
     aux[0] = val;
     aux[1] = (int)tau;
-    env->SetIntArrayRegion(a, 0, 2, aux);
+    set_int_region(env, a, 0, 2, aux);
   } catch (std::bad_alloc &ba) {
     out_of_mem_exception(env);
   }
@@ -4450,6 +8471,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valGetScalar(JNIEnv *env, jclass
 }
 
 JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_valGetIntegerAsBytes(JNIEnv *env, jclass, jlong model, jint tag, jint id){
+  TRACE_NATIVE();
   yval_t yval;
   jbyteArray result = NULL;
   mpz_t z;
@@ -4471,6 +8493,7 @@ JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_valGetIntegerAsBytes(JNIEn
 }
 
 JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_valGetRationalNumAsBytes(JNIEnv *env, jclass, jlong model, jint tag, jint id){
+  TRACE_NATIVE();
   yval_t yval;
   jbyteArray result = NULL;
   mpq_t q;
@@ -4494,6 +8517,7 @@ JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_valGetRationalNumAsBytes(J
 }
 
 JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_valGetRationalDenAsBytes(JNIEnv *env, jclass, jlong model, jint tag, jint id){
+  TRACE_NATIVE();
   yval_t yval;
   jbyteArray result = NULL;
   mpq_t q;
@@ -4517,8 +8541,37 @@ JNIEXPORT jbyteArray JNICALL Java_com_sri_yices_Yices_valGetRationalDenAsBytes(J
 
 }
 
+
+JNIEXPORT jlongArray JNICALL Java_com_sri_yices_Yices_valGetRationalLimbs(JNIEnv *env, jclass, jlong model, jint tag, jint id) {
+  TRACE_NATIVE();
+  model_t *mdl = reinterpret_cast<model_t *>(model);
+  yval_t yval;
+  jlongArray result = NULL;
+  int64_t num;
+  uint64_t den;
+
+  if (!convertToYval(tag, id, &yval) || tag != YVAL_RATIONAL) {
+    return result;
+  }
+
+  try {
+    if (yices_val_get_rational64(mdl, &yval, &num, &den) >= 0) {
+      result = rational64_to_limbs(env, num, den);
+    } else {
+      yices_clear_error();
+      if (yices_val_get_mpq(mdl, &yval, scratch_q.q) >= 0) {
+        result = mpq_to_limbs(env, scratch_q.q);
+      }
+    }
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  return result;
+}
+
 //iam: can I really get away without checking the tye of the children array?
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valExpandTuple(JNIEnv *env, jclass, jlong mdl, jint tag, jint id, jobjectArray children){
+  TRACE_NATIVE();
   yval_t yval;
   int32_t arity;
   jsize n;
@@ -4527,7 +8580,6 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valExpandTuple(JNIEnv *env, jcla
   model_t *model = reinterpret_cast<model_t *>(mdl);
   int32_t i;
   yval_t ychild;
-  jobject child;
 
   if (!convertToYval(tag, id, &yval) ||  tag != YVAL_TUPLE) {
     return -1;
@@ -4543,19 +8595,19 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valExpandTuple(JNIEnv *env, jcla
   carr = new yval_t[arity];
   code = yices_val_expand_tuple(model, &yval, carr);
   if (code < 0) {
-    delete carr;
+    delete [] carr;
     return -4;
   }
   for (i = 0; i < arity; i++) {
     ychild = carr[i];
-    child = makeYVal(env, &ychild);
-    env->SetObjectArrayElement(children, i, child);
+    setYValElement(env, children, i, &ychild);
   }
-  delete carr;
+  delete [] carr;
   return 0;
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valFunctionCardinality(JNIEnv *env, jclass, jlong model, jint tag, jint id){
+  TRACE_NATIVE();
   yval_t yval;
   int32_t code;
   yval_t def;
@@ -4575,6 +8627,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valFunctionCardinality(JNIEnv *e
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valExpandFunction(JNIEnv *env, jclass cls, jlong mdl, jint tag, jint id,  jobjectArray def, jobjectArray mappings){
+  TRACE_NATIVE();
   yval_t yval;
   int32_t cardinality;
   jsize ndef;
@@ -4603,15 +8656,16 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valExpandFunction(JNIEnv *env, j
   yices_init_yval_vector(&ymaps);
   code = yices_val_expand_function(reinterpret_cast<model_t *>(mdl), &yval, &ydef, &ymaps);
   if (code < 0) {
+    yices_delete_yval_vector(&ymaps);
     return -5;
   }
 
   assert(static_cast<int32_t>(ymaps.size) == cardinality);
 
-  env->SetObjectArrayElement(def, 0, makeYVal(env, &ydef));
+  setYValElement(env, def, 0, &ydef);
 
   for (i = 0; i < cardinality; i++) {
-    env->SetObjectArrayElement(mappings, i, makeYVal(env, &(ymaps.data[i])));
+    setYValElement(env, mappings, i, &(ymaps.data[i]));
   }
 
   yices_delete_yval_vector(&ymaps);
@@ -4619,6 +8673,7 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valExpandFunction(JNIEnv *env, j
 }
 
 JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valExpandMapping(JNIEnv *env, jclass, jlong mdl, jint tag, jint id, jobjectArray args, jobjectArray value){
+  TRACE_NATIVE();
   yval_t yval;
   int32_t arity;
   model_t *model = reinterpret_cast<model_t *>(mdl);
@@ -4651,22 +8706,220 @@ JNIEXPORT jint JNICALL Java_com_sri_yices_Yices_valExpandMapping(JNIEnv *env, jc
   code = yices_val_expand_mapping(model, &yval, yargs, &yvalue);
 
   if (code == 0) {
-    env->SetObjectArrayElement(value, 0, makeYVal(env, &yvalue));
+    setYValElement(env, value, 0, &yvalue);
 
     for (i = 0; i < arity; i++) {
-      env->SetObjectArrayElement(args, i, makeYVal(env, &(yargs[i])));
+      setYValElement(env, args, i, &(yargs[i]));
     }
   }
-  delete yargs;
+  delete [] yargs;
   return 0;
 }
 
 
-#if 0
+/*
+ * VALUE SNAPSHOTS
+ *
+ * The DAG of values reachable from a set of terms, flattened into a single
+ * long array (cf. ValueSnapshot.java). Nodes are numbered 0 ... n-1 in the
+ * order they are discovered, the roots first. Each node is visited once even
+ * if it's shared.
+ *
+ * Layout, for n nodes and r roots:
+ *   a[0] = n, a[1] = r
+ *   then r root indices
+ *   then n tags, n ids
+ *   then n+1 child offsets and n+1 value offsets
+ *   then the children of all nodes, then the values of all nodes
+ * The children of node i are children[coff[i] ... coff[i+1]-1]:
+ *   tuple: the components
+ *   function: the default value then the mappings
+ *   mapping: the arguments then the value
+ * The values of node i are values[voff[i] ... voff[i+1]-1]:
+ *   bool: 0 or 1
+ *   rational: 1, num, den if the value fits in 64 bits, or 0, 0, 0 otherwise
+ *   algebraic: the raw bits of the double approximation
+ *   bitvector: the width, then the value in 64bit words (little endian)
+ *   scalar: the index and the type
+ *   function: the type (or -1 before Yices 2.6.2)
+ */
+struct yval_snapshot {
+  model_t *mdl;
+  std::vector<yval_t> nodes;
+  std::unordered_map<int64_t, int32_t> index;
+  std::vector<int32_t> child_off;
+  std::vector<int32_t> children;
+  std::vector<int32_t> value_off;
+  std::vector<int64_t> values;
+  std::vector<int32_t> bits;
+  yval_vector_t aux;
+
+  yval_snapshot(model_t *m): mdl(m) {
+    yices_init_yval_vector(&aux);
+  }
+
+  ~yval_snapshot() {
+    yices_delete_yval_vector(&aux);
+  }
+
+  // index of v: add it if it's new
+  int32_t add(const yval_t &v) {
+    int64_t key = (static_cast<int64_t>(v.node_tag) << 32) | static_cast<uint32_t>(v.node_id);
+    std::unordered_map<int64_t, int32_t>::iterator it = index.find(key);
+    if (it != index.end()) return it->second;
+    int32_t i = nodes.size();
+    nodes.push_back(v);
+    index[key] = i;
+    return i;
+  }
+
+  void add_children(uint32_t n, const yval_t *a) {
+    for (uint32_t k=0; k<n; k++) {
+      int32_t c = add(a[k]);
+      children.push_back(c);
+    }
+  }
 
-JNIEXPORT void JNICALL Java_com_sri_yices_Yices_printModel(JNIEnv *env, jclass, jint f, jlong model) {
-  // Figure out file descriptors later - for now, just print to stdout
-  yices_print_model(stdout, reinterpret_cast<model_t*>(model));
-}
+  // store the children and values of node i: return false if Yices fails
+  bool expand(int32_t i) {
+    yval_t v = nodes[i];
+    int32_t code = 0;
 
+    switch (v.node_tag) {
+    case YVAL_BOOL: {
+      int32_t b = 0;
+      code = yices_val_get_bool(mdl, &v, &b);
+      values.push_back(b);
+      break;
+    }
+    case YVAL_RATIONAL: {
+      int64_t num = 0;
+      uint64_t den = 0;
+      if (yices_val_get_rational64(mdl, &v, &num, &den) == 0 && den <= INT64_MAX) {
+        values.push_back(1);
+        values.push_back(num);
+        values.push_back(den);
+      } else {
+        // too large: the Java side gets the value with valGetRational
+        yices_clear_error();
+        values.push_back(0);
+        values.push_back(0);
+        values.push_back(0);
+      }
+      break;
+    }
+    case YVAL_ALGEBRAIC: {
+      double x = 0;
+      int64_t raw;
+      code = yices_val_get_double(mdl, &v, &x);
+      memcpy(&raw, &x, sizeof(raw));
+      values.push_back(raw);
+      break;
+    }
+    case YVAL_BV: {
+      uint32_t w = yices_val_bitsize(mdl, &v);
+      bits.resize(w > 0 ? w : 1);
+      code = yices_val_get_bv(mdl, &v, bits.data());
+      values.push_back(w);
+      size_t k = values.size();
+      values.resize(k + (w + 63)/64);
+      pack_bits(w, bits.data(), reinterpret_cast<uint64_t *>(values.data() + k));
+      break;
+    }
+    case YVAL_SCALAR: {
+      int32_t val = 0;
+      type_t tau = -1;
+      code = yices_val_get_scalar(mdl, &v, &val, &tau);
+      values.push_back(val);
+      values.push_back(tau);
+      break;
+    }
+    case YVAL_TUPLE: {
+      uint32_t n = yices_val_tuple_arity(mdl, &v);
+      std::vector<yval_t> a(n > 0 ? n : 1);
+      code = yices_val_expand_tuple(mdl, &v, a.data());
+      if (code >= 0) add_children(n, a.data());
+      break;
+    }
+    case YVAL_FUNCTION: {
+      yval_t def;
+      code = yices_val_expand_function(mdl, &v, &def, &aux);
+      if (code >= 0) {
+        add_children(1, &def);
+        add_children(aux.size, aux.data);
+      }
+#ifdef YICES_AT_LEAST_2_6_2
+      values.push_back(yices_val_function_type(mdl, &v));
+#else
+      values.push_back(-1);
 #endif
+      break;
+    }
+    case YVAL_MAPPING: {
+      uint32_t n = yices_val_mapping_arity(mdl, &v);
+      std::vector<yval_t> a(n + 1);
+      code = yices_val_expand_mapping(mdl, &v, a.data(), &a[n]);
+      if (code >= 0) add_children(n + 1, a.data());
+      break;
+    }
+    default:
+      break;
+    }
+
+    child_off.push_back(children.size());
+    value_off.push_back(values.size());
+    return code >= 0;
+  }
+};
+
+JNIEXPORT jlongArray JNICALL Java_com_sri_yices_Yices_valSnapshot(JNIEnv *env, jclass, jlong model, jintArray terms) {
+  TRACE_NATIVE();
+  jlongArray result = NULL;
+  jsize r = env->GetArrayLength(terms);
+  int32_t *t = scratch_copy(env, terms, r);
+  if (t == NULL) return NULL;
+
+  try {
+    yval_snapshot snap(reinterpret_cast<model_t*>(model));
+    std::vector<int32_t> roots(r);
+    bool ok = true;
+    for (jsize i=0; i<r && ok; i++) {
+      yval_t v;
+      ok = yices_get_value(snap.mdl, t[i], &v) == 0;
+      if (ok) roots[i] = snap.add(v);
+    }
+    snap.child_off.push_back(0);
+    snap.value_off.push_back(0);
+    // snap.nodes grows as we go
+    for (size_t i=0; i<snap.nodes.size() && ok; i++) {
+      ok = snap.expand(i);
+    }
+
+    if (ok) {
+      size_t n = snap.nodes.size();
+      size_t size = 2 + r + 2 * n + 2 * (n + 1) + snap.children.size() + snap.values.size();
+      if (size > static_cast<size_t>(INT32_MAX)) {
+        out_of_mem_exception(env);
+      } else {
+        std::vector<jlong> a;
+        a.reserve(size);
+        a.push_back(n);
+        a.push_back(r);
+        a.insert(a.end(), roots.begin(), roots.end());
+        for (size_t i=0; i<n; i++) a.push_back(snap.nodes[i].node_tag);
+        for (size_t i=0; i<n; i++) a.push_back(snap.nodes[i].node_id);
+        a.insert(a.end(), snap.child_off.begin(), snap.child_off.end());
+        a.insert(a.end(), snap.value_off.begin(), snap.value_off.end());
+        a.insert(a.end(), snap.children.begin(), snap.children.end());
+        a.insert(a.end(), snap.values.begin(), snap.values.end());
+        result = convertToLongArray(env, a.size(), a.data());
+      }
+    }
+  } catch (std::bad_alloc &ba) {
+    out_of_mem_exception(env);
+  }
+  scratch_free(t);
+  return result;
+}
+
+
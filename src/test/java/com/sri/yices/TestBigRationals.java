@@ -38,4 +38,41 @@ public class TestBigRationals {
         BigRational q2 = new BigRational(minus_one, ten.pow(25));
         Assert.assertEquals(q, q2);
     }
+
+    @Test
+    public void testLimbs() {
+        // small values: { num, den }
+        BigRational q = Yices.limbsToRational(new long[] { -7, 3 });
+        Assert.assertEquals(BigInteger.valueOf(-7), q.getNumerator());
+        Assert.assertEquals(BigInteger.valueOf(3), q.getDenominator());
+
+        // -2^64 / (2^63 + 1)
+        BigInteger two = BigInteger.valueOf(2);
+        q = Yices.limbsToRational(new long[] { -1, 2, 0, 1, Long.MIN_VALUE + 1 });
+        Assert.assertEquals(two.pow(64).negate(), q.getNumerator());
+        Assert.assertEquals(two.pow(63).add(BigInteger.ONE), q.getDenominator());
+
+        // 0 / 1 in the long format
+        q = Yices.limbsToRational(new long[] { 0, 0, 1 });
+        Assert.assertEquals(BigInteger.ZERO, q.getNumerator());
+        Assert.assertEquals(BigInteger.ONE, q.getDenominator());
+    }
+
+    @Test
+    public void testRationalConstants() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        BigInteger big = BigInteger.TEN.pow(40).add(BigInteger.ONE);
+        BigRational[] values = {
+            new BigRational("-1/3"),
+            new BigRational(BigInteger.valueOf(Long.MIN_VALUE), BigInteger.ONE),
+            new BigRational(BigInteger.valueOf(Long.MAX_VALUE), BigInteger.valueOf(Long.MAX_VALUE - 1)),
+            new BigRational(big.negate(), BigInteger.valueOf(7)),
+            new BigRational(BigInteger.valueOf(5), big),
+        };
+        for (BigRational v : values) {
+            int t = Terms.rationalConst(v);
+            Assert.assertEquals(v, Terms.arithConstValue(t));
+        }
+    }
 }
@@ -1,5 +1,8 @@
 package com.sri.yices;
 
+import java.time.Duration;
+import java.util.HashSet;
+
 import org.junit.Assert;
 import org.junit.Test;
 
@@ -169,4 +172,376 @@ public class TestContext {
         bitvectorFactor(1009, 32);
         bitvectorFactor(817147, 100);
     }
+
+    @Test
+    public void testContextPool() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int x = Terms.newUninterpretedTerm(Types.INT);
+        long census = Context.getCensus();
+        try (ContextPool pool = new ContextPool(2)) {
+            pool.prefill("QF_LIA", 1);
+            Assert.assertEquals(1, pool.idleCount("QF_LIA"));
+
+            Context first;
+            try (Context c = pool.acquire("QF_LIA")) {
+                first = c;
+                Assert.assertEquals(0, pool.idleCount("QF_LIA"));
+                c.assertFormula(Terms.arithGt(x, Terms.intConst(3)));
+                c.assertFormula(Terms.arithLt(x, Terms.intConst(2)));
+                Assert.assertEquals(Status.UNSAT, c.check(pool.parameters("QF_LIA")));
+            }
+            Assert.assertEquals(1, pool.idleCount("QF_LIA"));
+
+            // we get the same Yices context back, reset, in a new lease
+            try (Context c = pool.acquire("QF_LIA")) {
+                Assert.assertNotSame(first, c);
+                Assert.assertEquals(0, first.getPtr());
+                Assert.assertEquals(Status.IDLE, c.getStatus());
+                // closing the old lease again doesn't affect the new holder
+                first.close();
+                Assert.assertEquals(0, pool.idleCount("QF_LIA"));
+                c.assertFormula(Terms.arithGt(x, Terms.intConst(3)));
+                Assert.assertEquals(Status.SAT, c.check());
+            }
+
+            // the pool keeps at most two idle contexts per logic
+            Context c1 = pool.acquire("QF_LIA");
+            Context c2 = pool.acquire("QF_LIA");
+            Context c3 = pool.acquire("QF_LIA");
+            c1.close();
+            c2.close();
+            c3.close();
+            c3.close();
+            Assert.assertEquals(2, pool.idleCount("QF_LIA"));
+            Assert.assertEquals(census + 2, Context.getCensus());
+            Assert.assertSame(pool.config("QF_LIA"), pool.config("QF_LIA"));
+        }
+        Assert.assertEquals(census, Context.getCensus());
+    }
+
+    @Test
+    public void testCensus() throws Exception {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        // concurrent updates
+        long configs = Config.getCensus();
+        long params = Parameters.getCensus();
+        Thread[] threads = new Thread[4];
+        for (int i = 0; i < threads.length; i++) {
+            threads[i] = new Thread(() -> {
+                for (int k = 0; k < 1000; k++) {
+                    try (Config c = new Config(); Parameters p = new Parameters()) {
+                        c.set("mode", "one-shot");
+                    }
+                }
+            });
+            threads[i].start();
+        }
+        for (Thread t : threads) t.join();
+        Assert.assertEquals(configs, Config.getCensus());
+        Assert.assertEquals(params, Parameters.getCensus());
+
+        // a context that's never closed is freed by the Cleaner
+        long census = Context.getCensus();
+        long leaks = Context.getLeakCount();
+        new Context();
+        Assert.assertEquals(census + 1, Context.getCensus());
+        for (int i = 0; i < 50 && Context.getLeakCount() == leaks; i++) {
+            System.gc();
+            Thread.sleep(20);
+        }
+        // System.gc() is only a hint
+        assumeTrue(Context.getLeakCount() > leaks);
+        // the Cleaner thread may still be freeing it
+        for (int i = 0; i < 50 && Context.getCensus() != census; i++) {
+            NativeRef.drain();
+            Thread.sleep(20);
+        }
+        Assert.assertEquals(census, Context.getCensus());
+
+        long heap = Yices.nativeHeapUsage();
+        Assert.assertTrue(heap == -1 || heap > 0);
+    }
+
+    @Test
+    public void testEnumerateModels() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int a = Terms.newUninterpretedTerm(Types.BOOL);
+        int b = Terms.newUninterpretedTerm(Types.BOOL);
+        int c = Terms.newUninterpretedTerm(Types.BOOL);
+        int x = Terms.newUninterpretedTerm(Types.bvType(4));
+
+        try (Context ctx = new Context()) {
+            ctx.assertFormula(Terms.or(a, b, c));
+            ctx.assertFormula(Terms.bvLt(x, Terms.bvConst(4, 5)));
+
+            // projection on a and b: three models
+            ctx.push();
+            ModelEnumeration e = ctx.enumerateModels(null, new int[] { a, b }, 10, null);
+            Assert.assertEquals(Status.UNSAT, e.status());
+            Assert.assertEquals(3, e.count());
+            HashSet<String> seen = new HashSet<>();
+            for (int i = 0; i < e.count(); i++) {
+                ModelValues v = e.values(i);
+                Assert.assertTrue(v.boolValue(0) || v.boolValue(1));
+                Assert.assertTrue(seen.add(v.boolValue(0) + " " + v.boolValue(1)));
+                Assert.assertEquals(2, e.valueTerms(i).length);
+            }
+            ctx.pop();
+
+            // bitvectors: 5 values, stop after 3
+            ctx.push();
+            e = ctx.enumerateModels(null, new int[] { x }, 3, Duration.ofMinutes(1));
+            Assert.assertEquals(Status.SAT, e.status());
+            Assert.assertEquals(3, e.count());
+            // the arrays have one row per model; a huge budget means no deadline
+            e = ctx.enumerateModels(null, new int[] { x }, 1000, Duration.ofNanos(Long.MAX_VALUE));
+            Assert.assertEquals(Status.UNSAT, e.status());
+            Assert.assertEquals(2, e.count());
+            Assert.assertEquals(2, e.rawValues().length);
+            Assert.assertEquals(2 * e.wordsPerModel(), e.rawBits().length);
+            ctx.pop();
+
+            // whole models: 7 assignments of a, b, c times 5 values of x
+            ctx.push();
+            e = ctx.enumerateModels(null, new int[0], 100, null);
+            Assert.assertEquals(Status.UNSAT, e.status());
+            Assert.assertEquals(35, e.count());
+            ctx.pop();
+        }
+    }
+
+    @Test
+    public void testAssumptionBatch() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int a = Terms.newUninterpretedTerm(Types.BOOL);
+        int b = Terms.newUninterpretedTerm(Types.BOOL);
+        int x = Terms.newUninterpretedTerm(Types.INT);
+
+        try (Context ctx = new Context()) {
+            ctx.assertFormula(Terms.implies(a, Terms.arithGt(x, Terms.intConst(0))));
+            ctx.assertFormula(Terms.implies(b, Terms.arithLt(x, Terms.intConst(0))));
+
+            int[][] sets = { { a }, { a, b }, { b }, { } };
+            AssumptionBatch r = ctx.checkWithAssumptionsBatch(null, sets, new int[] { x }, null);
+            Assert.assertEquals(4, r.size());
+            Assert.assertEquals(4, r.processed());
+            Assert.assertEquals(Status.SAT, r.status(0));
+            Assert.assertEquals(Status.UNSAT, r.status(1));
+            Assert.assertEquals(Status.SAT, r.status(2));
+            Assert.assertEquals(Status.SAT, r.status(3));
+            Assert.assertEquals(3, r.count(Status.SAT));
+            Assert.assertNull(r.core(0));
+            Assert.assertEquals(2, r.core(1).length);
+            Assert.assertNull(r.values(1));
+
+            Assert.assertEquals(1, r.values(0).length);
+            Assert.assertTrue(Terms.isArithConstant(r.values(0)[0]));
+            Assert.assertTrue(Terms.isArithConstant(r.values(2)[0]));
+            Assert.assertNotEquals(r.values(0)[0], r.values(2)[0]);
+
+            // a huge budget is the same as no limit
+            r = ctx.checkWithAssumptionsBatch(null, sets, null, Duration.ofNanos(Long.MAX_VALUE));
+            Assert.assertEquals(4, r.processed());
+            Assert.assertEquals(Status.UNSAT, r.status(1));
+
+            // invalid offsets
+            try {
+                ctx.checkWithAssumptionsBatch(null, new int[] { 0, 3 }, new int[] { a }, null, null);
+                Assert.fail("expected an exception");
+            } catch (IllegalArgumentException e) {
+            }
+        }
+    }
+
+    @Test
+    public void testPortfolio() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int x = Terms.newUninterpretedTerm(Types.INT);
+        int y = Terms.newUninterpretedTerm(Types.INT);
+        try (Portfolio portfolio = new Portfolio();
+             Parameters p1 = new Parameters();
+             Parameters p2 = new Parameters()) {
+            p1.setParam("random-seed", "1");
+            p2.setParam("random-seed", "2");
+            try (Config cfg = new Config("QF_LIA")) {
+                portfolio.add(cfg, p1);
+                portfolio.add(cfg, p2);
+            }
+            portfolio.add("QF_LIA", null);
+            Assert.assertEquals(3, portfolio.size());
+
+            portfolio.assertFormula(Terms.arithGt(x, Terms.add(y, Terms.intConst(3))));
+            portfolio.push();
+            portfolio.assertFormula(Terms.arithLt(x, y));
+            Assert.assertEquals(Status.UNSAT, portfolio.check());
+            Assert.assertTrue(portfolio.winner() >= 0);
+            portfolio.pop();
+
+            Assert.assertEquals(Status.SAT, portfolio.check());
+            try (Model m = portfolio.getModel()) {
+                Assert.assertTrue(m.integerValue(x) > m.integerValue(y) + 3);
+            }
+        }
+    }
+
+    @Test
+    public void testTimeouts() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int tau = Types.bvType(128);
+        int a = Terms.newUninterpretedTerm(tau);
+        int b = Terms.newUninterpretedTerm(tau);
+        // product of two 32-bit primes
+        int p = Terms.bvMul(Terms.bvConst(128, 4294967291L), Terms.bvConst(128, 4294967279L));
+        try (Context c = new Context("QF_BV")) {
+            c.assertFormula(Terms.bvEq(p, Terms.bvMul(a, b)));
+            c.assertFormula(Terms.bvGt(a, Terms.bvOne(128)));
+            c.assertFormula(Terms.bvGe(b, a));
+            c.assertFormula(Terms.bvLt(b, p));
+
+            long start = System.nanoTime();
+            Status stat = c.check(50, java.util.concurrent.TimeUnit.MILLISECONDS);
+            long elapsed = System.nanoTime() - start;
+            System.out.println("Status after 50ms: " + stat + " (" + elapsed/1000000 + "ms)");
+            if (stat == Status.INTERRUPTED) {
+                Assert.assertTrue(elapsed < 5000000000L);
+            }
+        }
+
+        // a deadline that expires after the check returned must not affect later checks
+        int x = Terms.newUninterpretedTerm(Types.INT);
+        try (Context c = new Context("QF_LIA")) {
+            c.assertFormula(Terms.arithGt(x, Terms.intConst(0)));
+            for (int i = 0; i < 100; i++) {
+                Status stat = c.check(java.time.Duration.ofNanos(1000 * i));
+                Assert.assertTrue(stat == Status.SAT || stat == Status.INTERRUPTED);
+                Assert.assertEquals(Status.SAT, c.check());
+            }
+        }
+    }
+
+    @Test
+    public void testCheckAsync() throws Exception {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int x = Terms.newUninterpretedTerm(Types.INT);
+        try (Context c = new Context("QF_LIA")) {
+            c.assertFormula(Terms.arithGt(x, Terms.intConst(7)));
+            java.util.concurrent.CompletableFuture<Status> f = c.checkAsync();
+            Assert.assertEquals(Status.SAT, f.get());
+            try (Model m = c.getModel()) {
+                Assert.assertTrue(m.integerValue(x) > 7);
+            }
+            int[] assumptions = { Terms.arithLt(x, Terms.intConst(0)) };
+            Assert.assertEquals(Status.UNSAT, c.checkWithAssumptionsAsync(null, assumptions).get());
+            Assert.assertArrayEquals(assumptions, c.getUnsatCore());
+
+            // lazy model and core
+            CheckFuture g = c.checkAsync();
+            Assert.assertEquals(Status.SAT, g.get());
+            Assert.assertNull(g.unsatCore());
+            try (Model m = g.model()) {
+                Assert.assertSame(m, g.model());
+                Assert.assertTrue(m.integerValue(x) > 7);
+            }
+            g = c.checkWithAssumptionsAsync(null, assumptions);
+            Assert.assertEquals(Status.UNSAT, g.get());
+            Assert.assertNull(g.model());
+            Assert.assertArrayEquals(assumptions, g.unsatCore());
+        }
+
+        // cancellation stops the search
+        int tau = Types.bvType(128);
+        int a = Terms.newUninterpretedTerm(tau);
+        int b = Terms.newUninterpretedTerm(tau);
+        int p = Terms.bvMul(Terms.bvConst(128, 4294967291L), Terms.bvConst(128, 4294967279L));
+        try (Context c = new Context("QF_BV")) {
+            c.assertFormula(Terms.bvEq(p, Terms.bvMul(a, b)));
+            c.assertFormula(Terms.bvGt(a, Terms.bvOne(128)));
+            c.assertFormula(Terms.bvGe(b, a));
+            c.assertFormula(Terms.bvLt(b, p));
+            java.util.concurrent.ExecutorService executor = java.util.concurrent.Executors.newSingleThreadExecutor();
+            java.util.concurrent.CompletableFuture<Status> f = c.checkAsync(null, executor);
+            Thread.sleep(50);
+            f.cancel(true);
+            Assert.assertTrue(f.isCancelled());
+            // the check must return soon after the cancellation
+            executor.shutdown();
+            Assert.assertTrue(executor.awaitTermination(10, java.util.concurrent.TimeUnit.SECONDS));
+            Assert.assertNotEquals(Status.SEARCHING, c.getStatus());
+        }
+
+        // close waits for a cancelled check to return
+        Context c = new Context("QF_BV");
+        c.assertFormula(Terms.bvEq(p, Terms.bvMul(a, b)));
+        c.assertFormula(Terms.bvGt(a, Terms.bvOne(128)));
+        c.assertFormula(Terms.bvGe(b, a));
+        c.assertFormula(Terms.bvLt(b, p));
+        java.util.concurrent.CompletableFuture<Status> f = c.checkAsync();
+        Thread.sleep(50);
+        f.cancel(true);
+        c.close();
+        Assert.assertTrue(f.isCancelled());
+    }
+
+    @Test
+    public void testQueryCache() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int x = Terms.newUninterpretedTerm(Types.INT);
+        int pos = Terms.arithGt(x, Terms.ZERO);
+        int small = Terms.arithLt(x, Terms.intConst(3));
+        int neg = Terms.arithLt(x, Terms.ZERO);
+
+        QueryCache cache = new QueryCache(1 << 20);
+        QueryCache.Result r = cache.check("QF_LIA", new int[] { pos, small });
+        Assert.assertEquals(Status.SAT, r.status());
+        Assert.assertFalse(r.isCached());
+
+        // same set of formulas in another order
+        r = cache.check("QF_LIA", new int[] { small, pos, small });
+        Assert.assertEquals(Status.SAT, r.status());
+        Assert.assertTrue(r.isCached());
+        Assert.assertNull(r.model());
+
+        // the first request for a model is a miss, the next one is a hit
+        r = cache.check("QF_LIA", new int[] { pos, small }, true, false, null);
+        Assert.assertFalse(r.isCached());
+        r.model().close();
+        r = cache.check("QF_LIA", new int[] { pos, small }, true, false, null);
+        Assert.assertTrue(r.isCached());
+        try (Model m = r.model()) {
+            long v = m.integerValue(x);
+            Assert.assertTrue(v > 0 && v < 3);
+        }
+
+        r = cache.check("QF_LIA", new int[] { pos, neg, small }, false, true, Duration.ofSeconds(10));
+        Assert.assertEquals(Status.UNSAT, r.status());
+        int[] core = r.core();
+        Assert.assertTrue(core.length >= 2);
+        r = cache.check("QF_LIA", new int[] { neg, small, pos }, false, true, null);
+        Assert.assertTrue(r.isCached());
+        Assert.assertArrayEquals(core, r.core());
+
+        Assert.assertEquals(3, cache.hits());
+        Assert.assertEquals(3, cache.misses());
+        Assert.assertEquals(2, cache.size());
+        Assert.assertTrue(cache.bytes() > 0);
+
+        // eviction
+        QueryCache tiny = new QueryCache(1);
+        tiny.check("QF_LIA", new int[] { pos });
+        Assert.assertEquals(0, tiny.size());
+        Assert.assertEquals(1, tiny.evictions());
+
+        // invalidation
+        Yices.yicesGarbageCollect(new int[] { pos, small, neg }, null, false);
+        Assert.assertEquals(0, cache.size());
+        Assert.assertFalse(cache.check("QF_LIA", new int[] { pos, small }).isCached());
+    }
 }
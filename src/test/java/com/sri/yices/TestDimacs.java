@@ -1,5 +1,11 @@
 package com.sri.yices;
 
+import java.io.ByteArrayOutputStream;
+import java.io.File;
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+
 import org.junit.Assert;
 import org.junit.Test;
 
@@ -78,4 +84,82 @@ public class TestDimacs {
          }
     }
 
+    @Test
+    public void testDimacsStream() throws Exception {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+        assumeTrue(Yices.versionOrdinal() >= Yices.versionOrdinal(2, 6, 2));
+
+        int tau = Types.bvType(12);
+        int x = Terms.newUninterpretedTerm(tau);
+        int y = Terms.newUninterpretedTerm(tau);
+        int[] formulas = { Terms.bvEq(Terms.bvMul(x, y), Terms.bvConst(12, 1537)),
+                           Terms.bvGt(x, Terms.bvConst(12, 1)), Terms.bvGt(y, Terms.bvConst(12, 1)) };
+
+        // same CNF as the file export
+        File file = File.createTempFile("yices", ".cnf");
+        file.deleteOnExit();
+        Status[] status = new Status[1];
+        Assert.assertTrue(Dimacs.export(formulas, file.getPath(), false, status));
+        byte[] expected = Files.readAllBytes(file.toPath());
+
+        Status[] status2 = new Status[1];
+        try (DimacsBuffer cnf = Dimacs.exportToBuffer(formulas, false, status2)) {
+            Assert.assertNotNull(cnf);
+            Assert.assertEquals(status[0], status2[0]);
+            Assert.assertEquals(expected.length, cnf.size());
+
+            ByteBuffer copy = ByteBuffer.allocateDirect(cnf.size());
+            cnf.copyTo(copy);
+            copy.flip();
+            Assert.assertEquals(ByteBuffer.wrap(expected), copy);
+
+            ByteArrayOutputStream text = new ByteArrayOutputStream();
+            cnf.writeTo(text);
+            Assert.assertArrayEquals(expected, text.toByteArray());
+
+            // binary format: header and number of clauses
+            ByteArrayOutputStream bin = new ByteArrayOutputStream();
+            cnf.writeBinaryTo(bin);
+            byte[] b = bin.toByteArray();
+            Assert.assertEquals("ycnf", new String(b, 0, 4, StandardCharsets.US_ASCII));
+            long[] pos = { 4 };
+            long vars = readVarint(b, pos);
+            long clauses = readVarint(b, pos);
+            long count = 0;
+            while (pos[0] < b.length) {
+                long lit = readVarint(b, pos);
+                Assert.assertTrue(lit / 2 <= vars);
+                if (lit == 0) count ++;
+            }
+            Assert.assertEquals(clauses, count);
+            Assert.assertTrue(b.length < expected.length);
+        }
+
+        // buffer() is a copy: still readable after close
+        DimacsBuffer cnf = Dimacs.exportToBuffer(formulas, false, status2);
+        ByteBuffer text = cnf.buffer();
+        cnf.close();
+        Assert.assertEquals(ByteBuffer.wrap(expected), text);
+        try {
+            cnf.buffer();
+            Assert.fail("closed buffer");
+        } catch (IllegalStateException e) {
+            // expected
+        }
+
+        // trivial formula: no CNF
+        Assert.assertNull(Dimacs.exportToBuffer(Terms.FALSE, false, status));
+        Assert.assertEquals(Status.UNSAT, status[0]);
+    }
+
+    private static long readVarint(byte[] b, long[] pos) {
+        long x = 0;
+        int shift = 0;
+        while (true) {
+            int c = b[(int) pos[0]++] & 0xFF;
+            x |= ((long) (c & 0x7F)) << shift;
+            if (c < 0x80) return x;
+            shift += 7;
+        }
+    }
 }
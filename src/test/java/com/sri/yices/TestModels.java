@@ -1,5 +1,7 @@
 package com.sri.yices;
 
+import java.nio.ByteBuffer;
+
 import org.junit.Assert;
 import org.junit.Test;
 
@@ -33,6 +35,56 @@ public class TestModels {
         }
     }
 
+    @Test
+    public void testPrintToBuffer() throws Exception {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int x = Terms.newUninterpretedTerm("print_x", Types.INT);
+        int y = Terms.newUninterpretedTerm("print_y", Types.INT);
+        int f = Terms.arithGt(x, Terms.add(y, Terms.intConst(1000)));
+        try (Context c = new Context()) {
+            c.assertFormula(f);
+            Assert.assertEquals(Status.SAT, c.check());
+            try (Model m = c.getModel()) {
+                String expected = m.toString().trim();
+
+                java.io.ByteArrayOutputStream out = new java.io.ByteArrayOutputStream();
+                m.writeTo(out);
+                Assert.assertEquals(expected, out.toString("UTF-8").trim());
+
+                StringBuilder sb = new StringBuilder();
+                m.appendTo(sb);
+                Assert.assertEquals(expected, sb.toString().trim());
+
+                // too small: nothing is copied
+                ByteBuffer small = ByteBuffer.allocateDirect(2);
+                int n = m.toBuffer(small);
+                Assert.assertTrue(n > 2);
+                Assert.assertEquals(0, small.position());
+
+                for (ByteBuffer b : new ByteBuffer[] { ByteBuffer.allocateDirect(n), ByteBuffer.allocate(n + 10) }) {
+                    Assert.assertEquals(n, m.toBuffer(b));
+                    Assert.assertEquals(n, b.position());
+                    b.flip();
+                    byte[] bytes = new byte[b.remaining()];
+                    b.get(bytes);
+                    Assert.assertEquals(expected, new String(bytes, "UTF-8").trim());
+                }
+            }
+        }
+
+        ByteBuffer b = ByteBuffer.allocateDirect(1000);
+        int n = Terms.toBuffer(f, 80, 30, b);
+        byte[] bytes = new byte[n];
+        b.flip();
+        b.get(bytes);
+        Assert.assertEquals(Terms.toString(f).trim(), new String(bytes, "UTF-8").trim());
+
+        StringBuilder sb = new StringBuilder();
+        Terms.appendTo(f, 80, 30, sb);
+        Assert.assertEquals(Terms.toString(f).trim(), sb.toString().trim());
+    }
+
     @Test
     public void testTuple() {
         int tau = Types.tupleType(Types.BOOL, Types.REAL, Types.INT);
@@ -163,6 +215,62 @@ public class TestModels {
     }
 
 
+    @Test
+    public void testValueSnapshot() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int tau = Types.functionType(Types.INT, Types.BOOL, Types.bvType(70));
+        int f = Terms.newUninterpretedTerm(tau);
+        int i = Terms.newUninterpretedTerm(Types.INT);
+        int b = Terms.newUninterpretedTerm(Types.BOOL);
+        int x = Terms.newUninterpretedTerm(Types.REAL);
+
+        try (Context c = new Context()) {
+            c.assertFormula(Terms.neq(Terms.funApplication(f, i, b), Terms.funApplication(f, Terms.add(i, Terms.ONE), b)));
+            c.assertFormula(Terms.eq(Terms.mul(Terms.intConst(3), x), Terms.ONE));
+            Assert.assertEquals(Status.SAT, c.check());
+            try (Model m = c.getModel()) {
+                ValueSnapshot snap = m.snapshot(f, x);
+                Assert.assertEquals(2, snap.numRoots());
+
+                // same DAG as with expandFunction/expandMapping
+                ValueSnapshot.Node fn = snap.root(0);
+                YVal yf = m.getValue(f);
+                Assert.assertEquals(yf.tag, fn.tag());
+                Assert.assertEquals(yf.id, fn.id());
+                Assert.assertEquals(tau, fn.functionType());
+                VectorValue expanded = m.expandFunction(yf);
+                Assert.assertEquals(expanded.vector.length, fn.numMappings());
+                Assert.assertEquals(expanded.value.id, fn.defaultValue().id());
+                assertSameBits(m.bvValue(expanded.value), fn.defaultValue());
+                for (int k = 0; k < fn.numMappings(); k++) {
+                    ValueSnapshot.Node map = fn.mapping(k);
+                    VectorValue mv = m.expandMapping(expanded.vector[k]);
+                    Assert.assertEquals(2, map.mappingArity());
+                    Assert.assertEquals(m.integerValue(mv.vector[0]), map.mappingArg(0).numerator());
+                    Assert.assertEquals(m.boolValue(mv.vector[1]), map.mappingArg(1).boolValue());
+                    Assert.assertEquals(70, map.mappingValue().bvWidth());
+                    assertSameBits(m.bvValue(mv.value), map.mappingValue());
+                }
+
+                ValueSnapshot.Node r = snap.root(1);
+                Assert.assertEquals(1, r.numerator());
+                Assert.assertEquals(3, r.denominator());
+                Assert.assertEquals(m.bigRationalValue(x), r.bigRationalValue());
+
+                // cached
+                Assert.assertSame(m.valueTree(f), m.valueTree(f));
+            }
+        }
+    }
+
+    private static void assertSameBits(boolean[] bits, ValueSnapshot.Node node) {
+        Assert.assertEquals(bits.length, node.bvWidth());
+        for (int j = 0; j < bits.length; j++) {
+            Assert.assertEquals(bits[j], node.bvBit(j));
+        }
+    }
+
     @Test
     public void testImplicant() {
         int i = Terms.newUninterpretedTerm("i", Types.INT);
@@ -207,6 +315,156 @@ public class TestModels {
         }
     }
 
+    @Test
+    public void testBulkValues() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int scalar = Types.newScalarType(5);
+        int p = Terms.newUninterpretedTerm(Types.BOOL);
+        int i = Terms.newUninterpretedTerm(Types.INT);
+        int r = Terms.newUninterpretedTerm(Types.REAL);
+        int u = Terms.newUninterpretedTerm(Types.bvType(8));
+        int v = Terms.newUninterpretedTerm(Types.bvType(100));
+        int s = Terms.newUninterpretedTerm(scalar);
+        int t = Terms.newUninterpretedTerm(Types.tupleType(Types.BOOL, Types.INT));
+        int big = Terms.parse("123456789012345678901234567890");
+        int[] vars = {p, i, r, u, v, s, t};
+        int[] vals = {Terms.mkTrue(), Terms.intConst(-1L << 40), Terms.rationalConst(1, 3),
+                      Terms.bvConst(8, 0xa5),
+                      Terms.bvConcat(Terms.bvConst(36, 0x987654321L), Terms.bvConst(64, 0x0123456789abcdefL)),
+                      Terms.mkConst(scalar, 3), Terms.tuple(Terms.mkFalse(), Terms.intConst(2))};
+        try (Model m = new Model(vars, vals)) {
+            int[] terms = {p, i, r, u, v, s, t, Terms.add(i, big), Terms.not(p)};
+            ModelValues values = m.values(terms);
+            Assert.assertEquals(terms.length, values.size());
+            Assert.assertTrue(values.boolValue(0));
+            Assert.assertEquals(-1L << 40, values.integerValue(1));
+            Assert.assertEquals(ModelValues.OVERFLOW, values.kind(2));
+            Assert.assertEquals(8, values.bvWidth(3));
+            Assert.assertEquals(0xa5, values.bvLong(3));
+            Assert.assertEquals(100, values.bvWidth(4));
+            Assert.assertArrayEquals(new long[] {0x0123456789abcdefL, 0x987654321L}, values.bvWords(4));
+            Assert.assertTrue(values.bvBit(4, 99));
+            Assert.assertFalse(values.bvBit(4, 98));
+            Assert.assertEquals(3, values.scalarValue(5));
+            Assert.assertEquals(ModelValues.OTHER, values.kind(6));
+            Assert.assertEquals(ModelValues.OVERFLOW, values.kind(7));
+            Assert.assertFalse(values.boolValue(8));
+
+            // must agree with the one-term-at-a-time API
+            boolean[] bits = m.bvValue(v);
+            for (int k = 0; k < bits.length; k++) {
+                Assert.assertEquals(bits[k], values.bvBit(4, k));
+            }
+            Assert.assertEquals(m.bigIntegerValue(terms[7]), m.bigRationalValue(terms[7]).getNumerator());
+        }
+    }
+
+    @Test
+    public void testPackedBitvectors() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        long[] w = {0x0123456789abcdefL, -1L, 0x5L};
+        boolean[] bits = new boolean[130];
+        for (int i = 0; i < bits.length; i++) {
+            bits[i] = ((w[i >>> 6] >>> (i & 63)) & 1) != 0;
+        }
+        int c = Terms.bvConstFromWords(130, w);
+        Assert.assertEquals(Terms.bvConst(bits), c);
+        Assert.assertEquals(Terms.bvConst(16, 0xcdef), Terms.bvConstFromWords(16, w));
+
+        ByteBuffer heap = ByteBuffer.allocate(17);
+        ByteBuffer direct = ByteBuffer.allocateDirect(17);
+        for (int i = 0; i < 17; i++) {
+            byte x = (byte) (w[i >>> 3] >>> (8 * (i & 7)));
+            heap.put(i, x);
+            direct.put(i, x);
+        }
+        Assert.assertEquals(c, Terms.bvConstFromBytes(130, heap));
+        Assert.assertEquals(c, Terms.bvConstFromBytes(130, direct));
+
+        int u = Terms.newUninterpretedTerm(Types.bvType(130));
+        try (Model m = new Model(new int[] {u}, new int[] {c})) {
+            Assert.assertArrayEquals(new long[] {w[0], w[1], 1L}, m.bvValueWords(u));
+            ByteBuffer b = ByteBuffer.allocateDirect(17);
+            Assert.assertEquals(17, m.bvValueBytes(u, b));
+            Assert.assertEquals(direct.get(0), b.get(0));
+            Assert.assertEquals(1, b.get(16));
+            ByteBuffer h = ByteBuffer.allocate(17);
+            Assert.assertEquals(17, m.bvValueBytes(u, h));
+            Assert.assertEquals(b, h);
+        }
+
+        if (Yices.versionOrdinal() >= Yices.versionOrdinal(2, 6, 4)) {
+            try (Model m = new Model()) {
+                m.setBVFromWords(u, w);
+                Assert.assertArrayEquals(new long[] {w[0], w[1], 1L}, m.bvValueWords(u));
+                int v = Terms.newUninterpretedTerm(Types.bvType(12));
+                m.setBVFromBytes(v, direct);
+                Assert.assertArrayEquals(new long[] {0xdefL}, m.bvValueWords(v));
+            }
+        }
+    }
+
+    @Test
+    public void testBulkSetters() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+        assumeTrue(Yices.versionOrdinal() >= Yices.versionOrdinal(2, 6, 4));
+
+        int[] p = { Terms.newUninterpretedTerm(Types.BOOL), Terms.newUninterpretedTerm(Types.BOOL) };
+        int[] x = { Terms.newUninterpretedTerm(Types.INT), Terms.newUninterpretedTerm(Types.INT) };
+        int[] r = { Terms.newUninterpretedTerm(Types.REAL), Terms.newUninterpretedTerm(Types.REAL) };
+        int[] b = { Terms.newUninterpretedTerm(Types.bvType(8)), Terms.newUninterpretedTerm(Types.bvType(100)),
+                    Terms.newUninterpretedTerm(Types.bvType(64)) };
+
+        try (Model m = new Model()) {
+            m.setBooleans(p, new boolean[] { true, false });
+            m.setIntegers(x, new long[] { -3, 1L << 40 });
+            m.setRationals(r, new long[] { 1, 3, -7, 2 });
+            m.setBVWords(b, new long[] { 0x1ff, -1L, 0xfL, 0x8000000000000000L });
+            Assert.assertTrue(m.boolValue(p[0]));
+            Assert.assertFalse(m.boolValue(p[1]));
+            Assert.assertEquals(-3, m.integerValue(x[0]));
+            Assert.assertEquals(1L << 40, m.integerValue(x[1]));
+            long[] q = new long[2];
+            m.rationalValue(r[1], q);
+            Assert.assertArrayEquals(new long[] { -7, 2 }, q);
+            Assert.assertArrayEquals(new long[] { 0xff }, m.bvValueWords(b[0]));
+            Assert.assertArrayEquals(new long[] { -1L, 0xfL }, m.bvValueWords(b[1]));
+            Assert.assertArrayEquals(new long[] { 0x8000000000000000L }, m.bvValueWords(b[2]));
+        }
+
+        try (Model m = new Model()) {
+            int[] c = { b[0], b[2] };
+            m.setBVIntegers(c, new long[] { 7, -2 });
+            Assert.assertArrayEquals(new long[] { 7 }, m.bvValueWords(b[0]));
+            Assert.assertArrayEquals(new long[] { -2 }, m.bvValueWords(b[2]));
+
+            // not enough words: nothing is assigned
+            try {
+                m.setBVWords(new int[] { b[1] }, new long[] { 1 });
+                Assert.fail();
+            } catch (IllegalArgumentException e) {
+            }
+
+            // not a bitvector: the previous variables are assigned
+            try {
+                m.setBVWords(new int[] { b[1], x[0] }, new long[] { 9, 1 });
+                Assert.fail();
+            } catch (IllegalArgumentException e) {
+            }
+            Assert.assertArrayEquals(new long[] { 9, 1 }, m.bvValueWords(b[1]));
+
+            // type error on the second variable: the first one is assigned
+            try {
+                m.setIntegers(new int[] { x[0], p[0] }, new long[] { 5, 6 });
+                Assert.fail();
+            } catch (YicesException e) {
+            }
+            Assert.assertEquals(5, m.integerValue(x[0]));
+        }
+    }
+
     @Test
     public void testModelSupport() {
         assumeTrue(Yices.versionOrdinal() >= Yices.versionOrdinal(2, 6, 2));
@@ -238,6 +496,64 @@ public class TestModels {
         }
     }
 
+    @Test
+    public void testModelBatch() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+        assumeTrue(Yices.versionOrdinal() >= Yices.versionOrdinal(2, 6, 2));
+        int x = Terms.newUninterpretedTerm("bx", Types.INT);
+        int y = Terms.newUninterpretedTerm("by", Types.REAL);
+        int f = Terms.parse("(and (> bx 0) (< bx 10) (> by bx))");
+        Model[] models = new Model[5];
+        try (Context c = new Context()) {
+            c.assertFormula(f);
+            for (int i = 0; i < models.length; i++) {
+                Assert.assertEquals(Status.SAT, c.check());
+                models[i] = c.getModel();
+                c.assertFormula(Terms.neq(x, Terms.intConst(models[i].integerValue(x))));
+            }
+        }
+        try {
+            int[] terms = { f };
+            for (boolean parallel : new boolean[] { false, true }) {
+                ModelBatch b = Model.implicantBatch(models, terms, parallel);
+                Assert.assertEquals(models.length, b.size());
+                Assert.assertEquals(0, b.failures());
+                for (int i = 0; i < models.length; i++) {
+                    Assert.assertArrayEquals(models[i].implicant(terms), b.cube(i));
+                    Assert.assertEquals(b.cube(i).length, b.end(i) - b.start(i));
+                }
+
+                b = Model.generalizeBatch(models, terms, new int[] { y }, GeneralizationMode.GEN_DEFAULT, parallel);
+                Assert.assertEquals(0, b.failures());
+                for (int i = 0; i < models.length; i++) {
+                    // y is eliminated
+                    Assert.assertTrue(b.cube(i).length > 0);
+                    for (int lit : b.cube(i)) {
+                        Assert.assertEquals(Terms.toString(lit).indexOf("by"), -1);
+                    }
+                }
+
+                b = Model.supportBatch(models, terms, parallel);
+                for (int i = 0; i < models.length; i++) {
+                    Assert.assertArrayEquals(models[i].support(terms), b.cube(i));
+                }
+            }
+
+            // the implicant fails if the formula is false in the model
+            int g = Terms.parse("(= bx 1)");
+            ModelBatch b = Model.implicantBatch(models, new int[] { g }, true);
+            int falseIn = 0;
+            for (Model m : models) {
+                if (!m.boolValue(g)) falseIn++;
+            }
+            Assert.assertEquals(falseIn, b.failures());
+        } finally {
+            for (Model m : models) {
+                if (m != null) m.close();
+            }
+        }
+    }
+
     @Test
     public void testChildren() {
         assumeTrue(Yices.versionOrdinal() >= Yices.versionOrdinal(2, 6, 2));
@@ -0,0 +1,93 @@
+package com.sri.yices;
+
+import org.junit.Assert;
+import org.junit.Test;
+
+import static org.junit.Assume.assumeTrue;
+
+public class TestTermBatch {
+
+    @Test
+    public void testBooleanBatch() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int boolType = Types.boolType();
+        int p = Terms.newUninterpretedTerm(boolType);
+        int q = Terms.newUninterpretedTerm(boolType);
+        int r = Terms.newUninterpretedTerm(boolType);
+
+        TermBatch b = new TermBatch(4);
+        int r0 = b.and(p, q);
+        int r1 = b.or(r0, r);
+        int r2 = b.not(r1);
+        int r3 = b.implies(r2, b.xor(p, r0));
+        Assert.assertEquals(5, b.count());
+
+        int[] terms = b.build();
+        Assert.assertEquals(5, terms.length);
+        Assert.assertEquals(Terms.and(p, q), TermBatch.term(terms, r0));
+        Assert.assertEquals(Terms.or(Terms.and(p, q), r), TermBatch.term(terms, r1));
+        Assert.assertEquals(Terms.not(terms[~r1]), TermBatch.term(terms, r2));
+        Assert.assertEquals(Terms.implies(terms[~r2], Terms.xor(p, terms[~r0])), TermBatch.term(terms, r3));
+        Assert.assertEquals(p, TermBatch.term(terms, p));
+    }
+
+    @Test
+    public void testArithAndBitvectorBatch() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int x = Terms.newUninterpretedTerm(Types.intType());
+        int u = Terms.newUninterpretedTerm(Types.bvType(32));
+        int v = Terms.newUninterpretedTerm(Types.bvType(32));
+
+        TermBatch b = new TermBatch();
+        int big = b.intConst(1L << 40);
+        int sum = b.add(x, big, b.intConst(-3));
+        int leq = b.arithLeq(sum, b.power(x, 2));
+        int c = b.bvConst(32, 0xdeadbeefL);
+        int e = b.bvExtract(b.bvAdd(u, v, c), 7, 0);
+        int lt = b.bvSLt(b.bvZeroExtend(e, 24), u);
+
+        int[] terms = b.build();
+        Assert.assertEquals(Terms.intConst(1L << 40), TermBatch.term(terms, big));
+        int expected = Terms.add(x, Terms.intConst(1L << 40), Terms.intConst(-3));
+        Assert.assertEquals(expected, TermBatch.term(terms, sum));
+        Assert.assertEquals(Terms.arithLeq(expected, Terms.power(x, 2)), TermBatch.term(terms, leq));
+        Assert.assertEquals(Terms.bvConst(32, 0xdeadbeefL), TermBatch.term(terms, c));
+        int f = Terms.bvExtract(Terms.bvAdd(u, v, Terms.bvConst(32, 0xdeadbeefL)), 7, 0);
+        Assert.assertEquals(f, TermBatch.term(terms, e));
+        Assert.assertEquals(Terms.bvSLt(Terms.bvZeroExtend(f, 24), u), TermBatch.term(terms, lt));
+    }
+
+    @Test
+    public void testBatchErrors() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int x = Terms.newUninterpretedTerm(Types.intType());
+        int p = Terms.newUninterpretedTerm(Types.boolType());
+
+        // type error in the second instruction
+        TermBatch b = new TermBatch();
+        int r0 = b.not(p);
+        b.and(r0, x);
+        try {
+            b.build();
+            Assert.fail("expected a YicesException");
+        } catch (YicesException e) {
+            System.out.println("Batch failed as expected: " + e.getMessage());
+        }
+
+        // forward reference
+        int[] program = { TermBatch.NOT, 1, TermBatch.ref(1), TermBatch.NOT, 1, p };
+        Assert.assertNull(Yices.termBatch(program, 2));
+        Yices.resetError();
+
+        // truncated program
+        Assert.assertNull(Yices.termBatch(new int[] { TermBatch.NOT, 1 }, 1));
+        Yices.resetError();
+
+        // bad arity: no Yices error
+        Assert.assertNull(Yices.termBatch(new int[] { TermBatch.NOT, 2, p, p }, 1));
+        Assert.assertEquals(0, Yices.errorCode());
+    }
+}
@@ -5,6 +5,9 @@ import org.junit.Ignore;
 import org.junit.Test;
 
 import java.math.BigInteger;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
 
 import static org.junit.Assume.assumeTrue;
 
@@ -458,6 +461,50 @@ public class TestYices {
         inspectTerm(Yices.parseBvBin("111000111"));
     }
 
+    @Test
+    public void testDirectBuffers() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int b = Yices.boolType();
+        int bv8 = Yices.bvType(8);
+        int[] p = new int[20];
+        for (int i = 0; i < p.length; i++) {
+            p[i] = Yices.newUninterpretedTerm(b);
+        }
+        IntBuffer buffer = ByteBuffer.allocateDirect(4 * p.length).order(ByteOrder.nativeOrder()).asIntBuffer();
+        buffer.put(p);
+        buffer.flip();
+
+        // more arguments than the old AUX_SIZE stack buffer
+        Assert.assertEquals(Yices.and(p), Terms.and(buffer));
+        Assert.assertEquals(Yices.or(p), Terms.or(buffer));
+        Assert.assertEquals(Yices.xor(p), Terms.xor(buffer));
+        Assert.assertEquals(0, buffer.position());
+
+        // sub-range
+        buffer.position(5).limit(8);
+        Assert.assertEquals(Yices.or(p[5], p[6], p[7]), Terms.or(buffer));
+        buffer.clear();
+
+        // the native code must not modify the buffer (yices_and sorts its argument)
+        for (int i = 0; i < p.length; i++) {
+            Assert.assertEquals(p[i], buffer.get(i));
+        }
+
+        // heap buffers fall back to the array variants
+        IntBuffer heap = IntBuffer.wrap(new int[] { Yices.newUninterpretedTerm(bv8), Yices.bvOne(8) });
+        Assert.assertEquals(Yices.bvAdd(heap.array()), Terms.bvAdd(heap));
+
+        // out of bounds: no Yices error is involved
+        for (int[] r : new int[][] { { 15, 10 }, { -1, 2 } }) {
+            try {
+                Yices.and(buffer, r[0], r[1]);
+                Assert.fail("expected an exception");
+            } catch (IllegalArgumentException e) {
+            }
+        }
+    }
+
     static private void tstMpz(String number) {
         System.out.println("Input: " + number);
         BigInteger base = new BigInteger(number);
@@ -739,4 +786,411 @@ public class TestYices {
         System.out.println(" number of types: " + Yices.yicesNumTypes());
         System.out.println();
     }
+
+    /*
+     * Handles and reference counters (no garbage collection: see testGC)
+     */
+    @Test
+    public void testTermHandles() throws Exception {
+        RefQueue.flush();
+        int base = Yices.yicesNumPosrefTerms();
+        int x = Terms.newUninterpretedTerm(Types.BOOL);
+        int y = Terms.newUninterpretedTerm(Types.BOOL);
+        TermHandle hx = TermHandle.of(x);
+        TermHandle hy = TermHandle.of(y);
+        TypeHandle hb = TypeHandle.of(Types.BOOL);
+        Assert.assertTrue(RefQueue.pending() >= 3);
+        RefQueue.flush();
+        Assert.assertEquals(0, RefQueue.pending());
+        Assert.assertEquals(base + 2, Yices.yicesNumPosrefTerms());
+
+        hy.release();
+        hy.release();
+        RefQueue.flush();
+        Assert.assertEquals(base + 1, Yices.yicesNumPosrefTerms());
+        Assert.assertEquals(TermHandle.of(x), hx);
+        hx.release();
+        hb.release();
+
+        // overflow of the queue
+        TermHandle[] a = new TermHandle[RefQueue.CAPACITY + 10];
+        for (int i = 0; i < a.length; i++) {
+            a[i] = TermHandle.of(x);
+        }
+        Assert.assertTrue(RefQueue.pending() < RefQueue.CAPACITY);
+        for (TermHandle h : a) h.release();
+        RefQueue.flush();
+        Assert.assertEquals(0, RefQueue.failures());
+
+        // collection policy
+        Assert.assertTrue(TermCollector.shouldCollect(200, 0, 2.0, 100));
+        Assert.assertFalse(TermCollector.shouldCollect(50, 0, 2.0, 100));
+        Assert.assertFalse(TermCollector.shouldCollect(300, 200, 2.0, 100));
+        Assert.assertTrue(TermCollector.shouldCollect(400, 200, 2.0, 100));
+    }
+
+    @Test
+    public void testTermInfo() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int x = Terms.newUninterpretedTerm("ti_x", Types.bvType(8));
+        int y = Terms.newUninterpretedTerm("ti_y", Types.bvType(8));
+        int t = Terms.bvAdd(x, y);
+        int f = Terms.bvLe(t, x);
+
+        TermInfo info = Terms.info(f);
+        Assert.assertEquals(Terms.constructor(f), info.constructor());
+        Assert.assertEquals(Terms.typeOf(f), info.type());
+        Assert.assertTrue(info.isBool());
+        Assert.assertFalse(info.isBitvector());
+        Assert.assertEquals(0, info.bitSize());
+        Assert.assertEquals(info.isComposite(), Terms.isComposite(f));
+        Assert.assertArrayEquals(Terms.children(f), info.children());
+        Assert.assertSame(info, Terms.info(f));
+
+        info = Terms.info(x);
+        Assert.assertTrue(info.isBitvector());
+        Assert.assertTrue(info.isAtomic());
+        Assert.assertEquals(8, info.bitSize());
+        Assert.assertEquals(Constructor.UNINTERPRETED_TERM, info.constructor());
+        Assert.assertEquals(0, info.children().length);
+
+        info = Terms.info(t);
+        Assert.assertEquals(Terms.isBvSum(t), info.isBvSum());
+        Assert.assertEquals(Terms.numChildren(t), info.numChildren());
+
+        // projection
+        int p = Terms.newUninterpretedTerm(Types.tupleType(Types.INT, Types.BOOL));
+        int s = Terms.select(2, p);
+        info = Terms.info(s);
+        Assert.assertTrue(info.isProjection());
+        Assert.assertEquals(Terms.projIndex(s), info.projIndex());
+        Assert.assertEquals(p, info.child(0));
+
+        Assert.assertTrue(Terms.infoCacheSize() > 0);
+        Yices.yicesGarbageCollect(true);
+        Assert.assertEquals(0, Terms.infoCacheSize());
+
+        try {
+            Terms.info(-5);
+            Assert.fail("expected an exception");
+        } catch (YicesException e) {
+        }
+    }
+
+    @Test
+    public void testParseBatch() throws Exception {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int x = Terms.newUninterpretedTerm("pb_x", Types.INT);
+        String text = "(> pb_x 0)\n pb_x ; a comment (\n(+ pb_x pb_undefined) (and true\n false)\n)";
+
+        ParseBatch p = Terms.parseAll(text);
+        Assert.assertEquals(5, p.size());
+        Assert.assertEquals(Terms.arithGt0(x), p.get(0));
+        Assert.assertEquals(x, p.get(1));
+        Assert.assertTrue(p.isError(2));
+        Assert.assertNotEquals(0, p.errorCode(2));
+        Assert.assertEquals(Terms.FALSE, p.get(3));
+        Assert.assertTrue(p.isError(4));
+        Assert.assertArrayEquals(new int[] { 2, 4 }, p.errors());
+        Assert.assertEquals("pb_x", text.substring(p.start(1), p.end(1)));
+        Assert.assertEquals(0, p.errorCode(0));
+
+        // direct buffer and file
+        byte[] bytes = text.getBytes(java.nio.charset.StandardCharsets.UTF_8);
+        ByteBuffer b = ByteBuffer.allocateDirect(bytes.length + 3);
+        b.put(new byte[3]).put(bytes).flip().position(3);
+        Assert.assertArrayEquals(p.results(), Terms.parseAll(b).results());
+        Assert.assertEquals(3, b.position());
+        Assert.assertEquals(0, Terms.parseAll(ByteBuffer.allocateDirect(0)).size());
+
+        java.nio.file.Path file = java.nio.file.Files.createTempFile("yices", ".ys");
+        try {
+            java.nio.file.Files.write(file, bytes);
+            Assert.assertArrayEquals(p.results(), Terms.parseFile(file).results());
+            // empty file
+            java.nio.file.Files.write(file, new byte[0]);
+            Assert.assertEquals(0, Terms.parseFile(file).size());
+        } finally {
+            java.nio.file.Files.delete(file);
+        }
+
+        // types
+        p = Types.parseAll("int (bitvector 8) (-> int bool) bogus");
+        Assert.assertEquals(4, p.size());
+        Assert.assertEquals(Types.INT, p.get(0));
+        Assert.assertEquals(Types.bvType(8), p.get(1));
+        Assert.assertEquals(1, p.errorCount());
+    }
+
+    @Test
+    public void testTermSnapshot() throws Exception {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int u = Yices.newUninterpretedType();
+        Yices.setTypeName(u, "snap_U");
+        int x = Terms.newUninterpretedTerm("snap_x", Types.INT);
+        int y = Terms.newUninterpretedTerm("snap_y", Types.REAL);
+        int b = Terms.newUninterpretedTerm("snap_b", Types.bvType(8));
+        int f = Terms.newUninterpretedTerm("snap_f", Types.functionType(Types.INT, u));
+        int v = Terms.newVariable("snap_v", Types.INT);
+
+        int[] roots = {
+            Terms.arithGt(Terms.add(Terms.mul(Terms.intConst(3), x), Terms.rationalConst(-1, 7)), y),
+            Terms.bvLt(Terms.bvMul(b, b), Terms.bvConst(8, 200)),
+            Terms.eq(Terms.funApplication(f, x), Terms.funApplication(f, Terms.intConst(0))),
+            Terms.forall(new int[] { v }, Terms.arithGeq(Terms.mul(v, v), Terms.ZERO)),
+            Terms.arithGeq(Terms.intConst(BigInteger.TEN.pow(30)), Terms.mul(x, y)),
+        };
+        Yices.setTermName(roots[0], "snap_root");
+
+        byte[] snapshot = TermSnapshot.save(roots);
+
+        // the uninterpreted terms have the same names and types: the terms are rebuilt as is
+        Assert.assertArrayEquals(roots, TermSnapshot.load(snapshot));
+
+        java.nio.file.Path file = java.nio.file.Files.createTempFile("yices", ".snap");
+        try {
+            TermSnapshot.save(file, roots);
+            Assert.assertArrayEquals(roots, TermSnapshot.load(file));
+        } finally {
+            java.nio.file.Files.delete(file);
+        }
+
+        // without names, all uninterpreted terms and types are fresh
+        int[] copy = TermSnapshot.load(TermSnapshot.save(roots, false));
+        Assert.assertEquals(roots.length, copy.length);
+        Assert.assertNotEquals(roots[0], copy[0]);
+        Assert.assertEquals(Terms.dagSize(roots), Terms.dagSize(copy));
+
+        try {
+            TermSnapshot.load(new byte[] { 1, 2, 3, 4 });
+            Assert.fail("expected an exception");
+        } catch (IllegalArgumentException e) {
+        }
+
+        // corrupted length of the first name (word 8, after the header, kind, and index)
+        byte[] bad = snapshot.clone();
+        for (int i = 32; i < 36; i++) bad[i] = (byte) 0xFF;
+        try {
+            TermSnapshot.load(bad);
+            Assert.fail("expected an exception");
+        } catch (IllegalArgumentException e) {
+        }
+    }
+
+    @Test
+    public void testTermDag() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int g = Terms.newUninterpretedTerm(Types.functionType(Types.INT, Types.INT, Types.BOOL));
+        int h = Terms.newUninterpretedTerm(Types.functionType(Types.INT, Types.INT));
+        int a = Terms.newUninterpretedTerm(Types.INT);
+        int ha = Terms.funApplication(h, a);
+        int k = Terms.funApplication(g, ha, ha);
+
+        // g, h, a, (h a), (g (h a) (h a))
+        TermDag dag = Terms.dag(k);
+        Assert.assertEquals(5, dag.size());
+        Assert.assertEquals(k, dag.term(dag.size() - 1));
+        for (int i = 0; i < dag.size(); i++) {
+            for (int j = 0; j < dag.numChildren(i); j++) {
+                Assert.assertTrue(dag.child(i, j) < i);
+            }
+        }
+        int i = dag.indexOf(k);
+        Assert.assertEquals(Constructor.APP_TERM, dag.constructor(i));
+        Assert.assertEquals(3, dag.numChildren(i));
+        Assert.assertEquals(dag.indexOf(ha), dag.child(i, 1));
+        Assert.assertEquals(dag.child(i, 1), dag.child(i, 2));
+        Assert.assertEquals(-1, dag.indexOf(Terms.TRUE));
+
+        Assert.assertEquals(5, Terms.dagSize(k));
+        Assert.assertEquals(8, Terms.treeSize(k));
+        Assert.assertEquals(3, Terms.uninterpretedTerms(k).length);
+        Assert.assertEquals(0, Terms.freeVariables(k).length);
+
+        // free variables
+        int x = Terms.newVariable(Types.INT);
+        int y = Terms.newVariable(Types.INT);
+        int body = Terms.funApplication(g, x, y);
+        int q = Terms.forall(new int[] { x }, body);
+        Assert.assertArrayEquals(new int[] { y }, Terms.freeVariables(q));
+        Assert.assertEquals(2, Terms.freeVariables(body).length);
+        Assert.assertArrayEquals(new int[] { g }, Terms.uninterpretedTerms(q));
+
+        try {
+            Terms.dag(-5);
+            Assert.fail("expected an exception");
+        } catch (YicesException e) {
+        }
+    }
+
+    @Test
+    public void testSubstitution() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int x0 = Terms.newVariable(Types.INT);
+        int x1 = Terms.newVariable(Types.INT);
+        int x2 = Terms.newVariable(Types.INT);
+        int[] vars = { x0, x1 };
+        int[] next = { x1, x2 };
+        int t = Terms.arithLt(x0, x1);
+        int u = Terms.add(x0, Terms.intConst(1));
+
+        try (Substitution s = new Substitution(vars, next)) {
+            int w = s.apply(t);
+            Assert.assertEquals(Terms.subst(t, vars, next), w);
+            Assert.assertEquals(1, s.misses());
+            Assert.assertEquals(s.apply(t), w);
+            Assert.assertEquals(1, s.hits());
+
+            int[] a = { t, u, t, x0, Terms.intConst(3) };
+            int[] b = a.clone();
+            Terms.substArray(b, vars, next);
+            s.applyArray(a);
+            Assert.assertArrayEquals(b, a);
+            Assert.assertEquals(4, s.memoSize());
+
+            // the memo table is emptied by the garbage collector
+            Yices.yicesGarbageCollect(new int[] { t, u }, null, false);
+            Assert.assertEquals(0, s.memoSize());
+            Assert.assertEquals(Terms.subst(t, vars, next), s.apply(t));
+            s.clearMemo();
+            Assert.assertEquals(0, s.hits() + s.misses());
+        }
+
+        try {
+            new Substitution(new int[] { x0 }, new int[] { Terms.TRUE });
+            Assert.fail("ill-typed substitution");
+        } catch (YicesException e) {
+            // expected
+        }
+    }
+
+    @Test
+    public void testProfiler() throws Exception {
+        // buckets
+        for (long t = 0; t < 100000; t++) {
+            int b = Profiler.bucket(t);
+            Assert.assertTrue(Profiler.bucketLowerBound(b) <= t);
+            Assert.assertTrue(b + 1 == Profiler.NUM_BUCKETS || t < Profiler.bucketLowerBound(b + 1));
+        }
+        Assert.assertTrue(Profiler.bucket(Long.MAX_VALUE) < Profiler.NUM_BUCKETS);
+
+        // concurrent updates
+        Thread[] threads = new Thread[8];
+        for (int i = 0; i < threads.length; i++) {
+            threads[i] = new Thread(() -> {
+                for (int k = 0; k < 10000; k++) {
+                    Profiler.delta("Test.profiler", 0, 1000 + k % 10);
+                }
+            });
+            threads[i].start();
+        }
+        for (Thread t : threads) {
+            t.join();
+        }
+        Profiler.Snapshot s = Profiler.snapshot().get("Test.profiler");
+        Assert.assertEquals(80000, s.calls);
+        Assert.assertEquals(1009, s.maxNanos);
+        Assert.assertTrue(s.percentileNanos(50) >= 768 && s.percentileNanos(50) <= 1009);
+        Profiler.registerMBean();
+        Profiler.clear();
+        Assert.assertNull(Profiler.snapshot().get("Test.profiler"));
+    }
+
+    @Test
+    public void testNativeTracing() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        if (!Yices.setNativeTracing(true)) {
+            // the library was built without tracing
+            Assert.assertEquals(0, Yices.nativeStats()[0]);
+            Assert.assertEquals(0, Yices.nativeTraceNames().length);
+            return;
+        }
+        try {
+            Yices.resetNativeStats();
+            int x = Terms.newUninterpretedTerm(Types.INT);
+            for (int i = 0; i < 10; i++) {
+                Terms.add(x, Terms.intConst(i));
+            }
+            java.util.Map<String, long[]> stats = Profiler.nativeSnapshot();
+            long[] add = stats.get("add__II");
+            Assert.assertNotNull(add);
+            Assert.assertEquals(10, add[0]);
+            Assert.assertTrue(add[2] <= add[1]);
+            System.out.println(Profiler.nativeReport());
+        } finally {
+            Yices.setNativeTracing(false);
+        }
+    }
+
+    @Test
+    public void testNoThrow() {
+        assumeTrue(TestAssumptions.IS_YICES_INSTALLED);
+
+        int x = Terms.newUninterpretedTerm(Types.INT);
+        int b = Terms.newUninterpretedTerm(Types.BOOL);
+
+        Assert.assertFalse(NoThrow.isEnabled());
+        try (NoThrow scope = NoThrow.enter()) {
+            Assert.assertTrue(NoThrow.isEnabled());
+            NoThrow.clearError();
+            Assert.assertEquals(0, NoThrow.errorCode());
+
+            // type mismatch
+            Assert.assertEquals(Terms.NULL_TERM, Terms.add(x, b));
+            int code = NoThrow.errorCode();
+            Assert.assertTrue(code != 0);
+            // the Yices error is cleared, the slot is not
+            Assert.assertEquals(0, Yices.errorCode());
+            Assert.assertTrue(Terms.add(x, x) >= 0);
+            Assert.assertEquals(code, NoThrow.errorCode());
+
+            ErrorReport report = NoThrow.errorReport();
+            Assert.assertEquals(code, report.code);
+            Assert.assertEquals(b, report.term1);
+            Assert.assertTrue(NoThrow.errorString().length() > 0);
+            Assert.assertEquals(code, NoThrow.error().errorReport.code);
+
+            Assert.assertEquals(Types.NULL_TYPE, Types.bvType(Integer.MAX_VALUE));
+            Assert.assertTrue(NoThrow.errorCode() != code);
+
+            // x is not a function
+            Assert.assertEquals(Terms.NULL_TERM, Terms.funApplication(x, x));
+            Assert.assertTrue(NoThrow.errorCode() != 0);
+
+            // nested scopes
+            try (NoThrow inner = NoThrow.enter()) {
+                Assert.assertEquals(Terms.NULL_TERM, Terms.not(x));
+            }
+            Assert.assertTrue(NoThrow.isEnabled());
+
+            // other threads still throw
+            boolean[] thrown = new boolean[1];
+            Thread t = new Thread(() -> {
+                try {
+                    Terms.not(x);
+                } catch (YicesException e) {
+                    thrown[0] = true;
+                }
+            });
+            t.start();
+            t.join();
+            Assert.assertTrue(thrown[0]);
+        } catch (InterruptedException e) {
+            throw new RuntimeException(e);
+        }
+        Assert.assertFalse(NoThrow.isEnabled());
+
+        try {
+            Terms.add(x, b);
+            Assert.fail("expected a YicesException");
+        } catch (YicesException e) {
+            Assert.assertTrue(e.errorReport.code != 0);
+        }
+    }
 }